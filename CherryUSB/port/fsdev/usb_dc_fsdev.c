@@ -325,7 +325,7 @@ int usbd_ep_start_read(uint8_t busid, const uint8_t ep, uint8_t *data, uint32_t
     return 0;
 }
 
-void USBD_IRQHandler(uint8_t busid)
+USB_CCMRAM_TEXT_SECTION void USBD_IRQHandler(uint8_t busid)
 {
     uint16_t wIstr, wEPVal;
     uint8_t ep_idx;
@@ -499,7 +499,7 @@ void USBD_IRQHandler(uint8_t busid)
     }
 }
 
-static void fsdev_write_pma(USB_TypeDef *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
+USB_CCMRAM_TEXT_SECTION static void fsdev_write_pma(USB_TypeDef *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
 {
     uint32_t n = ((uint32_t)wNBytes + 1U) >> 1;
     uint32_t BaseAddr = (uint32_t)USBx;
@@ -532,7 +532,7 @@ static void fsdev_write_pma(USB_TypeDef *USBx, uint8_t *pbUsrBuf, uint16_t wPMAB
   * @param   wNBytes no. of bytes to be copied.
   * @retval None
   */
-static void fsdev_read_pma(USB_TypeDef *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
+USB_CCMRAM_TEXT_SECTION static void fsdev_read_pma(USB_TypeDef *USBx, uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
 {
     uint32_t n = (uint32_t)wNBytes >> 1;
     uint32_t BaseAddr = (uint32_t)USBx;
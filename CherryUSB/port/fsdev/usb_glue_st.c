@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "usbd_core.h"
+#include "ccmram.h"
 
 #if __has_include("stm32f0xx_hal.h")
 #include "stm32f0xx_hal.h"
@@ -60,7 +61,10 @@ void USB_IRQHandler(void)
     USBD_IRQHandler(0);
 }
 
-void USB_LP_IRQHandler(void)
+USB_CCMRAM_TEXT_SECTION void USB_LP_IRQHandler(void)
 {
+    uint32_t start = DWT->CYCCNT;
+
     USBD_IRQHandler(0);
+    CCM_UsbIrqDone(start);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "usbd_core.h"
 #include "usbd_cdc_acm.h"
 #include "chry_ringbuffer.h"  // 引入CherryRingBuffer头文件
+#include "mempool.h"          // 发送缓冲区来自POOL_USB
 
 /*!< endpoint address */
 #define CDC_IN_EP  0x81
@@ -32,6 +33,10 @@
 #define CDC_TX_RINGBUF_SIZE  (4096)  // 发送环形缓冲区大小
 #define CDC_USB_READ_SIZE    (2048)  // USB单次读取大小
 
+#if (CDC_USB_READ_SIZE > POOL_USB_SIZE)
+#error "CDC_USB_READ_SIZE exceeds POOL_USB_SIZE"
+#endif
+
 /* RingBuffer实例 */
 static chry_ringbuffer_t rx_ringbuf;
 static chry_ringbuffer_t tx_ringbuf;
@@ -42,7 +47,9 @@ USB_NOCACHE_RAM_SECTION USB_MEM_ALIGNX uint8_t tx_ringbuf_pool[CDC_TX_RINGBUF_SI
 
 /* USB临时缓冲区 */
 USB_NOCACHE_RAM_SECTION USB_MEM_ALIGNX uint8_t usb_read_buffer[CDC_USB_READ_SIZE];
-USB_NOCACHE_RAM_SECTION USB_MEM_ALIGNX uint8_t usb_write_buffer[CDC_USB_READ_SIZE];
+
+/* USB发送缓冲区：每次传输从POOL_USB取一块，传输完成或断开时归还 */
+static uint8_t *volatile usb_write_block;
 
 volatile bool ep_tx_busy_flag = false;
 volatile uint8_t dtr_enable = 0;
@@ -53,6 +60,7 @@ void usbd_cdc_acm_bulk_out(uint8_t busid, uint8_t ep, uint32_t nbytes);
 void usbd_cdc_acm_bulk_in(uint8_t busid, uint8_t ep, uint32_t nbytes);
 void usbd_cdc_acm_set_dtr(uint8_t busid, uint8_t intf, bool dtr);
 void cdc_acm_try_send(uint8_t busid);
+static void cdc_acm_release_write(void);
 
 /* ========== 描述符定义 (保持原样) ========== */
 #ifdef CONFIG_USBDEV_ADVANCE_DESC
@@ -173,6 +181,7 @@ static void usbd_event_handler(uint8_t busid, uint8_t event)
             // 断开连接时清空缓冲区
             chry_ringbuffer_reset(&rx_ringbuf);
             chry_ringbuffer_reset(&tx_ringbuf);
+            cdc_acm_release_write();
             ep_tx_busy_flag = false;
             break;
             
@@ -183,6 +192,7 @@ static void usbd_event_handler(uint8_t busid, uint8_t event)
             break;
             
         case USBD_EVENT_CONFIGURED:
+            cdc_acm_release_write();
             ep_tx_busy_flag = false;
             // 启动第一次USB接收
             usbd_ep_start_read(busid, CDC_OUT_EP, usb_read_buffer, CDC_USB_READ_SIZE);
@@ -227,6 +237,7 @@ void usbd_cdc_acm_bulk_in(uint8_t busid, uint8_t ep, uint32_t nbytes)
     if ((nbytes % usbd_get_ep_mps(busid, ep)) == 0 && nbytes) {
         usbd_ep_start_write(busid, CDC_IN_EP, NULL, 0);
     } else {
+        cdc_acm_release_write();
         ep_tx_busy_flag = false;
         
         // 发送完成后，检查是否还有待发送数据
@@ -299,15 +310,33 @@ void cdc_acm_try_send(uint8_t busid)
     // 限制单次发送大小
     uint32_t send_size = (available > CDC_USB_READ_SIZE) ? CDC_USB_READ_SIZE : available;
     
+    // 取发送缓冲区，只有一块：上一次传输未完成时取不到
+    uint8_t *block = POOL_Alloc(POOL_USB, "cdc");
+    if (block == NULL) {
+        return;
+    }
+
     // 从环形缓冲区读取数据到USB发送缓冲区
-    uint32_t read_size = chry_ringbuffer_read(&tx_ringbuf, usb_write_buffer, send_size);
+    uint32_t read_size = chry_ringbuffer_read(&tx_ringbuf, block, send_size);
     
     if (read_size > 0) {
+        usb_write_block = block;
         ep_tx_busy_flag = true;
-        usbd_ep_start_write(busid, CDC_IN_EP, usb_write_buffer, read_size);
+        usbd_ep_start_write(busid, CDC_IN_EP, block, read_size);
+    } else {
+        POOL_Free(block);
     }
 }
 
+/* 归还发送缓冲区 */
+static void cdc_acm_release_write(void)
+{
+    uint8_t *block = usb_write_block;
+
+    usb_write_block = NULL;
+    POOL_Free(block);
+}
+
 /* ========== 应用层API：写入数据到发送缓冲区 ========== */
 int cdc_acm_send_data(uint8_t busid, const uint8_t *data, uint32_t len)
 {
@@ -35,6 +35,13 @@
 /* attribute data into no cache ram */
 #define USB_NOCACHE_RAM_SECTION __attribute__((section(".noncacheable")))
 
+/* attribute the device interrupt path into ccm ram (make CCMRAM=0 keeps it in flash) */
+#ifdef CCMRAM_DISABLE
+#define USB_CCMRAM_TEXT_SECTION
+#else
+#define USB_CCMRAM_TEXT_SECTION __attribute__((section(".ccmram_text")))
+#endif
+
 /* use usb_memcpy default for high performance but cost more flash memory.
  * And, arm libc has a bug that memcpy() may cause data misalignment when the size is not a multiple of 4.
 */
@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    ccmram.h
+  * @brief   CCM SRAM usage and timings of the code placed there.
+  ******************************************************************************
+  * @attention
+  *
+  * The 16 KB CCM SRAM sits on the I-Code/D-Code buses at 0x10000000: code
+  * there runs without the flash wait states (4 at 170 MHz) and data there
+  * does not compete with the DMA for SRAM1. CCMRAM_TEXT, CCMRAM_DATA and
+  * CCMRAM_BSS (main.h) place the FFT and window kernels, the decimation
+  * filters, the DSP scratch buffer and the USB device interrupt path in
+  * it; the startup copies and clears the sections.
+  *
+  * "ccm" reports the space used, the cycles of a 1024-point real FFT on
+  * each engine and the cycles of the USB interrupts taken since the last
+  * "ccm reset". Built with make CCMRAM=0 everything stays in flash and
+  * SRAM1, so that the two builds can be compared at the same clock
+  * profile.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CCMRAM_H
+#define __CCMRAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CCM_BENCH_SIZE            1024U   /* Real points of the FFT timing     */
+#define CCM_BENCH_RUNS            8U      /* Timed runs, the fastest is kept   */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void CCM_Init(void);
+void CCM_UsbIrqDone(uint32_t start);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CCMRAM_H */
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    console.h
+  * @brief   Line based command console on the USB CDC ACM port.
+  ******************************************************************************
+  * @attention
+  *
+  * Commands are registered at start-up with CON_Register() and executed from
+  * CON_Process(), which the main loop calls from USBPD_DPM_UserExecute().
+  * A line is split at spaces into at most CON_ARGS_MAX arguments, argv[0]
+  * being the command name. Handlers run in thread mode and may block; they
+  * print with CON_Write()/CON_Printf(). The console answers "OK" or
+  * "ERR <code>" after each handler returns.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CONSOLE_H
+#define __CONSOLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CON_LINE_MAX        96U
+#define CON_ARGS_MAX        8U
+#define CON_COMMANDS_MAX    24U
+#define CON_PRINTF_MAX      384U  /* Longest CON_Printf() output, one JSON line */
+#define CON_TX_TIMEOUT      100U  /* ms without progress before output is dropped */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  CON_OK = 0,
+  CON_ERROR,
+  CON_ERROR_FULL,
+} CON_StatusTypeDef;
+
+/* Returns 0 on success, a command specific error code otherwise */
+typedef int32_t (*CON_HandlerTypeDef)(int32_t argc, char *argv[]);
+
+typedef struct
+{
+  const char         *Name;
+  const char         *Help;     /* One line usage shown by "help" */
+  CON_HandlerTypeDef  Handler;
+} CON_CommandTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+CON_StatusTypeDef CON_Register(const CON_CommandTypeDef *cmd);
+void              CON_Process(void);
+uint32_t          CON_Write(const void *data, uint32_t len);
+int32_t           CON_Printf(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CONSOLE_H */
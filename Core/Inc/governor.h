@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    governor.h
+  * @brief   Performance governor following the USB PD power budget.
+  ******************************************************************************
+  * @attention
+  *
+  * The DPM reports the power of the explicit contract (or the Type-C default
+  * power without one). The governor derates it and selects the fastest
+  * profile that fits: system clock, voltage scaling range and the limits
+  * the workloads apply to themselves (I2S rate, FFT length, SD write burst).
+  *
+  * Budgets are only recorded by GOV_SetBudget()/GOV_LimitBudget(), the
+  * clock tree is switched from GOV_Process() in the main loop. A lower
+  * request is applied before the Request message leaves, a higher one only
+  * once the source has sent PS_RDY.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __GOVERNOR_H
+#define __GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define GOV_DEFAULT_MW            2500U   /* Type-C default power, 5 V 500 mA   */
+#define GOV_DERATING_PCT          80U     /* Share of the contract the board uses */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  GOV_PROFILE_LOW = 0,      /* 16 MHz, range 2                         */
+  GOV_PROFILE_ECO,          /* 64 MHz, range 1                         */
+  GOV_PROFILE_HIGH,         /* 120 MHz, range 1                        */
+  GOV_PROFILE_PERF,         /* 170 MHz, range 1 boost                  */
+  GOV_PROFILE_COUNT
+} GOV_ProfileTypeDef;
+
+typedef struct
+{
+  uint32_t SysClk;          /* Hz                                      */
+  uint32_t MaxI2sRate;      /* Highest audio sampling rate, Hz         */
+  uint32_t MaxFftSize;      /* Longest FFT, points                     */
+  uint32_t SdBurstSectors;  /* Longest multi-sector SD write           */
+} GOV_LimitsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void                     GOV_Init(void);
+void                     GOV_SetBudget(uint32_t power);
+void                     GOV_LimitBudget(uint32_t power);
+void                     GOV_SetCeiling(GOV_ProfileTypeDef profile);
+void                     GOV_Process(void);
+GOV_ProfileTypeDef       GOV_GetProfile(void);
+const GOV_LimitsTypeDef *GOV_GetLimits(void);
+uint32_t                 GOV_SetI2sRate(uint32_t rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GOVERNOR_H */
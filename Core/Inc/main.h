@@ -58,6 +58,18 @@ extern "C" {
 
 /* Exported macro ------------------------------------------------------------*/
 /* USER CODE BEGIN EM */
+/* Placement in CCM SRAM (code, initialized data, zeroed data), see the
+   .ccmram sections of the linker script. Built with make CCMRAM=0 they
+   stay in flash and SRAM1, as a reference for "ccm" timings. */
+#if defined(CCMRAM_DISABLE)
+#define CCMRAM_TEXT
+#define CCMRAM_DATA
+#define CCMRAM_BSS
+#else
+#define CCMRAM_TEXT         __attribute__((section(".ccmram_text")))
+#define CCMRAM_DATA         __attribute__((section(".ccmram")))
+#define CCMRAM_BSS          __attribute__((section(".ccmram_bss")))
+#endif
 
 /* USER CODE END EM */
 
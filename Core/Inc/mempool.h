@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @file    mempool.h
+  * @brief   Fixed-block pools in a static arena, in place of the heap.
+  ******************************************************************************
+  * @attention
+  *
+  * The arena is sized at compile time from the pool table below and cut
+  * into blocks by POOL_Init(); there is no heap (_sbrk() always fails).
+  * Each pool keeps its free blocks in a list threaded through the blocks
+  * themselves, so POOL_Alloc() and POOL_Free() take a constant time, with
+  * interrupts masked for a few instructions: they may be called from
+  * interrupt handlers.
+  *
+  * Every block in use records its owner tag and the tick it was taken.
+  * "pool" lists the pools with their use, high-water mark and failed
+  * requests, "pool leaks" lists the blocks held and for how long, and
+  * "pool reset" restarts the high-water marks from the current use.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MEMPOOL_H
+#define __MEMPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define POOL_SECTOR_SIZE          512U    /* SD sector                         */
+#define POOL_SECTOR_COUNT         4U
+#define POOL_FRAME_SIZE           2048U   /* 1024 int16, 512 floats, LFN work  */
+#define POOL_FRAME_COUNT          3U
+#define POOL_USB_SIZE             2048U   /* One CDC bulk IN transfer          */
+#define POOL_USB_COUNT            1U
+#define POOL_ALIGN                8U      /* Of every block                    */
+
+#define POOL_BLOCKS               (POOL_SECTOR_COUNT + POOL_FRAME_COUNT + POOL_USB_COUNT)
+#define POOL_ARENA_SIZE           ((POOL_SECTOR_SIZE * POOL_SECTOR_COUNT) \
+                                   + (POOL_FRAME_SIZE * POOL_FRAME_COUNT) \
+                                   + (POOL_USB_SIZE * POOL_USB_COUNT))
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  POOL_SECTOR = 0,
+  POOL_FRAME,
+  POOL_USB,
+  POOL_COUNT,
+} POOL_IdTypeDef;
+
+typedef struct
+{
+  uint32_t BlockSize;
+  uint32_t Blocks;
+  uint32_t Used;
+  uint32_t HighWater;   /* Most blocks in use since the last reset          */
+  uint32_t Allocs;
+  uint32_t Fails;       /* Requests with no block left                      */
+} POOL_StatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void  POOL_Init(void);
+void *POOL_Alloc(POOL_IdTypeDef pool, const char *owner);
+void  POOL_Free(void *block);
+void  POOL_GetStats(POOL_IdTypeDef pool, POOL_StatsTypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEMPOOL_H */
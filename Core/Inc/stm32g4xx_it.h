@@ -62,6 +62,8 @@ void DMA1_Channel4_IRQHandler(void);
 void SPI1_IRQHandler(void);
 void UCPD1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void ADC1_2_IRQHandler(void);
+void RTC_WKUP_IRQHandler(void);
 
 /* USER CODE END EFP */
 
@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file    ccmram.c
+  * @brief   CCM SRAM usage and timings of the code placed there.
+  ******************************************************************************
+  * @attention
+  *
+  * The FFT timings run on the DSP scratch buffer from the console, in the
+  * main loop, like the analyses that share it. The input is a full scale
+  * chirp so that the block floating point path does the same shifts on
+  * every run; it is rewritten before each run, outside the timed part.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_fft.h"
+#include "ccmram.h"
+
+/* Private define ------------------------------------------------------------*/
+#if (CCM_BENCH_SIZE > (2U * DSP_SCRATCH_SIZE))
+#error "CCM_BENCH_SIZE does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+/* USB interrupts since the last reset, written by USB_LP_IRQHandler() */
+static volatile uint32_t CcmUsbCount;
+static volatile uint64_t CcmUsbCycles;
+static volatile uint32_t CcmUsbMax;
+
+/* Private function prototypes -----------------------------------------------*/
+static void     CCM_Fill(int32_t *x, float *f);
+static uint32_t CCM_TimeFixed(void);
+static uint32_t CCM_TimeFloat(void);
+static int32_t  CCM_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef CCM_ConsoleCommand =
+{
+  .Name    = "ccm",
+  .Help    = "ccm [reset] - CCM SRAM use, FFT and USB interrupt cycles",
+  .Handler = CCM_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Chirp over the CCM_BENCH_SIZE points, as q30 in x or as float in f */
+static void CCM_Fill(int32_t *x, float *f)
+{
+  int32_t c;
+  int32_t s;
+  uint32_t k;
+
+  for (k = 0U; k < CCM_BENCH_SIZE; k++)
+  {
+    FFT_Twiddle((k * k) & (DSP_TABLE_SIZE - 1U), &c, &s);
+    if (x != NULL)
+    {
+      x[k] = s >> 1;
+    }
+    else
+    {
+      f[k] = (float)s / 2147483648.0f;
+    }
+  }
+}
+
+static uint32_t CCM_TimeFixed(void)
+{
+  FFT_CpxTypeDef *fft = DSP_GetScratch();
+  uint32_t best = UINT32_MAX;
+  uint32_t start;
+  uint32_t run;
+
+  for (run = 0U; run < CCM_BENCH_RUNS; run++)
+  {
+    CCM_Fill((int32_t *)fft, NULL);
+    start = DWT->CYCCNT;
+    (void)FFT_Real(fft, CCM_BENCH_SIZE);
+    start = DWT->CYCCNT - start;
+    if (start < best)
+    {
+      best = start;
+    }
+  }
+  return best;
+}
+
+static uint32_t CCM_TimeFloat(void)
+{
+  FFT_CpxF32TypeDef *fft = (FFT_CpxF32TypeDef *)DSP_GetScratch();
+  uint32_t best = UINT32_MAX;
+  uint32_t start;
+  uint32_t run;
+
+  for (run = 0U; run < CCM_BENCH_RUNS; run++)
+  {
+    CCM_Fill(NULL, (float *)fft);
+    start = DWT->CYCCNT;
+    FFT_RealF32(fft, CCM_BENCH_SIZE);
+    start = DWT->CYCCNT - start;
+    if (start < best)
+    {
+      best = start;
+    }
+  }
+  return best;
+}
+
+static int32_t CCM_Command(int32_t argc, char *argv[])
+{
+  extern uint8_t _sccmram; /* Symbols defined in the linker script */
+  extern uint8_t _eccmram;
+  extern uint8_t _sccmbss;
+  extern uint8_t _eccmbss;
+  uint32_t init = (uint32_t)&_eccmram - (uint32_t)&_sccmram;
+  uint32_t zero = (uint32_t)&_eccmbss - (uint32_t)&_sccmbss;
+  uint32_t primask;
+  uint32_t count;
+  uint32_t max;
+  uint64_t cycles;
+
+  if ((argc > 1) && (strcmp(argv[1], "reset") != 0))
+  {
+    return 1;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  count  = CcmUsbCount;
+  cycles = CcmUsbCycles;
+  max    = CcmUsbMax;
+  if (argc > 1)
+  {
+    CcmUsbCount  = 0U;
+    CcmUsbCycles = 0U;
+    CcmUsbMax    = 0U;
+  }
+  __set_PRIMASK(primask);
+
+#if defined(CCMRAM_DISABLE)
+  (void)CON_Printf("{\"ccm\":0,");
+#else
+  (void)CON_Printf("{\"ccm\":1,");
+#endif
+  (void)CON_Printf("\"sysclk\":%lu,\"init\":%lu,\"bss\":%lu,\"free\":%lu,"
+                   "\"fft_n\":%lu,\"fft_fixed\":%lu,\"fft_float\":%lu,"
+                   "\"usb_irqs\":%lu,\"usb_mean\":%lu,\"usb_max\":%lu}\r\n",
+                   (unsigned long)SystemCoreClock, (unsigned long)init, (unsigned long)zero,
+                   (unsigned long)(CCMSRAM_SIZE - init - zero), (unsigned long)CCM_BENCH_SIZE,
+                   (unsigned long)CCM_TimeFixed(), (unsigned long)CCM_TimeFloat(),
+                   (unsigned long)count,
+                   (unsigned long)((count != 0U) ? (cycles / count) : 0U), (unsigned long)max);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "ccm" command
+  * @retval None
+  */
+void CCM_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  (void)CON_Register(&CCM_ConsoleCommand);
+}
+
+/**
+  * @brief  Records the cycles of a USB interrupt
+  * @note   Called at the end of USB_LP_IRQHandler().
+  * @param  start: DWT->CYCCNT on entry
+  * @retval None
+  */
+CCMRAM_TEXT void CCM_UsbIrqDone(uint32_t start)
+{
+  uint32_t cycles = DWT->CYCCNT - start;
+
+  CcmUsbCount++;
+  CcmUsbCycles += cycles;
+  if (cycles > CcmUsbMax)
+  {
+    CcmUsbMax = cycles;
+  }
+}
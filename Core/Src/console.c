@@ -0,0 +1,234 @@
+/**
+  ******************************************************************************
+  * @file    console.c
+  * @brief   Line based command console on the USB CDC ACM port.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "cdc_acm_ringbuffer.h"
+
+/* Private define ------------------------------------------------------------*/
+#define CON_BUSID           0U
+
+/* Private variables ---------------------------------------------------------*/
+static const CON_CommandTypeDef *CON_Commands[CON_COMMANDS_MAX];
+static uint32_t CON_CommandCount;
+static char CON_Line[CON_LINE_MAX];
+static uint32_t CON_LineLen;
+static uint8_t CON_Overflow;
+
+/* Private function prototypes -----------------------------------------------*/
+static void CON_Execute(char *line);
+static int32_t CON_Help(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef CON_HelpCommand =
+{
+  .Name    = "help",
+  .Help    = "help - list commands",
+  .Handler = CON_Help,
+};
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Adds a command to the console
+  * @param  cmd: Command descriptor, must stay valid (usually const)
+  * @retval CON_OK or CON_ERROR_FULL
+  */
+CON_StatusTypeDef CON_Register(const CON_CommandTypeDef *cmd)
+{
+  if ((cmd == NULL) || (cmd->Name == NULL) || (cmd->Handler == NULL))
+  {
+    return CON_ERROR;
+  }
+  if (CON_CommandCount >= CON_COMMANDS_MAX)
+  {
+    return CON_ERROR_FULL;
+  }
+
+  CON_Commands[CON_CommandCount++] = cmd;
+
+  return CON_OK;
+}
+
+/**
+  * @brief  Collects received characters and runs complete lines
+  * @note   Called from the main loop, never from an interrupt.
+  * @retval None
+  */
+void CON_Process(void)
+{
+  uint8_t rx[32];
+  int len;
+  int i;
+
+  while ((len = cdc_acm_read_data(rx, sizeof(rx))) > 0)
+  {
+    for (i = 0; i < len; i++)
+    {
+      if ((rx[i] == '\r') || (rx[i] == '\n'))
+      {
+        if ((CON_LineLen != 0U) && (CON_Overflow == 0U))
+        {
+          CON_Line[CON_LineLen] = '\0';
+          CON_Execute(CON_Line);
+        }
+        else if (CON_Overflow != 0U)
+        {
+          CON_Printf("ERR line too long\r\n");
+        }
+        CON_LineLen = 0U;
+        CON_Overflow = 0U;
+      }
+      else if (CON_LineLen < (CON_LINE_MAX - 1U))
+      {
+        CON_Line[CON_LineLen++] = (char)rx[i];
+      }
+      else
+      {
+        CON_Overflow = 1U;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Queues output, waiting for the host while it makes progress
+  * @param  data: Bytes to send
+  * @param  len: Number of bytes
+  * @retval Bytes queued, less than len if the host stopped reading
+  */
+uint32_t CON_Write(const void *data, uint32_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t done = 0U;
+  uint32_t tickstart = HAL_GetTick();
+  int sent;
+
+  while (done < len)
+  {
+    sent = cdc_acm_send_data(CON_BUSID, &p[done], len - done);
+    if (sent > 0)
+    {
+      done += (uint32_t)sent;
+      tickstart = HAL_GetTick();
+    }
+    else if ((HAL_GetTick() - tickstart) >= CON_TX_TIMEOUT)
+    {
+      break;
+    }
+  }
+
+  return done;
+}
+
+/**
+  * @brief  Formatted output to the console
+  * @param  fmt: printf format
+  * @retval Characters queued or -1 on a formatting error
+  */
+int32_t CON_Printf(const char *fmt, ...)
+{
+  char buf[CON_PRINTF_MAX];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+
+  if (len < 0)
+  {
+    return -1;
+  }
+  if ((uint32_t)len >= sizeof(buf))
+  {
+    len = (int)sizeof(buf) - 1;
+  }
+
+  return (int32_t)CON_Write(buf, (uint32_t)len);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void CON_Execute(char *line)
+{
+  char *argv[CON_ARGS_MAX];
+  int32_t argc = 0;
+  int32_t ret;
+  uint32_t i;
+  char *p = line;
+
+  while ((*p != '\0') && (argc < (int32_t)CON_ARGS_MAX))
+  {
+    while (*p == ' ')
+    {
+      *p++ = '\0';
+    }
+    if (*p == '\0')
+    {
+      break;
+    }
+    argv[argc++] = p;
+    while ((*p != ' ') && (*p != '\0'))
+    {
+      p++;
+    }
+  }
+  if (argc == 0)
+  {
+    return;
+  }
+
+  if (strcmp(argv[0], CON_HelpCommand.Name) == 0)
+  {
+    ret = CON_HelpCommand.Handler(argc, argv);
+  }
+  else
+  {
+    for (i = 0U; i < CON_CommandCount; i++)
+    {
+      if (strcmp(argv[0], CON_Commands[i]->Name) == 0)
+      {
+        break;
+      }
+    }
+    if (i == CON_CommandCount)
+    {
+      CON_Printf("ERR unknown command '%s'\r\n", argv[0]);
+      return;
+    }
+    ret = CON_Commands[i]->Handler(argc, argv);
+  }
+
+  if (ret == 0)
+  {
+    CON_Printf("OK\r\n");
+  }
+  else
+  {
+    CON_Printf("ERR %ld\r\n", (long)ret);
+  }
+}
+
+static int32_t CON_Help(int32_t argc, char *argv[])
+{
+  uint32_t i;
+
+  UNUSED(argc);
+  UNUSED(argv);
+
+  CON_Printf("%s\r\n", CON_HelpCommand.Help);
+  for (i = 0U; i < CON_CommandCount; i++)
+  {
+    CON_Printf("%s\r\n", (CON_Commands[i]->Help != NULL) ? CON_Commands[i]->Help : CON_Commands[i]->Name);
+  }
+
+  return 0;
+}
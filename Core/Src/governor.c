@@ -0,0 +1,298 @@
+/**
+  ******************************************************************************
+  * @file    governor.c
+  * @brief   Performance governor following the USB PD power budget.
+  ******************************************************************************
+  * @attention
+  *
+  * All profiles run from the PLL fed by HSE / 2 (4 MHz), as set up by
+  * SystemClock_Config(). A switch goes through SYSCLK = HSE so that the
+  * regulator range and the PLL can be changed at a low frequency, then
+  * HAL_RCC_ClockConfig() updates SystemCoreClock, the flash latency and
+  * SysTick. USB (HSI48), UCPD (HSI16) and the RTC (LSE) do not depend on
+  * SYSCLK; I2S does and is reprogrammed after each switch.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "i2s.h"
+#include "console.h"
+#include "governor.h"
+#include "usbpd_pwr_sense.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  const char        *Name;
+  uint32_t           MinBudget;   /* Derated power needed, mW          */
+  uint32_t           PllN;
+  uint32_t           PllR;        /* RCC_PLLR_DIVx                     */
+  uint32_t           Scale;       /* PWR_REGULATOR_VOLTAGE_SCALEx      */
+  uint32_t           Latency;     /* FLASH_LATENCY_x                   */
+  GOV_LimitsTypeDef  Limits;
+} GOV_ProfileDefTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const GOV_ProfileDefTypeDef GOV_Profiles[GOV_PROFILE_COUNT] =
+{
+  { "low",  0U,    32U, RCC_PLLR_DIV8, PWR_REGULATOR_VOLTAGE_SCALE2,       FLASH_LATENCY_1,
+    {  16000000U, 16000U,  512U,  1U } },
+  { "eco",  1800U, 32U, RCC_PLLR_DIV2, PWR_REGULATOR_VOLTAGE_SCALE1,       FLASH_LATENCY_2,
+    {  64000000U, 48000U, 2048U,  4U } },
+  { "high", 3500U, 60U, RCC_PLLR_DIV2, PWR_REGULATOR_VOLTAGE_SCALE1,       FLASH_LATENCY_3,
+    { 120000000U, 96000U, 4096U, 16U } },
+  { "perf", 6000U, 85U, RCC_PLLR_DIV2, PWR_REGULATOR_VOLTAGE_SCALE1_BOOST, FLASH_LATENCY_4,
+    { 170000000U, 96000U, 8192U, 32U } },
+};
+
+static volatile uint32_t GovBudget  = GOV_DEFAULT_MW;
+static GOV_ProfileTypeDef GovCeiling = GOV_PROFILE_PERF;
+static GOV_ProfileTypeDef GovProfile = GOV_PROFILE_PERF;   /* SystemClock_Config() */
+static uint32_t GovI2sRate;
+static uint8_t  GovI2sPending;
+static uint32_t GovSwitches;
+static uint32_t GovSwitchTick;
+
+/* Private function prototypes -----------------------------------------------*/
+static GOV_ProfileTypeDef GOV_Select(uint32_t budget);
+static void               GOV_Apply(GOV_ProfileTypeDef profile);
+static void               GOV_UpdateI2s(void);
+static int32_t            GOV_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef GOV_ConsoleCommand =
+{
+  .Name    = "gov",
+  .Help    = "gov [auto|low|eco|high|perf] - highest clock profile allowed, power budget",
+  .Handler = GOV_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Fastest profile within the derated budget and the ceiling */
+static GOV_ProfileTypeDef GOV_Select(uint32_t budget)
+{
+  uint32_t usable = (budget * GOV_DERATING_PCT) / 100U;
+  uint32_t profile = (uint32_t)GovCeiling;
+
+  while ((profile > 0U) && (GOV_Profiles[profile].MinBudget > usable))
+  {
+    profile--;
+  }
+  return (GOV_ProfileTypeDef)profile;
+}
+
+static void GOV_Apply(GOV_ProfileTypeDef profile)
+{
+  const GOV_ProfileDefTypeDef *def = &GOV_Profiles[profile];
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  /* The ADC runs from HCLK / 4: no conversion across the switch */
+  PWRS_Suspend();
+
+  /* Park on HSE (8 MHz) with the current latency */
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+                              | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSE;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, __HAL_FLASH_GET_LATENCY()) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  if (HAL_PWREx_ControlVoltageScaling(def->Scale) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLM = RCC_PLLM_DIV2;
+  RCC_OscInitStruct.PLL.PLLN = def->PllN;
+  RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
+  RCC_OscInitStruct.PLL.PLLQ = RCC_PLLQ_DIV2;
+  RCC_OscInitStruct.PLL.PLLR = def->PllR;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, def->Latency) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  PWRS_Resume();
+
+  GovProfile = profile;
+  GovSwitches++;
+  GovSwitchTick = HAL_GetTick();
+  GovI2sPending = 1U;
+}
+
+/* The I2S prescaler follows SYSCLK; only reprogrammed while idle */
+static void GOV_UpdateI2s(void)
+{
+  uint32_t rate = GovI2sRate;
+
+  if (hi2s2.State != HAL_I2S_STATE_READY)
+  {
+    return;
+  }
+  if (rate > GOV_Profiles[GovProfile].Limits.MaxI2sRate)
+  {
+    rate = GOV_Profiles[GovProfile].Limits.MaxI2sRate;
+  }
+  hi2s2.Init.AudioFreq = rate;
+  if (HAL_I2S_Init(&hi2s2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  GovI2sPending = 0U;
+}
+
+static int32_t GOV_Command(int32_t argc, char *argv[])
+{
+  uint32_t profile;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "auto") == 0)
+    {
+      profile = GOV_PROFILE_PERF;
+    }
+    else
+    {
+      for (profile = 0U; profile < GOV_PROFILE_COUNT; profile++)
+      {
+        if (strcmp(argv[1], GOV_Profiles[profile].Name) == 0)
+        {
+          break;
+        }
+      }
+      if (profile == GOV_PROFILE_COUNT)
+      {
+        return 1;
+      }
+    }
+    GOV_SetCeiling((GOV_ProfileTypeDef)profile);
+    GOV_Process();
+  }
+
+  (void)CON_Printf("{\"budget_mw\":%lu,\"usable_mw\":%lu,\"profile\":\"%s\",\"ceiling\":\"%s\",\"sysclk\":%lu,"
+                   "\"i2s_max\":%lu,\"i2s_rate\":%lu,\"fft_max\":%lu,\"sd_burst\":%lu,\"switches\":%lu,"
+                   "\"switch_tick\":%lu}\r\n",
+                   (unsigned long)GovBudget, (unsigned long)((GovBudget * GOV_DERATING_PCT) / 100U),
+                   GOV_Profiles[GovProfile].Name, GOV_Profiles[GovCeiling].Name,
+                   (unsigned long)SystemCoreClock,
+                   (unsigned long)GOV_Profiles[GovProfile].Limits.MaxI2sRate, (unsigned long)hi2s2.Init.AudioFreq,
+                   (unsigned long)GOV_Profiles[GovProfile].Limits.MaxFftSize,
+                   (unsigned long)GOV_Profiles[GovProfile].Limits.SdBurstSectors,
+                   (unsigned long)GovSwitches, (unsigned long)GovSwitchTick);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Applies the profile of the default USB power
+  * @note   Call after MX_I2S2_Init(). Until a contract is reached the board
+  *         must live on the Type-C default power.
+  * @retval None
+  */
+void GOV_Init(void)
+{
+  GovI2sRate = hi2s2.Init.AudioFreq;
+  GOV_Process();
+  (void)CON_Register(&GOV_ConsoleCommand);
+}
+
+/**
+  * @brief  Records the power granted by the source
+  * @param  power: Contract power in mW, GOV_DEFAULT_MW without contract
+  * @retval None
+  */
+void GOV_SetBudget(uint32_t power)
+{
+  GovBudget = power;
+}
+
+/**
+  * @brief  Lowers the budget ahead of a request for less power
+  * @param  power: Power about to be requested in mW
+  * @retval None
+  */
+void GOV_LimitBudget(uint32_t power)
+{
+  if (power < GovBudget)
+  {
+    GovBudget = power;
+  }
+}
+
+/**
+  * @brief  Caps the profiles the governor may select
+  * @param  profile: Fastest profile allowed, GOV_PROFILE_PERF for no cap
+  * @retval None
+  */
+void GOV_SetCeiling(GOV_ProfileTypeDef profile)
+{
+  GovCeiling = profile;
+}
+
+/**
+  * @brief  Switches to the profile of the current budget
+  * @note   Main loop only: the HAL clock functions need the tick.
+  * @retval None
+  */
+void GOV_Process(void)
+{
+  GOV_ProfileTypeDef profile = GOV_Select(GovBudget);
+
+  if (profile != GovProfile)
+  {
+    GOV_Apply(profile);
+  }
+  if (GovI2sPending != 0U)
+  {
+    GOV_UpdateI2s();
+  }
+}
+
+/**
+  * @brief  Profile in use
+  * @retval GOV_ProfileTypeDef
+  */
+GOV_ProfileTypeDef GOV_GetProfile(void)
+{
+  return GovProfile;
+}
+
+/**
+  * @brief  Limits of the profile in use
+  * @retval Pointer to the limits, valid until the next GOV_Process()
+  */
+const GOV_LimitsTypeDef *GOV_GetLimits(void)
+{
+  return &GOV_Profiles[GovProfile].Limits;
+}
+
+/**
+  * @brief  Sets the I2S sampling rate, within the profile limit
+  * @note   Applied by GOV_Process() while I2S is idle, and again after
+  *         every profile change.
+  * @param  rate: Requested rate in Hz
+  * @retval Rate that will be used
+  */
+uint32_t GOV_SetI2sRate(uint32_t rate)
+{
+  GovI2sRate    = rate;
+  GovI2sPending = 1U;
+
+  return (rate > GOV_Profiles[GovProfile].Limits.MaxI2sRate) ? GOV_Profiles[GovProfile].Limits.MaxI2sRate : rate;
+}
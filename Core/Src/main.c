@@ -35,6 +35,10 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "cdc_acm_ringbuffer.h"
+#include "governor.h"
+#include "dsp_app.h"
+#include "ccmram.h"
+#include "mempool.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -86,6 +90,7 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
+  POOL_Init();
 
   /* USER CODE END Init */
 
@@ -114,6 +119,11 @@ int main(void)
 
   cdc_acm_init(u_busid, USB_BASE);
 
+  /* Type-C default power until a PD contract is reached */
+  GOV_Init();
+  DSP_Init();
+  CCM_Init();
+
   /* USER CODE END 2 */
 
   /* USBPD initialisation ---------------------------------*/
@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @file    mempool.c
+  * @brief   Fixed-block pools in a static arena, in place of the heap.
+  ******************************************************************************
+  * @attention
+  *
+  * POOL_Free() finds the pool of a block from its address, so callers only
+  * keep the pointer. A pointer that is not the start of a block in use
+  * (double free, foreign pointer) is refused and counted in "errors".
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "mempool.h"
+
+/* Private define ------------------------------------------------------------*/
+#if ((POOL_SECTOR_SIZE % POOL_ALIGN) != 0U) || ((POOL_FRAME_SIZE % POOL_ALIGN) != 0U) \
+    || ((POOL_USB_SIZE % POOL_ALIGN) != 0U)
+#error "POOL block sizes must be multiples of POOL_ALIGN"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  const char *Name;
+  uint32_t    Size;
+  uint32_t    Count;
+} POOL_DefTypeDef;
+
+typedef struct
+{
+  uint8_t          *Base;
+  uint8_t          *End;
+  void             *Free;     /* First free block, holds the next one      */
+  uint32_t          First;    /* Index of its first block in PoolOwner[]   */
+  POOL_StatsTypeDef Stats;
+} POOL_PoolTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const POOL_DefTypeDef POOL_Defs[POOL_COUNT] =
+{
+  [POOL_SECTOR] = { "sector", POOL_SECTOR_SIZE, POOL_SECTOR_COUNT },
+  [POOL_FRAME]  = { "frame",  POOL_FRAME_SIZE,  POOL_FRAME_COUNT  },
+  [POOL_USB]    = { "usb",    POOL_USB_SIZE,    POOL_USB_COUNT    },
+};
+
+static uint8_t PoolArena[POOL_ARENA_SIZE] __attribute__((aligned(POOL_ALIGN)));
+static POOL_PoolTypeDef PoolPools[POOL_COUNT];
+
+/* Per block, NULL while free */
+static const char *PoolOwner[POOL_BLOCKS];
+static uint32_t    PoolTick[POOL_BLOCKS];
+
+static uint32_t PoolErrors;
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t POOL_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef POOL_ConsoleCommand =
+{
+  .Name    = "pool",
+  .Help    = "pool [leaks|reset] - memory pools, high-water marks, blocks held",
+  .Handler = POOL_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static int32_t POOL_Command(int32_t argc, char *argv[])
+{
+  POOL_StatsTypeDef stats;
+  uint32_t primask;
+  uint32_t id;
+  uint32_t i;
+  uint32_t tick = HAL_GetTick();
+  const char *owner;
+  uint32_t taken;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "leaks") == 0)
+    {
+      for (id = 0U; id < (uint32_t)POOL_COUNT; id++)
+      {
+        for (i = 0U; i < POOL_Defs[id].Count; i++)
+        {
+          primask = __get_PRIMASK();
+          __disable_irq();
+          owner = PoolOwner[PoolPools[id].First + i];
+          taken = PoolTick[PoolPools[id].First + i];
+          __set_PRIMASK(primask);
+          if (owner != NULL)
+          {
+            (void)CON_Printf("{\"pool\":\"%s\",\"block\":%lu,\"owner\":\"%s\",\"age_ms\":%lu}\r\n",
+                             POOL_Defs[id].Name, (unsigned long)i, owner, (unsigned long)(tick - taken));
+          }
+        }
+      }
+      return 0;
+    }
+    if (strcmp(argv[1], "reset") != 0)
+    {
+      return 1;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for (id = 0U; id < (uint32_t)POOL_COUNT; id++)
+    {
+      PoolPools[id].Stats.HighWater = PoolPools[id].Stats.Used;
+      PoolPools[id].Stats.Fails     = 0U;
+    }
+    PoolErrors = 0U;
+    __set_PRIMASK(primask);
+  }
+
+  for (id = 0U; id < (uint32_t)POOL_COUNT; id++)
+  {
+    POOL_GetStats((POOL_IdTypeDef)id, &stats);
+    (void)CON_Printf("{\"pool\":\"%s\",\"size\":%lu,\"blocks\":%lu,\"used\":%lu,\"hwm\":%lu,"
+                     "\"allocs\":%lu,\"fails\":%lu}\r\n",
+                     POOL_Defs[id].Name, (unsigned long)stats.BlockSize, (unsigned long)stats.Blocks,
+                     (unsigned long)stats.Used, (unsigned long)stats.HighWater,
+                     (unsigned long)stats.Allocs, (unsigned long)stats.Fails);
+  }
+  (void)CON_Printf("{\"arena\":%lu,\"errors\":%lu}\r\n",
+                   (unsigned long)POOL_ARENA_SIZE, (unsigned long)PoolErrors);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Cuts the arena into the pools, registers the "pool" command
+  * @note   Call before any allocation, ahead of the FatFs and USB set up.
+  * @retval None
+  */
+void POOL_Init(void)
+{
+  POOL_PoolTypeDef *p;
+  uint8_t *next = PoolArena;
+  uint32_t first = 0U;
+  uint32_t id;
+  uint32_t i;
+
+  for (id = 0U; id < (uint32_t)POOL_COUNT; id++)
+  {
+    p = &PoolPools[id];
+    p->Base  = next;
+    p->End   = next + (POOL_Defs[id].Size * POOL_Defs[id].Count);
+    p->Free  = NULL;
+    p->First = first;
+    (void)memset(&p->Stats, 0, sizeof(p->Stats));
+    p->Stats.BlockSize = POOL_Defs[id].Size;
+    p->Stats.Blocks    = POOL_Defs[id].Count;
+
+    /* Last block pushed first, so that blocks are handed out in order */
+    for (i = POOL_Defs[id].Count; i > 0U; i--)
+    {
+      *(void **)(p->Base + ((i - 1U) * POOL_Defs[id].Size)) = p->Free;
+      p->Free = p->Base + ((i - 1U) * POOL_Defs[id].Size);
+      PoolOwner[first + i - 1U] = NULL;
+    }
+    next   = p->End;
+    first += POOL_Defs[id].Count;
+  }
+  PoolErrors = 0U;
+
+  (void)CON_Register(&POOL_ConsoleCommand);
+}
+
+/**
+  * @brief  Takes a block
+  * @param  pool: POOL_IdTypeDef
+  * @param  owner: Tag shown by "pool leaks", a string literal
+  * @retval Block of POOL_xxx_SIZE bytes, POOL_ALIGN aligned, or NULL
+  */
+void *POOL_Alloc(POOL_IdTypeDef pool, const char *owner)
+{
+  POOL_PoolTypeDef *p;
+  uint32_t primask;
+  uint32_t index;
+  void *block;
+
+  if (pool >= POOL_COUNT)
+  {
+    return NULL;
+  }
+  p = &PoolPools[pool];
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  block = p->Free;
+  if (block == NULL)
+  {
+    p->Stats.Fails++;
+  }
+  else
+  {
+    p->Free = *(void **)block;
+    index = p->First + (((uint32_t)((uint8_t *)block - p->Base)) / p->Stats.BlockSize);
+    PoolOwner[index] = (owner != NULL) ? owner : "?";
+    PoolTick[index]  = HAL_GetTick();
+    p->Stats.Allocs++;
+    if (++p->Stats.Used > p->Stats.HighWater)
+    {
+      p->Stats.HighWater = p->Stats.Used;
+    }
+  }
+  __set_PRIMASK(primask);
+
+  return block;
+}
+
+/**
+  * @brief  Returns a block to its pool
+  * @param  block: From POOL_Alloc(), NULL is ignored
+  * @retval None
+  */
+void POOL_Free(void *block)
+{
+  POOL_PoolTypeDef *p = NULL;
+  uint8_t *b = (uint8_t *)block;
+  uint32_t primask;
+  uint32_t offset;
+  uint32_t index;
+  uint32_t id;
+
+  if (block == NULL)
+  {
+    return;
+  }
+  for (id = 0U; id < (uint32_t)POOL_COUNT; id++)
+  {
+    if ((b >= PoolPools[id].Base) && (b < PoolPools[id].End))
+    {
+      p = &PoolPools[id];
+      break;
+    }
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (p == NULL)
+  {
+    PoolErrors++;
+  }
+  else
+  {
+    offset = (uint32_t)(b - p->Base);
+    index  = p->First + (offset / p->Stats.BlockSize);
+    if (((offset % p->Stats.BlockSize) != 0U) || (PoolOwner[index] == NULL))
+    {
+      PoolErrors++;
+    }
+    else
+    {
+      PoolOwner[index] = NULL;
+      *(void **)block = p->Free;
+      p->Free = block;
+      p->Stats.Used--;
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Use of a pool
+  * @param  pool: POOL_IdTypeDef
+  * @param  stats: Copy of the counters
+  * @retval None
+  */
+void POOL_GetStats(POOL_IdTypeDef pool, POOL_StatsTypeDef *stats)
+{
+  uint32_t primask;
+
+  if (pool >= POOL_COUNT)
+  {
+    (void)memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *stats = PoolPools[pool].Stats;
+  __set_PRIMASK(primask);
+}
@@ -23,6 +23,8 @@
 #include "usbpd.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "usbpd_pwr_sense.h"
+#include "usbpd_lowpower.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -286,5 +288,20 @@ void UCPD1_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles ADC1 and ADC2 global interrupt (VBUS analog watchdog).
+  */
+void ADC1_2_IRQHandler(void)
+{
+  PWRS_IRQHandler();
+}
+
+/**
+  * @brief This function handles RTC wakeup timer interrupt through EXTI line 20 (idle timeout).
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+  LPM_RTC_IRQHandler();
+}
 
 /* USER CODE END 1 */
@@ -0,0 +1,332 @@
+/**
+  ******************************************************************************
+  * @file    dsp_app.c
+  * @brief   Sample ring and scheduler of the signal analysis modules.
+  ******************************************************************************
+  * @attention
+  *
+  * DSP_Process() runs from the DPM loop. It produces the generator samples
+  * due since the last pass, then lets each stage process a bounded amount
+  * of data so that the PD stack is never held for long; the return value
+  * keeps the loop awake while work is left. The chain is:
+  *
+  *   input ring -> decimation (DEC_) -> output ring -> Welch PSD (WEL_)
+  *              -> NCO mixer, I/Q decimation -> zoom FFT (ZOOM_)
+  *              -> weighting, octave-decimation tree -> band levels (OCT_)
+  *              -> Goertzel resonators -> tone levels and events (GTZ_)
+  *              -> FFT frames -> THD, THD+N, SNR, SINAD, ENOB (THD_)
+  *              -> FFT frames -> log-frequency waterfall rows (SPG_)
+  *                 (both on the fixed-point or FPU power path, ENG_)
+  *   input rings x, y -> cross spectra -> H1, H2, coherence (XFR_)
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "governor.h"
+#include "dsp_decim.h"
+#include "dsp_engine.h"
+#include "dsp_gen.h"
+#include "dsp_goertzel.h"
+#include "dsp_octave.h"
+#include "dsp_spectro.h"
+#include "dsp_thd.h"
+#include "dsp_welch.h"
+#include "dsp_xfer.h"
+#include "dsp_zoom.h"
+#include "dsp_app.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DSP_GEN_BACKLOG_MAX       (DSP_RING_SIZE / 2U)  /* Samples, then resync */
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t DspBuffer[DSP_RING_SIZE];
+static int16_t DspBufferY[DSP_RING_SIZE];
+static DSP_RingTypeDef DspInput = { DspBuffer, DSP_RING_SIZE, 0U, 0U };
+static DSP_RingTypeDef DspInputY = { DspBufferY, DSP_RING_SIZE, 0U, 0U };
+static FFT_CpxTypeDef DspScratch[DSP_SCRATCH_SIZE] CCMRAM_BSS __attribute__((aligned(8)));
+
+static DSP_SourceTypeDef DspSource;
+static uint32_t DspRequestedRate = DSP_RATE_DEFAULT;
+static uint32_t DspRate;        /* Hz */
+
+static uint32_t DspGenTick;
+static uint64_t DspGenProduced;
+static uint32_t DspGenResyncs;
+
+static const char *const DSP_SourceNames[DSP_SOURCE_COUNT] = { "off", "gen", "ext" };
+
+/* Private function prototypes -----------------------------------------------*/
+static void    DSP_Generate(void);
+static int32_t DSP_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef DSP_ConsoleCommand =
+{
+  .Name    = "dsp",
+  .Help    = "dsp [fs <hz>|dec <ratio>|gen <hz> [dbfs] [noise_dbfs]|ext|off] - sample source",
+  .Handler = DSP_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void DSP_Generate(void)
+{
+  uint64_t due = ((uint64_t)(HAL_GetTick() - DspGenTick) * DspRate) / 1000U;
+  uint32_t count;
+  uint32_t chunk;
+  int16_t *dst;
+
+  /* Loop held up (SD card, clock switch): skip rather than flood */
+  if ((due - DspGenProduced) > DSP_GEN_BACKLOG_MAX)
+  {
+    DspGenTick = HAL_GetTick();
+    DspGenProduced = 0U;
+    DspGenResyncs++;
+    return;
+  }
+
+  count = (uint32_t)(due - DspGenProduced);
+  while (count != 0U)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    if (chunk > count)
+    {
+      chunk = count;
+    }
+    GEN_Fill(dst, chunk);
+    (void)memcpy(DSP_GetWriteBufferY(), dst, chunk * sizeof(int16_t));
+    DSP_Commit(chunk);
+    count -= chunk;
+    DspGenProduced += chunk;
+  }
+}
+
+static int32_t DSP_Command(int32_t argc, char *argv[])
+{
+  GEN_ConfigTypeDef gen;
+
+  GEN_GetConfig(&gen);
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "fs") == 0) && (argc > 2))
+    {
+      (void)DSP_SetRate((uint32_t)strtoul(argv[2], NULL, 0));
+    }
+    else if ((strcmp(argv[1], "dec") == 0) && (argc > 2))
+    {
+      if (DEC_SetRatio((uint32_t)strtoul(argv[2], NULL, 0)) != DEC_OK)
+      {
+        return 1;
+      }
+      DSP_Reset();
+    }
+    else if ((strcmp(argv[1], "gen") == 0) && (argc > 2))
+    {
+      gen.Frequency = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+      gen.Level     = (argc > 3) ? (int32_t)strtol(argv[3], NULL, 0) : gen.Level;
+      gen.Noise     = (argc > 4) ? (int32_t)strtol(argv[4], NULL, 0) : GEN_LEVEL_OFF;
+      GEN_Configure(&gen, DspRate);
+      DSP_SetSource(DSP_SOURCE_GEN);
+    }
+    else if (strcmp(argv[1], "ext") == 0)
+    {
+      DSP_SetSource(DSP_SOURCE_EXT);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      DSP_SetSource(DSP_SOURCE_OFF);
+    }
+    else
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"source\":\"%s\",\"fs\":%lu,\"fs_req\":%lu,\"written\":%lu,\"dec\":%lu,"
+                   "\"fs_out_mhz\":%lu,\"dec_overruns\":%lu,\"gen_mhz\":%lu,\"gen_dbfs\":%ld,"
+                   "\"noise_dbfs\":%ld,\"resyncs\":%lu}\r\n",
+                   DSP_SourceNames[DspSource], (unsigned long)DspRate, (unsigned long)DspRequestedRate,
+                   (unsigned long)DspInput.Write, (unsigned long)DEC_GetRatio(),
+                   (unsigned long)DEC_GetOutput()->Rate, (unsigned long)DEC_GetOverruns(),
+                   (unsigned long)gen.Frequency, (long)gen.Level, (long)gen.Noise,
+                   (unsigned long)DspGenResyncs);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialises the analysis modules
+  * @note   Call after GOV_Init(), the rate depends on the clock profile,
+  *         and after MX_CORDIC_Init().
+  * @retval None
+  */
+void DSP_Init(void)
+{
+  ENG_Init();
+  WEL_Init();
+  ZOOM_Init();
+  OCT_Init();
+  GTZ_Init();
+  THD_Init();
+  SPG_Init();
+  XFR_Init();
+  (void)DSP_SetRate(DspRequestedRate);
+  (void)CON_Register(&DSP_ConsoleCommand);
+}
+
+/**
+  * @brief  Runs the analysis modules
+  * @note   Main loop only.
+  * @retval 1 if work is left for the next pass
+  */
+uint8_t DSP_Process(void)
+{
+  uint32_t rate = DspRequestedRate;
+  uint8_t pending;
+
+  if (rate > GOV_GetLimits()->MaxI2sRate)
+  {
+    rate = GOV_GetLimits()->MaxI2sRate;
+  }
+  if (rate != DspRate)
+  {
+    DspRate = rate;
+    DSP_Reset();
+  }
+
+  if (DspSource == DSP_SOURCE_GEN)
+  {
+    DSP_Generate();
+  }
+
+  pending  = DEC_Process();
+  pending |= WEL_Process();
+  pending |= ZOOM_Process();
+  pending |= OCT_Process();
+  pending |= GTZ_Process();
+  pending |= THD_Process();
+  pending |= SPG_Process();
+  pending |= XFR_Process();
+
+  /* The generator is paced by the tick, keep polling it */
+  return (DspSource == DSP_SOURCE_GEN) ? 1U : pending;
+}
+
+/**
+  * @brief  Restarts the generator and every stage from the newest samples
+  * @note   Call after a change of rate, source or decimation.
+  * @retval None
+  */
+void DSP_Reset(void)
+{
+  GEN_ConfigTypeDef gen;
+
+  GEN_GetConfig(&gen);
+  GEN_Configure(&gen, DspRate);
+  DspInput.Rate = DspRate * 1000U;
+  DspInputY.Rate = DspInput.Rate;
+  DspGenTick = HAL_GetTick();
+  DspGenProduced = 0U;
+  DEC_Reset();
+  WEL_Reset();
+  ZOOM_Reset();
+  OCT_Reset();
+  GTZ_Reset();
+  THD_Reset();
+  SPG_Reset();
+  XFR_Reset();
+}
+
+/**
+  * @brief  Selects the sample producer
+  * @param  source: DSP_SourceTypeDef
+  * @retval None
+  */
+void DSP_SetSource(DSP_SourceTypeDef source)
+{
+  DspSource = source;
+  DSP_Reset();
+}
+
+/**
+  * @brief  Sets the sampling rate
+  * @param  rate: Requested rate in Hz
+  * @retval Rate in use, capped by the clock profile
+  */
+uint32_t DSP_SetRate(uint32_t rate)
+{
+  DspRequestedRate = rate;
+  DspRate = GOV_SetI2sRate(rate);
+  DSP_Reset();
+  return DspRate;
+}
+
+/**
+  * @brief  Ring filled by the sample producer
+  * @retval Input ring
+  */
+DSP_RingTypeDef *DSP_GetInput(void)
+{
+  return &DspInput;
+}
+
+/**
+  * @brief  Second channel of the input, written with the input ring
+  * @retval Input ring of channel y
+  */
+DSP_RingTypeDef *DSP_GetInputY(void)
+{
+  return &DspInputY;
+}
+
+/**
+  * @brief  FFT buffer shared by the analysis modules
+  * @note   Only valid within one module call: each module fills it,
+  *         transforms and reads it back before returning.
+  * @retval DSP_SCRATCH_SIZE complex values
+  */
+FFT_CpxTypeDef *DSP_GetScratch(void)
+{
+  return DspScratch;
+}
+
+/**
+  * @brief  Room for the next input samples
+  * @note   Producer side, interrupt safe.
+  * @param  count: Contiguous samples that may be written, <= DSP_RING_GUARD
+  * @retval Write pointer
+  */
+int16_t *DSP_GetWriteBuffer(uint32_t *count)
+{
+  return DSP_RingWritePtr(&DspInput, count);
+}
+
+/**
+  * @brief  Room for the next input samples of channel y
+  * @note   Producer side, interrupt safe. Same position and count as
+  *         DSP_GetWriteBuffer(), the channels are committed together.
+  * @retval Write pointer
+  */
+int16_t *DSP_GetWriteBufferY(void)
+{
+  uint32_t count;
+
+  return DSP_RingWritePtr(&DspInputY, &count);
+}
+
+/**
+  * @brief  Publishes input samples written in the buffers of DSP_GetWriteBuffer()
+  *         and DSP_GetWriteBufferY()
+  * @note   Producer side, interrupt safe.
+  * @param  count: Samples written per channel
+  * @retval None
+  */
+void DSP_Commit(uint32_t count)
+{
+  /* y first: a reader of both channels goes by the write index of x */
+  DSP_RingCommit(&DspInputY, count);
+  DSP_RingCommit(&DspInput, count);
+}
@@ -0,0 +1,88 @@
+/**
+  ******************************************************************************
+  * @file    dsp_app.h
+  * @brief   Sample ring and scheduler of the signal analysis modules.
+  ******************************************************************************
+  * @attention
+  *
+  * The analysis modules read int16 samples from rings. The input is a pair
+  * of rings, x (left) and y (right), filled together by a producer
+  * (converter DMA callback or the test generator), which writes at most
+  * DSP_RING_GUARD samples per channel at a time in the buffers returned by
+  * DSP_GetWriteBuffer() and DSP_GetWriteBufferY(), then publishes both
+  * with DSP_Commit(); all may be called from an interrupt. The single
+  * channel analyses read x only, the transfer function both. The
+  * generator writes the same signal on both channels. Processing stages
+  * (decimation) fill their own output ring the same way from the main
+  * loop.
+  *
+  * Consumers keep their own 32-bit sample index and read in place, without
+  * copies: data older than Size - DSP_RING_GUARD samples may be overwritten
+  * at any time, which DSP_RingIsValid() tells.
+  *
+  * The sampling rate follows the performance governor: the rate asked with
+  * "dsp fs" is capped by the I2S limit of the current clock profile and
+  * every module restarts when the effective rate changes.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_APP_H
+#define __DSP_APP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_fft.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define DSP_RING_SIZE             4096U   /* int16 samples, power of two       */
+#define DSP_RING_GUARD            256U    /* Largest uncommitted write         */
+#define DSP_RATE_DEFAULT          48000U
+#define DSP_SCRATCH_SIZE          512U    /* FFT_CpxTypeDef, shared FFT buffer */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  int16_t           *Buffer;
+  uint32_t           Size;    /* Samples, power of two                      */
+  volatile uint32_t  Write;   /* Index of the next sample, wraps at 2^32    */
+  uint32_t           Rate;    /* Sampling rate, mHz                         */
+} DSP_RingTypeDef;
+
+typedef enum
+{
+  DSP_SOURCE_OFF = 0,
+  DSP_SOURCE_GEN,           /* DDS generator, paced by the HAL tick         */
+  DSP_SOURCE_EXT,           /* External producer                            */
+  DSP_SOURCE_COUNT,
+} DSP_SourceTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void             DSP_Init(void);
+uint8_t          DSP_Process(void);
+void             DSP_Reset(void);
+void             DSP_SetSource(DSP_SourceTypeDef source);
+uint32_t         DSP_SetRate(uint32_t rate);
+DSP_RingTypeDef *DSP_GetInput(void);
+DSP_RingTypeDef *DSP_GetInputY(void);
+FFT_CpxTypeDef  *DSP_GetScratch(void);
+int16_t         *DSP_GetWriteBuffer(uint32_t *count);
+int16_t         *DSP_GetWriteBufferY(void);
+void             DSP_Commit(uint32_t count);
+
+int16_t         *DSP_RingWritePtr(DSP_RingTypeDef *ring, uint32_t *count);
+void             DSP_RingCommit(DSP_RingTypeDef *ring, uint32_t count);
+uint32_t         DSP_RingWriteIndex(const DSP_RingTypeDef *ring);
+const int16_t   *DSP_RingSamples(const DSP_RingTypeDef *ring, uint32_t index, uint32_t *count);
+uint8_t          DSP_RingIsValid(const DSP_RingTypeDef *ring, uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_APP_H */
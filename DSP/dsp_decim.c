@@ -0,0 +1,371 @@
+/**
+  ******************************************************************************
+  * @file    dsp_decim.c
+  * @brief   Multi-stage decimation of the input samples.
+  ******************************************************************************
+  * @attention
+  *
+  * CIC: 4 integrators at the input rate, 4 combs at the output rate, in
+  * 64-bit modular arithmetic (gain up to 32^4 = 2^20 on 16-bit samples),
+  * then scaled back to 16 bits. It only goes down to 8 fs_out: its first
+  * image band, 8 fs_out +- 0.4 fs_out, is then more than 100 dB down,
+  * where stopping at 4 fs_out left it at -77 dB (-64 dB for a CIC ratio
+  * of 2).
+  *
+  * Compensator: 19 tap least-squares FIR, gain 1 / sinc^4 up to 0.1 fs_in
+  * (the CIC droop for large ratios), stopband from 0.4 fs_in (-90 dB), the
+  * band that folds onto the passband of the half-bands. The passband of
+  * the chain only uses it up to 0.05 fs_in, where it over-corrects a CIC
+  * ratio of 2 by less than 0.04 dB.
+  *
+  * Half-band: 55 tap Kaiser (beta 8.6), passband 0.2 fs_in, stopband from
+  * 0.3 fs_in. Every other tap is zero except the centre one (0.5), so the
+  * output is the 28 tap phase of the samples of one parity plus half the
+  * centre sample of the other parity.
+  *
+  * FIR delay lines are stored twice (write at i and i + taps) so that the
+  * taps always see a contiguous window, read two samples at a time for
+  * SMLALD.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "dsp_decim.h"
+
+/* Exported variables --------------------------------------------------------*/
+const int16_t DEC_HalfBandCoeffs[DEC_HB_TAPS] __attribute__((aligned(4))) =
+{
+     -3,     9,   -20,    42,   -78,   134,  -218,   341,  -519,   778,
+  -1174,  1848, -3329, 10380, 10380, -3329,  1848, -1174,   778,  -519,
+    341,  -218,   134,   -78,    42,   -20,     9,    -3,
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const int16_t DEC_CompCoeffs[DEC_COMP_TAPS] __attribute__((aligned(4))) =
+{
+     27,    -3,  -231,    -2,  1027,   129, -3330, -1138, 10699, 18412,
+  10699, -1138, -3330,   129,  1027,    -2,  -231,    -3,    27,     0,
+};
+
+static int16_t DecBuffer[DEC_RING_SIZE];
+static DSP_RingTypeDef DecRing = { DecBuffer, DEC_RING_SIZE, 0U, 0U };
+
+static DEC_ChainTypeDef DecChain = { .Ratio = 1U };
+static int16_t DecStage1[DEC_BLOCK];
+static int16_t DecStage2[DEC_BLOCK / 2U];
+
+static uint32_t DecRead;
+static uint32_t DecOverruns;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t DEC_Read2(const int16_t *p);
+static int64_t  DEC_Dot(const int16_t *x, const int16_t *h, uint32_t taps);
+static int16_t  DEC_Round(int64_t acc);
+static uint32_t DEC_Cic(DEC_CicTypeDef *cic, const int16_t *src, uint32_t n, int16_t *dst);
+static uint32_t DEC_Comp(DEC_CompTypeDef *fir, const int16_t *src, uint32_t n, int16_t *dst);
+static uint32_t DEC_HalfBand(DEC_HalfBandTypeDef *hb, const int16_t *src, uint32_t n, int16_t *dst);
+static void     DEC_Output(const int16_t *src, uint32_t n);
+
+/* Private functions ---------------------------------------------------------*/
+/* Two consecutive int16, any alignment (LDR handles unaligned words) */
+CCMRAM_TEXT static inline uint32_t DEC_Read2(const int16_t *p)
+{
+  uint32_t v;
+
+  (void)memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/* sum(h[i] x[i]), taps even */
+CCMRAM_TEXT static inline int64_t DEC_Dot(const int16_t *x, const int16_t *h, uint32_t taps)
+{
+  uint64_t acc = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < taps; i += 2U)
+  {
+    acc = __SMLALD(DEC_Read2(&x[i]), DEC_Read2(&h[i]), acc);
+  }
+  return (int64_t)acc;
+}
+
+/* q30 accumulator to q15, rounded and saturated */
+CCMRAM_TEXT static inline int16_t DEC_Round(int64_t acc)
+{
+  acc = (acc + (1 << 14)) >> 15;
+  if (acc > INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  if (acc < INT16_MIN)
+  {
+    return INT16_MIN;
+  }
+  return (int16_t)acc;
+}
+
+CCMRAM_TEXT static uint32_t DEC_Cic(DEC_CicTypeDef *cic, const int16_t *src, uint32_t n, int16_t *dst)
+{
+  uint64_t i0 = cic->Integrator[0];
+  uint64_t i1 = cic->Integrator[1];
+  uint64_t i2 = cic->Integrator[2];
+  uint64_t i3 = cic->Integrator[3];
+  uint64_t y;
+  uint64_t z;
+  uint32_t out = 0U;
+  uint32_t k;
+  uint32_t s;
+  int64_t v;
+
+  for (s = 0U; s < n; s++)
+  {
+    i0 += (uint64_t)(int64_t)src[s];
+    i1 += i0;
+    i2 += i1;
+    i3 += i2;
+    if (++cic->Count == cic->Ratio)
+    {
+      cic->Count = 0U;
+      y = i3;
+      for (k = 0U; k < DEC_CIC_ORDER; k++)
+      {
+        z = cic->Comb[k];
+        cic->Comb[k] = y;
+        y -= z;
+      }
+      v = ((int64_t)y + ((int64_t)1 << (cic->Shift - 1U))) >> cic->Shift;
+      dst[out++] = (int16_t)__SSAT((int32_t)v, 16);
+    }
+  }
+
+  cic->Integrator[0] = i0;
+  cic->Integrator[1] = i1;
+  cic->Integrator[2] = i2;
+  cic->Integrator[3] = i3;
+  return out;
+}
+
+CCMRAM_TEXT static uint32_t DEC_Comp(DEC_CompTypeDef *fir, const int16_t *src, uint32_t n, int16_t *dst)
+{
+  uint32_t out = 0U;
+  uint32_t s;
+
+  for (s = 0U; s < n; s++)
+  {
+    fir->Pos = ((fir->Pos == 0U) ? DEC_COMP_TAPS : fir->Pos) - 1U;
+    fir->Line[fir->Pos] = src[s];
+    fir->Line[fir->Pos + DEC_COMP_TAPS] = src[s];
+    fir->Phase ^= 1U;
+    if (fir->Phase == 0U)
+    {
+      dst[out++] = DEC_Round(DEC_Dot(&fir->Line[fir->Pos], DEC_CompCoeffs, DEC_COMP_TAPS));
+    }
+  }
+  return out;
+}
+
+CCMRAM_TEXT static uint32_t DEC_HalfBand(DEC_HalfBandTypeDef *hb, const int16_t *src, uint32_t n, int16_t *dst)
+{
+  uint32_t out = 0U;
+  uint32_t s;
+  int64_t acc;
+
+  for (s = 0U; s < n; s++)
+  {
+    hb->Phase ^= 1U;
+    if (hb->Phase != 0U)
+    {
+      hb->Even = src[s];
+      continue;
+    }
+
+    hb->Pos = ((hb->Pos == 0U) ? DEC_HB_TAPS : hb->Pos) - 1U;
+    hb->Line[hb->Pos] = src[s];
+    hb->Line[hb->Pos + DEC_HB_TAPS] = src[s];
+
+    /* Centre tap: the even sample DEC_HB_DELAY - 1 pairs back */
+    hb->Delay[hb->DelayPos] = hb->Even;
+    hb->DelayPos = (hb->DelayPos + 1U) % DEC_HB_DELAY;
+
+    acc = DEC_Dot(&hb->Line[hb->Pos], DEC_HalfBandCoeffs, DEC_HB_TAPS)
+        + ((int64_t)hb->Delay[hb->DelayPos] * DEC_HB_CENTRE);
+    dst[out++] = DEC_Round(acc);
+  }
+  return out;
+}
+
+static void DEC_Output(const int16_t *src, uint32_t n)
+{
+  uint32_t chunk;
+  int16_t *dst;
+
+  while (n != 0U)
+  {
+    dst = DSP_RingWritePtr(&DecRing, &chunk);
+    if (chunk > n)
+    {
+      chunk = n;
+    }
+    (void)memcpy(dst, src, chunk * sizeof(int16_t));
+    DSP_RingCommit(&DecRing, chunk);
+    src = &src[chunk];
+    n -= chunk;
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Clears a chain and sets its ratio
+  * @param  chain: Chain state
+  * @param  ratio: 1 (no decimation) or a power of two, 2..DEC_RATIO_MAX
+  * @retval DEC_OK, DEC_ERROR if the ratio is not supported
+  */
+DEC_StatusTypeDef DEC_ChainInit(DEC_ChainTypeDef *chain, uint32_t ratio)
+{
+  if ((ratio == 0U) || (ratio > DEC_RATIO_MAX) || ((ratio & (ratio - 1U)) != 0U))
+  {
+    return DEC_ERROR;
+  }
+
+  (void)memset(chain, 0, sizeof(*chain));
+  chain->Ratio = ratio;
+  if (ratio >= 16U)
+  {
+    chain->Cic.Ratio = ratio / 8U;
+    chain->Cic.Shift = DEC_CIC_ORDER * (31U - __CLZ(chain->Cic.Ratio));
+  }
+  return DEC_OK;
+}
+
+/**
+  * @brief  Decimates one block
+  * @note   The chains share scratch buffers: main loop only.
+  * @param  chain: Chain state, ratio >= 2
+  * @param  src: Input samples
+  * @param  n: Input samples, <= DEC_BLOCK
+  * @param  dst: Room for n / 2 output samples
+  * @retval Output samples written
+  */
+uint32_t DEC_ChainRun(DEC_ChainTypeDef *chain, const int16_t *src, uint32_t n, int16_t *dst)
+{
+  uint32_t count;
+
+  switch (chain->Ratio)
+  {
+    case 2U:
+      return DEC_HalfBand(&chain->HalfBand[0], src, n, dst);
+    case 4U:
+      count = DEC_HalfBand(&chain->HalfBand[0], src, n, DecStage1);
+      return DEC_HalfBand(&chain->HalfBand[1], DecStage1, count, dst);
+    case 8U:
+      count = DEC_HalfBand(&chain->HalfBand[0], src, n, DecStage1);
+      count = DEC_HalfBand(&chain->HalfBand[1], DecStage1, count, DecStage2);
+      return DEC_HalfBand(&chain->HalfBand[2], DecStage2, count, dst);
+    default:
+      count = DEC_Cic(&chain->Cic, src, n, DecStage1);
+      count = DEC_Comp(&chain->Comp, DecStage1, count, DecStage2);
+      count = DEC_HalfBand(&chain->HalfBand[0], DecStage2, count, DecStage1);
+      return DEC_HalfBand(&chain->HalfBand[1], DecStage1, count, dst);
+  }
+}
+
+/**
+  * @brief  Sets the decimation ratio of the analysis chain
+  * @note   Follow with DSP_Reset().
+  * @param  ratio: 1 (no decimation) or a power of two, 2..DEC_RATIO_MAX
+  * @retval DEC_OK, DEC_ERROR if the ratio is not supported
+  */
+DEC_StatusTypeDef DEC_SetRatio(uint32_t ratio)
+{
+  return DEC_ChainInit(&DecChain, ratio);
+}
+
+/**
+  * @brief  Decimation ratio
+  * @retval Ratio, 1 when bypassed
+  */
+uint32_t DEC_GetRatio(void)
+{
+  return DecChain.Ratio;
+}
+
+/**
+  * @brief  Clears the filters and restarts from the newest input sample
+  * @retval None
+  */
+void DEC_Reset(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+
+  (void)DEC_ChainInit(&DecChain, DecChain.Ratio);
+  DecRead = DSP_RingWriteIndex(input);
+  DecRing.Rate = input->Rate / DecChain.Ratio;
+}
+
+/**
+  * @brief  Decimates the input received since the last call
+  * @note   Main loop only, at most DEC_PASS_MAX input samples per call.
+  * @retval 1 if input is left for the next pass
+  */
+uint8_t DEC_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  int16_t out[DEC_BLOCK / 2U];
+  const int16_t *src;
+  uint32_t write;
+  uint32_t done = 0U;
+  uint32_t n;
+  uint32_t len;
+
+  if (DecChain.Ratio == 1U)
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if (DSP_RingIsValid(input, DecRead) == 0U)
+  {
+    DecRead = write;
+    DecOverruns++;
+  }
+
+  while ((DecRead != write) && (done < DEC_PASS_MAX))
+  {
+    src = DSP_RingSamples(input, DecRead, &len);
+    n = write - DecRead;
+    if (n > len)
+    {
+      n = len;
+    }
+    if (n > DEC_BLOCK)
+    {
+      n = DEC_BLOCK;
+    }
+    DEC_Output(out, DEC_ChainRun(&DecChain, src, n, out));
+    DecRead += n;
+    done += n;
+  }
+
+  return (DecRead != write) ? 1U : 0U;
+}
+
+/**
+  * @brief  Ring the analysis reads
+  * @retval Decimated ring, or the input ring for ratio 1
+  */
+DSP_RingTypeDef *DEC_GetOutput(void)
+{
+  return (DecChain.Ratio == 1U) ? DSP_GetInput() : &DecRing;
+}
+
+/**
+  * @brief  Input samples lost because the chain fell behind
+  * @retval Number of resynchronisations
+  */
+uint32_t DEC_GetOverruns(void)
+{
+  return DecOverruns;
+}
@@ -0,0 +1,114 @@
+/**
+  ******************************************************************************
+  * @file    dsp_decim.h
+  * @brief   Multi-stage decimation of the input samples.
+  ******************************************************************************
+  * @attention
+  *
+  * Decimates the DSP input ring by a power of two from 2 to DEC_RATIO_MAX
+  * into its own output ring, so that a short FFT resolves narrow bins:
+  *
+  *   ratio 2        half-band /2
+  *   ratio 4        half-band /2, half-band /2
+  *   ratio 8        half-band /2, half-band /2, half-band /2
+  *   ratio 16..256  CIC (4th order) /(ratio/8), CIC compensator /2,
+  *                  half-band /2, half-band /2
+  *
+  * From DC to 0.4 fs_out the output is alias free (> 78 dB) and flat
+  * within 0.005 dB peak to peak for ratios 2 to 8, 0.04 dB above
+  * (Tests/Src/test_dsp_decim.c). The FIR stages are polyphase, computed at the output rate
+  * with the dual 16-bit MAC; the filter state is kept across blocks so the
+  * output is continuous. Ratio 1 bypasses the chain, DEC_GetOutput() then
+  * returns the input ring.
+  *
+  * Other modules can run their own chains (DEC_ChainTypeDef) on any block
+  * of samples with DEC_ChainInit()/DEC_ChainRun().
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_DECIM_H
+#define __DSP_DECIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_app.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define DEC_RATIO_MAX             256U
+#define DEC_RING_SIZE             2048U   /* Output samples, power of two      */
+#define DEC_BLOCK                 256U    /* Input samples per filter call     */
+#define DEC_PASS_MAX              1024U   /* Input samples per DEC_Process()   */
+
+#define DEC_CIC_ORDER             4U
+#define DEC_COMP_TAPS             20U     /* 19 + one zero, even for pairs     */
+#define DEC_HB_TAPS               28U     /* Non-zero taps of one parity       */
+#define DEC_HB_DELAY              14U     /* Pairs to the centre tap, + 1      */
+#define DEC_HB_STAGES             3U
+#define DEC_HB_CENTRE             16384   /* Centre tap, q15                   */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  DEC_OK = 0,
+  DEC_ERROR,
+} DEC_StatusTypeDef;
+
+typedef struct
+{
+  uint64_t Integrator[DEC_CIC_ORDER];
+  uint64_t Comb[DEC_CIC_ORDER];
+  uint32_t Ratio;
+  uint32_t Shift;           /* log2(Ratio^order)                            */
+  uint32_t Count;
+} DEC_CicTypeDef;
+
+typedef struct
+{
+  int16_t  Line[2U * DEC_COMP_TAPS];
+  uint32_t Pos;
+  uint32_t Phase;
+} DEC_CompTypeDef;
+
+typedef struct
+{
+  int16_t  Line[2U * DEC_HB_TAPS];  /* Odd samples, newest first           */
+  int16_t  Delay[DEC_HB_DELAY];     /* Even samples, for the centre tap    */
+  uint32_t Pos;
+  uint32_t DelayPos;
+  uint32_t Phase;
+  int16_t  Even;
+} DEC_HalfBandTypeDef;
+
+typedef struct
+{
+  uint32_t            Ratio;
+  DEC_CicTypeDef      Cic;
+  DEC_CompTypeDef     Comp;
+  DEC_HalfBandTypeDef HalfBand[DEC_HB_STAGES];
+} DEC_ChainTypeDef;
+
+/* Exported variables --------------------------------------------------------*/
+/* Half-band taps of one parity, q15 (the other parity is the centre tap) */
+extern const int16_t DEC_HalfBandCoeffs[DEC_HB_TAPS];
+
+/* Exported functions prototypes ---------------------------------------------*/
+DEC_StatusTypeDef DEC_SetRatio(uint32_t ratio);
+uint32_t          DEC_GetRatio(void);
+void              DEC_Reset(void);
+uint8_t           DEC_Process(void);
+DSP_RingTypeDef  *DEC_GetOutput(void);
+uint32_t          DEC_GetOverruns(void);
+DEC_StatusTypeDef DEC_ChainInit(DEC_ChainTypeDef *chain, uint32_t ratio);
+uint32_t          DEC_ChainRun(DEC_ChainTypeDef *chain, const int16_t *src, uint32_t n, int16_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_DECIM_H */
@@ -0,0 +1,341 @@
+/**
+  ******************************************************************************
+  * @file    dsp_engine.c
+  * @brief   Fixed-point or FPU path of the window, FFT and magnitude chain.
+  ******************************************************************************
+  * @attention
+  *
+  * Both paths work in place in the DSP scratch buffer: n samples take
+  * n 32-bit words as q30 or float, and the n/2 + 1 powers are written as
+  * float over the spectrum, bin k over the already read word 2k.
+  *
+  * The Cortex-M4 FPU is scalar, the float loops are only unrolled by four
+  * (as the CMSIS-DSP kernels) so that loads and multiplies overlap; the
+  * square root is the VSQRT instruction, without the errno path of
+  * sqrtf().
+  *
+  * The benchmark tone is a -6 dBFS sine centred on bin n/8, windowed with
+  * Blackman-Harris: its level error and the floor of the bins away from
+  * its lobe (limited by the 16-bit quantisation of the tone, about
+  * -115 dB at 1024 points) measure each path; dev is the largest
+  * difference between the two spectra over the bins within 80 dB of the
+  * peak.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "mempool.h"
+#include "dsp_app.h"
+#include "dsp_fft.h"
+#include "dsp_engine.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ENG_BENCH_SHIFT           17U     /* q31 sine to -6 dBFS int16         */
+#define ENG_BENCH_RANGE           1e-8f   /* Bins compared by dev, re peak     */
+
+#if (ENG_FFT_MAX > (2U * DSP_SCRATCH_SIZE))
+#error "ENG_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+
+#if ((ENG_FFT_MAX * 2U) > POOL_FRAME_SIZE)
+#error "The benchmark tone and spectrum do not fit in POOL_FRAME blocks"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static ENG_EngineTypeDef EngEngine = ENG_FIXED;
+
+static const char *const ENG_Names[ENG_COUNT] = { "fixed", "float" };
+
+/* Private function prototypes -----------------------------------------------*/
+static float  *ENG_PowerWith(ENG_EngineTypeDef engine, WIN_WindowTypeDef window, uint32_t n,
+                             const int16_t *src1, uint32_t len1, const int16_t *src2);
+static float   ENG_Sqrt(float x);
+static int32_t ENG_Centi(float value);
+static void    ENG_Bench(uint32_t n, int16_t *tone, float *fixed);
+static int32_t ENG_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef ENG_ConsoleCommand =
+{
+  .Name    = "fft",
+  .Help    = "fft [fixed|float|bench [n]] - FFT engine of THD and spectrogram, speed and accuracy",
+  .Handler = ENG_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static float *ENG_PowerWith(ENG_EngineTypeDef engine, WIN_WindowTypeDef window, uint32_t n,
+                            const int16_t *src1, uint32_t len1, const int16_t *src2)
+{
+  float *p = (float *)DSP_GetScratch();
+  uint32_t bins = n / 2U;
+  uint32_t k;
+  float nyquist;
+  float unit;
+  float re;
+  float im;
+
+  if (engine == ENG_FLOAT)
+  {
+    WIN_ApplyF32(window, n, src1, len1, src2, p);
+    FFT_RealF32((FFT_CpxF32TypeDef *)p, n);
+    unit = 1.0f;
+  }
+  else
+  {
+    WIN_Apply(window, n, src1, len1, src2, (int32_t *)p);
+    /* Values in units of 2^(e - 30) full scale, converted one by one */
+    unit = ldexpf(1.0f, FFT_Real((FFT_CpxTypeDef *)p, n) - 30);
+    for (k = 0U; k < n; k++)
+    {
+      p[k] = unit * (float)((int32_t *)p)[k];
+    }
+  }
+
+  nyquist = p[1] * p[1];
+  p[1] = 0.0f;
+  for (k = 0U; k < bins; k++)
+  {
+    re = p[2U * k];
+    im = p[(2U * k) + 1U];
+    p[k] = (re * re) + (im * im);
+  }
+  p[bins] = nyquist;
+  return p;
+}
+
+/* Square root on the FPU */
+static float ENG_Sqrt(float x)
+{
+#if defined(__FPU_USED) && (__FPU_USED == 1U)
+  float root;
+
+  __ASM volatile ("vsqrt.f32 %0, %1" : "=t" (root) : "t" (x));
+  return root;
+#else
+  return sqrtf(x);
+#endif
+}
+
+/* Value x 100, rounded and kept within int16_t */
+static int32_t ENG_Centi(float value)
+{
+  value *= 100.0f;
+  if (value > (float)INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  return (value < (float)INT16_MIN) ? INT16_MIN : (int32_t)lrintf(value);
+}
+
+/* Times and checks both paths at n points, one JSON line; tone takes n
+   samples and fixed the first n/2 bins of the fixed-point spectrum */
+static void ENG_Bench(uint32_t n, int16_t *tone, float *fixed)
+{
+  const WIN_InfoTypeDef *win = WIN_GetInfo(WIN_BLACKMAN_HARRIS);
+  uint32_t cycles[ENG_COUNT];
+  int32_t level[ENG_COUNT];
+  int32_t spread[ENG_COUNT];
+  uint32_t bins = n / 2U;
+  uint32_t k0 = n / 8U;
+  uint32_t guard = win->Lobe + 1U;
+  uint32_t engine;
+  uint32_t run;
+  uint32_t start;
+  uint32_t count;
+  uint32_t k;
+  int32_t c;
+  int32_t s;
+  float expected = ((float)n * (float)n * win->CoherentGain * win->CoherentGain) / 16.0f;
+  float *p;
+  float noise;
+  float dev = 0.0f;
+
+  /* -6 dBFS: amplitude 1/2, bin power N^2 CG^2 / 16 */
+  for (k = 0U; k < n; k++)
+  {
+    FFT_Twiddle(k * k0 * (DSP_TABLE_SIZE / n), &c, &s);
+    tone[k] = (int16_t)(s >> ENG_BENCH_SHIFT);
+  }
+
+  for (engine = 0U; engine < ENG_COUNT; engine++)
+  {
+    cycles[engine] = UINT32_MAX;
+    for (run = 0U; run < ENG_BENCH_RUNS; run++)
+    {
+      start = DWT->CYCCNT;
+      p = ENG_PowerWith((ENG_EngineTypeDef)engine, WIN_BLACKMAN_HARRIS, n, tone, n, tone);
+      ENG_Magnitude(p, bins + 1U);
+      start = DWT->CYCCNT - start;
+      if (start < cycles[engine])
+      {
+        cycles[engine] = start;
+      }
+    }
+
+    p = ENG_PowerWith((ENG_EngineTypeDef)engine, WIN_BLACKMAN_HARRIS, n, tone, n, tone);
+    noise = 0.0f;
+    count = 0U;
+    for (k = guard; k < bins; k++)
+    {
+      if ((k + guard < k0) || (k > k0 + guard))
+      {
+        noise += p[k];
+        count++;
+      }
+    }
+    level[engine] = ENG_Centi(10.0f * log10f(p[k0] / expected));
+    spread[engine] = ENG_Centi(10.0f * log10f(fmaxf(noise / (float)count, 1e-30f) / p[k0]));
+
+    if (engine == (uint32_t)ENG_FIXED)
+    {
+      (void)memcpy(fixed, p, bins * sizeof(float));
+    }
+  }
+
+  for (k = 0U; k < bins; k++)
+  {
+    if ((fixed[k] > (ENG_BENCH_RANGE * fixed[k0])) && (p[k] > 0.0f))
+    {
+      dev = fmaxf(dev, fabsf(10.0f * log10f(p[k] / fixed[k])));
+    }
+  }
+
+  (void)CON_Printf("{\"n\":%lu,\"fixed_cycles\":%lu,\"float_cycles\":%lu,\"fixed_level_cdb\":%ld,"
+                   "\"float_level_cdb\":%ld,\"fixed_floor_cdb\":%ld,\"float_floor_cdb\":%ld,"
+                   "\"dev_mdb\":%ld,\"faster\":\"%s\"}\r\n",
+                   (unsigned long)n, (unsigned long)cycles[ENG_FIXED], (unsigned long)cycles[ENG_FLOAT],
+                   (long)level[ENG_FIXED], (long)level[ENG_FLOAT], (long)spread[ENG_FIXED],
+                   (long)spread[ENG_FLOAT], (long)lrintf(dev * 1000.0f),
+                   ENG_Names[(cycles[ENG_FLOAT] < cycles[ENG_FIXED]) ? ENG_FLOAT : ENG_FIXED]);
+}
+
+static int32_t ENG_Command(int32_t argc, char *argv[])
+{
+  int16_t *tone;
+  float *fixed;
+  uint32_t n;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "fixed") == 0)
+    {
+      ENG_SetEngine(ENG_FIXED);
+    }
+    else if (strcmp(argv[1], "float") == 0)
+    {
+      ENG_SetEngine(ENG_FLOAT);
+    }
+    else if (strcmp(argv[1], "bench") == 0)
+    {
+      n = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 0U;
+      if ((n != 0U) && ((n < ENG_FFT_MIN) || (n > ENG_FFT_MAX) || ((n & (n - 1U)) != 0U)))
+      {
+        return 1;
+      }
+      tone  = POOL_Alloc(POOL_FRAME, "fft");
+      fixed = POOL_Alloc(POOL_FRAME, "fft");
+      if ((tone == NULL) || (fixed == NULL))
+      {
+        POOL_Free(fixed);
+        POOL_Free(tone);
+        return 2;
+      }
+      for (n = (n != 0U) ? n : ENG_FFT_MIN; n <= ENG_FFT_MAX; n *= 2U)
+      {
+        ENG_Bench(n, tone, fixed);
+        if (argc > 2)
+        {
+          break;
+        }
+      }
+      POOL_Free(fixed);
+      POOL_Free(tone);
+    }
+    else
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"engine\":\"%s\"}\r\n", ENG_Names[EngEngine]);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "fft" command, the fixed-point path is selected
+  * @retval None
+  */
+void ENG_Init(void)
+{
+  (void)CON_Register(&ENG_ConsoleCommand);
+}
+
+/**
+  * @brief  Selects the path of ENG_Power()
+  * @param  engine: ENG_EngineTypeDef
+  * @retval None
+  */
+void ENG_SetEngine(ENG_EngineTypeDef engine)
+{
+  if (engine < ENG_COUNT)
+  {
+    EngEngine = engine;
+  }
+}
+
+/**
+  * @brief  Path of ENG_Power()
+  * @retval ENG_EngineTypeDef
+  */
+ENG_EngineTypeDef ENG_GetEngine(void)
+{
+  return EngEngine;
+}
+
+/**
+  * @brief  Power spectrum of n windowed samples
+  * @note   Main loop only, the result is in the DSP scratch buffer.
+  * @param  window: WIN_WindowTypeDef
+  * @param  n: Power of two, ENG_FFT_MIN..ENG_FFT_MAX
+  * @param  src1: First samples, up to the end of the ring
+  * @param  len1: Samples in src1, <= n
+  * @param  src2: Following n - len1 samples, start of the ring
+  * @retval n/2 + 1 powers, |DFT|^2 of full scale samples
+  */
+float *ENG_Power(WIN_WindowTypeDef window, uint32_t n,
+                 const int16_t *src1, uint32_t len1, const int16_t *src2)
+{
+  return ENG_PowerWith(EngEngine, window, n, src1, len1, src2);
+}
+
+/**
+  * @brief  Power to magnitude, in place
+  * @param  p: Powers
+  * @param  bins: Number of values
+  * @retval None
+  */
+void ENG_Magnitude(float *p, uint32_t bins)
+{
+  uint32_t blocks = bins >> 2U;
+  uint32_t k = 0U;
+
+  while (blocks != 0U)
+  {
+    p[k]      = ENG_Sqrt(p[k]);
+    p[k + 1U] = ENG_Sqrt(p[k + 1U]);
+    p[k + 2U] = ENG_Sqrt(p[k + 2U]);
+    p[k + 3U] = ENG_Sqrt(p[k + 3U]);
+    k += 4U;
+    blocks--;
+  }
+  for (; k < bins; k++)
+  {
+    p[k] = ENG_Sqrt(p[k]);
+  }
+}
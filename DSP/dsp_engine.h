@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    dsp_engine.h
+  * @brief   Fixed-point or FPU path of the window, FFT and magnitude chain.
+  ******************************************************************************
+  * @attention
+  *
+  * ENG_Power() windows FftSize int16 samples taken from a ring, transforms
+  * them and returns the power spectrum as float, bins 0..FftSize/2, in
+  * units of |DFT|^2 of full scale samples: a full scale sine centred on
+  * bin k reads N^2 CG^2 / 4 there. It runs either on the integer unit
+  * (q30 window, block floating point FFT_Real()) or on the FPU (float
+  * window, FFT_RealF32()), as selected at run time; both give the same
+  * values, to the rounding of each path, so the analyses built on it
+  * (THD, spectrogram) do not depend on the choice.
+  *
+  * "fft bench" times both paths over the supported sizes on a test tone
+  * and reports their accuracy, so that each setup can keep the faster
+  * one for the frame size it uses.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_ENGINE_H
+#define __DSP_ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define ENG_FFT_MIN               64U     /* Real points                       */
+#define ENG_FFT_MAX               1024U
+#define ENG_BENCH_RUNS            4U      /* Timed runs, the fastest is kept   */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  ENG_FIXED = 0,          /* q31 block floating point                       */
+  ENG_FLOAT,              /* Single precision FPU                           */
+  ENG_COUNT,
+} ENG_EngineTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              ENG_Init(void);
+void              ENG_SetEngine(ENG_EngineTypeDef engine);
+ENG_EngineTypeDef ENG_GetEngine(void);
+float            *ENG_Power(WIN_WindowTypeDef window, uint32_t n,
+                            const int16_t *src1, uint32_t len1, const int16_t *src2);
+void              ENG_Magnitude(float *p, uint32_t bins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_ENGINE_H */
@@ -0,0 +1,421 @@
+/**
+  ******************************************************************************
+  * @file    dsp_fft.c
+  * @brief   Radix-2 FFT, complex and real input, fixed-point and float.
+  ******************************************************************************
+  * @attention
+  *
+  * Decimation in time, bit-reversed input. The twiddle factors come from
+  * the quarter wave of TBL_SineQ31; the products use the 32x32->64 bit
+  * multiplier (SMULL/SMLAL).
+  *
+  * Block floating point: the input is first shifted so that its largest
+  * component has FFT_GUARD_BITS leading zeros (4 x headroom, CLZ of the
+  * OR of the magnitudes). A butterfly stage at most doubles the
+  * largest magnitude, so a stage is only halved when the peak of the
+  * previous one, gathered in the same loop, reaches FFT_PEAK_MAX; the
+  * magnitudes then stay below 2^31 whatever the data, and quiet inputs
+  * keep all their bits instead of losing one per stage.
+  *
+  * The float transforms follow the same structure, with the twiddle
+  * factors converted from the q31 table once per group of butterflies.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "dsp_fft.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FFT_QUARTER               (DSP_TABLE_SIZE / 4U)
+#define FFT_INDEX_MASK            (DSP_TABLE_SIZE - 1U)
+#define FFT_GUARD_BITS            3U      /* Leading zeros of a normalised peak */
+#define FFT_PEAK_MAX              (1UL << (32U - FFT_GUARD_BITS))
+
+/* |v|, one less for negative values: only the leading bit matters */
+#define FFT_MAG(v)                ((uint32_t)(v) ^ (uint32_t)((v) >> 31))
+
+#define FFT_Q31_TO_F32            4.656612873e-10f  /* 2^-31 */
+
+/* Private function prototypes -----------------------------------------------*/
+static void    FFT_BitReverse(FFT_CpxTypeDef *x, uint32_t n);
+static int32_t FFT_Normalise(FFT_CpxTypeDef *x, uint32_t n);
+static int32_t FFT_Transform(FFT_CpxTypeDef *x, uint32_t n, uint32_t *peak);
+static void    FFT_BitReverseF32(FFT_CpxF32TypeDef *x, uint32_t n);
+static void    FFT_TwiddleF32(uint32_t index, float *cosine, float *sine);
+
+/* Private functions ---------------------------------------------------------*/
+CCMRAM_TEXT static void FFT_BitReverse(FFT_CpxTypeDef *x, uint32_t n)
+{
+  FFT_CpxTypeDef tmp;
+  uint32_t shift = 32U - FFT_Log2(n);
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 1U; i < (n - 1U); i++)
+  {
+    j = __RBIT(i) >> shift;
+    if (i < j)
+    {
+      tmp  = x[i];
+      x[i] = x[j];
+      x[j] = tmp;
+    }
+  }
+}
+
+CCMRAM_TEXT static void FFT_BitReverseF32(FFT_CpxF32TypeDef *x, uint32_t n)
+{
+  FFT_CpxF32TypeDef tmp;
+  uint32_t shift = 32U - FFT_Log2(n);
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 1U; i < (n - 1U); i++)
+  {
+    j = __RBIT(i) >> shift;
+    if (i < j)
+    {
+      tmp  = x[i];
+      x[i] = x[j];
+      x[j] = tmp;
+    }
+  }
+}
+
+CCMRAM_TEXT static void FFT_TwiddleF32(uint32_t index, float *cosine, float *sine)
+{
+  int32_t c;
+  int32_t s;
+
+  FFT_Twiddle(index, &c, &s);
+  *cosine = (float)c * FFT_Q31_TO_F32;
+  *sine   = (float)s * FFT_Q31_TO_F32;
+}
+
+/* Shifts the block so that its peak is just below FFT_PEAK_MAX, returns
+   the exponent of the shift (negative for a left shift) */
+CCMRAM_TEXT static int32_t FFT_Normalise(FFT_CpxTypeDef *x, uint32_t n)
+{
+  uint32_t peak = 0U;
+  uint32_t zeros;
+  uint32_t shift;
+  uint32_t i;
+
+  for (i = 0U; i < n; i++)
+  {
+    peak |= FFT_MAG(x[i].Re) | FFT_MAG(x[i].Im);
+  }
+  if (peak == 0U)
+  {
+    return 0;
+  }
+
+  zeros = __CLZ(peak);
+  if (zeros > FFT_GUARD_BITS)
+  {
+    shift = zeros - FFT_GUARD_BITS;
+    for (i = 0U; i < n; i++)
+    {
+      x[i].Re = (int32_t)((uint32_t)x[i].Re << shift);
+      x[i].Im = (int32_t)((uint32_t)x[i].Im << shift);
+    }
+    return -(int32_t)shift;
+  }
+
+  shift = FFT_GUARD_BITS - zeros;
+  for (i = 0U; (shift != 0U) && (i < n); i++)
+  {
+    x[i].Re >>= shift;
+    x[i].Im >>= shift;
+  }
+  return (int32_t)shift;
+}
+
+/* Complex transform, peak: OR of the output magnitudes */
+CCMRAM_TEXT static int32_t FFT_Transform(FFT_CpxTypeDef *x, uint32_t n, uint32_t *peak)
+{
+  FFT_CpxTypeDef *a;
+  FFT_CpxTypeDef *b;
+  uint32_t half;
+  uint32_t step;
+  uint32_t shift;
+  uint32_t next = 0U;
+  uint32_t i;
+  uint32_t k;
+  int32_t exponent;
+  int32_t c;
+  int32_t s;
+  int32_t tr;
+  int32_t ti;
+  int32_t ar;
+  int32_t ai;
+
+  FFT_BitReverse(x, n);
+  exponent = FFT_Normalise(x, n);
+
+  /* First stage, W = 1, never halved after the normalisation */
+  for (i = 0U; i < n; i += 2U)
+  {
+    ar = x[i].Re;
+    ai = x[i].Im;
+    tr = x[i + 1U].Re;
+    ti = x[i + 1U].Im;
+    x[i].Re      = ar + tr;
+    x[i].Im      = ai + ti;
+    x[i + 1U].Re = ar - tr;
+    x[i + 1U].Im = ai - ti;
+    next |= FFT_MAG(x[i].Re) | FFT_MAG(x[i].Im) | FFT_MAG(x[i + 1U].Re) | FFT_MAG(x[i + 1U].Im);
+  }
+
+  for (half = 2U; half < n; half <<= 1U)
+  {
+    shift = (next >= FFT_PEAK_MAX) ? 1U : 0U;
+    exponent += (int32_t)shift;
+    next = 0U;
+    step = DSP_TABLE_SIZE / (half << 1U);
+    for (k = 0U; k < half; k++)
+    {
+      FFT_Twiddle(k * step, &c, &s);
+      for (i = k; i < n; i += (half << 1U))
+      {
+        a = &x[i];
+        b = &x[i + half];
+        /* (b * (c - js)) >> shift */
+        tr = (int32_t)((((int64_t)b->Re * c) + ((int64_t)b->Im * s)) >> 31) >> shift;
+        ti = (int32_t)((((int64_t)b->Im * c) - ((int64_t)b->Re * s)) >> 31) >> shift;
+        ar = a->Re >> shift;
+        ai = a->Im >> shift;
+        a->Re = ar + tr;
+        a->Im = ai + ti;
+        b->Re = ar - tr;
+        b->Im = ai - ti;
+        next |= FFT_MAG(a->Re) | FFT_MAG(a->Im) | FFT_MAG(b->Re) | FFT_MAG(b->Im);
+      }
+    }
+  }
+
+  *peak = next;
+  return exponent;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  cos and sin of 2 pi index / DSP_TABLE_SIZE
+  * @param  index: Angle, any value (taken modulo DSP_TABLE_SIZE)
+  * @param  cosine: q31 cosine
+  * @param  sine: q31 sine
+  * @retval None
+  */
+CCMRAM_TEXT void FFT_Twiddle(uint32_t index, int32_t *cosine, int32_t *sine)
+{
+  uint32_t i = index & FFT_INDEX_MASK;
+  uint32_t r = i & (FFT_QUARTER - 1U);
+
+  switch (i / FFT_QUARTER)
+  {
+    case 0U:
+      *sine   = TBL_SineQ31[r];
+      *cosine = TBL_SineQ31[FFT_QUARTER - r];
+      break;
+    case 1U:
+      *sine   = TBL_SineQ31[FFT_QUARTER - r];
+      *cosine = -TBL_SineQ31[r];
+      break;
+    case 2U:
+      *sine   = -TBL_SineQ31[r];
+      *cosine = -TBL_SineQ31[FFT_QUARTER - r];
+      break;
+    default:
+      *sine   = -TBL_SineQ31[FFT_QUARTER - r];
+      *cosine = TBL_SineQ31[r];
+      break;
+  }
+}
+
+/**
+  * @brief  log2 of a power of two
+  * @param  n: Power of two
+  * @retval log2(n)
+  */
+CCMRAM_TEXT uint32_t FFT_Log2(uint32_t n)
+{
+  return 31U - __CLZ(n);
+}
+
+/**
+  * @brief  In-place forward complex FFT
+  * @param  x: n complex q31 values
+  * @param  n: Power of two, 2..FFT_SIZE_MAX/2
+  * @retval Block exponent, may be negative
+  */
+CCMRAM_TEXT int32_t FFT_Complex(FFT_CpxTypeDef *x, uint32_t n)
+{
+  uint32_t peak;
+
+  return FFT_Transform(x, n, &peak);
+}
+
+/**
+  * @brief  In-place forward FFT of real data
+  * @param  x: n real q31 samples as n/2 complex values
+  * @param  n: Power of two, FFT_SIZE_MIN..FFT_SIZE_MAX
+  * @retval Block exponent, may be negative
+  */
+CCMRAM_TEXT int32_t FFT_Real(FFT_CpxTypeDef *x, uint32_t n)
+{
+  uint32_t m = n / 2U;
+  uint32_t step = DSP_TABLE_SIZE / n;
+  uint32_t k;
+  uint32_t peak;
+  uint32_t half;
+  int32_t exponent;
+  int32_t c;
+  int32_t s;
+  int64_t er;
+  int64_t ei;
+  int64_t orr;
+  int64_t oi;
+  int64_t wr;
+  int64_t wi;
+  int32_t z0r;
+  int32_t z0i;
+
+  exponent = FFT_Transform(x, m, &peak);
+
+  /* Split Z = FFT(even + j odd) into the spectrum of the real sequence:
+     X[k] = E[k] + W^k O[k], X[m-k] = conj(E[k] - W^k O[k]), which may
+     double the magnitude: halved under the same rule as a stage */
+  half = (peak >= FFT_PEAK_MAX) ? 1U : 0U;
+  z0r = x[0].Re;
+  z0i = x[0].Im;
+  x[0].Re = (int32_t)(((int64_t)z0r + z0i) >> half);
+  x[0].Im = (int32_t)(((int64_t)z0r - z0i) >> half);
+
+  for (k = 1U; k <= (m / 2U); k++)
+  {
+    er  = ((int64_t)x[k].Re + x[m - k].Re) >> 1;
+    ei  = ((int64_t)x[k].Im - x[m - k].Im) >> 1;
+    /* O = (Z[k] - conj(Z[m-k])) / 2j */
+    orr = ((int64_t)x[k].Im + x[m - k].Im) >> 1;
+    oi  = -(((int64_t)x[k].Re - x[m - k].Re) >> 1);
+
+    FFT_Twiddle(k * step, &c, &s);
+    wr = ((orr * c) + (oi * s)) >> 31;
+    wi = ((oi * c) - (orr * s)) >> 31;
+
+    x[k].Re     = (int32_t)((er + wr) >> half);
+    x[k].Im     = (int32_t)((ei + wi) >> half);
+    x[m - k].Re = (int32_t)((er - wr) >> half);
+    x[m - k].Im = (int32_t)(-((ei - wi) >> half));
+  }
+
+  return exponent + (int32_t)half;
+}
+
+/**
+  * @brief  In-place forward complex FFT, single precision
+  * @param  x: n complex values
+  * @param  n: Power of two, 2..FFT_SIZE_MAX/2
+  * @retval None
+  */
+CCMRAM_TEXT void FFT_ComplexF32(FFT_CpxF32TypeDef *x, uint32_t n)
+{
+  FFT_CpxF32TypeDef *a;
+  FFT_CpxF32TypeDef *b;
+  uint32_t half;
+  uint32_t step;
+  uint32_t i;
+  uint32_t k;
+  float c;
+  float s;
+  float tr;
+  float ti;
+  float ar;
+  float ai;
+
+  FFT_BitReverseF32(x, n);
+
+  /* First stage, W = 1 */
+  for (i = 0U; i < n; i += 2U)
+  {
+    ar = x[i].Re;
+    ai = x[i].Im;
+    tr = x[i + 1U].Re;
+    ti = x[i + 1U].Im;
+    x[i].Re      = ar + tr;
+    x[i].Im      = ai + ti;
+    x[i + 1U].Re = ar - tr;
+    x[i + 1U].Im = ai - ti;
+  }
+
+  for (half = 2U; half < n; half <<= 1U)
+  {
+    step = DSP_TABLE_SIZE / (half << 1U);
+    for (k = 0U; k < half; k++)
+    {
+      FFT_TwiddleF32(k * step, &c, &s);
+      for (i = k; i < n; i += (half << 1U))
+      {
+        a = &x[i];
+        b = &x[i + half];
+        /* b * (c - js) */
+        tr = (b->Re * c) + (b->Im * s);
+        ti = (b->Im * c) - (b->Re * s);
+        ar = a->Re;
+        ai = a->Im;
+        a->Re = ar + tr;
+        a->Im = ai + ti;
+        b->Re = ar - tr;
+        b->Im = ai - ti;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  In-place forward FFT of real data, single precision
+  * @param  x: n real samples as n/2 complex values
+  * @param  n: Power of two, FFT_SIZE_MIN..FFT_SIZE_MAX
+  * @retval None
+  */
+CCMRAM_TEXT void FFT_RealF32(FFT_CpxF32TypeDef *x, uint32_t n)
+{
+  uint32_t m = n / 2U;
+  uint32_t step = DSP_TABLE_SIZE / n;
+  uint32_t k;
+  float c;
+  float s;
+  float er;
+  float ei;
+  float orr;
+  float oi;
+  float wr;
+  float wi;
+  float z0r;
+
+  FFT_ComplexF32(x, m);
+
+  /* Same split as FFT_Real(), without the halving */
+  z0r = x[0].Re;
+  x[0].Re = z0r + x[0].Im;
+  x[0].Im = z0r - x[0].Im;
+
+  for (k = 1U; k <= (m / 2U); k++)
+  {
+    er  = 0.5f * (x[k].Re + x[m - k].Re);
+    ei  = 0.5f * (x[k].Im - x[m - k].Im);
+    orr = 0.5f * (x[k].Im + x[m - k].Im);
+    oi  = 0.5f * (x[m - k].Re - x[k].Re);
+
+    FFT_TwiddleF32(k * step, &c, &s);
+    wr = (orr * c) + (oi * s);
+    wi = (oi * c) - (orr * s);
+
+    x[k].Re     = er + wr;
+    x[k].Im     = ei + wi;
+    x[m - k].Re = er - wr;
+    x[m - k].Im = wi - ei;
+  }
+}
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    dsp_fft.h
+  * @brief   Radix-2 FFT, complex and real input, fixed-point and float.
+  ******************************************************************************
+  * @attention
+  *
+  * Transforms run in place on q31 data, in block floating point: the
+  * input block is scaled to its peak and a stage is only halved when its
+  * output could overflow, so any q31 input is accepted and small signals
+  * keep their resolution. The functions return the block exponent, the
+  * transform being X[k] = 2^exponent * x_out[k]; it depends on the data
+  * (negative for quiet inputs), frames summed together must be brought
+  * to a common exponent first.
+  *
+  * The real transform takes n real samples stored as n/2 complex values
+  * (even samples in Re, odd samples in Im) and returns bins 0..n/2-1 in
+  * place, the real Nyquist bin n/2 being stored in x[0].Im.
+  *
+  * FFT_ComplexF32() and FFT_RealF32() are the same transforms in single
+  * precision, with the same layouts and no scaling (X[k] = x_out[k]), for
+  * the FPU path of the analyses (see dsp_engine.h).
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_FFT_H
+#define __DSP_FFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_tables.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define FFT_SIZE_MIN              16U               /* Real points        */
+#define FFT_SIZE_MAX              DSP_TABLE_SIZE    /* Real points        */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  int32_t Re;
+  int32_t Im;
+} FFT_CpxTypeDef;
+
+typedef struct
+{
+  float Re;
+  float Im;
+} FFT_CpxF32TypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int32_t  FFT_Complex(FFT_CpxTypeDef *x, uint32_t n);
+int32_t  FFT_Real(FFT_CpxTypeDef *x, uint32_t n);
+void     FFT_ComplexF32(FFT_CpxF32TypeDef *x, uint32_t n);
+void     FFT_RealF32(FFT_CpxF32TypeDef *x, uint32_t n);
+void     FFT_Twiddle(uint32_t index, int32_t *cosine, int32_t *sine);
+uint32_t FFT_Log2(uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_FFT_H */
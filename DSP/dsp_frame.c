@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file    dsp_frame.c
+  * @brief   Binary result frames of the DSP modules on the CDC link.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "cdc_acm_ringbuffer.h"
+#include "dsp_frame.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DFR_BUSID                 0U
+#define DFR_SOF                   0xFDU
+#define DFR_EOF                   0xA5U
+
+/* Private variables ---------------------------------------------------------*/
+static const uint8_t DFR_Eof[4] = { DFR_EOF, DFR_EOF, DFR_EOF, DFR_EOF };
+static DFR_StatsTypeDef DfrStats;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Sends one frame
+  * @note   Main loop only.
+  * @param  tag: DFR_TAG_xxx
+  * @param  header: Frame header, may be NULL
+  * @param  header_len: Header size in bytes
+  * @param  data: Payload, may be NULL
+  * @param  len: Payload size in bytes
+  * @retval DFR_OK, DFR_BUSY if the CDC ring cannot take the frame now
+  */
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len,
+                           const void *data, uint32_t len)
+{
+  uint32_t value = header_len + len;
+  uint8_t head[7];
+
+  if (value > DFR_VALUE_MAX)
+  {
+    return DFR_ERROR;
+  }
+  if (cdc_acm_get_tx_free() < (value + DFR_FRAME_OVERHEAD))
+  {
+    DfrStats.Dropped++;
+    return DFR_BUSY;
+  }
+
+  head[0] = DFR_SOF;
+  head[1] = DFR_SOF;
+  head[2] = DFR_SOF;
+  head[3] = DFR_SOF;
+  head[4] = tag;
+  head[5] = (uint8_t)(value >> 8U);
+  head[6] = (uint8_t)value;
+  (void)cdc_acm_send_data(DFR_BUSID, head, sizeof(head));
+  if (header_len != 0U)
+  {
+    (void)cdc_acm_send_data(DFR_BUSID, (const uint8_t *)header, header_len);
+  }
+  if (len != 0U)
+  {
+    (void)cdc_acm_send_data(DFR_BUSID, (const uint8_t *)data, len);
+  }
+  (void)cdc_acm_send_data(DFR_BUSID, DFR_Eof, sizeof(DFR_Eof));
+
+  DfrStats.Frames++;
+  DfrStats.Bytes += value + DFR_FRAME_OVERHEAD;
+  return DFR_OK;
+}
+
+/**
+  * @brief  Checks that a group of frames can be sent without a drop
+  * @param  frames: Number of frames
+  * @param  bytes: Total header and payload bytes
+  * @retval 1 if the CDC ring has room for all of them
+  */
+uint8_t DFR_Fits(uint32_t frames, uint32_t bytes)
+{
+  return (cdc_acm_get_tx_free() >= (bytes + (frames * DFR_FRAME_OVERHEAD))) ? 1U : 0U;
+}
+
+/**
+  * @brief  Counts frames given up by the caller
+  * @param  frames: Number of frames not sent
+  * @retval None
+  */
+void DFR_Drop(uint32_t frames)
+{
+  DfrStats.Dropped += frames;
+}
+
+/**
+  * @brief  Counters of the DSP frames
+  * @param  stats: Filled with the counters
+  * @retval None
+  */
+void DFR_GetStats(DFR_StatsTypeDef *stats)
+{
+  *stats = DfrStats;
+}
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file    dsp_frame.h
+  * @brief   Binary result frames of the DSP modules on the CDC link.
+  ******************************************************************************
+  * @attention
+  *
+  * Results are sent in the TLV framing of the USBPD trace stream so that
+  * one decoder handles both: SOF (0xFD x4), TAG, LENGTH (2 bytes, MSB
+  * first), VALUE, EOF (0xA5 x4). The DSP tags use port field 7 (0xE0 +
+  * type), which the PD stack never emits. VALUE is a packed little endian
+  * header specific to the tag followed by the data.
+  *
+  * A frame is written only if it fits whole in the CDC transmit ring,
+  * otherwise it is dropped and counted: the analysis never waits for the
+  * host.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_FRAME_H
+#define __DSP_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define DFR_TAG_PSD               0xE1U   /* WEL_FrameHeaderTypeDef + uint32_t bins */
+#define DFR_TAG_ZOOM              0xE2U   /* ZOOM_FrameHeaderTypeDef + uint32_t bins */
+#define DFR_TAG_OCTAVE            0xE3U   /* OCT_FrameHeaderTypeDef + int16_t levels */
+#define DFR_TAG_TONE              0xE4U   /* GTZ_FrameHeaderTypeDef + int16_t levels */
+#define DFR_TAG_TONE_EVENT        0xE5U   /* GTZ_EventTypeDef                        */
+#define DFR_TAG_THD               0xE6U   /* THD_FrameHeaderTypeDef + int16_t levels */
+#define DFR_TAG_XFER              0xE7U   /* XFR_FrameHeaderTypeDef + XFR_BinTypeDef */
+#define DFR_TAG_SPECTRO           0xE8U   /* SPG_FrameHeaderTypeDef + uint8_t row    */
+
+#define DFR_FRAME_OVERHEAD        11U
+#define DFR_VALUE_MAX             0xFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  DFR_OK = 0,
+  DFR_BUSY,
+  DFR_ERROR,
+} DFR_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t Frames;
+  uint32_t Bytes;
+  uint32_t Dropped;
+} DFR_StatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len,
+                           const void *data, uint32_t len);
+uint8_t           DFR_Fits(uint32_t frames, uint32_t bytes);
+void              DFR_Drop(uint32_t frames);
+void              DFR_GetStats(DFR_StatsTypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_FRAME_H */
@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file    dsp_gen.c
+  * @brief   DDS test tone generator.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include "main.h"
+#include "dsp_tables.h"
+#include "dsp_gen.h"
+
+/* Private define ------------------------------------------------------------*/
+#define GEN_QUARTER               (DSP_TABLE_SIZE / 4U)
+#define GEN_FRAC_BITS             (32U - DSP_TABLE_LOG2)
+
+/* Private variables ---------------------------------------------------------*/
+static GEN_ConfigTypeDef GenConfig = { 1000000U, -6, GEN_LEVEL_OFF };
+static uint32_t GenPhase;
+static uint32_t GenIncrement;
+static int32_t  GenAmplitude;   /* q15 */
+static int32_t  GenNoise;       /* q15 */
+static uint32_t GenSeed = 0x2545F491U;
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t GEN_Table(uint32_t index);
+static int32_t GEN_Amplitude(int32_t level);
+
+/* Private functions ---------------------------------------------------------*/
+/* sin(2 pi index / DSP_TABLE_SIZE) from the quarter wave */
+static int32_t GEN_Table(uint32_t index)
+{
+  uint32_t i = index & (DSP_TABLE_SIZE - 1U);
+  uint32_t r = i & (GEN_QUARTER - 1U);
+
+  switch (i / GEN_QUARTER)
+  {
+    case 0U:  return TBL_SineQ31[r];
+    case 1U:  return TBL_SineQ31[GEN_QUARTER - r];
+    case 2U:  return -TBL_SineQ31[r];
+    default:  return -TBL_SineQ31[GEN_QUARTER - r];
+  }
+}
+
+/* dBFS to q15 peak amplitude */
+static int32_t GEN_Amplitude(int32_t level)
+{
+  if (level <= GEN_LEVEL_OFF)
+  {
+    return 0;
+  }
+  if (level >= 0)
+  {
+    return 32767;
+  }
+  return (int32_t)(32767.0f * powf(10.0f, (float)level / 20.0f) + 0.5f);
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  sin(2 pi phase / 2^32), interpolated
+  * @param  phase: Phase, full circle = 2^32
+  * @retval q31 sine
+  */
+int32_t GEN_Sine(uint32_t phase)
+{
+  uint32_t index = phase >> GEN_FRAC_BITS;
+  int32_t frac = (int32_t)((phase >> (GEN_FRAC_BITS - 15U)) & 0x7FFFU);
+  int32_t s0 = GEN_Table(index);
+  int32_t s1 = GEN_Table(index + 1U);
+
+  return s0 + (int32_t)(((int64_t)(s1 - s0) * frac) >> 15);
+}
+
+/**
+  * @brief  Sets the tone and noise
+  * @param  config: Tone and noise parameters
+  * @param  rate: Sampling rate in Hz
+  * @retval None
+  */
+void GEN_Configure(const GEN_ConfigTypeDef *config, uint32_t rate)
+{
+  GenConfig    = *config;
+  GenIncrement = (rate != 0U)
+                 ? (uint32_t)(((uint64_t)config->Frequency << 32U) / ((uint64_t)rate * 1000U))
+                 : 0U;
+  GenAmplitude = GEN_Amplitude(config->Level);
+  GenNoise     = GEN_Amplitude(config->Noise);
+}
+
+/**
+  * @brief  Current settings
+  * @param  config: Filled with the settings
+  * @retval None
+  */
+void GEN_GetConfig(GEN_ConfigTypeDef *config)
+{
+  *config = GenConfig;
+}
+
+/**
+  * @brief  Produces the next samples
+  * @param  dst: count int16 samples
+  * @param  count: Number of samples
+  * @retval None
+  */
+void GEN_Fill(int16_t *dst, uint32_t count)
+{
+  uint32_t phase = GenPhase;
+  uint32_t seed = GenSeed;
+  int32_t sample;
+  uint32_t i;
+
+  for (i = 0U; i < count; i++)
+  {
+    sample = (int32_t)(((int64_t)GEN_Sine(phase) * GenAmplitude) >> 31);
+    phase += GenIncrement;
+    if (GenNoise != 0)
+    {
+      seed ^= seed << 13U;
+      seed ^= seed >> 17U;
+      seed ^= seed << 5U;
+      sample += (int32_t)(((int64_t)(int32_t)seed * GenNoise) >> 31);
+    }
+    dst[i] = (int16_t)__SSAT(sample, 16);
+  }
+
+  GenPhase = phase;
+  GenSeed = seed;
+}
@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file    dsp_gen.h
+  * @brief   DDS test tone generator.
+  ******************************************************************************
+  * @attention
+  *
+  * 32-bit phase accumulator driving the q31 sine table with linear
+  * interpolation (spurs below -120 dBFS), plus optional uniform white
+  * noise from a xorshift generator. Used as the signal source of the
+  * analysis chain when no converter feeds it, and as the stimulus of the
+  * distortion measurements.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_GEN_H
+#define __DSP_GEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define GEN_LEVEL_OFF             (-200)  /* dBFS, silences a component       */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Frequency;   /* mHz                                              */
+  int32_t  Level;       /* Tone peak, dBFS                                  */
+  int32_t  Noise;       /* Noise peak, dBFS, GEN_LEVEL_OFF for none         */
+} GEN_ConfigTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void    GEN_Configure(const GEN_ConfigTypeDef *config, uint32_t rate);
+void    GEN_GetConfig(GEN_ConfigTypeDef *config);
+void    GEN_Fill(int16_t *dst, uint32_t count);
+int32_t GEN_Sine(uint32_t phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_GEN_H */
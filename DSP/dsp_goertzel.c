@@ -0,0 +1,518 @@
+/**
+  ******************************************************************************
+  * @file    dsp_goertzel.c
+  * @brief   Goertzel detectors watching a set of tones.
+  ******************************************************************************
+  * @attention
+  *
+  * Resonator: s[n] = x[n] + 2 cos(w) s[n-1] - s[n-2], 2 cos(w) in q30, the
+  * state in block floating point. An input at the tone frequency makes
+  * the state grow by up to 1 / (2 |sin w|) of its amplitude per sample,
+  * so each tone feeds x << 16 shifted right, rounded, by Gain = 2 +
+  * log2(GTZ_CHUNK / (2 |sin w|)): over a chunk the state cannot grow by
+  * more than 2^29. Before each chunk, a state reaching 2^29 (CLZ < 3) is
+  * halved as needed, the input with it, and the halvings are counted in
+  * Exp. The frequency need not fall on a bin of the block. Near DC and
+  * fs / 2, where 2 cos(w) is close to +-2, the coefficient and |X|^2 are
+  * computed from 2 - |2 cos(w)| so that float rounding does not move the
+  * resonance or cancel the power.
+  *
+  * At the end of a block |X|^2 = s1^2 + s2^2 - 2 cos(w) s1 s2, scaled back
+  * by 2^(2 (Gain + Exp)); a full scale sine on the tone gives
+  * |X| = Block / 2 and reads 0 dB.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_frame.h"
+#include "dsp_goertzel.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  int32_t  Coeff;     /* 2 cos w, q30                                      */
+  int32_t  S1;
+  int32_t  S2;
+  uint8_t  Gain;      /* Right shift of x << 16, state not rescaled        */
+  uint8_t  Exp;       /* Halvings of the state in this block               */
+  uint8_t  On;        /* Above the threshold                               */
+  int16_t  Level;     /* Last block, 0.01 dBFS                             */
+  uint32_t Events;
+} GTZ_StateTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static GTZ_ToneTypeDef  GtzTones[GTZ_TONES_MAX];
+static GTZ_StateTypeDef GtzState[GTZ_TONES_MAX];
+
+static uint8_t  GtzEnabled;
+static uint32_t GtzBlock = 480U;
+static uint32_t GtzRateMs = 1000U;
+static uint32_t GtzCount;       /* Samples in the current block            */
+static uint32_t GtzBlocks;
+static uint32_t GtzRead;
+
+static uint32_t GtzSeq;
+static uint32_t GtzEvents;
+static uint32_t GtzOverruns;
+static uint32_t GtzReportTick;
+static uint32_t GtzCycles;      /* Current block                           */
+static uint32_t GtzBlockCycles; /* Last block                              */
+
+/* Private function prototypes -----------------------------------------------*/
+static void    GTZ_Setup(uint32_t index);
+static void    GTZ_Run(const int16_t *src, uint32_t n);
+static void    GTZ_Block(void);
+static void    GTZ_Event(uint32_t index);
+static void    GTZ_Report(void);
+static int32_t GTZ_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef GTZ_ConsoleCommand =
+{
+  .Name    = "tone",
+  .Help    = "tone [add <hz> [dbfs]|del <i>|clear|n <samples>|rate <ms>|on|off] - Goertzel tone detectors",
+  .Handler = GTZ_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Coefficient and input gain for the input rate, clears the state */
+static void GTZ_Setup(uint32_t index)
+{
+  GTZ_StateTypeDef *st = &GtzState[index];
+  uint32_t rate = DSP_GetInput()->Rate;
+  uint32_t freq = GtzTones[index].Frequency;
+  uint32_t dist;
+  float a;
+  float s;
+  int64_t k;
+  int32_t gain;
+
+  (void)memset(st, 0, sizeof(*st));
+  st->Level = GTZ_LEVEL_MIN;
+  if ((freq == 0U) || (freq >= (rate / 2U)))
+  {
+    return;
+  }
+
+  /* From the distance v to DC or to fs / 2, a = v / 2 in radians:
+     |2 cos w| = 2 - 4 sin^2 a. Only the small term is rounded, in float,
+     so the resonance stays on the tone where 2 cos w is close to +-2 */
+  dist = (freq < (rate / 4U)) ? freq : ((rate / 2U) - freq);
+  a = ((float)M_PI * (float)dist) / (float)rate;
+  s = fmaxf(sinf(2.0f * a), 1e-6f);
+  k = llrintf(4.0f * sinf(a) * sinf(a) * 1073741824.0f);
+  k = (freq < (rate / 4U)) ? (2147483648LL - k) : (k - 2147483648LL);
+  gain = 2 + (int32_t)ceilf(log2f((float)GTZ_CHUNK / (2.0f * s)));
+  st->Coeff = (int32_t)((k > INT32_MAX) ? INT32_MAX : k);
+  st->Gain  = (uint8_t)((gain > 31) ? 31 : gain);
+}
+
+/* Up to GTZ_CHUNK samples through every active resonator */
+static void GTZ_Run(const int16_t *src, uint32_t n)
+{
+  GTZ_StateTypeDef *st;
+  uint32_t clz;
+  uint32_t shift;
+  uint32_t t;
+  uint32_t i;
+  int32_t coeff;
+  int32_t round;
+  int32_t s0;
+  int32_t s1;
+  int32_t s2;
+
+  for (t = 0U; t < GTZ_TONES_MAX; t++)
+  {
+    st = &GtzState[t];
+    if (st->Gain == 0U)
+    {
+      continue;
+    }
+
+    s1 = st->S1;
+    s2 = st->S2;
+    clz = __CLZ((uint32_t)abs(s1) | (uint32_t)abs(s2));
+    if (clz < 3U)
+    {
+      s1 >>= 3U - clz;
+      s2 >>= 3U - clz;
+      st->Exp += (uint8_t)(3U - clz);
+    }
+    shift = (uint32_t)st->Gain + st->Exp;
+    if (shift > 31U)
+    {
+      shift = 31U;
+    }
+
+    coeff = st->Coeff;
+    /* x << 16 >> shift as x << 15 >> (shift - 1), rounded: once Exp has
+       grown a truncation bias of half an input LSB reads as a tone near DC */
+    shift--;
+    round = (int32_t)(1UL << (shift - 1U));
+    for (i = 0U; i < n; i++)
+    {
+      s0 = ((((int32_t)src[i] * 32768) + round) >> shift) + (int32_t)(((int64_t)coeff * s1) >> 30) - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    st->S1 = s1;
+    st->S2 = s2;
+  }
+}
+
+/* Levels of the block just completed, threshold events */
+static void GTZ_Block(void)
+{
+  GTZ_StateTypeDef *st;
+  float n2 = (float)GtzBlock * (float)GtzBlock;
+  float s1;
+  float s2;
+  float d;
+  float k;
+  float p;
+  float db;
+  uint32_t t;
+
+  for (t = 0U; t < GTZ_TONES_MAX; t++)
+  {
+    st = &GtzState[t];
+    if (st->Gain == 0U)
+    {
+      continue;
+    }
+
+    s1 = (float)st->S1;
+    s2 = (float)st->S2;
+    /* s1^2 + s2^2 - 2 cos w s1 s2 = (s1 -+ s2)^2 +- (2 -+ 2 cos w) s1 s2
+       with the sign of cos w: no cancellation near DC and fs / 2 */
+    if (st->Coeff >= 0)
+    {
+      d = (float)((int64_t)st->S1 - st->S2);
+      k = ldexpf((float)(2147483648LL - st->Coeff), -30);
+      p = (d * d) + (k * s1 * s2);
+    }
+    else
+    {
+      d = (float)((int64_t)st->S1 + st->S2);
+      k = ldexpf((float)(2147483648LL + st->Coeff), -30);
+      p = (d * d) - (k * s1 * s2);
+    }
+    /* 4 |X|^2 / Block^2, x in FS units: state LSB = 2^(Gain + Exp - 31) */
+    p = ldexpf(p, (2 * ((int32_t)st->Gain + (int32_t)st->Exp)) - 60) / n2;
+    db = (p > 1e-20f) ? (1000.0f * log10f(p)) : (float)GTZ_LEVEL_MIN;
+    if (db < (float)GTZ_LEVEL_MIN)
+    {
+      db = (float)GTZ_LEVEL_MIN;
+    }
+    st->Level = (db > (float)INT16_MAX) ? INT16_MAX : (int16_t)lrintf(db);
+
+    if (((st->On == 0U) && (st->Level >= GtzTones[t].Threshold))
+        || ((st->On != 0U) && (st->Level < (GtzTones[t].Threshold - GTZ_HYSTERESIS))))
+    {
+      st->On ^= 1U;
+      GTZ_Event(t);
+    }
+
+    st->S1  = 0;
+    st->S2  = 0;
+    st->Exp = 0U;
+  }
+  GtzBlocks++;
+}
+
+static void GTZ_Event(uint32_t index)
+{
+  GTZ_EventTypeDef event;
+
+  event.Tick      = HAL_GetTick();
+  event.Blocks    = GtzBlocks;
+  event.Frequency = GtzTones[index].Frequency;
+  event.Level     = GtzState[index].Level;
+  event.Tone      = (uint8_t)index;
+  event.On        = GtzState[index].On;
+  (void)DFR_Send(DFR_TAG_TONE_EVENT, &event, sizeof(event), NULL, 0U);
+
+  GtzState[index].Events++;
+  GtzEvents++;
+}
+
+/* Last levels, up to the highest tone slot in use */
+static void GTZ_Report(void)
+{
+  GTZ_FrameHeaderTypeDef header;
+  int16_t levels[GTZ_TONES_MAX];
+  uint32_t tones = 0U;
+  uint32_t t;
+
+  for (t = 0U; t < GTZ_TONES_MAX; t++)
+  {
+    levels[t] = GtzState[t].Level;
+    if (GtzTones[t].Frequency != 0U)
+    {
+      tones = t + 1U;
+    }
+  }
+
+  header.Seq        = GtzSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = DSP_GetInput()->Rate;
+  header.Block      = GtzBlock;
+  header.Blocks     = GtzBlocks;
+  header.Tones      = (uint8_t)tones;
+  (void)memset(header.Reserved, 0, sizeof(header.Reserved));
+  (void)DFR_Send(DFR_TAG_TONE, &header, sizeof(header), levels, tones * sizeof(int16_t));
+}
+
+static int32_t GTZ_Command(int32_t argc, char *argv[])
+{
+  GTZ_ToneTypeDef tone;
+  uint32_t index;
+  uint32_t t;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "add") == 0) && (argc > 2))
+    {
+      index = 0U;
+      while ((index < GTZ_TONES_MAX) && (GtzTones[index].Frequency != 0U))
+      {
+        index++;
+      }
+      tone.Frequency = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+      tone.Threshold = (int16_t)((argc > 3) ? (strtof(argv[3], NULL) * 100.0f) : -2000.0f);
+      if ((tone.Frequency == 0U) || (GTZ_SetTone(index, &tone) != GTZ_OK))
+      {
+        return 1;
+      }
+    }
+    else if ((strcmp(argv[1], "del") == 0) && (argc > 2))
+    {
+      tone.Frequency = 0U;
+      tone.Threshold = 0;
+      if (GTZ_SetTone((uint32_t)strtoul(argv[2], NULL, 0), &tone) != GTZ_OK)
+      {
+        return 1;
+      }
+    }
+    else if (strcmp(argv[1], "clear") == 0)
+    {
+      (void)memset(GtzTones, 0, sizeof(GtzTones));
+      GTZ_Reset();
+    }
+    else if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      if (GTZ_SetBlock((uint32_t)strtoul(argv[2], NULL, 0)) != GTZ_OK)
+      {
+        return 1;
+      }
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      if (GTZ_SetRate((uint32_t)strtoul(argv[2], NULL, 0)) != GTZ_OK)
+      {
+        return 1;
+      }
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+      GTZ_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      GTZ_Enable(0U);
+    }
+    else
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"n\":%lu,\"rbw_mhz\":%lu,\"rate_ms\":%lu,\"blocks\":%lu,\"events\":%lu,"
+                   "\"reports\":%lu,\"overruns\":%lu,\"block_cycles\":%lu}\r\n",
+                   GtzEnabled, (unsigned long)GtzBlock, (unsigned long)(DSP_GetInput()->Rate / GtzBlock),
+                   (unsigned long)GtzRateMs, (unsigned long)GtzBlocks, (unsigned long)GtzEvents,
+                   (unsigned long)GtzSeq, (unsigned long)GtzOverruns, (unsigned long)GtzBlockCycles);
+  for (t = 0U; t < GTZ_TONES_MAX; t++)
+  {
+    if (GtzTones[t].Frequency != 0U)
+    {
+      (void)CON_Printf("{\"tone\":%lu,\"mhz\":%lu,\"thr\":%d,\"level\":%d,\"above\":%u,\"events\":%lu}\r\n",
+                       (unsigned long)t, (unsigned long)GtzTones[t].Frequency, GtzTones[t].Threshold,
+                       GtzState[t].Level, GtzState[t].On, (unsigned long)GtzState[t].Events);
+    }
+  }
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "tone" command, detection starts disabled
+  * @retval None
+  */
+void GTZ_Init(void)
+{
+  GTZ_Reset();
+  (void)CON_Register(&GTZ_ConsoleCommand);
+}
+
+/**
+  * @brief  Watches a tone or frees its slot
+  * @param  index: Slot, < GTZ_TONES_MAX
+  * @param  tone: Frequency 0 frees the slot
+  * @retval GTZ_OK, GTZ_ERROR if the slot or the frequency is out of range
+  */
+GTZ_StatusTypeDef GTZ_SetTone(uint32_t index, const GTZ_ToneTypeDef *tone)
+{
+  if ((index >= GTZ_TONES_MAX) || (tone->Frequency >= (DSP_GetInput()->Rate / 2U)))
+  {
+    return GTZ_ERROR;
+  }
+
+  GtzTones[index] = *tone;
+  GTZ_Reset();
+  return GTZ_OK;
+}
+
+/**
+  * @brief  Sets the samples per level, hence the bandwidth fs / block
+  * @param  block: GTZ_BLOCK_MIN..GTZ_BLOCK_MAX
+  * @retval GTZ_OK, GTZ_ERROR if out of range
+  */
+GTZ_StatusTypeDef GTZ_SetBlock(uint32_t block)
+{
+  if ((block < GTZ_BLOCK_MIN) || (block > GTZ_BLOCK_MAX))
+  {
+    return GTZ_ERROR;
+  }
+
+  GtzBlock = block;
+  GTZ_Reset();
+  return GTZ_OK;
+}
+
+/**
+  * @brief  Sets the period of the level frames
+  * @param  rate_ms: Period, > 0
+  * @retval GTZ_OK, GTZ_ERROR if 0
+  */
+GTZ_StatusTypeDef GTZ_SetRate(uint32_t rate_ms)
+{
+  if (rate_ms == 0U)
+  {
+    return GTZ_ERROR;
+  }
+
+  GtzRateMs = rate_ms;
+  return GTZ_OK;
+}
+
+/**
+  * @brief  Starts or stops the detectors
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void GTZ_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (GtzEnabled == 0U))
+  {
+    GTZ_Reset();
+  }
+  GtzEnabled = enable;
+}
+
+/**
+  * @brief  Applies the input rate, restarts the block from the newest samples
+  * @note   Tones at or above the new fs / 2 are kept but not watched.
+  * @retval None
+  */
+void GTZ_Reset(void)
+{
+  uint32_t t;
+
+  for (t = 0U; t < GTZ_TONES_MAX; t++)
+  {
+    GTZ_Setup(t);
+  }
+  GtzCount = 0U;
+  GtzCycles = 0U;
+  GtzRead = DSP_RingWriteIndex(DSP_GetInput());
+  GtzReportTick = HAL_GetTick();
+}
+
+/**
+  * @brief  Runs the new input through the detectors, reports when due
+  * @note   Main loop only.
+  * @retval 1 if input is left for the next pass
+  */
+uint8_t GTZ_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  const int16_t *src;
+  uint32_t write;
+  uint32_t done = 0U;
+  uint32_t start;
+  uint32_t len;
+  uint32_t n;
+
+  if (GtzEnabled == 0U)
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if (DSP_RingIsValid(input, GtzRead) == 0U)
+  {
+    GtzRead = write;
+    GtzOverruns++;
+  }
+
+  while ((GtzRead != write) && (done < GTZ_PASS_MAX))
+  {
+    src = DSP_RingSamples(input, GtzRead, &len);
+    n = write - GtzRead;
+    if (n > len)
+    {
+      n = len;
+    }
+    if (n > GTZ_CHUNK)
+    {
+      n = GTZ_CHUNK;
+    }
+    if (n > (GtzBlock - GtzCount))
+    {
+      n = GtzBlock - GtzCount;
+    }
+
+    start = DWT->CYCCNT;
+    GTZ_Run(src, n);
+    GtzCount += n;
+    if (GtzCount == GtzBlock)
+    {
+      GTZ_Block();
+      GtzBlockCycles = GtzCycles + (DWT->CYCCNT - start);
+      GtzCycles = 0U;
+      GtzCount = 0U;
+    }
+    else
+    {
+      GtzCycles += DWT->CYCCNT - start;
+    }
+
+    GtzRead += n;
+    done += n;
+  }
+
+  if ((GtzBlocks != 0U) && ((HAL_GetTick() - GtzReportTick) >= GtzRateMs))
+  {
+    GTZ_Report();
+    GtzReportTick = HAL_GetTick();
+  }
+
+  return (GtzRead != write) ? 1U : 0U;
+}
@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    dsp_goertzel.h
+  * @brief   Goertzel detectors watching a set of tones.
+  ******************************************************************************
+  * @attention
+  *
+  * Each watched tone has its own Goertzel resonator running on the input:
+  * one multiply per tone and per sample, so the cost follows the number of
+  * tones and not the resolution. Every Block input samples the power of
+  * each tone is read, converted to dB relative to a full scale sine centred
+  * on the tone (rectangular window, bandwidth fs / Block), and the
+  * resonators restart.
+  *
+  * A tone whose level reaches its threshold raises an event, and a new one
+  * when it falls GTZ_HYSTERESIS below. Events are sent at once as
+  * DFR_TAG_TONE_EVENT frames; the levels of all tones, every RateMs, as a
+  * DFR_TAG_TONE frame of int16_t in 0.01 dB, in tone index order.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_GOERTZEL_H
+#define __DSP_GOERTZEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define GTZ_TONES_MAX             64U
+#define GTZ_BLOCK_MIN             16U     /* Samples                           */
+#define GTZ_BLOCK_MAX             65536U
+#define GTZ_CHUNK                 64U     /* Samples between headroom checks   */
+#define GTZ_PASS_MAX              1024U   /* Input samples per GTZ_Process()   */
+#define GTZ_HYSTERESIS            300     /* 0.01 dB                           */
+#define GTZ_LEVEL_MIN             (-20000) /* 0.01 dB, no signal               */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  GTZ_OK = 0,
+  GTZ_ERROR,
+} GTZ_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t Frequency;   /* mHz, below fs / 2, 0 for an unused slot          */
+  int16_t  Threshold;   /* 0.01 dBFS                                         */
+} GTZ_ToneTypeDef;
+
+/* DFR_TAG_TONE header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Seq;
+  uint32_t Tick;
+  uint32_t SampleRate;  /* mHz                                               */
+  uint32_t Block;       /* Samples per level                                 */
+  uint32_t Blocks;      /* Blocks completed since start                      */
+  uint8_t  Tones;
+  uint8_t  Reserved[3];
+} GTZ_FrameHeaderTypeDef;
+
+/* DFR_TAG_TONE_EVENT value, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Tick;
+  uint32_t Blocks;      /* Block that crossed the threshold                  */
+  uint32_t Frequency;   /* mHz                                               */
+  int16_t  Level;       /* 0.01 dBFS                                         */
+  uint8_t  Tone;
+  uint8_t  On;          /* 1 above the threshold, 0 back below               */
+} GTZ_EventTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              GTZ_Init(void);
+GTZ_StatusTypeDef GTZ_SetTone(uint32_t index, const GTZ_ToneTypeDef *tone);
+GTZ_StatusTypeDef GTZ_SetBlock(uint32_t block);
+GTZ_StatusTypeDef GTZ_SetRate(uint32_t rate_ms);
+void              GTZ_Enable(uint8_t enable);
+void              GTZ_Reset(void);
+uint8_t           GTZ_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_GOERTZEL_H */
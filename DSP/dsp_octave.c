@@ -0,0 +1,804 @@
+/**
+  ******************************************************************************
+  * @file    dsp_octave.c
+  * @brief   Fractional-octave band levels of the input.
+  ******************************************************************************
+  * @attention
+  *
+  * The signal is carried in q31 with 6 dB of headroom (input << 15). The
+  * biquads are direct form I with q30 coefficients, the feedback ones
+  * negated, and a 64-bit accumulator (SMLAL); the weighting sections feed
+  * their truncation error back so that the noise of the 20 Hz poles does
+  * not build up at low frequencies.
+  *
+  * The filters are designed in float for the current rate: bilinear
+  * transform of the analog prototypes, with each corner prewarped. The A
+  * and C weightings use the poles of IEC 61672-1 and are normalised to
+  * 0 dB at 1 kHz; the band-pass sections come from the 3rd order
+  * Butterworth low-pass (s -> (s^2 + w0^2) / (B s)), each normalised to
+  * unity gain at the band centre. The decimators are the half-band of
+  * DEC_ applied to 32-bit data.
+  *
+  * The mean squares are kept in float, in q31^2 units.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_decim.h"
+#include "dsp_frame.h"
+#include "dsp_octave.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  float Re;
+  float Im;
+} OCT_CpxTypeDef;
+
+typedef struct
+{
+  float Pole1;    /* Hz */
+  float Pole2;    /* Hz */
+  float B1;       /* Numerator 1 + B1 z^-1 + z^-2: -2 high-pass, 2 low-pass */
+} OCT_WeightDefTypeDef;
+
+/* y = B0 x0 + B1 x1 + B2 x2 + A1 y1 + A2 y2, q30 */
+typedef struct
+{
+  int32_t B0;
+  int32_t B1;
+  int32_t B2;
+  int32_t A1;
+  int32_t A2;
+} OCT_WeightCoeffTypeDef;
+
+typedef struct
+{
+  int32_t  X1;
+  int32_t  X2;
+  int32_t  Y1;
+  int32_t  Y2;
+  uint32_t Error;   /* Bits dropped from the last output */
+} OCT_WeightStateTypeDef;
+
+/* y = G (x0 - x2) + A1 y1 + A2 y2, q30 */
+typedef struct
+{
+  int32_t G;
+  int32_t A1;
+  int32_t A2;
+} OCT_BandCoeffTypeDef;
+
+typedef struct
+{
+  int32_t X1;
+  int32_t X2;
+  int32_t Y1;
+  int32_t Y2;
+} OCT_BandStateTypeDef;
+
+typedef struct
+{
+  OCT_BandStateTypeDef Section[OCT_BAND_SECTIONS];
+  float                Ms;    /* Fast, Slow                                */
+  double               Sum;   /* Leq                                       */
+} OCT_BandTypeDef;
+
+typedef struct
+{
+  int32_t  Line[2U * DEC_HB_TAPS];
+  int32_t  Delay[DEC_HB_DELAY];
+  uint32_t Pos;
+  uint32_t DelayPos;
+  uint32_t Phase;
+  int32_t  Even;
+} OCT_HalfBandTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define OCT_FREQ_MIN              20.0f   /* Hz, lowest top band of a stage */
+#define OCT_EDGE_MAX              0.4f    /* Upper band edge / fs          */
+#define OCT_POLE_MAX              0.45f   /* Weighting poles clamped, / fs */
+#define OCT_TAU_FAST              0.125f  /* s */
+#define OCT_TAU_SLOW              1.0f    /* s */
+
+#if (OCT_BLOCK > (2U * DSP_SCRATCH_SIZE))     /* int32_t in FFT_CpxTypeDef */
+#error "OCT_BLOCK does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static OCT_ConfigTypeDef OctConfig =
+{
+  .Fraction  = 3U,
+  .Weighting = OCT_WEIGHT_A,
+  .Time      = OCT_TIME_FAST,
+  .RateMs    = 1000U,
+};
+
+static const OCT_WeightDefTypeDef OCT_WeightA[] =
+{
+  { 20.598997f,  20.598997f, -2.0f },
+  { 107.65265f,  737.86223f, -2.0f },
+  { 12194.217f,  12194.217f,  2.0f },
+};
+
+static const OCT_WeightDefTypeDef OCT_WeightC[] =
+{
+  { 20.598997f,  20.598997f, -2.0f },
+  { 12194.217f,  12194.217f,  2.0f },
+};
+
+static const char *const OCT_WeightNames[OCT_WEIGHT_COUNT] = { "z", "a", "c" };
+static const char *const OCT_TimeNames[OCT_TIME_COUNT] = { "fast", "slow", "leq" };
+
+static OCT_WeightCoeffTypeDef OctWeightCoeffs[OCT_WEIGHT_SECTIONS];
+static OCT_WeightStateTypeDef OctWeightState[OCT_WEIGHT_SECTIONS];
+static OCT_BandCoeffTypeDef   OctBandCoeffs[OCT_FRACTION_MAX][OCT_BAND_SECTIONS];
+static OCT_BandTypeDef        OctBands[OCT_BANDS_MAX];
+static OCT_HalfBandTypeDef    OctHalfBand[OCT_STAGES_MAX - 1U];
+static float                  OctAlpha[OCT_STAGES_MAX];
+static uint32_t               OctCount[OCT_STAGES_MAX];
+static int32_t                OctStageA[OCT_BLOCK];
+static int32_t                OctStageB[OCT_BLOCK / 2U];
+
+static uint8_t  OctEnabled;
+static uint32_t OctWeightSections;
+static uint32_t OctStages;
+static int32_t  OctTopBand;     /* m of the highest band                   */
+static uint32_t OctRead;
+static uint32_t OctSamples;
+
+static uint32_t OctSeq;
+static uint32_t OctOverruns;
+static uint32_t OctReportTick;
+static uint32_t OctCycles;      /* Per input sample, last block            */
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t  OCT_Q30(float value);
+static int32_t  OCT_Sat(int64_t acc);
+static OCT_CpxTypeDef OCT_CpxDiv(OCT_CpxTypeDef a, OCT_CpxTypeDef b);
+static OCT_CpxTypeDef OCT_CpxSqrt(OCT_CpxTypeDef a);
+static float    OCT_Gain(float b1, float b2, float a1, float a2, float w);
+static void     OCT_DesignWeighting(float fs);
+static void     OCT_DesignBand(float fc, OCT_BandCoeffTypeDef *coeff);
+static void     OCT_Weight(const int16_t *src, uint32_t n, int32_t *dst);
+static void     OCT_Band(OCT_BandTypeDef *band, const OCT_BandCoeffTypeDef *coeff,
+                         const int32_t *src, uint32_t n, float alpha);
+static uint32_t OCT_HalfBand(OCT_HalfBandTypeDef *hb, const int32_t *src, uint32_t n, int32_t *dst);
+static void     OCT_Tree(const int16_t *src, uint32_t n);
+static int16_t  OCT_Level(float ms);
+static void     OCT_Report(void);
+static uint32_t OCT_Find(const char *const *names, uint32_t count, const char *name);
+static int32_t  OCT_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef OCT_ConsoleCommand =
+{
+  .Name    = "oct",
+  .Help    = "oct [1|3|6|weight <a|c|z>|time <fast|slow|leq>|rate <ms>|off] - fractional-octave levels",
+  .Handler = OCT_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static int32_t OCT_Q30(float value)
+{
+  value *= 1073741824.0f;
+  if (value >= 2147483647.0f)
+  {
+    return INT32_MAX;
+  }
+  if (value <= -2147483648.0f)
+  {
+    return INT32_MIN;
+  }
+  return (int32_t)lrintf(value);
+}
+
+static inline int32_t OCT_Sat(int64_t acc)
+{
+  if (acc > INT32_MAX)
+  {
+    return INT32_MAX;
+  }
+  if (acc < INT32_MIN)
+  {
+    return INT32_MIN;
+  }
+  return (int32_t)acc;
+}
+
+static OCT_CpxTypeDef OCT_CpxDiv(OCT_CpxTypeDef a, OCT_CpxTypeDef b)
+{
+  OCT_CpxTypeDef q;
+  float d = (b.Re * b.Re) + (b.Im * b.Im);
+
+  q.Re = ((a.Re * b.Re) + (a.Im * b.Im)) / d;
+  q.Im = ((a.Im * b.Re) - (a.Re * b.Im)) / d;
+  return q;
+}
+
+/* Principal root, Im >= 0 for a negative real */
+static OCT_CpxTypeDef OCT_CpxSqrt(OCT_CpxTypeDef a)
+{
+  OCT_CpxTypeDef r;
+  float m = hypotf(a.Re, a.Im);
+
+  r.Re = sqrtf((m + a.Re) / 2.0f);
+  r.Im = copysignf(sqrtf((m - a.Re) / 2.0f), a.Im);
+  return r;
+}
+
+/* |(1 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)| at z = e^jw */
+static float OCT_Gain(float b1, float b2, float a1, float a2, float w)
+{
+  float c1 = cosf(w);
+  float s1 = sinf(w);
+  float c2 = cosf(2.0f * w);
+  float s2 = sinf(2.0f * w);
+
+  return hypotf(1.0f + (b1 * c1) + (b2 * c2), (b1 * s1) + (b2 * s2))
+         / hypotf(1.0f + (a1 * c1) + (a2 * c2), (a1 * s1) + (a2 * s2));
+}
+
+/* Real poles mapped with z = (1 - t) / (1 + t), t = tan(pi f / fs);
+   the gain that brings 1 kHz to 0 dB goes to the last (low-pass) section */
+static void OCT_DesignWeighting(float fs)
+{
+  const OCT_WeightDefTypeDef *def;
+  float w = (2.0f * (float)M_PI * 1000.0f) / fs;
+  float gain = 1.0f;
+  float g;
+  float t1;
+  float t2;
+  float p1;
+  float p2;
+  uint32_t k;
+
+  switch (OctConfig.Weighting)
+  {
+    case OCT_WEIGHT_A:
+      def = OCT_WeightA;
+      OctWeightSections = sizeof(OCT_WeightA) / sizeof(OCT_WeightA[0]);
+      break;
+    case OCT_WEIGHT_C:
+      def = OCT_WeightC;
+      OctWeightSections = sizeof(OCT_WeightC) / sizeof(OCT_WeightC[0]);
+      break;
+    default:
+      def = NULL;
+      OctWeightSections = 0U;
+      break;
+  }
+
+  for (k = 0U; k < OctWeightSections; k++)
+  {
+    t1 = tanf(((float)M_PI * fminf(def[k].Pole1, OCT_POLE_MAX * fs)) / fs);
+    t2 = tanf(((float)M_PI * fminf(def[k].Pole2, OCT_POLE_MAX * fs)) / fs);
+    p1 = (1.0f - t1) / (1.0f + t1);
+    p2 = (1.0f - t2) / (1.0f + t2);
+    gain *= OCT_Gain(def[k].B1, 1.0f, -(p1 + p2), p1 * p2, w);
+    g = (k == (OctWeightSections - 1U)) ? (1.0f / gain) : 1.0f;
+
+    OctWeightCoeffs[k].B0 = OCT_Q30(g);
+    OctWeightCoeffs[k].B1 = OCT_Q30(g * def[k].B1);
+    OctWeightCoeffs[k].B2 = OCT_Q30(g);
+    OctWeightCoeffs[k].A1 = OCT_Q30(p1 + p2);
+    OctWeightCoeffs[k].A2 = OCT_Q30(-(p1 * p2));
+  }
+}
+
+/* 6th order Butterworth band-pass, fc = centre / fs */
+static void OCT_DesignBand(float fc, OCT_BandCoeffTypeDef *coeff)
+{
+  static const OCT_CpxTypeDef prototype[OCT_BAND_SECTIONS] =
+  {
+    { -1.0f, 0.0f }, { -0.5f, 0.8660254f }, { -0.5f, 0.8660254f },
+  };
+  static const float sign[OCT_BAND_SECTIONS] = { 1.0f, 1.0f, -1.0f };
+  float ratio = exp2f(0.5f / (float)OctConfig.Fraction);
+  float w1 = 2.0f * tanf(((float)M_PI * fc) / ratio);
+  float w2 = 2.0f * tanf((float)M_PI * fc * ratio);
+  float w0sq = w1 * w2;
+  float bw = w2 - w1;
+  float centre = 2.0f * atanf(sqrtf(w0sq) / 2.0f);
+  OCT_CpxTypeDef pb;
+  OCT_CpxTypeDef d;
+  OCT_CpxTypeDef s;
+  OCT_CpxTypeDef z;
+  float a1;
+  float a2;
+  uint32_t k;
+
+  for (k = 0U; k < OCT_BAND_SECTIONS; k++)
+  {
+    /* Root of s^2 - p B s + w0^2 */
+    pb.Re = prototype[k].Re * bw;
+    pb.Im = prototype[k].Im * bw;
+    d.Re = ((pb.Re * pb.Re) - (pb.Im * pb.Im)) - (4.0f * w0sq);
+    d.Im = 2.0f * pb.Re * pb.Im;
+    d = OCT_CpxSqrt(d);
+    s.Re = (pb.Re + (sign[k] * d.Re)) / 2.0f;
+    s.Im = (pb.Im + (sign[k] * d.Im)) / 2.0f;
+
+    /* z = (2 + s) / (2 - s), paired with its conjugate */
+    z = OCT_CpxDiv((OCT_CpxTypeDef){ 2.0f + s.Re, s.Im }, (OCT_CpxTypeDef){ 2.0f - s.Re, -s.Im });
+    a1 = -2.0f * z.Re;
+    a2 = (z.Re * z.Re) + (z.Im * z.Im);
+
+    coeff[k].G  = OCT_Q30(1.0f / OCT_Gain(0.0f, -1.0f, a1, a2, centre));
+    coeff[k].A1 = OCT_Q30(-a1);
+    coeff[k].A2 = OCT_Q30(-a2);
+  }
+}
+
+/* Input to q31 (<< 15), through the weighting sections */
+static void OCT_Weight(const int16_t *src, uint32_t n, int32_t *dst)
+{
+  const OCT_WeightCoeffTypeDef *c;
+  OCT_WeightStateTypeDef *st;
+  int64_t acc;
+  int32_t x;
+  int32_t x1;
+  int32_t x2;
+  int32_t y1;
+  int32_t y2;
+  uint32_t err;
+  uint32_t i;
+  uint32_t k;
+
+  for (i = 0U; i < n; i++)
+  {
+    dst[i] = (int32_t)src[i] * 32768;
+  }
+
+  for (k = 0U; k < OctWeightSections; k++)
+  {
+    c  = &OctWeightCoeffs[k];
+    st = &OctWeightState[k];
+    x1 = st->X1;
+    x2 = st->X2;
+    y1 = st->Y1;
+    y2 = st->Y2;
+    err = st->Error;
+    for (i = 0U; i < n; i++)
+    {
+      x = dst[i];
+      acc = ((int64_t)c->B0 * x) + ((int64_t)c->B1 * x1) + ((int64_t)c->B2 * x2)
+          + ((int64_t)c->A1 * y1) + ((int64_t)c->A2 * y2) + (int64_t)err;
+      err = (uint32_t)acc & 0x3FFFFFFFU;
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = OCT_Sat(acc >> 30);
+      dst[i] = y1;
+    }
+    st->X1 = x1;
+    st->X2 = x2;
+    st->Y1 = y1;
+    st->Y2 = y2;
+    st->Error = err;
+  }
+}
+
+/* One band over a block of its stage, then its detector */
+static void OCT_Band(OCT_BandTypeDef *band, const OCT_BandCoeffTypeDef *coeff,
+                     const int32_t *src, uint32_t n, float alpha)
+{
+  int32_t *work = (int32_t *)DSP_GetScratch();
+  OCT_BandStateTypeDef *st;
+  int64_t acc;
+  int32_t g;
+  int32_t a1;
+  int32_t a2;
+  int32_t x;
+  int32_t x1;
+  int32_t x2;
+  int32_t y1;
+  int32_t y2;
+  float sum;
+  float ms;
+  float v;
+  uint32_t i;
+  uint32_t k;
+
+  for (k = 0U; k < OCT_BAND_SECTIONS; k++)
+  {
+    st = &band->Section[k];
+    g  = coeff[k].G;
+    a1 = coeff[k].A1;
+    a2 = coeff[k].A2;
+    x1 = st->X1;
+    x2 = st->X2;
+    y1 = st->Y1;
+    y2 = st->Y2;
+    for (i = 0U; i < n; i++)
+    {
+      x = src[i];
+      acc = ((int64_t)g * x) - ((int64_t)g * x2) + ((int64_t)a1 * y1) + ((int64_t)a2 * y2);
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = OCT_Sat(acc >> 30);
+      work[i] = y1;
+    }
+    st->X1 = x1;
+    st->X2 = x2;
+    st->Y1 = y1;
+    st->Y2 = y2;
+    src = work;
+  }
+
+  if (OctConfig.Time == OCT_TIME_LEQ)
+  {
+    sum = 0.0f;
+    for (i = 0U; i < n; i++)
+    {
+      v = (float)work[i];
+      sum += v * v;
+    }
+    band->Sum += (double)sum;
+  }
+  else
+  {
+    ms = band->Ms;
+    for (i = 0U; i < n; i++)
+    {
+      v = (float)work[i];
+      ms += alpha * ((v * v) - ms);
+    }
+    band->Ms = ms;
+  }
+}
+
+/* DEC_HalfBand() on q31 samples */
+static uint32_t OCT_HalfBand(OCT_HalfBandTypeDef *hb, const int32_t *src, uint32_t n, int32_t *dst)
+{
+  const int32_t *x;
+  uint32_t out = 0U;
+  uint32_t s;
+  uint32_t i;
+  int64_t acc;
+
+  for (s = 0U; s < n; s++)
+  {
+    hb->Phase ^= 1U;
+    if (hb->Phase != 0U)
+    {
+      hb->Even = src[s];
+      continue;
+    }
+
+    hb->Pos = ((hb->Pos == 0U) ? DEC_HB_TAPS : hb->Pos) - 1U;
+    hb->Line[hb->Pos] = src[s];
+    hb->Line[hb->Pos + DEC_HB_TAPS] = src[s];
+
+    hb->Delay[hb->DelayPos] = hb->Even;
+    hb->DelayPos = (hb->DelayPos + 1U) % DEC_HB_DELAY;
+
+    x = &hb->Line[hb->Pos];
+    acc = (int64_t)hb->Delay[hb->DelayPos] * DEC_HB_CENTRE;
+    for (i = 0U; i < DEC_HB_TAPS; i++)
+    {
+      acc += (int64_t)x[i] * DEC_HalfBandCoeffs[i];
+    }
+    dst[out++] = OCT_Sat((acc + (1 << 14)) >> 15);
+  }
+  return out;
+}
+
+/* Weighting, then each stage's bands and the decimation to the next */
+static void OCT_Tree(const int16_t *src, uint32_t n)
+{
+  int32_t *buf = OctStageA;
+  int32_t *next = OctStageB;
+  int32_t *tmp;
+  uint32_t start = DWT->CYCCNT;
+  uint32_t total = n;
+  uint32_t o;
+  uint32_t j;
+
+  OCT_Weight(src, n, buf);
+
+  for (o = 0U; (o < OctStages) && (n != 0U); o++)
+  {
+    for (j = 0U; j < OctConfig.Fraction; j++)
+    {
+      OCT_Band(&OctBands[(o * OctConfig.Fraction) + j], OctBandCoeffs[j], buf, n, OctAlpha[o]);
+    }
+    OctCount[o] += n;
+
+    if ((o + 1U) < OctStages)
+    {
+      n = OCT_HalfBand(&OctHalfBand[o], buf, n, next);
+      tmp = buf;
+      buf = next;
+      next = tmp;
+    }
+  }
+
+  OctSamples += total;
+  OctCycles = (DWT->CYCCNT - start) / total;
+}
+
+/* Mean square in q31^2 to 0.01 dB, 8 ms / 2^62 = 1.0 for a full scale sine */
+static int16_t OCT_Level(float ms)
+{
+  float db;
+
+  ms = ldexpf(ms, -59);
+  if (ms < 1e-20f)
+  {
+    return OCT_LEVEL_MIN;
+  }
+  db = 1000.0f * log10f(ms);
+  if (db > (float)INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  return (db < (float)OCT_LEVEL_MIN) ? OCT_LEVEL_MIN : (int16_t)lrintf(db);
+}
+
+/* Levels from the lowest band; a Leq report restarts the integration */
+static void OCT_Report(void)
+{
+  OCT_FrameHeaderTypeDef header;
+  int16_t levels[OCT_BANDS_MAX];
+  uint32_t bands = OctStages * OctConfig.Fraction;
+  uint32_t count;
+  uint32_t i;
+  uint32_t k;
+  float ms;
+
+  for (i = 0U; i < bands; i++)
+  {
+    k = bands - 1U - i;
+    if (OctConfig.Time == OCT_TIME_LEQ)
+    {
+      count = OctCount[k / OctConfig.Fraction];
+      ms = (count != 0U) ? (float)(OctBands[k].Sum / (double)count) : 0.0f;
+    }
+    else
+    {
+      ms = OctBands[k].Ms;
+    }
+    levels[i] = OCT_Level(ms);
+  }
+
+  header.Seq        = OctSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = DSP_GetInput()->Rate;
+  header.Samples    = OctSamples;
+  header.FirstBand  = (int16_t)((OctTopBand - (int32_t)bands) + 1);
+  header.Bands      = (uint8_t)bands;
+  header.Fraction   = (uint8_t)OctConfig.Fraction;
+  header.Weighting  = (uint8_t)OctConfig.Weighting;
+  header.Time       = (uint8_t)OctConfig.Time;
+  (void)DFR_Send(DFR_TAG_OCTAVE, &header, sizeof(header), levels, bands * sizeof(int16_t));
+
+  if (OctConfig.Time == OCT_TIME_LEQ)
+  {
+    for (k = 0U; k < bands; k++)
+    {
+      OctBands[k].Sum = 0.0;
+    }
+    (void)memset(OctCount, 0, sizeof(OctCount));
+    OctSamples = 0U;
+  }
+}
+
+static uint32_t OCT_Find(const char *const *names, uint32_t count, const char *name)
+{
+  uint32_t i;
+
+  for (i = 0U; i < count; i++)
+  {
+    if (strcmp(names[i], name) == 0)
+    {
+      break;
+    }
+  }
+  return i;
+}
+
+static int32_t OCT_Command(int32_t argc, char *argv[])
+{
+  OCT_ConfigTypeDef config = OctConfig;
+  uint8_t start = 0U;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "weight") == 0) && (argc > 2))
+    {
+      config.Weighting = (OCT_WeightingTypeDef)OCT_Find(OCT_WeightNames, OCT_WEIGHT_COUNT, argv[2]);
+    }
+    else if ((strcmp(argv[1], "time") == 0) && (argc > 2))
+    {
+      config.Time = (OCT_TimeTypeDef)OCT_Find(OCT_TimeNames, OCT_TIME_COUNT, argv[2]);
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      config.RateMs = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      OCT_Enable(0U);
+    }
+    else
+    {
+      config.Fraction = (uint32_t)strtoul(argv[1], NULL, 0);
+      start = 1U;
+    }
+    if (OCT_Configure(&config) != OCT_OK)
+    {
+      return 1;
+    }
+    if (start != 0U)
+    {
+      OCT_Enable(1U);
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"fraction\":%lu,\"weight\":\"%s\",\"time\":\"%s\",\"rate_ms\":%lu,"
+                   "\"stages\":%lu,\"bands\":%lu,\"first\":%ld,\"samples\":%lu,\"reports\":%lu,"
+                   "\"overruns\":%lu,\"cycles\":%lu}\r\n",
+                   OctEnabled, (unsigned long)OctConfig.Fraction, OCT_WeightNames[OctConfig.Weighting],
+                   OCT_TimeNames[OctConfig.Time], (unsigned long)OctConfig.RateMs,
+                   (unsigned long)OctStages, (unsigned long)(OctStages * OctConfig.Fraction),
+                   (long)((OctTopBand - (int32_t)(OctStages * OctConfig.Fraction)) + 1),
+                   (unsigned long)OctSamples, (unsigned long)OctSeq, (unsigned long)OctOverruns,
+                   (unsigned long)OctCycles);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "oct" command, the analyser starts disabled
+  * @retval None
+  */
+void OCT_Init(void)
+{
+  OCT_Reset();
+  (void)CON_Register(&OCT_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, redesigns the filters
+  * @param  config: New settings
+  * @retval OCT_OK, OCT_ERROR if a setting is out of range
+  */
+OCT_StatusTypeDef OCT_Configure(const OCT_ConfigTypeDef *config)
+{
+  if (((config->Fraction != 1U) && (config->Fraction != 3U) && (config->Fraction != 6U))
+      || (config->Weighting >= OCT_WEIGHT_COUNT) || (config->Time >= OCT_TIME_COUNT)
+      || (config->RateMs == 0U))
+  {
+    return OCT_ERROR;
+  }
+
+  OctConfig = *config;
+  OCT_Reset();
+  return OCT_OK;
+}
+
+/**
+  * @brief  Starts or stops the analyser
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void OCT_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (OctEnabled == 0U))
+  {
+    OCT_Reset();
+  }
+  OctEnabled = enable;
+}
+
+/**
+  * @brief  Designs the filters for the input rate, clears their state
+  * @retval None
+  */
+void OCT_Reset(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  float fs = (float)input->Rate / 1000.0f;
+  float fraction = (float)OctConfig.Fraction;
+  float tau = (OctConfig.Time == OCT_TIME_SLOW) ? OCT_TAU_SLOW : OCT_TAU_FAST;
+  float top;
+  uint32_t o;
+  uint32_t j;
+
+  (void)memset(OctWeightState, 0, sizeof(OctWeightState));
+  (void)memset(OctBands, 0, sizeof(OctBands));
+  (void)memset(OctHalfBand, 0, sizeof(OctHalfBand));
+  (void)memset(OctCount, 0, sizeof(OctCount));
+  OctStages = 0U;
+  OctSamples = 0U;
+
+  if (fs > 0.0f)
+  {
+    /* Highest band with f * 2^(1 / (2 Fraction)) <= OCT_EDGE_MAX fs */
+    OctTopBand = (int32_t)floorf((fraction * log2f((OCT_EDGE_MAX * fs) / 1000.0f)) - 0.5f);
+    top = 1000.0f * exp2f((float)OctTopBand / fraction);
+    if (top >= OCT_FREQ_MIN)
+    {
+      OctStages = (uint32_t)floorf(log2f(top / OCT_FREQ_MIN)) + 1U;
+    }
+    if (OctStages > OCT_STAGES_MAX)
+    {
+      OctStages = OCT_STAGES_MAX;
+    }
+
+    OCT_DesignWeighting(fs);
+    for (j = 0U; j < OctConfig.Fraction; j++)
+    {
+      OCT_DesignBand((top * exp2f(-(float)j / fraction)) / fs, OctBandCoeffs[j]);
+    }
+    for (o = 0U; o < OctStages; o++)
+    {
+      OctAlpha[o] = 1.0f - expf(-ldexpf(1.0f, (int32_t)o) / (tau * fs));
+    }
+  }
+
+  OctRead = DSP_RingWriteIndex(input);
+  OctReportTick = HAL_GetTick();
+}
+
+/**
+  * @brief  Filters the new input, reports when due
+  * @note   Main loop only.
+  * @retval 1 if input is left for the next pass
+  */
+uint8_t OCT_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  const int16_t *src;
+  uint32_t write;
+  uint32_t done = 0U;
+  uint32_t len;
+  uint32_t n;
+
+  if ((OctEnabled == 0U) || (OctStages == 0U))
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if (DSP_RingIsValid(input, OctRead) == 0U)
+  {
+    OctRead = write;
+    OctOverruns++;
+  }
+
+  while ((OctRead != write) && (done < OCT_PASS_MAX))
+  {
+    src = DSP_RingSamples(input, OctRead, &len);
+    n = write - OctRead;
+    if (n > len)
+    {
+      n = len;
+    }
+    if (n > OCT_BLOCK)
+    {
+      n = OCT_BLOCK;
+    }
+
+    OCT_Tree(src, n);
+
+    OctRead += n;
+    done += n;
+  }
+
+  if ((OctSamples != 0U) && ((HAL_GetTick() - OctReportTick) >= OctConfig.RateMs))
+  {
+    OCT_Report();
+    OctReportTick = HAL_GetTick();
+  }
+
+  return (OctRead != write) ? 1U : 0U;
+}
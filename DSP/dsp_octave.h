@@ -0,0 +1,108 @@
+/**
+  ******************************************************************************
+  * @file    dsp_octave.h
+  * @brief   Fractional-octave band levels of the input.
+  ******************************************************************************
+  * @attention
+  *
+  * The input goes through the A, C or Z (flat) frequency weighting, then
+  * through an octave-decimation tree: each stage runs the band-pass filters
+  * of one octave (1, 3 or 6 bands, 6th order Butterworth, base-two centre
+  * frequencies 1 kHz * 2^(m / Fraction)) and passes the signal, low-pass
+  * filtered and decimated by 2, to the next stage. Every stage sees its
+  * octave at the same relative frequency, so one set of band filters
+  * serves them all and the cost per input sample is about twice that of
+  * the top octave, whatever the number of octaves.
+  *
+  * The band filters are designed for the running sample rate; the top band
+  * is the highest whose upper edge stays below 0.4 fs, the alias free band
+  * of the half-band decimators, and the tree goes down to 20 Hz. The mean
+  * square of each band is integrated with the Fast (125 ms) or Slow (1 s)
+  * exponential time weighting, or linearly between reports (Leq).
+  *
+  * Every RateMs a DFR_TAG_OCTAVE frame carries the levels, lowest band
+  * first, as int16_t in 0.01 dB relative to a full scale sine:
+  *
+  *   level[i] at 1 kHz * 2^((FirstBand + i) / Fraction)
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_OCTAVE_H
+#define __DSP_OCTAVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define OCT_FRACTION_MAX          6U      /* Bands per octave                  */
+#define OCT_STAGES_MAX            11U     /* Octaves, 20 Hz at 96 kHz          */
+#define OCT_BANDS_MAX             (OCT_FRACTION_MAX * OCT_STAGES_MAX)
+#define OCT_BAND_SECTIONS         3U      /* Biquads per band                  */
+#define OCT_WEIGHT_SECTIONS       3U      /* Biquads of the A weighting        */
+#define OCT_BLOCK                 256U    /* Input samples per pass of the tree */
+#define OCT_PASS_MAX              1024U   /* Input samples per OCT_Process()   */
+#define OCT_LEVEL_MIN             (-20000) /* 0.01 dB, silent band             */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  OCT_OK = 0,
+  OCT_ERROR,
+} OCT_StatusTypeDef;
+
+typedef enum
+{
+  OCT_WEIGHT_Z = 0,
+  OCT_WEIGHT_A,
+  OCT_WEIGHT_C,
+  OCT_WEIGHT_COUNT,
+} OCT_WeightingTypeDef;
+
+typedef enum
+{
+  OCT_TIME_FAST = 0,
+  OCT_TIME_SLOW,
+  OCT_TIME_LEQ,
+  OCT_TIME_COUNT,
+} OCT_TimeTypeDef;
+
+typedef struct
+{
+  uint32_t             Fraction;  /* Bands per octave: 1, 3 or 6            */
+  OCT_WeightingTypeDef Weighting;
+  OCT_TimeTypeDef      Time;
+  uint32_t             RateMs;    /* Report period                           */
+} OCT_ConfigTypeDef;
+
+/* DFR_TAG_OCTAVE header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Seq;
+  uint32_t Tick;
+  uint32_t SampleRate;  /* Input rate, mHz                                  */
+  uint32_t Samples;     /* Input samples integrated (Leq) or since reset    */
+  int16_t  FirstBand;   /* m of the first level                             */
+  uint8_t  Bands;
+  uint8_t  Fraction;
+  uint8_t  Weighting;   /* OCT_WeightingTypeDef                             */
+  uint8_t  Time;        /* OCT_TimeTypeDef                                  */
+} OCT_FrameHeaderTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              OCT_Init(void);
+OCT_StatusTypeDef OCT_Configure(const OCT_ConfigTypeDef *config);
+void              OCT_Enable(uint8_t enable);
+void              OCT_Reset(void);
+uint8_t           OCT_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_OCTAVE_H */
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    dsp_ring.c
+  * @brief   Sample rings of the signal analysis modules.
+  ******************************************************************************
+  * @attention
+  *
+  * The ring accessors of dsp_app.h. They only depend on the ring itself,
+  * so the modules that read or fill a ring link without the scheduler.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "dsp_app.h"
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Room for the next samples of a ring
+  * @param  ring: Ring written by the caller only
+  * @param  count: Contiguous samples that may be written, <= DSP_RING_GUARD
+  * @retval Write pointer
+  */
+int16_t *DSP_RingWritePtr(DSP_RingTypeDef *ring, uint32_t *count)
+{
+  uint32_t offset = ring->Write & (ring->Size - 1U);
+
+  *count = ring->Size - offset;
+  if (*count > DSP_RING_GUARD)
+  {
+    *count = DSP_RING_GUARD;
+  }
+  return &ring->Buffer[offset];
+}
+
+/**
+  * @brief  Publishes samples written in the buffer of DSP_RingWritePtr()
+  * @param  ring: Ring written by the caller only
+  * @param  count: Samples written
+  * @retval None
+  */
+void DSP_RingCommit(DSP_RingTypeDef *ring, uint32_t count)
+{
+  __DMB();
+  ring->Write += count;
+}
+
+/**
+  * @brief  Index of the next sample to be written
+  * @param  ring: Ring to read
+  * @retval Sample index, wraps at 2^32
+  */
+uint32_t DSP_RingWriteIndex(const DSP_RingTypeDef *ring)
+{
+  uint32_t write = ring->Write;
+
+  __DMB();
+  return write;
+}
+
+/**
+  * @brief  Samples from an index, up to the end of the ring
+  * @param  ring: Ring to read
+  * @param  index: Sample index
+  * @param  count: Contiguous samples available from the pointer
+  * @retval Read pointer
+  */
+const int16_t *DSP_RingSamples(const DSP_RingTypeDef *ring, uint32_t index, uint32_t *count)
+{
+  uint32_t offset = index & (ring->Size - 1U);
+
+  *count = ring->Size - offset;
+  return &ring->Buffer[offset];
+}
+
+/**
+  * @brief  Tells whether a sample is still in the ring
+  * @param  ring: Ring to read
+  * @param  index: Sample index, not after the write index
+  * @retval 1 if the sample cannot have been overwritten yet
+  */
+uint8_t DSP_RingIsValid(const DSP_RingTypeDef *ring, uint32_t index)
+{
+  return ((ring->Write - index) <= (ring->Size - DSP_RING_GUARD)) ? 1U : 0U;
+}
@@ -0,0 +1,426 @@
+/**
+  ******************************************************************************
+  * @file    dsp_spectro.c
+  * @brief   Log-frequency spectrogram rows, quantised and delta coded.
+  ******************************************************************************
+  * @attention
+  *
+  * The matrix is stored by column (start index of each column in a list
+  * of bin, weight pairs), with 16-bit weights where 65535 is the whole
+  * bin: a column costs one multiply-add per bin it covers, at most
+  * FftSize / 2 + 2 Columns for the row.
+  *
+  * The bin powers come from ENG_Power(), as in the THD measurement, and
+  * the column sums are turned into dB with a log2
+  * made of the float exponent and a parabola on the mantissa (0.005
+  * error, 0.015 dB, far below a code step); the scaling of the FFT and
+  * window goes in as an offset on the log.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_engine.h"
+#include "dsp_frame.h"
+#include "dsp_spectro.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint16_t Bin;
+  uint16_t Weight;      /* Fraction of the bin in the column, 65535 = 1     */
+} SPG_EntryTypeDef;
+
+/* Private define ------------------------------------------------------------*/
+#define SPG_BINS_MAX              ((SPG_FFT_MAX / 2U) + 1U)
+#define SPG_ENTRIES_MAX           (SPG_BINS_MAX + (2U * SPG_COLUMNS_MAX))
+#define SPG_CODE_DB               (10.0f * 0.30103f / SPG_DB_STEP)   /* Codes per log2 */
+
+#if (SPG_FFT_MAX > (2U * DSP_SCRATCH_SIZE))
+#error "SPG_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static SPG_ConfigTypeDef SpgConfig =
+{
+  .FftSize = SPG_FFT_MAX,
+  .Window  = WIN_HANN,
+  .Columns = 128U,
+  .FMin    = 20000U,
+  .FMax    = 0U,
+  .RowRate = 50U,
+};
+
+static SPG_EntryTypeDef SpgEntries[SPG_ENTRIES_MAX];
+static uint16_t SpgStart[SPG_COLUMNS_MAX + 1U];
+static uint8_t  SpgRow[SPG_COLUMNS_MAX];
+static uint8_t  SpgPrevious[SPG_COLUMNS_MAX];
+static uint8_t  SpgCode[SPG_COLUMNS_MAX];
+static float    SpgOffset;      /* log2 of the full scale reference        */
+static uint32_t SpgFMax;        /* mHz, in use                             */
+static uint32_t SpgHop;         /* Samples between rows                    */
+
+static uint8_t  SpgEnabled;
+static uint8_t  SpgKey;         /* Next row must be a key row              */
+static uint32_t SpgRead;
+static uint32_t SpgRows;
+static uint32_t SpgKeys;
+static uint32_t SpgBytes;       /* Row payloads sent                       */
+static uint32_t SpgOverruns;
+static uint32_t SpgCycles;
+
+/* Private function prototypes -----------------------------------------------*/
+static void     SPG_Build(void);
+static float    SPG_Log2(float x);
+static void     SPG_Row(const DSP_RingTypeDef *input);
+static uint32_t SPG_Delta(void);
+static void     SPG_Send(void);
+static int32_t  SPG_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef SPG_ConsoleCommand =
+{
+  .Name    = "spectro",
+  .Help    = "spectro [on|off|n <size>|win <w>|cols <n>|fmin <hz>|fmax <hz>|rate <rows/s>] - waterfall",
+  .Handler = SPG_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Column matrix, hop and level offset for the settings and the input rate */
+static void SPG_Build(void)
+{
+  const WIN_InfoTypeDef *win = WIN_GetInfo(SpgConfig.Window);
+  uint32_t rate = DSP_GetInput()->Rate;
+  uint32_t n = SpgConfig.FftSize;
+  uint32_t count = 0U;
+  uint32_t c;
+  int32_t k;
+  int32_t from;
+  int32_t to;
+  float bin;
+  float ratio;
+  float lo;
+  float hi;
+  float weight;
+
+  SpgFMax = ((SpgConfig.FMax == 0U) || (SpgConfig.FMax > (rate / 2U))) ? (rate / 2U) : SpgConfig.FMax;
+  SpgHop = rate / (1000U * SpgConfig.RowRate);
+  (void)memset(SpgStart, 0, sizeof(SpgStart));
+  if ((SpgHop == 0U) || (SpgConfig.FMin >= SpgFMax))
+  {
+    SpgHop = 0U;
+    return;
+  }
+
+  bin = (float)n / (float)rate;
+  ratio = powf((float)SpgFMax / (float)SpgConfig.FMin, 1.0f / (float)SpgConfig.Columns);
+  hi = (float)SpgConfig.FMin * bin;
+  for (c = 0U; c < SpgConfig.Columns; c++)
+  {
+    lo = hi;
+    hi = lo * ratio;
+    from = (int32_t)lrintf(lo);
+    to = (int32_t)lrintf(hi);
+    if (to > (int32_t)(n / 2U))
+    {
+      to = (int32_t)(n / 2U);
+    }
+    SpgStart[c] = (uint16_t)count;
+    for (k = from; k <= to; k++)
+    {
+      weight = (fminf(hi, (float)k + 0.5f) - fmaxf(lo, (float)k - 0.5f)) / (hi - lo);
+      if ((weight > 0.0f) && (count < SPG_ENTRIES_MAX))
+      {
+        SpgEntries[count].Bin = (uint16_t)k;
+        SpgEntries[count].Weight = (uint16_t)lrintf(fminf(weight, 1.0f) * 65535.0f);
+        count++;
+      }
+    }
+  }
+  SpgStart[SpgConfig.Columns] = (uint16_t)count;
+
+  /* A full scale sine on a bin: |DFT|^2 = N^2 CG^2 / 4 */
+  SpgOffset = 2.0f - log2f(65535.0f)
+              - log2f((float)n * (float)n * win->CoherentGain * win->CoherentGain);
+}
+
+/* log2(x) within 0.005 for x > 0, about -127 for 0 */
+static float SPG_Log2(float x)
+{
+  uint32_t bits;
+  int32_t exponent;
+  float m;
+
+  (void)memcpy(&bits, &x, sizeof(bits));
+  exponent = (int32_t)((bits >> 23U) & 0xFFU) - 127;
+  bits = (bits & 0x007FFFFFU) | 0x3F800000U;
+  (void)memcpy(&m, &bits, sizeof(m));
+  return (float)exponent + ((((-0.34484843f * m) + 2.02466578f) * m) - 1.67487759f);
+}
+
+/* Transforms the frame at the read index into the codes of SpgRow */
+static void SPG_Row(const DSP_RingTypeDef *input)
+{
+  const float *p;
+  const int16_t *src;
+  const int16_t *wrap;
+  uint32_t n = SpgConfig.FftSize;
+  uint32_t len;
+  uint32_t avail;
+  uint32_t c;
+  uint32_t j;
+  float sum;
+  float code;
+
+  src = DSP_RingSamples(input, SpgRead, &len);
+  if (len > n)
+  {
+    len = n;
+  }
+  wrap = DSP_RingSamples(input, SpgRead + len, &avail);
+  p = ENG_Power(SpgConfig.Window, n, src, len, wrap);
+
+  for (c = 0U; c < SpgConfig.Columns; c++)
+  {
+    sum = 0.0f;
+    for (j = SpgStart[c]; j < SpgStart[c + 1U]; j++)
+    {
+      sum += (float)SpgEntries[j].Weight * p[SpgEntries[j].Bin];
+    }
+    code = 255.0f + (SPG_CODE_DB * (SPG_Log2(sum) + SpgOffset));
+    SpgRow[c] = (code <= 0.0f) ? 0U : ((code >= 255.0f) ? 255U : (uint8_t)(code + 0.5f));
+  }
+}
+
+/* Delta code of SpgRow into SpgCode, 0 if not shorter than the row */
+static uint32_t SPG_Delta(void)
+{
+  uint32_t columns = SpgConfig.Columns;
+  uint32_t len = 0U;
+  uint32_t run;
+  uint32_t c = 0U;
+  uint8_t d;
+
+  while (c < columns)
+  {
+    if ((len + 2U) > columns)
+    {
+      return 0U;
+    }
+    d = (uint8_t)(SpgRow[c] - SpgPrevious[c]);
+    if (d == 0U)
+    {
+      for (run = 1U; ((c + run) < columns) && (run < 255U) && (SpgRow[c + run] == SpgPrevious[c + run]); run++)
+      {
+      }
+      if (run > 2U)
+      {
+        SpgCode[len++] = SPG_RUN;
+        SpgCode[len++] = (uint8_t)run;
+        c += run;
+        continue;
+      }
+    }
+    else if (d == SPG_RUN)
+    {
+      SpgCode[len++] = SPG_RUN;
+      d = 0U;
+    }
+    SpgCode[len++] = d;
+    c++;
+  }
+  return (len < columns) ? len : 0U;
+}
+
+/* Sends SpgRow, as a key row or delta coded */
+static void SPG_Send(void)
+{
+  SPG_FrameHeaderTypeDef header;
+  uint32_t len = 0U;
+
+  if ((SpgKey == 0U) && ((SpgRows % SPG_KEY_ROWS) != 0U))
+  {
+    len = SPG_Delta();
+  }
+
+  header.Row      = SpgRows++;
+  header.Tick     = HAL_GetTick();
+  header.FMin     = SpgConfig.FMin;
+  header.FMax     = SpgFMax;
+  header.Columns  = (uint16_t)SpgConfig.Columns;
+  header.Key      = (len == 0U) ? 1U : 0U;
+  header.Reserved = 0U;
+  if (len == 0U)
+  {
+    len = SpgConfig.Columns;
+    SpgKeys++;
+  }
+
+  /* A lost row breaks the chain of differences */
+  SpgKey = (DFR_Send(DFR_TAG_SPECTRO, &header, sizeof(header), (header.Key != 0U) ? SpgRow : SpgCode, len)
+            != DFR_OK) ? 1U : 0U;
+  if (SpgKey == 0U)
+  {
+    SpgBytes += len;
+  }
+  (void)memcpy(SpgPrevious, SpgRow, SpgConfig.Columns);
+}
+
+static int32_t SPG_Command(int32_t argc, char *argv[])
+{
+  SPG_ConfigTypeDef config = SpgConfig;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      config.FftSize = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "win") == 0) && (argc > 2))
+    {
+      config.Window = WIN_Find(argv[2]);
+    }
+    else if ((strcmp(argv[1], "cols") == 0) && (argc > 2))
+    {
+      config.Columns = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "fmin") == 0) && (argc > 2))
+    {
+      config.FMin = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+    }
+    else if ((strcmp(argv[1], "fmax") == 0) && (argc > 2))
+    {
+      config.FMax = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      config.RowRate = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+      SPG_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      SPG_Enable(0U);
+    }
+    else
+    {
+      return 1;
+    }
+    if (SPG_Configure(&config) != SPG_OK)
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"n\":%lu,\"win\":\"%s\",\"cols\":%lu,\"fmin_mhz\":%lu,\"fmax_mhz\":%lu,"
+                   "\"rate\":%lu,\"hop\":%lu,\"entries\":%u,\"rows\":%lu,\"keys\":%lu,\"bytes\":%lu,"
+                   "\"overruns\":%lu,\"cycles\":%lu}\r\n",
+                   SpgEnabled, (unsigned long)SpgConfig.FftSize, WIN_GetInfo(SpgConfig.Window)->Name,
+                   (unsigned long)SpgConfig.Columns, (unsigned long)SpgConfig.FMin, (unsigned long)SpgFMax,
+                   (unsigned long)SpgConfig.RowRate, (unsigned long)SpgHop, SpgStart[SpgConfig.Columns],
+                   (unsigned long)SpgRows, (unsigned long)SpgKeys, (unsigned long)SpgBytes,
+                   (unsigned long)SpgOverruns, (unsigned long)SpgCycles);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "spectro" command, the stream starts disabled
+  * @retval None
+  */
+void SPG_Init(void)
+{
+  SPG_Reset();
+  (void)CON_Register(&SPG_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, rebuilds the column matrix
+  * @param  config: New settings
+  * @retval SPG_OK, SPG_ERROR if a setting is out of range
+  */
+SPG_StatusTypeDef SPG_Configure(const SPG_ConfigTypeDef *config)
+{
+  if ((config->FftSize < 64U) || (config->FftSize > SPG_FFT_MAX)
+      || ((config->FftSize & (config->FftSize - 1U)) != 0U) || (config->Window >= WIN_COUNT)
+      || (config->Columns < 8U) || (config->Columns > SPG_COLUMNS_MAX) || (config->FMin == 0U)
+      || ((config->FMax != 0U) && (config->FMax <= config->FMin))
+      || (config->RowRate == 0U) || (config->RowRate > SPG_ROWS_MAX))
+  {
+    return SPG_ERROR;
+  }
+
+  SpgConfig = *config;
+  SPG_Reset();
+  return SPG_OK;
+}
+
+/**
+  * @brief  Starts or stops the stream
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void SPG_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (SpgEnabled == 0U))
+  {
+    SPG_Reset();
+  }
+  SpgEnabled = enable;
+}
+
+/**
+  * @brief  Rebuilds the matrix for the input rate, restarts with a key row
+  * @retval None
+  */
+void SPG_Reset(void)
+{
+  SPG_Build();
+  SpgKey = 1U;
+  SpgRead = DSP_RingWriteIndex(DSP_GetInput());
+}
+
+/**
+  * @brief  Sends the next row when its frame is complete
+  * @note   Main loop only. One row per call.
+  * @retval 1 if another row is due
+  */
+uint8_t SPG_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  uint32_t write;
+  uint32_t start;
+
+  if ((SpgEnabled == 0U) || (SpgHop == 0U))
+  {
+    return 0U;
+  }
+
+  /* Signed: with a hop longer than the frame the read index runs ahead */
+  write = DSP_RingWriteIndex(input);
+  if ((int32_t)(write - SpgRead) < (int32_t)SpgConfig.FftSize)
+  {
+    return 0U;
+  }
+  if (DSP_RingIsValid(input, SpgRead) == 0U)
+  {
+    SpgRead = write;
+    SpgOverruns++;
+    return 0U;
+  }
+
+  start = DWT->CYCCNT;
+  SPG_Row(input);
+  SPG_Send();
+  SpgCycles = DWT->CYCCNT - start;
+  SpgRead += SpgHop;
+
+  return ((int32_t)(write - SpgRead) >= (int32_t)SpgConfig.FftSize) ? 1U : 0U;
+}
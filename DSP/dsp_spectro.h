@@ -0,0 +1,98 @@
+/**
+  ******************************************************************************
+  * @file    dsp_spectro.h
+  * @brief   Log-frequency spectrogram rows, quantised and delta coded.
+  ******************************************************************************
+  * @attention
+  *
+  * Every 1 / RowRate seconds the newest FftSize input samples are
+  * windowed and transformed (frames overlap when the hop is shorter than
+  * the FFT). The bin powers are remapped onto Columns log-spaced columns
+  * from FMin to FMax by a sparse matrix built when the settings or the
+  * rate change: each column is the mean power of the bins it covers,
+  * weighted by the fraction of each bin inside it, so that narrow low
+  * columns take the bin they fall in and wide high ones average many.
+  *
+  * Column c spans FMin (FMax / FMin)^(c / Columns) to the next edge; its
+  * level, relative to a full scale sine centred on a bin, is quantised to
+  * one byte in SPG_DB_STEP dB steps, 255 for 0 dBFS and 0 for
+  * -127.5 dBFS and below.
+  *
+  * A row goes out as one DFR_TAG_SPECTRO frame, either as the bytes
+  * themselves (key row) or as the differences with the previous row,
+  * modulo 256, one byte per column with a run code for unchanged
+  * columns:
+  *
+  *   0x80 0x00    difference of 0x80
+  *   0x80 n       n columns unchanged, n = 1..255
+  *   other d      difference d
+  *
+  * A row whose code would not be shorter than Columns bytes is sent as a
+  * key row, as are the first row, one row in SPG_KEY_ROWS and the row
+  * after a frame the CDC link could not take. At 100 rows/s of 256
+  * columns the stream stays below 30 kB/s, key rows only.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_SPECTRO_H
+#define __DSP_SPECTRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define SPG_FFT_MAX               1024U   /* Real points                       */
+#define SPG_COLUMNS_MAX           256U
+#define SPG_ROWS_MAX              200U    /* Rows per second                   */
+#define SPG_KEY_ROWS              64U     /* Rows between key rows             */
+#define SPG_DB_STEP               0.5f    /* dB per code                       */
+#define SPG_RUN                   0x80U   /* Run code of a delta row           */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SPG_OK = 0,
+  SPG_ERROR,
+} SPG_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t          FftSize;  /* Power of two, 64..SPG_FFT_MAX              */
+  WIN_WindowTypeDef Window;
+  uint32_t          Columns;  /* 8..SPG_COLUMNS_MAX                         */
+  uint32_t          FMin;     /* mHz, lower edge of column 0                */
+  uint32_t          FMax;     /* mHz, upper edge of the last column, 0 fs/2 */
+  uint32_t          RowRate;  /* Rows per second, 1..SPG_ROWS_MAX           */
+} SPG_ConfigTypeDef;
+
+/* DFR_TAG_SPECTRO header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Row;         /* Row number since start                           */
+  uint32_t Tick;
+  uint32_t FMin;        /* mHz                                              */
+  uint32_t FMax;        /* mHz, in use                                      */
+  uint16_t Columns;
+  uint8_t  Key;         /* 1 bytes, 0 delta code                            */
+  uint8_t  Reserved;
+} SPG_FrameHeaderTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              SPG_Init(void);
+SPG_StatusTypeDef SPG_Configure(const SPG_ConfigTypeDef *config);
+void              SPG_Enable(uint8_t enable);
+void              SPG_Reset(void);
+uint8_t           SPG_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_SPECTRO_H */
@@ -0,0 +1,681 @@
+/**
+  ******************************************************************************
+  * @file    dsp_tables.c
+  * @brief   Constant tables shared by the DSP modules.
+  ******************************************************************************
+  * @attention
+  *
+  * Generated for DSP_TABLE_SIZE = 4096 points, do not edit by hand:
+  *
+  *   TBL_SineQ31[i]   = round(2^31 sin(2 pi i / 4096)),    i = 0..1024
+  *   TBL_<window>[n]  = round(2^15 w(n)),                   n = 0..2048
+  *
+  * The windows are the first half (plus the centre point) of the periodic
+  * 4096 point windows w(n) = a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N) - ...
+  * with the coefficients listed in dsp_window.c. Values are clipped to the
+  * q31/q15 range.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dsp_tables.h"
+
+/* Exported variables --------------------------------------------------------*/
+const int32_t TBL_SineQ31[(DSP_TABLE_SIZE / 4U) + 1U] =
+{
+            0,     3294197,     6588387,     9882561,    13176712,    16470832,    19764913,    23058947,
+     26352928,    29646846,    32940695,    36234466,    39528151,    42821744,    46115236,    49408620,
+     52701887,    55995030,    59288042,    62580914,    65873638,    69166208,    72458615,    75750851,
+     79042909,    82334782,    85626460,    88917937,    92209205,    95500255,    98791081,   102081675,
+    105372028,   108662134,   111951983,   115241570,   118530885,   121819921,   125108670,   128397125,
+    131685278,   134973122,   138260647,   141547847,   144834714,   148121241,   151407418,   154693240,
+    157978697,   161263783,   164548489,   167832808,   171116733,   174400254,   177683365,   180966058,
+    184248325,   187530159,   190811551,   194092495,   197372981,   200653003,   203932553,   207211624,
+    210490206,   213768293,   217045878,   220322951,   223599506,   226875535,   230151030,   233425984,
+    236700388,   239974235,   243247518,   246520228,   249792358,   253063900,   256334847,   259605191,
+    262874923,   266144038,   269412525,   272680379,   275947592,   279214155,   282480061,   285745302,
+    289009871,   292273760,   295536961,   298799466,   302061269,   305322361,   308582734,   311842381,
+    315101295,   318359466,   321616889,   324873555,   328129457,   331384586,   334638936,   337892498,
+    341145265,   344397230,   347648383,   350898719,   354148230,   357396906,   360644742,   363891730,
+    367137861,   370383128,   373627523,   376871039,   380113669,   383355404,   386596237,   389836160,
+    393075166,   396313247,   399550396,   402786604,   406021865,   409256170,   412489512,   415721883,
+    418953276,   422183684,   425413098,   428641511,   431868915,   435095303,   438320667,   441545000,
+    444768294,   447990541,   451211734,   454431865,   457650927,   460868912,   464085813,   467301622,
+    470516330,   473729932,   476942419,   480153784,   483364019,   486573117,   489781069,   492987869,
+    496193509,   499397982,   502601279,   505803394,   509004318,   512204045,   515402566,   518599875,
+    521795963,   524990824,   528184449,   531376831,   534567963,   537757837,   540946445,   544133781,
+    547319836,   550504604,   553688076,   556870245,   560051104,   563230645,   566408860,   569585743,
+    572761285,   575935480,   579108320,   582279796,   585449903,   588618632,   591785976,   594951927,
+    598116479,   601279623,   604441352,   607601658,   610760536,   613917975,   617073971,   620228514,
+    623381598,   626533215,   629683357,   632832018,   635979190,   639124865,   642269036,   645411696,
+    648552838,   651692453,   654830535,   657967075,   661102068,   664235505,   667367379,   670497682,
+    673626408,   676753549,   679879097,   683003045,   686125387,   689246113,   692365218,   695482694,
+    698598533,   701712728,   704825272,   707936158,   711045377,   714152924,   717258790,   720362968,
+    723465451,   726566232,   729665303,   732762657,   735858287,   738952186,   742044345,   745134758,
+    748223418,   751310318,   754395449,   757478806,   760560380,   763640164,   766718151,   769794334,
+    772868706,   775941259,   779011986,   782080880,   785147934,   788213141,   791276492,   794337982,
+    797397602,   800455346,   803511207,   806565177,   809617249,   812667415,   815715670,   818762005,
+    821806413,   824848888,   827889422,   830928007,   833964638,   836999305,   840032004,   843062726,
+    846091463,   849118210,   852142959,   855165703,   858186435,   861205147,   864221832,   867236484,
+    870249095,   873259659,   876268167,   879274614,   882278992,   885281293,   888281512,   891279640,
+    894275671,   897269597,   900261413,   903251110,   906238681,   909224120,   912207419,   915188572,
+    918167572,   921144411,   924119082,   927091579,   930061894,   933030021,   935995952,   938959681,
+    941921200,   944880503,   947837582,   950792431,   953745043,   956695411,   959643527,   962589385,
+    965532978,   968474300,   971413342,   974350098,   977284562,   980216726,   983146583,   986074127,
+    988999351,   991922248,   994842810,   997761031,  1000676905,  1003590424,  1006501581,  1009410370,
+   1012316784,  1015220816,  1018122458,  1021021705,  1023918550,  1026812985,  1029705004,  1032594600,
+   1035481766,  1038366495,  1041248781,  1044128617,  1047005996,  1049880912,  1052753357,  1055623324,
+   1058490808,  1061355801,  1064218296,  1067078288,  1069935768,  1072790730,  1075643169,  1078493076,
+   1081340445,  1084185270,  1087027544,  1089867259,  1092704411,  1095538991,  1098370993,  1101200410,
+   1104027237,  1106851465,  1109673089,  1112492101,  1115308496,  1118122267,  1120933406,  1123741908,
+   1126547765,  1129350972,  1132151521,  1134949406,  1137744621,  1140537158,  1143327011,  1146114174,
+   1148898640,  1151680403,  1154459456,  1157235792,  1160009405,  1162780288,  1165548435,  1168313840,
+   1171076495,  1173836395,  1176593533,  1179347902,  1182099496,  1184848308,  1187594332,  1190337562,
+   1193077991,  1195815612,  1198550419,  1201282407,  1204011567,  1206737894,  1209461382,  1212182024,
+   1214899813,  1217614743,  1220326809,  1223036002,  1225742318,  1228445750,  1231146291,  1233843935,
+   1236538675,  1239230506,  1241919421,  1244605414,  1247288478,  1249968606,  1252645794,  1255320034,
+   1257991320,  1260659646,  1263325005,  1265987392,  1268646800,  1271303222,  1273956653,  1276607086,
+   1279254516,  1281898935,  1284540337,  1287178717,  1289814068,  1292446384,  1295075659,  1297701886,
+   1300325060,  1302945174,  1305562222,  1308176198,  1310787095,  1313394909,  1315999631,  1318601257,
+   1321199781,  1323795195,  1326387494,  1328976672,  1331562723,  1334145641,  1336725419,  1339302052,
+   1341875533,  1344445857,  1347013017,  1349577007,  1352137822,  1354695455,  1357249901,  1359801152,
+   1362349204,  1364894050,  1367435685,  1369974101,  1372509294,  1375041258,  1377569986,  1380095472,
+   1382617710,  1385136696,  1387652422,  1390164882,  1392674072,  1395179984,  1397682613,  1400181954,
+   1402678000,  1405170745,  1407660183,  1410146309,  1412629117,  1415108601,  1417584755,  1420057574,
+   1422527051,  1424993180,  1427455956,  1429915374,  1432371426,  1434824109,  1437273414,  1439719338,
+   1442161874,  1444601017,  1447036760,  1449469098,  1451898025,  1454323536,  1456745625,  1459164286,
+   1461579514,  1463991302,  1466399645,  1468804538,  1471205974,  1473603949,  1475998456,  1478389489,
+   1480777044,  1483161115,  1485541696,  1487918781,  1490292364,  1492662441,  1495029006,  1497392053,
+   1499751576,  1502107570,  1504460029,  1506808949,  1509154322,  1511496145,  1513834411,  1516169114,
+   1518500250,  1520827813,  1523151797,  1525472197,  1527789007,  1530102222,  1532411837,  1534717846,
+   1537020244,  1539319024,  1541614183,  1543905714,  1546193612,  1548477872,  1550758488,  1553035455,
+   1555308768,  1557578421,  1559844408,  1562106725,  1564365367,  1566620327,  1568871601,  1571119183,
+   1573363068,  1575603251,  1577839726,  1580072489,  1582301533,  1584526854,  1586748447,  1588966306,
+   1591180426,  1593390801,  1595597428,  1597800299,  1599999411,  1602194758,  1604386335,  1606574136,
+   1608758157,  1610938393,  1613114838,  1615287487,  1617456335,  1619621377,  1621782608,  1623940023,
+   1626093616,  1628243383,  1630389319,  1632531418,  1634669676,  1636804087,  1638934646,  1641061349,
+   1643184191,  1645303166,  1647418269,  1649529496,  1651636841,  1653740300,  1655839867,  1657935539,
+   1660027308,  1662115172,  1664199124,  1666279161,  1668355276,  1670427466,  1672495725,  1674560049,
+   1676620432,  1678676870,  1680729357,  1682777890,  1684822463,  1686863072,  1688899711,  1690932376,
+   1692961062,  1694985765,  1697006479,  1699023199,  1701035922,  1703044642,  1705049355,  1707050055,
+   1709046739,  1711039401,  1713028037,  1715012642,  1716993211,  1718969740,  1720942225,  1722910659,
+   1724875040,  1726835361,  1728791620,  1730743810,  1732691928,  1734635968,  1736575927,  1738511799,
+   1740443581,  1742371267,  1744294853,  1746214334,  1748129707,  1750040966,  1751948107,  1753851126,
+   1755750017,  1757644777,  1759535401,  1761421885,  1763304224,  1765182414,  1767056450,  1768926328,
+   1770792044,  1772653593,  1774510970,  1776364172,  1778213194,  1780058032,  1781898681,  1783735137,
+   1785567396,  1787395453,  1789219305,  1791038946,  1792854372,  1794665580,  1796472565,  1798275323,
+   1800073849,  1801868139,  1803658189,  1805443995,  1807225553,  1809002858,  1810775906,  1812544694,
+   1814309216,  1816069469,  1817825449,  1819577151,  1821324572,  1823067707,  1824806552,  1826541103,
+   1828271356,  1829997307,  1831718951,  1833436286,  1835149306,  1836858008,  1838562388,  1840262441,
+   1841958164,  1843649553,  1845336604,  1847019312,  1848697674,  1850371686,  1852041343,  1853706643,
+   1855367581,  1857024153,  1858676355,  1860324183,  1861967634,  1863606704,  1865241388,  1866871683,
+   1868497586,  1870119091,  1871736196,  1873348897,  1874957189,  1876561070,  1878160535,  1879755580,
+   1881346202,  1882932397,  1884514161,  1886091491,  1887664383,  1889232832,  1890796837,  1892356392,
+   1893911494,  1895462140,  1897008325,  1898550047,  1900087301,  1901620084,  1903148392,  1904672222,
+   1906191570,  1907706433,  1909216806,  1910722688,  1912224073,  1913720958,  1915213340,  1916701216,
+   1918184581,  1919663432,  1921137767,  1922607581,  1924072871,  1925533633,  1926989864,  1928441561,
+   1929888720,  1931331338,  1932769411,  1934202936,  1935631910,  1937056329,  1938476190,  1939891490,
+   1941302225,  1942708392,  1944109987,  1945507008,  1946899451,  1948287312,  1949670589,  1951049279,
+   1952423377,  1953792881,  1955157788,  1956518093,  1957873796,  1959224890,  1960571375,  1961913246,
+   1963250501,  1964583136,  1965911148,  1967234535,  1968553292,  1969867417,  1971176906,  1972481757,
+   1973781967,  1975077532,  1976368450,  1977654717,  1978936331,  1980213288,  1981485585,  1982753220,
+   1984016189,  1985274489,  1986528118,  1987777073,  1989021350,  1990260946,  1991495860,  1992726087,
+   1993951625,  1995172471,  1996388622,  1997600076,  1998806829,  2000008879,  2001206222,  2002398857,
+   2003586779,  2004769987,  2005948478,  2007122248,  2008291295,  2009455617,  2010615210,  2011770073,
+   2012920201,  2014065592,  2015206245,  2016342155,  2017473321,  2018599739,  2019721407,  2020838323,
+   2021950484,  2023057887,  2024160529,  2025258408,  2026351522,  2027439867,  2028523442,  2029602243,
+   2030676269,  2031745516,  2032809982,  2033869665,  2034924562,  2035974670,  2037019988,  2038060512,
+   2039096241,  2040127172,  2041153301,  2042174628,  2043191150,  2044202863,  2045209767,  2046211857,
+   2047209133,  2048201592,  2049189231,  2050172048,  2051150040,  2052123207,  2053091544,  2054055050,
+   2055013723,  2055967560,  2056916560,  2057860719,  2058800036,  2059734508,  2060664133,  2061588910,
+   2062508835,  2063423908,  2064334124,  2065239484,  2066139983,  2067035621,  2067926394,  2068812302,
+   2069693342,  2070569511,  2071440808,  2072307231,  2073168777,  2074025446,  2074877233,  2075724139,
+   2076566160,  2077403294,  2078235540,  2079062896,  2079885360,  2080702930,  2081515603,  2082323379,
+   2083126254,  2083924228,  2084717298,  2085505463,  2086288720,  2087067068,  2087840505,  2088609029,
+   2089372638,  2090131331,  2090885105,  2091633960,  2092377892,  2093116901,  2093850985,  2094580142,
+   2095304370,  2096023667,  2096738032,  2097447464,  2098151960,  2098851519,  2099546139,  2100235819,
+   2100920556,  2101600350,  2102275199,  2102945101,  2103610054,  2104270057,  2104925109,  2105575208,
+   2106220352,  2106860540,  2107495770,  2108126041,  2108751352,  2109371700,  2109987085,  2110597505,
+   2111202959,  2111803444,  2112398960,  2112989506,  2113575080,  2114155680,  2114731305,  2115301954,
+   2115867626,  2116428319,  2116984031,  2117534762,  2118080511,  2118621275,  2119157054,  2119687847,
+   2120213651,  2120734467,  2121250292,  2121761126,  2122266967,  2122767814,  2123263666,  2123754522,
+   2124240380,  2124721240,  2125197100,  2125667960,  2126133817,  2126594672,  2127050522,  2127501367,
+   2127947206,  2128388038,  2128823862,  2129254676,  2129680480,  2130101272,  2130517052,  2130927819,
+   2131333572,  2131734309,  2132130030,  2132520734,  2132906420,  2133287087,  2133662734,  2134033361,
+   2134398966,  2134759548,  2135115107,  2135465642,  2135811153,  2136151637,  2136487095,  2136817525,
+   2137142927,  2137463301,  2137778644,  2138088958,  2138394240,  2138694490,  2138989708,  2139279892,
+   2139565043,  2139845159,  2140120240,  2140390284,  2140655293,  2140915264,  2141170197,  2141420092,
+   2141664948,  2141904764,  2142139541,  2142369276,  2142593971,  2142813624,  2143028234,  2143237802,
+   2143442326,  2143641807,  2143836244,  2144025635,  2144209982,  2144389283,  2144563539,  2144732748,
+   2144896910,  2145056025,  2145210092,  2145359112,  2145503083,  2145642006,  2145775880,  2145904705,
+   2146028480,  2146147205,  2146260881,  2146369505,  2146473080,  2146571603,  2146665076,  2146753497,
+   2146836866,  2146915184,  2146988450,  2147056664,  2147119825,  2147177934,  2147230991,  2147278995,
+   2147321946,  2147359845,  2147392690,  2147420483,  2147443222,  2147460908,  2147473542,  2147481121,
+   2147483647,
+};
+
+const int16_t TBL_HannQ15[(DSP_TABLE_SIZE / 2U) + 1U] =
+{
+       0,      0,      0,      0,      0,      0,      1,      1,      1,      2,      2,      2,
+       3,      3,      4,      4,      5,      6,      6,      7,      8,      9,      9,     10,
+      11,     12,     13,     14,     15,     16,     17,     19,     20,     21,     22,     24,
+      25,     26,     28,     29,     31,     32,     34,     36,     37,     39,     41,     43,
+      44,     46,     48,     50,     52,     54,     56,     58,     60,     63,     65,     67,
+      69,     72,     74,     76,     79,     81,     84,     86,     89,     92,     94,     97,
+     100,    103,    105,    108,    111,    114,    117,    120,    123,    126,    129,    133,
+     136,    139,    142,    146,    149,    152,    156,    159,    163,    166,    170,    174,
+     177,    181,    185,    189,    192,    196,    200,    204,    208,    212,    216,    220,
+     224,    228,    233,    237,    241,    246,    250,    254,    259,    263,    268,    272,
+     277,    281,    286,    291,    296,    300,    305,    310,    315,    320,    325,    330,
+     335,    340,    345,    350,    355,    360,    366,    371,    376,    382,    387,    393,
+     398,    404,    409,    415,    420,    426,    432,    438,    443,    449,    455,    461,
+     467,    473,    479,    485,    491,    497,    503,    509,    516,    522,    528,    535,
+     541,    547,    554,    560,    567,    574,    580,    587,    593,    600,    607,    614,
+     621,    627,    634,    641,    648,    655,    662,    669,    677,    684,    691,    698,
+     705,    713,    720,    728,    735,    742,    750,    757,    765,    773,    780,    788,
+     796,    803,    811,    819,    827,    835,    843,    851,    859,    867,    875,    883,
+     891,    899,    908,    916,    924,    933,    941,    949,    958,    966,    975,    983,
+     992,   1001,   1009,   1018,   1027,   1035,   1044,   1053,   1062,   1071,   1080,   1089,
+    1098,   1107,   1116,   1125,   1134,   1144,   1153,   1162,   1171,   1181,   1190,   1200,
+    1209,   1218,   1228,   1238,   1247,   1257,   1266,   1276,   1286,   1296,   1306,   1315,
+    1325,   1335,   1345,   1355,   1365,   1375,   1385,   1395,   1406,   1416,   1426,   1436,
+    1447,   1457,   1467,   1478,   1488,   1499,   1509,   1520,   1530,   1541,   1552,   1562,
+    1573,   1584,   1595,   1605,   1616,   1627,   1638,   1649,   1660,   1671,   1682,   1693,
+    1704,   1716,   1727,   1738,   1749,   1761,   1772,   1783,   1795,   1806,   1818,   1829,
+    1841,   1853,   1864,   1876,   1887,   1899,   1911,   1923,   1935,   1946,   1958,   1970,
+    1982,   1994,   2006,   2018,   2030,   2043,   2055,   2067,   2079,   2091,   2104,   2116,
+    2128,   2141,   2153,   2166,   2178,   2191,   2203,   2216,   2229,   2241,   2254,   2267,
+    2280,   2292,   2305,   2318,   2331,   2344,   2357,   2370,   2383,   2396,   2409,   2422,
+    2435,   2449,   2462,   2475,   2488,   2502,   2515,   2528,   2542,   2555,   2569,   2582,
+    2596,   2610,   2623,   2637,   2651,   2664,   2678,   2692,   2706,   2719,   2733,   2747,
+    2761,   2775,   2789,   2803,   2817,   2831,   2846,   2860,   2874,   2888,   2902,   2917,
+    2931,   2945,   2960,   2974,   2989,   3003,   3018,   3032,   3047,   3061,   3076,   3091,
+    3105,   3120,   3135,   3150,   3165,   3179,   3194,   3209,   3224,   3239,   3254,   3269,
+    3284,   3299,   3315,   3330,   3345,   3360,   3376,   3391,   3406,   3421,   3437,   3452,
+    3468,   3483,   3499,   3514,   3530,   3545,   3561,   3577,   3592,   3608,   3624,   3640,
+    3655,   3671,   3687,   3703,   3719,   3735,   3751,   3767,   3783,   3799,   3815,   3831,
+    3847,   3864,   3880,   3896,   3912,   3929,   3945,   3961,   3978,   3994,   4011,   4027,
+    4044,   4060,   4077,   4094,   4110,   4127,   4144,   4160,   4177,   4194,   4211,   4227,
+    4244,   4261,   4278,   4295,   4312,   4329,   4346,   4363,   4380,   4397,   4414,   4432,
+    4449,   4466,   4483,   4501,   4518,   4535,   4553,   4570,   4587,   4605,   4622,   4640,
+    4657,   4675,   4693,   4710,   4728,   4746,   4763,   4781,   4799,   4817,   4834,   4852,
+    4870,   4888,   4906,   4924,   4942,   4960,   4978,   4996,   5014,   5032,   5050,   5068,
+    5087,   5105,   5123,   5141,   5160,   5178,   5196,   5215,   5233,   5251,   5270,   5288,
+    5307,   5325,   5344,   5363,   5381,   5400,   5418,   5437,   5456,   5475,   5493,   5512,
+    5531,   5550,   5569,   5588,   5606,   5625,   5644,   5663,   5682,   5701,   5721,   5740,
+    5759,   5778,   5797,   5816,   5835,   5855,   5874,   5893,   5913,   5932,   5951,   5971,
+    5990,   6010,   6029,   6048,   6068,   6088,   6107,   6127,   6146,   6166,   6186,   6205,
+    6225,   6245,   6264,   6284,   6304,   6324,   6344,   6364,   6383,   6403,   6423,   6443,
+    6463,   6483,   6503,   6523,   6543,   6564,   6584,   6604,   6624,   6644,   6664,   6685,
+    6705,   6725,   6746,   6766,   6786,   6807,   6827,   6847,   6868,   6888,   6909,   6929,
+    6950,   6971,   6991,   7012,   7032,   7053,   7074,   7094,   7115,   7136,   7157,   7177,
+    7198,   7219,   7240,   7261,   7282,   7302,   7323,   7344,   7365,   7386,   7407,   7428,
+    7449,   7470,   7492,   7513,   7534,   7555,   7576,   7597,   7619,   7640,   7661,   7682,
+    7704,   7725,   7746,   7768,   7789,   7811,   7832,   7853,   7875,   7896,   7918,   7939,
+    7961,   7983,   8004,   8026,   8047,   8069,   8091,   8112,   8134,   8156,   8177,   8199,
+    8221,   8243,   8265,   8286,   8308,   8330,   8352,   8374,   8396,   8418,   8440,   8462,
+    8484,   8506,   8528,   8550,   8572,   8594,   8616,   8638,   8661,   8683,   8705,   8727,
+    8749,   8772,   8794,   8816,   8839,   8861,   8883,   8906,   8928,   8950,   8973,   8995,
+    9018,   9040,   9063,   9085,   9108,   9130,   9153,   9175,   9198,   9220,   9243,   9266,
+    9288,   9311,   9334,   9356,   9379,   9402,   9424,   9447,   9470,   9493,   9516,   9538,
+    9561,   9584,   9607,   9630,   9653,   9676,   9699,   9722,   9745,   9768,   9791,   9814,
+    9837,   9860,   9883,   9906,   9929,   9952,   9975,   9998,  10021,  10045,  10068,  10091,
+   10114,  10137,  10161,  10184,  10207,  10230,  10254,  10277,  10300,  10324,  10347,  10370,
+   10394,  10417,  10441,  10464,  10487,  10511,  10534,  10558,  10581,  10605,  10628,  10652,
+   10676,  10699,  10723,  10746,  10770,  10793,  10817,  10841,  10864,  10888,  10912,  10935,
+   10959,  10983,  11007,  11030,  11054,  11078,  11102,  11125,  11149,  11173,  11197,  11221,
+   11245,  11269,  11292,  11316,  11340,  11364,  11388,  11412,  11436,  11460,  11484,  11508,
+   11532,  11556,  11580,  11604,  11628,  11652,  11676,  11700,  11724,  11748,  11772,  11797,
+   11821,  11845,  11869,  11893,  11917,  11942,  11966,  11990,  12014,  12038,  12063,  12087,
+   12111,  12135,  12160,  12184,  12208,  12233,  12257,  12281,  12306,  12330,  12354,  12379,
+   12403,  12427,  12452,  12476,  12501,  12525,  12549,  12574,  12598,  12623,  12647,  12672,
+   12696,  12721,  12745,  12770,  12794,  12819,  12843,  12868,  12892,  12917,  12942,  12966,
+   12991,  13015,  13040,  13064,  13089,  13114,  13138,  13163,  13188,  13212,  13237,  13262,
+   13286,  13311,  13336,  13360,  13385,  13410,  13435,  13459,  13484,  13509,  13533,  13558,
+   13583,  13608,  13632,  13657,  13682,  13707,  13732,  13756,  13781,  13806,  13831,  13856,
+   13881,  13905,  13930,  13955,  13980,  14005,  14030,  14055,  14079,  14104,  14129,  14154,
+   14179,  14204,  14229,  14254,  14279,  14304,  14329,  14353,  14378,  14403,  14428,  14453,
+   14478,  14503,  14528,  14553,  14578,  14603,  14628,  14653,  14678,  14703,  14728,  14753,
+   14778,  14803,  14828,  14853,  14878,  14903,  14928,  14953,  14978,  15003,  15028,  15053,
+   15078,  15104,  15129,  15154,  15179,  15204,  15229,  15254,  15279,  15304,  15329,  15354,
+   15379,  15404,  15429,  15455,  15480,  15505,  15530,  15555,  15580,  15605,  15630,  15655,
+   15680,  15706,  15731,  15756,  15781,  15806,  15831,  15856,  15881,  15907,  15932,  15957,
+   15982,  16007,  16032,  16057,  16082,  16108,  16133,  16158,  16183,  16208,  16233,  16258,
+   16283,  16309,  16334,  16359,  16384,  16409,  16434,  16459,  16485,  16510,  16535,  16560,
+   16585,  16610,  16635,  16660,  16686,  16711,  16736,  16761,  16786,  16811,  16836,  16861,
+   16887,  16912,  16937,  16962,  16987,  17012,  17037,  17062,  17088,  17113,  17138,  17163,
+   17188,  17213,  17238,  17263,  17288,  17313,  17339,  17364,  17389,  17414,  17439,  17464,
+   17489,  17514,  17539,  17564,  17589,  17614,  17639,  17664,  17690,  17715,  17740,  17765,
+   17790,  17815,  17840,  17865,  17890,  17915,  17940,  17965,  17990,  18015,  18040,  18065,
+   18090,  18115,  18140,  18165,  18190,  18215,  18240,  18265,  18290,  18315,  18340,  18365,
+   18390,  18415,  18439,  18464,  18489,  18514,  18539,  18564,  18589,  18614,  18639,  18664,
+   18689,  18713,  18738,  18763,  18788,  18813,  18838,  18863,  18887,  18912,  18937,  18962,
+   18987,  19012,  19036,  19061,  19086,  19111,  19136,  19160,  19185,  19210,  19235,  19259,
+   19284,  19309,  19333,  19358,  19383,  19408,  19432,  19457,  19482,  19506,  19531,  19556,
+   19580,  19605,  19630,  19654,  19679,  19704,  19728,  19753,  19777,  19802,  19826,  19851,
+   19876,  19900,  19925,  19949,  19974,  19998,  20023,  20047,  20072,  20096,  20121,  20145,
+   20170,  20194,  20219,  20243,  20267,  20292,  20316,  20341,  20365,  20389,  20414,  20438,
+   20462,  20487,  20511,  20535,  20560,  20584,  20608,  20633,  20657,  20681,  20705,  20730,
+   20754,  20778,  20802,  20826,  20851,  20875,  20899,  20923,  20947,  20971,  20996,  21020,
+   21044,  21068,  21092,  21116,  21140,  21164,  21188,  21212,  21236,  21260,  21284,  21308,
+   21332,  21356,  21380,  21404,  21428,  21452,  21476,  21499,  21523,  21547,  21571,  21595,
+   21619,  21643,  21666,  21690,  21714,  21738,  21761,  21785,  21809,  21833,  21856,  21880,
+   21904,  21927,  21951,  21975,  21998,  22022,  22045,  22069,  22092,  22116,  22140,  22163,
+   22187,  22210,  22234,  22257,  22281,  22304,  22327,  22351,  22374,  22398,  22421,  22444,
+   22468,  22491,  22514,  22538,  22561,  22584,  22607,  22631,  22654,  22677,  22700,  22723,
+   22747,  22770,  22793,  22816,  22839,  22862,  22885,  22908,  22931,  22954,  22977,  23000,
+   23023,  23046,  23069,  23092,  23115,  23138,  23161,  23184,  23207,  23230,  23252,  23275,
+   23298,  23321,  23344,  23366,  23389,  23412,  23434,  23457,  23480,  23502,  23525,  23548,
+   23570,  23593,  23615,  23638,  23660,  23683,  23705,  23728,  23750,  23773,  23795,  23818,
+   23840,  23862,  23885,  23907,  23929,  23952,  23974,  23996,  24019,  24041,  24063,  24085,
+   24107,  24130,  24152,  24174,  24196,  24218,  24240,  24262,  24284,  24306,  24328,  24350,
+   24372,  24394,  24416,  24438,  24460,  24482,  24503,  24525,  24547,  24569,  24591,  24612,
+   24634,  24656,  24677,  24699,  24721,  24742,  24764,  24785,  24807,  24829,  24850,  24872,
+   24893,  24915,  24936,  24957,  24979,  25000,  25022,  25043,  25064,  25086,  25107,  25128,
+   25149,  25171,  25192,  25213,  25234,  25255,  25276,  25298,  25319,  25340,  25361,  25382,
+   25403,  25424,  25445,  25466,  25486,  25507,  25528,  25549,  25570,  25591,  25611,  25632,
+   25653,  25674,  25694,  25715,  25736,  25756,  25777,  25797,  25818,  25839,  25859,  25880,
+   25900,  25921,  25941,  25961,  25982,  26002,  26022,  26043,  26063,  26083,  26104,  26124,
+   26144,  26164,  26184,  26204,  26225,  26245,  26265,  26285,  26305,  26325,  26345,  26365,
+   26385,  26404,  26424,  26444,  26464,  26484,  26504,  26523,  26543,  26563,  26582,  26602,
+   26622,  26641,  26661,  26680,  26700,  26720,  26739,  26758,  26778,  26797,  26817,  26836,
+   26855,  26875,  26894,  26913,  26933,  26952,  26971,  26990,  27009,  27028,  27047,  27067,
+   27086,  27105,  27124,  27143,  27162,  27180,  27199,  27218,  27237,  27256,  27275,  27293,
+   27312,  27331,  27350,  27368,  27387,  27405,  27424,  27443,  27461,  27480,  27498,  27517,
+   27535,  27553,  27572,  27590,  27608,  27627,  27645,  27663,  27681,  27700,  27718,  27736,
+   27754,  27772,  27790,  27808,  27826,  27844,  27862,  27880,  27898,  27916,  27934,  27951,
+   27969,  27987,  28005,  28022,  28040,  28058,  28075,  28093,  28111,  28128,  28146,  28163,
+   28181,  28198,  28215,  28233,  28250,  28267,  28285,  28302,  28319,  28336,  28354,  28371,
+   28388,  28405,  28422,  28439,  28456,  28473,  28490,  28507,  28524,  28541,  28557,  28574,
+   28591,  28608,  28624,  28641,  28658,  28674,  28691,  28708,  28724,  28741,  28757,  28774,
+   28790,  28807,  28823,  28839,  28856,  28872,  28888,  28904,  28921,  28937,  28953,  28969,
+   28985,  29001,  29017,  29033,  29049,  29065,  29081,  29097,  29113,  29128,  29144,  29160,
+   29176,  29191,  29207,  29223,  29238,  29254,  29269,  29285,  29300,  29316,  29331,  29347,
+   29362,  29377,  29392,  29408,  29423,  29438,  29453,  29469,  29484,  29499,  29514,  29529,
+   29544,  29559,  29574,  29589,  29603,  29618,  29633,  29648,  29663,  29677,  29692,  29707,
+   29721,  29736,  29750,  29765,  29779,  29794,  29808,  29823,  29837,  29851,  29866,  29880,
+   29894,  29908,  29922,  29937,  29951,  29965,  29979,  29993,  30007,  30021,  30035,  30049,
+   30062,  30076,  30090,  30104,  30117,  30131,  30145,  30158,  30172,  30186,  30199,  30213,
+   30226,  30240,  30253,  30266,  30280,  30293,  30306,  30319,  30333,  30346,  30359,  30372,
+   30385,  30398,  30411,  30424,  30437,  30450,  30463,  30476,  30488,  30501,  30514,  30527,
+   30539,  30552,  30565,  30577,  30590,  30602,  30615,  30627,  30640,  30652,  30664,  30677,
+   30689,  30701,  30713,  30725,  30738,  30750,  30762,  30774,  30786,  30798,  30810,  30822,
+   30833,  30845,  30857,  30869,  30881,  30892,  30904,  30915,  30927,  30939,  30950,  30962,
+   30973,  30985,  30996,  31007,  31019,  31030,  31041,  31052,  31064,  31075,  31086,  31097,
+   31108,  31119,  31130,  31141,  31152,  31163,  31173,  31184,  31195,  31206,  31216,  31227,
+   31238,  31248,  31259,  31269,  31280,  31290,  31301,  31311,  31321,  31332,  31342,  31352,
+   31362,  31373,  31383,  31393,  31403,  31413,  31423,  31433,  31443,  31453,  31462,  31472,
+   31482,  31492,  31502,  31511,  31521,  31530,  31540,  31550,  31559,  31568,  31578,  31587,
+   31597,  31606,  31615,  31624,  31634,  31643,  31652,  31661,  31670,  31679,  31688,  31697,
+   31706,  31715,  31724,  31733,  31741,  31750,  31759,  31767,  31776,  31785,  31793,  31802,
+   31810,  31819,  31827,  31835,  31844,  31852,  31860,  31869,  31877,  31885,  31893,  31901,
+   31909,  31917,  31925,  31933,  31941,  31949,  31957,  31965,  31972,  31980,  31988,  31995,
+   32003,  32011,  32018,  32026,  32033,  32040,  32048,  32055,  32063,  32070,  32077,  32084,
+   32091,  32099,  32106,  32113,  32120,  32127,  32134,  32141,  32147,  32154,  32161,  32168,
+   32175,  32181,  32188,  32194,  32201,  32208,  32214,  32221,  32227,  32233,  32240,  32246,
+   32252,  32259,  32265,  32271,  32277,  32283,  32289,  32295,  32301,  32307,  32313,  32319,
+   32325,  32330,  32336,  32342,  32348,  32353,  32359,  32364,  32370,  32375,  32381,  32386,
+   32392,  32397,  32402,  32408,  32413,  32418,  32423,  32428,  32433,  32438,  32443,  32448,
+   32453,  32458,  32463,  32468,  32472,  32477,  32482,  32487,  32491,  32496,  32500,  32505,
+   32509,  32514,  32518,  32522,  32527,  32531,  32535,  32540,  32544,  32548,  32552,  32556,
+   32560,  32564,  32568,  32572,  32576,  32579,  32583,  32587,  32591,  32594,  32598,  32602,
+   32605,  32609,  32612,  32616,  32619,  32622,  32626,  32629,  32632,  32635,  32639,  32642,
+   32645,  32648,  32651,  32654,  32657,  32660,  32663,  32665,  32668,  32671,  32674,  32676,
+   32679,  32682,  32684,  32687,  32689,  32692,  32694,  32696,  32699,  32701,  32703,  32705,
+   32708,  32710,  32712,  32714,  32716,  32718,  32720,  32722,  32724,  32725,  32727,  32729,
+   32731,  32732,  32734,  32736,  32737,  32739,  32740,  32742,  32743,  32744,  32746,  32747,
+   32748,  32749,  32751,  32752,  32753,  32754,  32755,  32756,  32757,  32758,  32759,  32759,
+   32760,  32761,  32762,  32762,  32763,  32764,  32764,  32765,  32765,  32766,  32766,  32766,
+   32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+};
+
+const int16_t TBL_BlackmanHarrisQ15[(DSP_TABLE_SIZE / 2U) + 1U] =
+{
+       2,      2,      2,      2,      2,      2,      2,      2,      2,      2,      2,      2,
+       2,      2,      2,      2,      2,      2,      2,      2,      2,      2,      2,      3,
+       3,      3,      3,      3,      3,      3,      3,      3,      3,      3,      3,      3,
+       3,      3,      4,      4,      4,      4,      4,      4,      4,      4,      4,      4,
+       5,      5,      5,      5,      5,      5,      5,      5,      5,      6,      6,      6,
+       6,      6,      6,      6,      7,      7,      7,      7,      7,      7,      7,      8,
+       8,      8,      8,      8,      8,      9,      9,      9,      9,      9,     10,     10,
+      10,     10,     10,     11,     11,     11,     11,     11,     12,     12,     12,     12,
+      13,     13,     13,     13,     13,     14,     14,     14,     14,     15,     15,     15,
+      16,     16,     16,     16,     17,     17,     17,     17,     18,     18,     18,     19,
+      19,     19,     20,     20,     20,     21,     21,     21,     22,     22,     22,     23,
+      23,     23,     24,     24,     24,     25,     25,     25,     26,     26,     26,     27,
+      27,     28,     28,     28,     29,     29,     30,     30,     30,     31,     31,     32,
+      32,     33,     33,     34,     34,     34,     35,     35,     36,     36,     37,     37,
+      38,     38,     39,     39,     40,     40,     41,     41,     42,     42,     43,     43,
+      44,     44,     45,     45,     46,     47,     47,     48,     48,     49,     49,     50,
+      51,     51,     52,     52,     53,     54,     54,     55,     56,     56,     57,     58,
+      58,     59,     59,     60,     61,     62,     62,     63,     64,     64,     65,     66,
+      66,     67,     68,     69,     69,     70,     71,     72,     72,     73,     74,     75,
+      76,     76,     77,     78,     79,     80,     80,     81,     82,     83,     84,     85,
+      85,     86,     87,     88,     89,     90,     91,     92,     93,     94,     95,     95,
+      96,     97,     98,     99,    100,    101,    102,    103,    104,    105,    106,    107,
+     108,    109,    110,    111,    112,    114,    115,    116,    117,    118,    119,    120,
+     121,    122,    124,    125,    126,    127,    128,    129,    131,    132,    133,    134,
+     135,    137,    138,    139,    140,    142,    143,    144,    145,    147,    148,    149,
+     151,    152,    153,    155,    156,    157,    159,    160,    162,    163,    164,    166,
+     167,    169,    170,    172,    173,    175,    176,    177,    179,    181,    182,    184,
+     185,    187,    188,    190,    191,    193,    195,    196,    198,    200,    201,    203,
+     205,    206,    208,    210,    211,    213,    215,    217,    218,    220,    222,    224,
+     225,    227,    229,    231,    233,    235,    236,    238,    240,    242,    244,    246,
+     248,    250,    252,    254,    256,    258,    260,    262,    264,    266,    268,    270,
+     272,    274,    276,    278,    281,    283,    285,    287,    289,    291,    294,    296,
+     298,    300,    303,    305,    307,    309,    312,    314,    316,    319,    321,    324,
+     326,    328,    331,    333,    336,    338,    341,    343,    346,    348,    351,    353,
+     356,    358,    361,    364,    366,    369,    371,    374,    377,    379,    382,    385,
+     388,    390,    393,    396,    399,    402,    404,    407,    410,    413,    416,    419,
+     422,    425,    428,    431,    434,    437,    440,    443,    446,    449,    452,    455,
+     458,    461,    464,    468,    471,    474,    477,    480,    484,    487,    490,    493,
+     497,    500,    504,    507,    510,    514,    517,    521,    524,    527,    531,    534,
+     538,    542,    545,    549,    552,    556,    560,    563,    567,    571,    574,    578,
+     582,    586,    589,    593,    597,    601,    605,    609,    613,    616,    620,    624,
+     628,    632,    636,    640,    645,    649,    653,    657,    661,    665,    669,    673,
+     678,    682,    686,    691,    695,    699,    703,    708,    712,    717,    721,    726,
+     730,    734,    739,    744,    748,    753,    757,    762,    767,    771,    776,    781,
+     785,    790,    795,    800,    804,    809,    814,    819,    824,    829,    834,    839,
+     844,    849,    854,    859,    864,    869,    874,    879,    885,    890,    895,    900,
+     906,    911,    916,    922,    927,    932,    938,    943,    949,    954,    960,    965,
+     971,    976,    982,    988,    993,    999,   1005,   1010,   1016,   1022,   1028,   1034,
+    1039,   1045,   1051,   1057,   1063,   1069,   1075,   1081,   1087,   1093,   1099,   1106,
+    1112,   1118,   1124,   1130,   1137,   1143,   1149,   1156,   1162,   1168,   1175,   1181,
+    1188,   1194,   1201,   1207,   1214,   1221,   1227,   1234,   1241,   1247,   1254,   1261,
+    1268,   1275,   1281,   1288,   1295,   1302,   1309,   1316,   1323,   1330,   1337,   1345,
+    1352,   1359,   1366,   1373,   1381,   1388,   1395,   1403,   1410,   1417,   1425,   1432,
+    1440,   1447,   1455,   1462,   1470,   1478,   1485,   1493,   1501,   1509,   1516,   1524,
+    1532,   1540,   1548,   1556,   1564,   1572,   1580,   1588,   1596,   1604,   1612,   1620,
+    1629,   1637,   1645,   1653,   1662,   1670,   1679,   1687,   1695,   1704,   1713,   1721,
+    1730,   1738,   1747,   1756,   1764,   1773,   1782,   1791,   1800,   1808,   1817,   1826,
+    1835,   1844,   1853,   1862,   1872,   1881,   1890,   1899,   1908,   1918,   1927,   1936,
+    1946,   1955,   1965,   1974,   1984,   1993,   2003,   2012,   2022,   2032,   2041,   2051,
+    2061,   2071,   2081,   2090,   2100,   2110,   2120,   2130,   2140,   2150,   2161,   2171,
+    2181,   2191,   2201,   2212,   2222,   2232,   2243,   2253,   2264,   2274,   2285,   2295,
+    2306,   2317,   2327,   2338,   2349,   2360,   2371,   2381,   2392,   2403,   2414,   2425,
+    2436,   2447,   2458,   2470,   2481,   2492,   2503,   2515,   2526,   2537,   2549,   2560,
+    2572,   2583,   2595,   2606,   2618,   2630,   2641,   2653,   2665,   2677,   2689,   2701,
+    2713,   2725,   2737,   2749,   2761,   2773,   2785,   2797,   2809,   2822,   2834,   2846,
+    2859,   2871,   2884,   2896,   2909,   2921,   2934,   2947,   2959,   2972,   2985,   2998,
+    3011,   3023,   3036,   3049,   3062,   3075,   3089,   3102,   3115,   3128,   3141,   3155,
+    3168,   3181,   3195,   3208,   3222,   3235,   3249,   3262,   3276,   3290,   3303,   3317,
+    3331,   3345,   3359,   3373,   3387,   3401,   3415,   3429,   3443,   3457,   3471,   3486,
+    3500,   3514,   3529,   3543,   3557,   3572,   3587,   3601,   3616,   3630,   3645,   3660,
+    3675,   3689,   3704,   3719,   3734,   3749,   3764,   3779,   3794,   3810,   3825,   3840,
+    3855,   3871,   3886,   3901,   3917,   3932,   3948,   3963,   3979,   3995,   4010,   4026,
+    4042,   4058,   4074,   4090,   4106,   4122,   4138,   4154,   4170,   4186,   4202,   4218,
+    4235,   4251,   4267,   4284,   4300,   4317,   4333,   4350,   4367,   4383,   4400,   4417,
+    4434,   4450,   4467,   4484,   4501,   4518,   4535,   4552,   4570,   4587,   4604,   4621,
+    4639,   4656,   4673,   4691,   4708,   4726,   4743,   4761,   4779,   4796,   4814,   4832,
+    4850,   4868,   4886,   4904,   4922,   4940,   4958,   4976,   4994,   5012,   5031,   5049,
+    5067,   5086,   5104,   5123,   5141,   5160,   5179,   5197,   5216,   5235,   5253,   5272,
+    5291,   5310,   5329,   5348,   5367,   5386,   5405,   5425,   5444,   5463,   5483,   5502,
+    5521,   5541,   5560,   5580,   5599,   5619,   5639,   5659,   5678,   5698,   5718,   5738,
+    5758,   5778,   5798,   5818,   5838,   5858,   5878,   5899,   5919,   5939,   5960,   5980,
+    6001,   6021,   6042,   6062,   6083,   6104,   6124,   6145,   6166,   6187,   6208,   6229,
+    6250,   6271,   6292,   6313,   6334,   6355,   6377,   6398,   6419,   6441,   6462,   6484,
+    6505,   6527,   6548,   6570,   6592,   6614,   6635,   6657,   6679,   6701,   6723,   6745,
+    6767,   6789,   6811,   6834,   6856,   6878,   6900,   6923,   6945,   6968,   6990,   7013,
+    7035,   7058,   7081,   7103,   7126,   7149,   7172,   7195,   7218,   7241,   7264,   7287,
+    7310,   7333,   7356,   7379,   7403,   7426,   7449,   7473,   7496,   7520,   7543,   7567,
+    7590,   7614,   7638,   7662,   7685,   7709,   7733,   7757,   7781,   7805,   7829,   7853,
+    7877,   7901,   7926,   7950,   7974,   7999,   8023,   8047,   8072,   8096,   8121,   8146,
+    8170,   8195,   8220,   8245,   8269,   8294,   8319,   8344,   8369,   8394,   8419,   8444,
+    8469,   8495,   8520,   8545,   8570,   8596,   8621,   8647,   8672,   8698,   8723,   8749,
+    8775,   8800,   8826,   8852,   8878,   8903,   8929,   8955,   8981,   9007,   9033,   9060,
+    9086,   9112,   9138,   9164,   9191,   9217,   9243,   9270,   9296,   9323,   9349,   9376,
+    9403,   9429,   9456,   9483,   9509,   9536,   9563,   9590,   9617,   9644,   9671,   9698,
+    9725,   9752,   9780,   9807,   9834,   9861,   9889,   9916,   9943,   9971,   9998,  10026,
+   10054,  10081,  10109,  10136,  10164,  10192,  10220,  10248,  10275,  10303,  10331,  10359,
+   10387,  10415,  10443,  10472,  10500,  10528,  10556,  10585,  10613,  10641,  10670,  10698,
+   10727,  10755,  10784,  10812,  10841,  10869,  10898,  10927,  10956,  10984,  11013,  11042,
+   11071,  11100,  11129,  11158,  11187,  11216,  11245,  11274,  11303,  11333,  11362,  11391,
+   11420,  11450,  11479,  11509,  11538,  11568,  11597,  11627,  11656,  11686,  11716,  11745,
+   11775,  11805,  11835,  11864,  11894,  11924,  11954,  11984,  12014,  12044,  12074,  12104,
+   12134,  12164,  12195,  12225,  12255,  12285,  12316,  12346,  12376,  12407,  12437,  12468,
+   12498,  12529,  12559,  12590,  12620,  12651,  12682,  12712,  12743,  12774,  12805,  12836,
+   12866,  12897,  12928,  12959,  12990,  13021,  13052,  13083,  13114,  13145,  13177,  13208,
+   13239,  13270,  13301,  13333,  13364,  13395,  13427,  13458,  13490,  13521,  13552,  13584,
+   13616,  13647,  13679,  13710,  13742,  13774,  13805,  13837,  13869,  13900,  13932,  13964,
+   13996,  14028,  14060,  14092,  14123,  14155,  14187,  14219,  14251,  14284,  14316,  14348,
+   14380,  14412,  14444,  14476,  14509,  14541,  14573,  14605,  14638,  14670,  14702,  14735,
+   14767,  14800,  14832,  14864,  14897,  14929,  14962,  14995,  15027,  15060,  15092,  15125,
+   15158,  15190,  15223,  15256,  15288,  15321,  15354,  15387,  15419,  15452,  15485,  15518,
+   15551,  15584,  15617,  15650,  15683,  15716,  15749,  15782,  15815,  15848,  15881,  15914,
+   15947,  15980,  16013,  16046,  16079,  16113,  16146,  16179,  16212,  16245,  16279,  16312,
+   16345,  16378,  16412,  16445,  16478,  16512,  16545,  16578,  16612,  16645,  16679,  16712,
+   16746,  16779,  16812,  16846,  16879,  16913,  16946,  16980,  17013,  17047,  17081,  17114,
+   17148,  17181,  17215,  17249,  17282,  17316,  17349,  17383,  17417,  17450,  17484,  17518,
+   17551,  17585,  17619,  17653,  17686,  17720,  17754,  17788,  17821,  17855,  17889,  17923,
+   17956,  17990,  18024,  18058,  18092,  18125,  18159,  18193,  18227,  18261,  18295,  18328,
+   18362,  18396,  18430,  18464,  18498,  18532,  18566,  18599,  18633,  18667,  18701,  18735,
+   18769,  18803,  18837,  18871,  18905,  18938,  18972,  19006,  19040,  19074,  19108,  19142,
+   19176,  19210,  19244,  19278,  19311,  19345,  19379,  19413,  19447,  19481,  19515,  19549,
+   19583,  19617,  19650,  19684,  19718,  19752,  19786,  19820,  19854,  19888,  19922,  19955,
+   19989,  20023,  20057,  20091,  20125,  20158,  20192,  20226,  20260,  20294,  20328,  20361,
+   20395,  20429,  20463,  20497,  20530,  20564,  20598,  20632,  20665,  20699,  20733,  20766,
+   20800,  20834,  20868,  20901,  20935,  20969,  21002,  21036,  21069,  21103,  21137,  21170,
+   21204,  21237,  21271,  21305,  21338,  21372,  21405,  21439,  21472,  21506,  21539,  21572,
+   21606,  21639,  21673,  21706,  21739,  21773,  21806,  21840,  21873,  21906,  21939,  21973,
+   22006,  22039,  22072,  22106,  22139,  22172,  22205,  22238,  22271,  22305,  22338,  22371,
+   22404,  22437,  22470,  22503,  22536,  22569,  22602,  22635,  22667,  22700,  22733,  22766,
+   22799,  22832,  22864,  22897,  22930,  22963,  22995,  23028,  23061,  23093,  23126,  23158,
+   23191,  23223,  23256,  23288,  23321,  23353,  23386,  23418,  23450,  23483,  23515,  23547,
+   23580,  23612,  23644,  23676,  23708,  23741,  23773,  23805,  23837,  23869,  23901,  23933,
+   23965,  23997,  24028,  24060,  24092,  24124,  24156,  24187,  24219,  24251,  24282,  24314,
+   24346,  24377,  24409,  24440,  24472,  24503,  24534,  24566,  24597,  24628,  24660,  24691,
+   24722,  24753,  24784,  24816,  24847,  24878,  24909,  24940,  24971,  25001,  25032,  25063,
+   25094,  25125,  25155,  25186,  25217,  25247,  25278,  25309,  25339,  25370,  25400,  25430,
+   25461,  25491,  25521,  25552,  25582,  25612,  25642,  25672,  25702,  25732,  25762,  25792,
+   25822,  25852,  25882,  25911,  25941,  25971,  26000,  26030,  26060,  26089,  26119,  26148,
+   26177,  26207,  26236,  26265,  26295,  26324,  26353,  26382,  26411,  26440,  26469,  26498,
+   26527,  26556,  26584,  26613,  26642,  26671,  26699,  26728,  26756,  26785,  26813,  26841,
+   26870,  26898,  26926,  26954,  26983,  27011,  27039,  27067,  27095,  27123,  27150,  27178,
+   27206,  27234,  27261,  27289,  27316,  27344,  27371,  27399,  27426,  27453,  27481,  27508,
+   27535,  27562,  27589,  27616,  27643,  27670,  27697,  27723,  27750,  27777,  27803,  27830,
+   27856,  27883,  27909,  27936,  27962,  27988,  28014,  28041,  28067,  28093,  28119,  28144,
+   28170,  28196,  28222,  28247,  28273,  28299,  28324,  28350,  28375,  28400,  28426,  28451,
+   28476,  28501,  28526,  28551,  28576,  28601,  28626,  28651,  28675,  28700,  28724,  28749,
+   28773,  28798,  28822,  28846,  28871,  28895,  28919,  28943,  28967,  28991,  29015,  29038,
+   29062,  29086,  29109,  29133,  29156,  29180,  29203,  29226,  29250,  29273,  29296,  29319,
+   29342,  29365,  29387,  29410,  29433,  29456,  29478,  29501,  29523,  29545,  29568,  29590,
+   29612,  29634,  29656,  29678,  29700,  29722,  29744,  29766,  29787,  29809,  29830,  29852,
+   29873,  29894,  29916,  29937,  29958,  29979,  30000,  30021,  30042,  30062,  30083,  30104,
+   30124,  30145,  30165,  30185,  30206,  30226,  30246,  30266,  30286,  30306,  30326,  30345,
+   30365,  30385,  30404,  30424,  30443,  30463,  30482,  30501,  30520,  30539,  30558,  30577,
+   30596,  30615,  30633,  30652,  30670,  30689,  30707,  30726,  30744,  30762,  30780,  30798,
+   30816,  30834,  30852,  30869,  30887,  30905,  30922,  30940,  30957,  30974,  30991,  31008,
+   31025,  31042,  31059,  31076,  31093,  31109,  31126,  31142,  31159,  31175,  31191,  31208,
+   31224,  31240,  31256,  31272,  31287,  31303,  31319,  31334,  31350,  31365,  31381,  31396,
+   31411,  31426,  31441,  31456,  31471,  31486,  31500,  31515,  31529,  31544,  31558,  31572,
+   31587,  31601,  31615,  31629,  31643,  31657,  31670,  31684,  31697,  31711,  31724,  31738,
+   31751,  31764,  31777,  31790,  31803,  31816,  31829,  31841,  31854,  31866,  31879,  31891,
+   31903,  31915,  31927,  31939,  31951,  31963,  31975,  31987,  31998,  32010,  32021,  32032,
+   32044,  32055,  32066,  32077,  32088,  32099,  32109,  32120,  32131,  32141,  32151,  32162,
+   32172,  32182,  32192,  32202,  32212,  32222,  32232,  32241,  32251,  32260,  32270,  32279,
+   32288,  32297,  32306,  32315,  32324,  32333,  32342,  32350,  32359,  32367,  32376,  32384,
+   32392,  32400,  32408,  32416,  32424,  32432,  32439,  32447,  32454,  32462,  32469,  32476,
+   32483,  32490,  32497,  32504,  32511,  32518,  32524,  32531,  32537,  32544,  32550,  32556,
+   32562,  32568,  32574,  32580,  32586,  32591,  32597,  32602,  32608,  32613,  32618,  32623,
+   32628,  32633,  32638,  32643,  32647,  32652,  32657,  32661,  32665,  32669,  32674,  32678,
+   32682,  32686,  32689,  32693,  32697,  32700,  32704,  32707,  32710,  32713,  32716,  32719,
+   32722,  32725,  32728,  32730,  32733,  32735,  32738,  32740,  32742,  32744,  32746,  32748,
+   32750,  32752,  32754,  32755,  32757,  32758,  32759,  32760,  32762,  32763,  32764,  32764,
+   32765,  32766,  32766,  32767,  32767,  32767,  32767,  32767,  32767,
+};
+
+const int16_t TBL_FlatTopQ15[(DSP_TABLE_SIZE / 2U) + 1U] =
+{
+     -14,    -14,    -14,    -14,    -14,    -14,    -14,    -14,    -14,    -14,    -14,    -14,
+     -14,    -14,    -14,    -14,    -14,    -14,    -14,    -15,    -15,    -15,    -15,    -15,
+     -15,    -15,    -15,    -15,    -15,    -15,    -16,    -16,    -16,    -16,    -16,    -16,
+     -16,    -17,    -17,    -17,    -17,    -17,    -17,    -17,    -18,    -18,    -18,    -18,
+     -18,    -19,    -19,    -19,    -19,    -19,    -20,    -20,    -20,    -20,    -21,    -21,
+     -21,    -21,    -22,    -22,    -22,    -22,    -23,    -23,    -23,    -23,    -24,    -24,
+     -24,    -25,    -25,    -25,    -25,    -26,    -26,    -26,    -27,    -27,    -27,    -28,
+     -28,    -28,    -29,    -29,    -30,    -30,    -30,    -31,    -31,    -31,    -32,    -32,
+     -33,    -33,    -33,    -34,    -34,    -35,    -35,    -36,    -36,    -37,    -37,    -37,
+     -38,    -38,    -39,    -39,    -40,    -40,    -41,    -41,    -42,    -42,    -43,    -43,
+     -44,    -44,    -45,    -45,    -46,    -47,    -47,    -48,    -48,    -49,    -49,    -50,
+     -50,    -51,    -52,    -52,    -53,    -53,    -54,    -55,    -55,    -56,    -57,    -57,
+     -58,    -59,    -59,    -60,    -61,    -61,    -62,    -63,    -63,    -64,    -65,    -65,
+     -66,    -67,    -68,    -68,    -69,    -70,    -71,    -71,    -72,    -73,    -74,    -75,
+     -75,    -76,    -77,    -78,    -79,    -79,    -80,    -81,    -82,    -83,    -84,    -84,
+     -85,    -86,    -87,    -88,    -89,    -90,    -91,    -92,    -93,    -94,    -94,    -95,
+     -96,    -97,    -98,    -99,   -100,   -101,   -102,   -103,   -104,   -105,   -106,   -107,
+    -108,   -109,   -110,   -111,   -113,   -114,   -115,   -116,   -117,   -118,   -119,   -120,
+    -121,   -122,   -124,   -125,   -126,   -127,   -128,   -129,   -131,   -132,   -133,   -134,
+    -135,   -137,   -138,   -139,   -140,   -142,   -143,   -144,   -145,   -147,   -148,   -149,
+    -151,   -152,   -153,   -155,   -156,   -157,   -159,   -160,   -161,   -163,   -164,   -165,
+    -167,   -168,   -170,   -171,   -173,   -174,   -176,   -177,   -178,   -180,   -181,   -183,
+    -184,   -186,   -188,   -189,   -191,   -192,   -194,   -195,   -197,   -199,   -200,   -202,
+    -203,   -205,   -207,   -208,   -210,   -212,   -213,   -215,   -217,   -218,   -220,   -222,
+    -224,   -225,   -227,   -229,   -231,   -232,   -234,   -236,   -238,   -240,   -241,   -243,
+    -245,   -247,   -249,   -251,   -253,   -254,   -256,   -258,   -260,   -262,   -264,   -266,
+    -268,   -270,   -272,   -274,   -276,   -278,   -280,   -282,   -284,   -286,   -288,   -290,
+    -292,   -294,   -297,   -299,   -301,   -303,   -305,   -307,   -309,   -312,   -314,   -316,
+    -318,   -320,   -323,   -325,   -327,   -329,   -332,   -334,   -336,   -339,   -341,   -343,
+    -346,   -348,   -350,   -353,   -355,   -357,   -360,   -362,   -365,   -367,   -370,   -372,
+    -375,   -377,   -379,   -382,   -385,   -387,   -390,   -392,   -395,   -397,   -400,   -402,
+    -405,   -408,   -410,   -413,   -416,   -418,   -421,   -424,   -426,   -429,   -432,   -434,
+    -437,   -440,   -443,   -445,   -448,   -451,   -454,   -457,   -459,   -462,   -465,   -468,
+    -471,   -474,   -477,   -480,   -482,   -485,   -488,   -491,   -494,   -497,   -500,   -503,
+    -506,   -509,   -512,   -515,   -518,   -521,   -525,   -528,   -531,   -534,   -537,   -540,
+    -543,   -546,   -550,   -553,   -556,   -559,   -562,   -566,   -569,   -572,   -575,   -579,
+    -582,   -585,   -589,   -592,   -595,   -599,   -602,   -605,   -609,   -612,   -615,   -619,
+    -622,   -626,   -629,   -633,   -636,   -640,   -643,   -646,   -650,   -654,   -657,   -661,
+    -664,   -668,   -671,   -675,   -678,   -682,   -686,   -689,   -693,   -697,   -700,   -704,
+    -708,   -711,   -715,   -719,   -723,   -726,   -730,   -734,   -738,   -741,   -745,   -749,
+    -753,   -757,   -760,   -764,   -768,   -772,   -776,   -780,   -784,   -788,   -792,   -796,
+    -799,   -803,   -807,   -811,   -815,   -819,   -823,   -827,   -831,   -835,   -840,   -844,
+    -848,   -852,   -856,   -860,   -864,   -868,   -872,   -876,   -881,   -885,   -889,   -893,
+    -897,   -901,   -906,   -910,   -914,   -918,   -923,   -927,   -931,   -935,   -940,   -944,
+    -948,   -953,   -957,   -961,   -966,   -970,   -974,   -979,   -983,   -987,   -992,   -996,
+   -1000,  -1005,  -1009,  -1014,  -1018,  -1023,  -1027,  -1032,  -1036,  -1041,  -1045,  -1049,
+   -1054,  -1058,  -1063,  -1068,  -1072,  -1077,  -1081,  -1086,  -1090,  -1095,  -1099,  -1104,
+   -1109,  -1113,  -1118,  -1122,  -1127,  -1132,  -1136,  -1141,  -1146,  -1150,  -1155,  -1160,
+   -1164,  -1169,  -1174,  -1178,  -1183,  -1188,  -1192,  -1197,  -1202,  -1207,  -1211,  -1216,
+   -1221,  -1225,  -1230,  -1235,  -1240,  -1245,  -1249,  -1254,  -1259,  -1264,  -1268,  -1273,
+   -1278,  -1283,  -1288,  -1292,  -1297,  -1302,  -1307,  -1312,  -1317,  -1321,  -1326,  -1331,
+   -1336,  -1341,  -1346,  -1350,  -1355,  -1360,  -1365,  -1370,  -1375,  -1380,  -1384,  -1389,
+   -1394,  -1399,  -1404,  -1409,  -1414,  -1419,  -1423,  -1428,  -1433,  -1438,  -1443,  -1448,
+   -1453,  -1458,  -1463,  -1467,  -1472,  -1477,  -1482,  -1487,  -1492,  -1497,  -1502,  -1507,
+   -1511,  -1516,  -1521,  -1526,  -1531,  -1536,  -1541,  -1546,  -1551,  -1555,  -1560,  -1565,
+   -1570,  -1575,  -1580,  -1585,  -1590,  -1594,  -1599,  -1604,  -1609,  -1614,  -1619,  -1624,
+   -1628,  -1633,  -1638,  -1643,  -1648,  -1653,  -1657,  -1662,  -1667,  -1672,  -1677,  -1681,
+   -1686,  -1691,  -1696,  -1701,  -1705,  -1710,  -1715,  -1720,  -1724,  -1729,  -1734,  -1738,
+   -1743,  -1748,  -1753,  -1757,  -1762,  -1767,  -1771,  -1776,  -1781,  -1785,  -1790,  -1795,
+   -1799,  -1804,  -1808,  -1813,  -1818,  -1822,  -1827,  -1831,  -1836,  -1840,  -1845,  -1849,
+   -1854,  -1858,  -1863,  -1867,  -1872,  -1876,  -1881,  -1885,  -1890,  -1894,  -1898,  -1903,
+   -1907,  -1911,  -1916,  -1920,  -1924,  -1929,  -1933,  -1937,  -1942,  -1946,  -1950,  -1954,
+   -1958,  -1963,  -1967,  -1971,  -1975,  -1979,  -1983,  -1987,  -1992,  -1996,  -2000,  -2004,
+   -2008,  -2012,  -2016,  -2020,  -2024,  -2027,  -2031,  -2035,  -2039,  -2043,  -2047,  -2051,
+   -2054,  -2058,  -2062,  -2066,  -2069,  -2073,  -2077,  -2080,  -2084,  -2088,  -2091,  -2095,
+   -2098,  -2102,  -2106,  -2109,  -2112,  -2116,  -2119,  -2123,  -2126,  -2129,  -2133,  -2136,
+   -2139,  -2143,  -2146,  -2149,  -2152,  -2155,  -2159,  -2162,  -2165,  -2168,  -2171,  -2174,
+   -2177,  -2180,  -2183,  -2186,  -2189,  -2191,  -2194,  -2197,  -2200,  -2203,  -2205,  -2208,
+   -2211,  -2213,  -2216,  -2218,  -2221,  -2223,  -2226,  -2228,  -2231,  -2233,  -2235,  -2238,
+   -2240,  -2242,  -2245,  -2247,  -2249,  -2251,  -2253,  -2255,  -2257,  -2259,  -2261,  -2263,
+   -2265,  -2267,  -2269,  -2271,  -2272,  -2274,  -2276,  -2277,  -2279,  -2281,  -2282,  -2284,
+   -2285,  -2287,  -2288,  -2289,  -2291,  -2292,  -2293,  -2295,  -2296,  -2297,  -2298,  -2299,
+   -2300,  -2301,  -2302,  -2303,  -2304,  -2305,  -2305,  -2306,  -2307,  -2307,  -2308,  -2309,
+   -2309,  -2310,  -2310,  -2310,  -2311,  -2311,  -2311,  -2312,  -2312,  -2312,  -2312,  -2312,
+   -2312,  -2312,  -2312,  -2312,  -2312,  -2312,  -2311,  -2311,  -2311,  -2310,  -2310,  -2309,
+   -2309,  -2308,  -2307,  -2307,  -2306,  -2305,  -2304,  -2303,  -2303,  -2302,  -2301,  -2299,
+   -2298,  -2297,  -2296,  -2295,  -2293,  -2292,  -2290,  -2289,  -2287,  -2286,  -2284,  -2282,
+   -2281,  -2279,  -2277,  -2275,  -2273,  -2271,  -2269,  -2267,  -2265,  -2262,  -2260,  -2258,
+   -2255,  -2253,  -2250,  -2248,  -2245,  -2242,  -2239,  -2237,  -2234,  -2231,  -2228,  -2225,
+   -2222,  -2218,  -2215,  -2212,  -2209,  -2205,  -2202,  -2198,  -2195,  -2191,  -2187,  -2183,
+   -2180,  -2176,  -2172,  -2168,  -2164,  -2159,  -2155,  -2151,  -2146,  -2142,  -2138,  -2133,
+   -2128,  -2124,  -2119,  -2114,  -2109,  -2104,  -2099,  -2094,  -2089,  -2084,  -2079,  -2073,
+   -2068,  -2063,  -2057,  -2051,  -2046,  -2040,  -2034,  -2028,  -2022,  -2016,  -2010,  -2004,
+   -1998,  -1991,  -1985,  -1979,  -1972,  -1966,  -1959,  -1952,  -1945,  -1938,  -1931,  -1924,
+   -1917,  -1910,  -1903,  -1896,  -1888,  -1881,  -1873,  -1866,  -1858,  -1850,  -1842,  -1834,
+   -1826,  -1818,  -1810,  -1802,  -1794,  -1785,  -1777,  -1768,  -1760,  -1751,  -1742,  -1733,
+   -1724,  -1715,  -1706,  -1697,  -1688,  -1679,  -1669,  -1660,  -1650,  -1641,  -1631,  -1621,
+   -1611,  -1601,  -1591,  -1581,  -1571,  -1561,  -1550,  -1540,  -1529,  -1519,  -1508,  -1497,
+   -1486,  -1475,  -1464,  -1453,  -1442,  -1431,  -1419,  -1408,  -1396,  -1385,  -1373,  -1361,
+   -1349,  -1337,  -1325,  -1313,  -1301,  -1289,  -1276,  -1264,  -1251,  -1238,  -1226,  -1213,
+   -1200,  -1187,  -1174,  -1161,  -1147,  -1134,  -1120,  -1107,  -1093,  -1080,  -1066,  -1052,
+   -1038,  -1024,  -1010,   -995,   -981,   -966,   -952,   -937,   -923,   -908,   -893,   -878,
+    -863,   -848,   -832,   -817,   -801,   -786,   -770,   -754,   -739,   -723,   -707,   -691,
+    -674,   -658,   -642,   -625,   -609,   -592,   -575,   -558,   -541,   -524,   -507,   -490,
+    -472,   -455,   -437,   -420,   -402,   -384,   -366,   -348,   -330,   -312,   -294,   -275,
+    -257,   -238,   -219,   -201,   -182,   -163,   -144,   -124,   -105,    -86,    -66,    -47,
+     -27,     -7,     13,     33,     53,     73,     93,    114,    134,    155,    176,    196,
+     217,    238,    259,    280,    302,    323,    345,    366,    388,    410,    432,    454,
+     476,    498,    520,    542,    565,    588,    610,    633,    656,    679,    702,    725,
+     749,    772,    796,    819,    843,    867,    891,    915,    939,    963,    987,   1012,
+    1036,   1061,   1086,   1111,   1136,   1161,   1186,   1211,   1236,   1262,   1287,   1313,
+    1339,   1365,   1391,   1417,   1443,   1469,   1496,   1522,   1549,   1575,   1602,   1629,
+    1656,   1683,   1711,   1738,   1765,   1793,   1820,   1848,   1876,   1904,   1932,   1960,
+    1988,   2017,   2045,   2074,   2103,   2131,   2160,   2189,   2218,   2247,   2277,   2306,
+    2336,   2365,   2395,   2425,   2455,   2485,   2515,   2545,   2575,   2606,   2636,   2667,
+    2698,   2729,   2759,   2791,   2822,   2853,   2884,   2916,   2947,   2979,   3011,   3043,
+    3075,   3107,   3139,   3171,   3203,   3236,   3269,   3301,   3334,   3367,   3400,   3433,
+    3466,   3499,   3533,   3566,   3600,   3634,   3667,   3701,   3735,   3769,   3804,   3838,
+    3872,   3907,   3941,   3976,   4011,   4046,   4081,   4116,   4151,   4187,   4222,   4257,
+    4293,   4329,   4365,   4400,   4436,   4473,   4509,   4545,   4581,   4618,   4654,   4691,
+    4728,   4765,   4802,   4839,   4876,   4913,   4951,   4988,   5026,   5063,   5101,   5139,
+    5177,   5215,   5253,   5291,   5330,   5368,   5406,   5445,   5484,   5523,   5561,   5600,
+    5639,   5679,   5718,   5757,   5797,   5836,   5876,   5916,   5955,   5995,   6035,   6075,
+    6116,   6156,   6196,   6237,   6277,   6318,   6359,   6399,   6440,   6481,   6522,   6564,
+    6605,   6646,   6688,   6729,   6771,   6812,   6854,   6896,   6938,   6980,   7022,   7064,
+    7107,   7149,   7192,   7234,   7277,   7320,   7362,   7405,   7448,   7491,   7534,   7578,
+    7621,   7664,   7708,   7751,   7795,   7839,   7883,   7926,   7970,   8014,   8059,   8103,
+    8147,   8191,   8236,   8280,   8325,   8370,   8414,   8459,   8504,   8549,   8594,   8639,
+    8685,   8730,   8775,   8821,   8866,   8912,   8957,   9003,   9049,   9095,   9141,   9187,
+    9233,   9279,   9325,   9372,   9418,   9464,   9511,   9557,   9604,   9651,   9698,   9745,
+    9791,   9838,   9886,   9933,   9980,  10027,  10074,  10122,  10169,  10217,  10264,  10312,
+   10360,  10408,  10455,  10503,  10551,  10599,  10647,  10696,  10744,  10792,  10840,  10889,
+   10937,  10986,  11034,  11083,  11132,  11180,  11229,  11278,  11327,  11376,  11425,  11474,
+   11523,  11572,  11621,  11671,  11720,  11769,  11819,  11868,  11918,  11967,  12017,  12067,
+   12117,  12166,  12216,  12266,  12316,  12366,  12416,  12466,  12516,  12566,  12617,  12667,
+   12717,  12767,  12818,  12868,  12919,  12969,  13020,  13070,  13121,  13172,  13222,  13273,
+   13324,  13375,  13426,  13477,  13528,  13579,  13630,  13681,  13732,  13783,  13834,  13885,
+   13936,  13988,  14039,  14090,  14142,  14193,  14244,  14296,  14347,  14399,  14450,  14502,
+   14553,  14605,  14657,  14708,  14760,  14812,  14863,  14915,  14967,  15019,  15071,  15122,
+   15174,  15226,  15278,  15330,  15382,  15434,  15486,  15538,  15590,  15642,  15694,  15746,
+   15798,  15850,  15903,  15955,  16007,  16059,  16111,  16163,  16215,  16268,  16320,  16372,
+   16424,  16477,  16529,  16581,  16633,  16686,  16738,  16790,  16842,  16895,  16947,  16999,
+   17052,  17104,  17156,  17209,  17261,  17313,  17366,  17418,  17470,  17522,  17575,  17627,
+   17679,  17732,  17784,  17836,  17888,  17941,  17993,  18045,  18098,  18150,  18202,  18254,
+   18306,  18359,  18411,  18463,  18515,  18567,  18619,  18672,  18724,  18776,  18828,  18880,
+   18932,  18984,  19036,  19088,  19140,  19192,  19244,  19296,  19348,  19400,  19451,  19503,
+   19555,  19607,  19659,  19710,  19762,  19814,  19865,  19917,  19969,  20020,  20072,  20123,
+   20175,  20226,  20278,  20329,  20380,  20432,  20483,  20534,  20585,  20637,  20688,  20739,
+   20790,  20841,  20892,  20943,  20994,  21045,  21095,  21146,  21197,  21248,  21298,  21349,
+   21400,  21450,  21501,  21551,  21602,  21652,  21702,  21752,  21803,  21853,  21903,  21953,
+   22003,  22053,  22103,  22153,  22203,  22252,  22302,  22352,  22401,  22451,  22500,  22550,
+   22599,  22648,  22698,  22747,  22796,  22845,  22894,  22943,  22992,  23041,  23089,  23138,
+   23187,  23235,  23284,  23332,  23381,  23429,  23477,  23525,  23573,  23621,  23669,  23717,
+   23765,  23813,  23860,  23908,  23956,  24003,  24050,  24098,  24145,  24192,  24239,  24286,
+   24333,  24380,  24427,  24473,  24520,  24567,  24613,  24659,  24706,  24752,  24798,  24844,
+   24890,  24936,  24982,  25027,  25073,  25118,  25164,  25209,  25254,  25300,  25345,  25390,
+   25434,  25479,  25524,  25569,  25613,  25658,  25702,  25746,  25790,  25834,  25878,  25922,
+   25966,  26010,  26053,  26097,  26140,  26183,  26226,  26269,  26312,  26355,  26398,  26441,
+   26483,  26526,  26568,  26610,  26652,  26694,  26736,  26778,  26820,  26861,  26903,  26944,
+   26985,  27027,  27068,  27109,  27149,  27190,  27231,  27271,  27312,  27352,  27392,  27432,
+   27472,  27512,  27551,  27591,  27630,  27670,  27709,  27748,  27787,  27826,  27865,  27903,
+   27942,  27980,  28018,  28056,  28094,  28132,  28170,  28208,  28245,  28282,  28320,  28357,
+   28394,  28431,  28467,  28504,  28540,  28577,  28613,  28649,  28685,  28721,  28756,  28792,
+   28827,  28863,  28898,  28933,  28968,  29002,  29037,  29072,  29106,  29140,  29174,  29208,
+   29242,  29276,  29309,  29342,  29376,  29409,  29442,  29474,  29507,  29540,  29572,  29604,
+   29636,  29668,  29700,  29732,  29763,  29795,  29826,  29857,  29888,  29919,  29949,  29980,
+   30010,  30040,  30071,  30100,  30130,  30160,  30189,  30219,  30248,  30277,  30306,  30334,
+   30363,  30391,  30419,  30448,  30475,  30503,  30531,  30558,  30586,  30613,  30640,  30667,
+   30693,  30720,  30746,  30772,  30798,  30824,  30850,  30876,  30901,  30926,  30951,  30976,
+   31001,  31026,  31050,  31075,  31099,  31123,  31146,  31170,  31194,  31217,  31240,  31263,
+   31286,  31309,  31331,  31353,  31376,  31398,  31419,  31441,  31463,  31484,  31505,  31526,
+   31547,  31567,  31588,  31608,  31628,  31648,  31668,  31688,  31707,  31727,  31746,  31765,
+   31784,  31802,  31821,  31839,  31857,  31875,  31893,  31910,  31928,  31945,  31962,  31979,
+   31996,  32012,  32029,  32045,  32061,  32077,  32092,  32108,  32123,  32138,  32153,  32168,
+   32183,  32197,  32211,  32225,  32239,  32253,  32267,  32280,  32293,  32306,  32319,  32332,
+   32344,  32357,  32369,  32381,  32392,  32404,  32415,  32427,  32438,  32449,  32459,  32470,
+   32480,  32490,  32500,  32510,  32520,  32529,  32538,  32547,  32556,  32565,  32574,  32582,
+   32590,  32598,  32606,  32613,  32621,  32628,  32635,  32642,  32649,  32655,  32662,  32668,
+   32674,  32680,  32685,  32691,  32696,  32701,  32706,  32710,  32715,  32719,  32723,  32727,
+   32731,  32735,  32738,  32741,  32744,  32747,  32750,  32752,  32755,  32757,  32759,  32761,
+   32762,  32763,  32765,  32766,  32767,  32767,  32767,  32767,  32767,
+};
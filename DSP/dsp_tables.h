@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    dsp_tables.h
+  * @brief   Constant tables shared by the DSP modules.
+  ******************************************************************************
+  * @attention
+  *
+  * The tables are sampled on a DSP_TABLE_SIZE point circle. A transform or
+  * window of n points (n a power of two, n <= DSP_TABLE_SIZE) reads every
+  * (DSP_TABLE_SIZE / n)-th entry.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_TABLES_H
+#define __DSP_TABLES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define DSP_TABLE_SIZE            4096U   /* Points on the circle                */
+#define DSP_TABLE_LOG2            12U
+
+/* Exported variables --------------------------------------------------------*/
+/* First quadrant of sin(2 pi i / DSP_TABLE_SIZE), q31 */
+extern const int32_t TBL_SineQ31[(DSP_TABLE_SIZE / 4U) + 1U];
+
+/* First half of the periodic windows, q15 */
+extern const int16_t TBL_HannQ15[(DSP_TABLE_SIZE / 2U) + 1U];
+extern const int16_t TBL_BlackmanHarrisQ15[(DSP_TABLE_SIZE / 2U) + 1U];
+extern const int16_t TBL_FlatTopQ15[(DSP_TABLE_SIZE / 2U) + 1U];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_TABLES_H */
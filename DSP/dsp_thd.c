@@ -0,0 +1,436 @@
+/**
+  ******************************************************************************
+  * @file    dsp_thd.c
+  * @brief   Distortion and noise measurement of a sine input.
+  ******************************************************************************
+  * @attention
+  *
+  * The power spectrum comes from ENG_Power(), on the fixed-point or the
+  * FPU path, in units of |DFT|^2 of full scale samples: a full scale sine
+  * gives a lobe sum of N^2 ENBW CG^2 / 4.
+  *
+  * The bins of DC (main lobe), of the fundamental and of the harmonics
+  * are marked as they are summed so that overlapping lobes, at low
+  * frequencies, are not counted twice.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_engine.h"
+#include "dsp_frame.h"
+#include "dsp_thd.h"
+
+/* Private define ------------------------------------------------------------*/
+#define THD_BINS_MAX              ((THD_FFT_MAX / 2U) + 1U)
+#define THD_USED_WORDS            ((THD_BINS_MAX + 31U) / 32U)
+
+#if (THD_FFT_MAX > (2U * DSP_SCRATCH_SIZE))
+#error "THD_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static THD_ConfigTypeDef ThdConfig =
+{
+  .FftSize   = THD_FFT_MAX,
+  .Window    = WIN_BLACKMAN_HARRIS,
+  .Harmonics = THD_HARMONICS_MAX,
+  .Average   = 4U,
+  .Bandwidth = 0U,
+};
+
+static uint32_t ThdUsed[THD_USED_WORDS];
+
+/* Sums over the frames of the current result, ENG_Power() units */
+static float    ThdFundamental;
+static float    ThdHarmonic[THD_HARMONICS_MAX + 1U];
+static float    ThdNoise;
+static float    ThdFrequency;   /* Sum of the fundamentals, bins           */
+static uint32_t ThdFrames;      /* With a fundamental                      */
+static uint32_t ThdCount;       /* Transformed                             */
+static uint32_t ThdLast;        /* Highest bin analysed                    */
+
+static THD_ResultTypeDef ThdResult;
+static int16_t  ThdLevels[THD_HARMONICS_MAX - 1U];
+static uint8_t  ThdValid;
+
+static uint8_t  ThdEnabled;
+static uint32_t ThdRead;
+static uint32_t ThdSeq;
+static uint32_t ThdOverruns;
+static uint32_t ThdCycles;
+
+/* Private function prototypes -----------------------------------------------*/
+static float   THD_Lobe(const float *p, float centre, uint32_t first, uint32_t last);
+static float  *THD_Frame(const DSP_RingTypeDef *input);
+static void    THD_Analyse(const float *p);
+static void    THD_Result(void);
+static void    THD_Clear(void);
+static int32_t THD_Centi(float value);
+static int32_t THD_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef THD_ConsoleCommand =
+{
+  .Name    = "thd",
+  .Help    = "thd [on|off|n <size>|win <hann|bh|flattop>|avg <frames>|harm <n>|bw <hz>] - distortion, SNR",
+  .Handler = THD_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Sum of the bins not taken yet within the lobe around centre, marks them */
+static float THD_Lobe(const float *p, float centre, uint32_t first, uint32_t last)
+{
+  uint32_t lobe = WIN_GetInfo(ThdConfig.Window)->Lobe + 1U;
+  int32_t k0 = (int32_t)lrintf(centre);
+  int32_t from = k0 - (int32_t)lobe;
+  int32_t to = k0 + (int32_t)lobe;
+  float sum = 0.0f;
+  int32_t k;
+
+  if (from < (int32_t)first)
+  {
+    from = (int32_t)first;
+  }
+  if (to > (int32_t)last)
+  {
+    to = (int32_t)last;
+  }
+  for (k = from; k <= to; k++)
+  {
+    if ((ThdUsed[(uint32_t)k / 32U] & (1UL << ((uint32_t)k % 32U))) == 0U)
+    {
+      ThdUsed[(uint32_t)k / 32U] |= 1UL << ((uint32_t)k % 32U);
+      sum += p[k];
+    }
+  }
+  return sum;
+}
+
+/* Power spectrum of the next frame, in the scratch buffer */
+static float *THD_Frame(const DSP_RingTypeDef *input)
+{
+  const int16_t *src;
+  const int16_t *wrap;
+  uint32_t len;
+  uint32_t avail;
+
+  src = DSP_RingSamples(input, ThdRead, &len);
+  if (len > ThdConfig.FftSize)
+  {
+    len = ThdConfig.FftSize;
+  }
+  wrap = DSP_RingSamples(input, ThdRead + len, &avail);
+  return ENG_Power(ThdConfig.Window, ThdConfig.FftSize, src, len, wrap);
+}
+
+/* Fundamental, harmonics and noise of the power spectrum p */
+static void THD_Analyse(const float *p)
+{
+  uint32_t bins = ThdConfig.FftSize / 2U;
+  uint32_t first = WIN_GetInfo(ThdConfig.Window)->Lobe + 1U;
+  uint32_t last = bins - 1U;
+  uint32_t peak;
+  uint32_t count = 0U;
+  uint32_t h;
+  uint32_t k;
+  float lm;
+  float l0;
+  float lp;
+  float f0;
+  float noise = 0.0f;
+
+  if (ThdConfig.Bandwidth != 0U)
+  {
+    k = (uint32_t)(((uint64_t)ThdConfig.Bandwidth * ThdConfig.FftSize) / DSP_GetInput()->Rate);
+    if (k < last)
+    {
+      last = k;
+    }
+  }
+
+  peak = first;
+  for (k = first; k <= last; k++)
+  {
+    if (p[k] > p[peak])
+    {
+      peak = k;
+    }
+  }
+  ThdLast = last;
+  if ((peak <= first) || (peak >= last) || (p[peak - 1U] <= 0.0f) || (p[peak + 1U] <= 0.0f))
+  {
+    return;
+  }
+
+  /* Vertex of the parabola through the log power around the peak */
+  lm = logf(p[peak - 1U]);
+  l0 = logf(p[peak]);
+  lp = logf(p[peak + 1U]);
+  f0 = (float)peak + ((0.5f * (lm - lp)) / ((lm - (2.0f * l0)) + lp));
+
+  (void)memset(ThdUsed, 0, sizeof(ThdUsed));
+  ThdFundamental += THD_Lobe(p, f0, first, last);
+  for (h = 2U; h <= ThdConfig.Harmonics; h++)
+  {
+    if (((float)h * f0) < (float)last)
+    {
+      ThdHarmonic[h] += THD_Lobe(p, (float)h * f0, first, last);
+    }
+  }
+
+  for (k = first; k <= last; k++)
+  {
+    if ((ThdUsed[k / 32U] & (1UL << (k % 32U))) == 0U)
+    {
+      noise += p[k];
+      count++;
+    }
+  }
+  if (count != 0U)
+  {
+    ThdNoise += (noise * (float)((last - first) + 1U)) / (float)count;
+  }
+
+  ThdFrequency += f0;
+  ThdFrames++;
+}
+
+/* Metrics of the frames summed, DFR_TAG_THD frame */
+static void THD_Result(void)
+{
+  THD_FrameHeaderTypeDef header;
+  const WIN_InfoTypeDef *win = WIN_GetInfo(ThdConfig.Window);
+  float n = (float)ThdConfig.FftSize;
+  float fs = (float)DSP_GetInput()->Rate / 1000.0f;
+  float f0 = ThdFrequency / (float)ThdFrames;
+  float p1 = ThdFundamental;
+  float harm = 0.0f;
+  float noise = fmaxf(ThdNoise, 1e-30f);
+  uint32_t h;
+
+  for (h = 2U; h <= ThdConfig.Harmonics; h++)
+  {
+    harm += ThdHarmonic[h];
+    ThdLevels[h - 2U] = (((float)h * f0) < (float)ThdLast)
+                        ? (int16_t)THD_Centi(10.0f * log10f(fmaxf(ThdHarmonic[h], 1e-30f) / p1))
+                        : (int16_t)THD_LEVEL_MIN;
+  }
+  harm = fmaxf(harm, 1e-30f);
+
+  ThdResult.Frames      = ThdFrames;
+  ThdResult.Fundamental = (f0 * fs) / n;
+  ThdResult.Level       = 10.0f * log10f((4.0f * p1 / (float)ThdFrames)
+                                         / (n * n * win->Enbw * win->CoherentGain * win->CoherentGain));
+  ThdResult.Thd         = 10.0f * log10f(harm / p1);
+  ThdResult.ThdN        = 10.0f * log10f((harm + noise) / p1);
+  ThdResult.Snr         = 10.0f * log10f(p1 / noise);
+  ThdResult.Sinad       = 10.0f * log10f((p1 + harm + noise) / (harm + noise));
+  ThdResult.Enob        = (ThdResult.Sinad - 1.76f) / 6.02f;
+  ThdValid = 1U;
+
+  header.Seq        = ThdSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = DSP_GetInput()->Rate;
+  header.FftSize    = (uint16_t)ThdConfig.FftSize;
+  header.Window     = (uint8_t)ThdConfig.Window;
+  header.Harmonics  = (uint8_t)ThdConfig.Harmonics;
+  header.Result     = ThdResult;
+  (void)DFR_Send(DFR_TAG_THD, &header, sizeof(header), ThdLevels,
+                 (ThdConfig.Harmonics - 1U) * sizeof(int16_t));
+}
+
+/* Sums of the current result */
+static void THD_Clear(void)
+{
+  ThdFundamental = 0.0f;
+  ThdNoise = 0.0f;
+  ThdFrequency = 0.0f;
+  (void)memset(ThdHarmonic, 0, sizeof(ThdHarmonic));
+  ThdFrames = 0U;
+  ThdCount = 0U;
+}
+
+/* Value x 100, rounded and kept within int16_t */
+static int32_t THD_Centi(float value)
+{
+  value *= 100.0f;
+  if (value > (float)INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  return (value < (float)THD_LEVEL_MIN) ? THD_LEVEL_MIN : (int32_t)lrintf(value);
+}
+
+static int32_t THD_Command(int32_t argc, char *argv[])
+{
+  THD_ConfigTypeDef config = ThdConfig;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      config.FftSize = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "win") == 0) && (argc > 2))
+    {
+      config.Window = WIN_Find(argv[2]);
+    }
+    else if ((strcmp(argv[1], "avg") == 0) && (argc > 2))
+    {
+      config.Average = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "harm") == 0) && (argc > 2))
+    {
+      config.Harmonics = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "bw") == 0) && (argc > 2))
+    {
+      config.Bandwidth = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+      THD_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      THD_Enable(0U);
+    }
+    else
+    {
+      return 1;
+    }
+    if (THD_Configure(&config) != THD_OK)
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"n\":%lu,\"win\":\"%s\",\"avg\":%lu,\"harm\":%lu,\"bw_mhz\":%lu,"
+                   "\"results\":%lu,\"overruns\":%lu,\"cycles\":%lu,\"valid\":%u,\"f0_mhz\":%lu,"
+                   "\"level_cdb\":%ld,\"thd_cdb\":%ld,\"thdn_cdb\":%ld,\"snr_cdb\":%ld,\"sinad_cdb\":%ld,"
+                   "\"enob_x100\":%ld}\r\n",
+                   ThdEnabled, (unsigned long)ThdConfig.FftSize, WIN_GetInfo(ThdConfig.Window)->Name,
+                   (unsigned long)ThdConfig.Average, (unsigned long)ThdConfig.Harmonics,
+                   (unsigned long)ThdConfig.Bandwidth, (unsigned long)ThdSeq, (unsigned long)ThdOverruns,
+                   (unsigned long)ThdCycles, ThdValid, (unsigned long)lrintf(ThdResult.Fundamental * 1000.0f),
+                   (long)THD_Centi(ThdResult.Level), (long)THD_Centi(ThdResult.Thd),
+                   (long)THD_Centi(ThdResult.ThdN), (long)THD_Centi(ThdResult.Snr),
+                   (long)THD_Centi(ThdResult.Sinad), (long)THD_Centi(ThdResult.Enob));
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "thd" command, the measurement starts disabled
+  * @retval None
+  */
+void THD_Init(void)
+{
+  THD_Reset();
+  (void)CON_Register(&THD_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, restarts the measurement
+  * @param  config: New settings
+  * @retval THD_OK, THD_ERROR if a setting is out of range
+  */
+THD_StatusTypeDef THD_Configure(const THD_ConfigTypeDef *config)
+{
+  if ((config->FftSize < 64U) || (config->FftSize > THD_FFT_MAX)
+      || ((config->FftSize & (config->FftSize - 1U)) != 0U) || (config->Window >= WIN_COUNT)
+      || (config->Harmonics < 2U) || (config->Harmonics > THD_HARMONICS_MAX)
+      || (config->Average == 0U) || (config->Average > THD_AVERAGE_MAX))
+  {
+    return THD_ERROR;
+  }
+
+  ThdConfig = *config;
+  THD_Reset();
+  return THD_OK;
+}
+
+/**
+  * @brief  Starts or stops the measurement
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void THD_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (ThdEnabled == 0U))
+  {
+    THD_Reset();
+  }
+  ThdEnabled = enable;
+}
+
+/**
+  * @brief  Drops the frames summed, restarts from the newest samples
+  * @retval None
+  */
+void THD_Reset(void)
+{
+  THD_Clear();
+  ThdRead = DSP_RingWriteIndex(DSP_GetInput());
+}
+
+/**
+  * @brief  Measures the next frame, sends the result when the average is full
+  * @note   Main loop only. One frame per call.
+  * @retval 1 if a full frame is left for the next pass
+  */
+uint8_t THD_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  uint32_t write;
+  uint32_t start;
+
+  if (ThdEnabled == 0U)
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if (DSP_RingIsValid(input, ThdRead) == 0U)
+  {
+    ThdRead = write;
+    ThdOverruns++;
+  }
+  if ((write - ThdRead) < ThdConfig.FftSize)
+  {
+    return 0U;
+  }
+
+  start = DWT->CYCCNT;
+  THD_Analyse(THD_Frame(input));
+  ThdCycles = DWT->CYCCNT - start;
+  ThdRead += ThdConfig.FftSize;
+
+  if (++ThdCount == ThdConfig.Average)
+  {
+    if (ThdFrames != 0U)
+    {
+      THD_Result();
+    }
+    THD_Clear();
+  }
+
+  return ((write - ThdRead) >= ThdConfig.FftSize) ? 1U : 0U;
+}
+
+/**
+  * @brief  Last result
+  * @param  result: Copy of the result
+  * @retval 1 if a result was produced since the measurement started
+  */
+uint8_t THD_GetResult(THD_ResultTypeDef *result)
+{
+  *result = ThdResult;
+  return ThdValid;
+}
@@ -0,0 +1,114 @@
+/**
+  ******************************************************************************
+  * @file    dsp_thd.h
+  * @brief   Distortion and noise measurement of a sine input.
+  ******************************************************************************
+  * @attention
+  *
+  * Frames of FftSize input samples are windowed and transformed; on each
+  * power spectrum the fundamental is the highest bin above DC, refined to
+  * a fraction of a bin by a parabola through the log power of the three
+  * bins around the peak (exact for a Gaussian lobe; errors of about 0.005
+  * bin with Blackman-Harris, 0.02 with Hann, 0.15 with the flat lobe of
+  * the flat-top). The power of a tone is the sum of the bins within the
+  * main lobe of the window, plus one bin, around its frequency; harmonics
+  * 2..Harmonics are taken at multiples of the interpolated fundamental.
+  * What is left between DC and the bandwidth limit is noise, scaled up
+  * for the bins the tones took.
+  * The leakage of the fundamental outside its lobe counts as noise and
+  * limits the SNR to about 44 dB with Hann, 80 dB with the flat-top and
+  * 87 dB with Blackman-Harris, the default.
+  * With 16-bit samples the level and the harmonics of a -1 dBFS tone read
+  * within 0.02 dB down to -70 dBc with Blackman-Harris, 0.05 dB with the
+  * flat-top, whose leakage is higher (Tests/Src/test_dsp_thd.c). A tone
+  * whose period is a whole number of samples, such as 1 kHz at 48 kHz,
+  * repeats its rounding error, which then falls on the harmonics: allow
+  * 0.05 dB at -60 dBc, or use 997 Hz.
+  *
+  * The powers of Average frames are summed, then a DFR_TAG_THD frame
+  * carries, with P1 the fundamental, H the harmonics and N the noise:
+  *
+  *   THD   = 10 log10(H / P1)            dB
+  *   THD+N = 10 log10((H + N) / P1)      dB
+  *   SNR   = 10 log10(P1 / N)            dB
+  *   SINAD = 10 log10((P1 + H + N) / (H + N)) dB
+  *   ENOB  = (SINAD - 1.76) / 6.02       bits
+  *
+  * followed by the level of each harmonic in 0.01 dBc (int16_t, from the
+  * 2nd; THD_LEVEL_MIN if above the band). With the generator as source
+  * (dsp gen) the board is a standalone audio analyser.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_THD_H
+#define __DSP_THD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define THD_FFT_MAX               1024U   /* Real points                       */
+#define THD_HARMONICS_MAX         10U     /* Highest harmonic measured         */
+#define THD_AVERAGE_MAX           64U     /* Frames                            */
+#define THD_LEVEL_MIN             (-20000) /* 0.01 dB                          */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  THD_OK = 0,
+  THD_ERROR,
+} THD_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t          FftSize;    /* Power of two, 64..THD_FFT_MAX            */
+  WIN_WindowTypeDef Window;
+  uint32_t          Harmonics;  /* 2..THD_HARMONICS_MAX                     */
+  uint32_t          Average;    /* Frames per result, 1..THD_AVERAGE_MAX    */
+  uint32_t          Bandwidth;  /* mHz, 0 for fs / 2                        */
+} THD_ConfigTypeDef;
+
+typedef struct
+{
+  uint32_t Frames;      /* Frames with a fundamental                        */
+  float    Fundamental; /* Hz                                               */
+  float    Level;       /* dB re full scale sine                            */
+  float    Thd;         /* dB                                               */
+  float    ThdN;        /* dB                                               */
+  float    Snr;         /* dB                                               */
+  float    Sinad;       /* dB                                               */
+  float    Enob;        /* bits                                             */
+} THD_ResultTypeDef;
+
+/* DFR_TAG_THD header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t          Seq;
+  uint32_t          Tick;
+  uint32_t          SampleRate; /* mHz                                      */
+  uint16_t          FftSize;
+  uint8_t           Window;     /* WIN_WindowTypeDef                        */
+  uint8_t           Harmonics;  /* Levels following the header: Harmonics-1 */
+  THD_ResultTypeDef Result;
+} THD_FrameHeaderTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              THD_Init(void);
+THD_StatusTypeDef THD_Configure(const THD_ConfigTypeDef *config);
+void              THD_Enable(uint8_t enable);
+void              THD_Reset(void);
+uint8_t           THD_Process(void);
+uint8_t           THD_GetResult(THD_ResultTypeDef *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_THD_H */
@@ -0,0 +1,520 @@
+/**
+  ******************************************************************************
+  * @file    dsp_welch.c
+  * @brief   Welch power spectral density estimator.
+  ******************************************************************************
+  * @attention
+  *
+  * Frame starts are queued as pointers into the sample ring, the samples
+  * are only read once, by the windowing that feeds the FFT buffer. One
+  * frame is transformed per DSP_Process() pass. A frame overwritten by the
+  * producer before it could be processed is dropped and counted as an
+  * overrun.
+  *
+  * Scaling: the window output is x w 2^30 and FFT_Real() divides by 2^e,
+  * so |DFT(x w)|^2 = P 2^(2e - 60) with P = Re^2 + Im^2 < 2^61. The one
+  * sided density is 2 |DFT|^2 / (fs N S2), S2 = mean(w^2) = ENBW CG^2.
+  * The block exponent e follows the level of each frame: the average
+  * keeps the largest one seen, frames of a smaller exponent are shifted
+  * down to it and the average is shifted when a larger one comes.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "governor.h"
+#include "dsp_app.h"
+#include "dsp_decim.h"
+#include "dsp_fft.h"
+#include "dsp_frame.h"
+#include "dsp_welch.h"
+
+/* Private define ------------------------------------------------------------*/
+#define WEL_BINS_MAX              ((WEL_FFT_MAX / 2U) + 1U)
+
+#if ((WEL_FFT_MAX / 2U) > DSP_SCRATCH_SIZE)
+#error "WEL_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  const int16_t *Ptr;     /* First sample in the ring                     */
+  uint32_t       Start;   /* Its sample index                             */
+} WEL_SliceTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t WelAccu[WEL_BINS_MAX];
+static uint32_t WelChunk[WEL_CHUNK_BINS];
+
+static WEL_ConfigTypeDef WelConfig =
+{
+  .FftSize  = WEL_FFT_MAX,
+  .Overlap  = 50U,
+  .Window   = WIN_HANN,
+  .Average  = WEL_AVG_LINEAR,
+  .ExpShift = 3U,
+  .RateMs   = 500U,
+};
+
+static uint8_t  WelEnabled;
+static const DSP_RingTypeDef *WelRing;   /* Decimation output           */
+static uint32_t WelSize;        /* FFT size in use                          */
+static int32_t  WelExponent;    /* Block exponent of the average            */
+static uint32_t WelNext;        /* Start of the next frame                  */
+static WEL_SliceTypeDef WelQueue[WEL_QUEUE_SIZE];
+static uint32_t WelQueueHead;
+static uint32_t WelQueueTail;
+
+static uint32_t WelFrames;      /* In the average                           */
+static uint32_t WelTotal;
+static uint32_t WelOverruns;
+static uint32_t WelSeq;
+static uint32_t WelReportTick;
+static uint32_t WelCycles;
+static uint32_t WelCyclesMax;
+
+static const char *const WEL_AverageNames[WEL_AVG_COUNT] = { "lin", "exp", "peak" };
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t WEL_Size(void);
+static void     WEL_Queue(void);
+static int32_t  WEL_Frame(const WEL_SliceTypeDef *slice);
+static void     WEL_Accumulate(int32_t exponent);
+static void     WEL_Report(void);
+static int32_t  WEL_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef WEL_ConsoleCommand =
+{
+  .Name    = "psd",
+  .Help    = "psd [n <size>|overlap <0|50|75>|win <hann|bh|flattop>|avg <lin|exp|peak> [shift]"
+             "|rate <ms>|on|off|reset] - Welch PSD",
+  .Handler = WEL_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* FFT size allowed by the configuration, the buffers and the clock profile */
+static uint32_t WEL_Size(void)
+{
+  uint32_t size = WelConfig.FftSize;
+
+  if (size > WEL_FFT_MAX)
+  {
+    size = WEL_FFT_MAX;
+  }
+  if (size > GOV_GetLimits()->MaxFftSize)
+  {
+    size = GOV_GetLimits()->MaxFftSize;
+  }
+  return size;
+}
+
+/* Queues the frames available in the ring */
+static void WEL_Queue(void)
+{
+  uint32_t write = DSP_RingWriteIndex(WelRing);
+  uint32_t hop = (WelSize * (100U - WelConfig.Overlap)) / 100U;
+  uint32_t len;
+
+  while ((write - WelNext) >= WelSize)
+  {
+    if (DSP_RingIsValid(WelRing, WelNext) == 0U)
+    {
+      /* Fell behind the producer: restart from the newest complete frame */
+      WelNext = write - WelSize;
+      WelOverruns++;
+      continue;
+    }
+    if ((WelQueueHead - WelQueueTail) == WEL_QUEUE_SIZE)
+    {
+      break;
+    }
+    WelQueue[WelQueueHead % WEL_QUEUE_SIZE].Ptr   = DSP_RingSamples(WelRing, WelNext, &len);
+    WelQueue[WelQueueHead % WEL_QUEUE_SIZE].Start = WelNext;
+    WelQueueHead++;
+    WelNext += hop;
+  }
+}
+
+/* Window and transform one frame into the scratch buffer, returns its exponent */
+static int32_t WEL_Frame(const WEL_SliceTypeDef *slice)
+{
+  FFT_CpxTypeDef *fft = DSP_GetScratch();
+  const int16_t *wrap;
+  uint32_t len;
+  uint32_t avail;
+
+  (void)DSP_RingSamples(WelRing, slice->Start, &len);
+  if (len > WelSize)
+  {
+    len = WelSize;
+  }
+  wrap = DSP_RingSamples(WelRing, slice->Start + len, &avail);
+  WIN_Apply(WelConfig.Window, WelSize, slice->Ptr, len, wrap, (int32_t *)fft);
+  return FFT_Real(fft, WelSize);
+}
+
+/* Adds the power of the frame in the scratch buffer to the average */
+static void WEL_Accumulate(int32_t exponent)
+{
+  const FFT_CpxTypeDef *fft = DSP_GetScratch();
+  uint32_t bins = WelSize / 2U;
+  uint32_t shift = 0U;    /* Of the frame powers, to the average exponent */
+  uint32_t k;
+  uint64_t p;
+
+  /* Powers move by 2 bits per step of the exponent */
+  if (WelFrames == 0U)
+  {
+    WelExponent = exponent;
+  }
+  else if (exponent > WelExponent)
+  {
+    shift = 2U * (uint32_t)(exponent - WelExponent);
+    for (k = 0U; k <= bins; k++)
+    {
+      WelAccu[k] = (shift < 64U) ? (WelAccu[k] >> shift) : 0U;
+    }
+    WelExponent = exponent;
+    shift = 0U;
+  }
+  else
+  {
+    shift = 2U * (uint32_t)(WelExponent - exponent);
+  }
+
+  for (k = 0U; k <= bins; k++)
+  {
+    if (k == 0U)
+    {
+      p = (uint64_t)((int64_t)fft[0].Re * fft[0].Re);
+    }
+    else if (k == bins)
+    {
+      p = (uint64_t)((int64_t)fft[0].Im * fft[0].Im);
+    }
+    else
+    {
+      p = (uint64_t)((int64_t)fft[k].Re * fft[k].Re)
+        + (uint64_t)((int64_t)fft[k].Im * fft[k].Im);
+    }
+    p = (shift < 64U) ? (p >> shift) : 0U;
+
+    switch (WelConfig.Average)
+    {
+      case WEL_AVG_LINEAR:
+        WelAccu[k] += p >> WEL_LINEAR_SHIFT;
+        break;
+      case WEL_AVG_EXP:
+        if (WelFrames == 0U)
+        {
+          WelAccu[k] = p;
+        }
+        else
+        {
+          WelAccu[k] = (uint64_t)((int64_t)WelAccu[k]
+                                  + (((int64_t)p - (int64_t)WelAccu[k]) >> WelConfig.ExpShift));
+        }
+        break;
+      default:
+        if (p > WelAccu[k])
+        {
+          WelAccu[k] = p;
+        }
+        break;
+    }
+  }
+  WelFrames++;
+  WelTotal++;
+}
+
+/* Sends the spectrum, all chunks or none */
+static void WEL_Report(void)
+{
+  WEL_FrameHeaderTypeDef header;
+  const WIN_InfoTypeDef *win = WIN_GetInfo(WelConfig.Window);
+  uint32_t bins = (WelSize / 2U) + 1U;
+  uint32_t chunks = (bins + WEL_CHUNK_BINS - 1U) / WEL_CHUNK_BINS;
+  uint64_t peak = 0U;
+  uint32_t shift = 0U;
+  uint32_t first;
+  uint32_t count;
+  uint32_t i;
+  float scale;
+
+  for (i = 0U; i < bins; i++)
+  {
+    if (WelAccu[i] > peak)
+    {
+      peak = WelAccu[i];
+    }
+  }
+  /* Interior bins are doubled (one-sided) */
+  peak <<= 1U;
+  if ((uint32_t)(peak >> 32U) != 0U)
+  {
+    shift = 32U - __CLZ((uint32_t)(peak >> 32U));
+  }
+
+  scale = ldexpf(1.0f, (2 * WelExponent) - 60)
+          / (((float)WelRing->Rate / 1000.0f) * (float)WelSize * win->Enbw * win->CoherentGain * win->CoherentGain);
+  if (WelConfig.Average == WEL_AVG_LINEAR)
+  {
+    scale = ldexpf(scale, (int32_t)WEL_LINEAR_SHIFT) / (float)WelFrames;
+  }
+
+  header.Seq        = WelSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = WelRing->Rate;
+  header.Frames     = WelFrames;
+  header.Scale      = scale;
+  header.FftSize    = (uint16_t)WelSize;
+  header.Window     = (uint8_t)WelConfig.Window;
+  header.Average    = (uint8_t)WelConfig.Average;
+  header.Exp        = (int8_t)shift;
+  header.BlockExp   = (int8_t)WelExponent;
+
+  if (DFR_Fits(chunks, (chunks * sizeof(header)) + (bins * sizeof(uint32_t))) == 0U)
+  {
+    DFR_Drop(chunks);
+    return;
+  }
+
+  for (first = 0U; first < bins; first += count)
+  {
+    count = ((bins - first) > WEL_CHUNK_BINS) ? WEL_CHUNK_BINS : (bins - first);
+    for (i = 0U; i < count; i++)
+    {
+      if (((first + i) == 0U) || ((first + i) == (bins - 1U)))
+      {
+        WelChunk[i] = (uint32_t)(WelAccu[first + i] >> shift);
+      }
+      else
+      {
+        WelChunk[i] = (uint32_t)((WelAccu[first + i] << 1U) >> shift);
+      }
+    }
+    header.FirstBin = (uint16_t)first;
+    header.Bins     = (uint16_t)count;
+    (void)DFR_Send(DFR_TAG_PSD, &header, sizeof(header), WelChunk, count * sizeof(uint32_t));
+  }
+}
+
+static int32_t WEL_Command(int32_t argc, char *argv[])
+{
+  WEL_ConfigTypeDef config = WelConfig;
+  DFR_StatsTypeDef stats;
+  uint32_t average;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      config.FftSize = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "overlap") == 0) && (argc > 2))
+    {
+      config.Overlap = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "win") == 0) && (argc > 2))
+    {
+      config.Window = WIN_Find(argv[2]);
+    }
+    else if ((strcmp(argv[1], "avg") == 0) && (argc > 2))
+    {
+      for (average = 0U; average < WEL_AVG_COUNT; average++)
+      {
+        if (strcmp(argv[2], WEL_AverageNames[average]) == 0)
+        {
+          break;
+        }
+      }
+      config.Average = (WEL_AverageTypeDef)average;
+      if (argc > 3)
+      {
+        config.ExpShift = (uint32_t)strtoul(argv[3], NULL, 0);
+      }
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      config.RateMs = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+      WEL_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      WEL_Enable(0U);
+    }
+    else if (strcmp(argv[1], "reset") == 0)
+    {
+      WEL_Reset();
+    }
+    else
+    {
+      return 1;
+    }
+    if (WEL_Configure(&config) != WEL_OK)
+    {
+      return 1;
+    }
+  }
+
+  DFR_GetStats(&stats);
+  (void)CON_Printf("{\"on\":%u,\"n\":%lu,\"n_cfg\":%lu,\"overlap\":%lu,\"win\":\"%s\",\"enbw_x1000\":%lu,"
+                   "\"avg\":\"%s\",\"exp_shift\":%lu,\"rate_ms\":%lu,\"fs_mhz\":%lu,\"frames\":%lu,\"total\":%lu,"
+                   "\"reports\":%lu,\"overruns\":%lu,\"dropped\":%lu,\"cycles\":%lu,\"cycles_max\":%lu}\r\n",
+                   WelEnabled, (unsigned long)WelSize, (unsigned long)WelConfig.FftSize,
+                   (unsigned long)WelConfig.Overlap, WIN_GetInfo(WelConfig.Window)->Name,
+                   (unsigned long)(WIN_GetInfo(WelConfig.Window)->Enbw * 1000.0f + 0.5f),
+                   WEL_AverageNames[WelConfig.Average], (unsigned long)WelConfig.ExpShift,
+                   (unsigned long)WelConfig.RateMs, (unsigned long)WelRing->Rate,
+                   (unsigned long)WelFrames, (unsigned long)WelTotal, (unsigned long)WelSeq,
+                   (unsigned long)WelOverruns, (unsigned long)stats.Dropped,
+                   (unsigned long)WelCycles, (unsigned long)WelCyclesMax);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "psd" command, the estimator starts disabled
+  * @retval None
+  */
+void WEL_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  WEL_Reset();
+  (void)CON_Register(&WEL_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, restarts the average
+  * @param  config: New settings
+  * @retval WEL_OK, WEL_ERROR if a setting is out of range
+  */
+WEL_StatusTypeDef WEL_Configure(const WEL_ConfigTypeDef *config)
+{
+  if ((config->FftSize < FFT_SIZE_MIN) || (config->FftSize > FFT_SIZE_MAX)
+      || ((config->FftSize & (config->FftSize - 1U)) != 0U)
+      || ((config->Overlap != 0U) && (config->Overlap != 50U) && (config->Overlap != 75U))
+      || (config->Window >= WIN_COUNT) || (config->Average >= WEL_AVG_COUNT)
+      || (config->ExpShift == 0U) || (config->ExpShift > 15U) || (config->RateMs == 0U))
+  {
+    return WEL_ERROR;
+  }
+
+  if (memcmp(config, &WelConfig, sizeof(WelConfig)) != 0)
+  {
+    WelConfig = *config;
+    WEL_Reset();
+  }
+  return WEL_OK;
+}
+
+/**
+  * @brief  Current settings
+  * @param  config: Filled with the settings
+  * @retval None
+  */
+void WEL_GetConfig(WEL_ConfigTypeDef *config)
+{
+  *config = WelConfig;
+}
+
+/**
+  * @brief  Starts or stops the estimator
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void WEL_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (WelEnabled == 0U))
+  {
+    WEL_Reset();
+  }
+  WelEnabled = enable;
+}
+
+/**
+  * @brief  Clears the average and restarts from the newest samples
+  * @retval None
+  */
+void WEL_Reset(void)
+{
+  WelRing = DEC_GetOutput();
+  WelSize = WEL_Size();
+  WelNext = DSP_RingWriteIndex(WelRing);
+  WelQueueTail = WelQueueHead;
+  WelFrames = 0U;
+  WelReportTick = HAL_GetTick();
+  (void)memset(WelAccu, 0, sizeof(WelAccu));
+}
+
+/**
+  * @brief  Processes at most one frame, reports when due
+  * @note   Main loop only.
+  * @retval 1 if frames are waiting
+  */
+uint8_t WEL_Process(void)
+{
+  WEL_SliceTypeDef slice;
+  uint32_t start;
+  int32_t exponent;
+
+  if (WelEnabled == 0U)
+  {
+    return 0U;
+  }
+  if (WEL_Size() != WelSize)
+  {
+    WEL_Reset();
+  }
+
+  WEL_Queue();
+
+  if (WelQueueHead != WelQueueTail)
+  {
+    slice = WelQueue[WelQueueTail % WEL_QUEUE_SIZE];
+    WelQueueTail++;
+
+    start = DWT->CYCCNT;
+    exponent = WEL_Frame(&slice);
+    /* The producer may have overwritten the frame while it was read */
+    if (DSP_RingIsValid(WelRing, slice.Start) != 0U)
+    {
+      WEL_Accumulate(exponent);
+    }
+    else
+    {
+      WelOverruns++;
+    }
+    WelCycles = DWT->CYCCNT - start;
+    if (WelCycles > WelCyclesMax)
+    {
+      WelCyclesMax = WelCycles;
+    }
+  }
+
+  if ((WelFrames != 0U)
+      && (((HAL_GetTick() - WelReportTick) >= WelConfig.RateMs)
+          || ((WelConfig.Average == WEL_AVG_LINEAR) && (WelFrames >= WEL_LINEAR_FRAMES_MAX))))
+  {
+    WEL_Report();
+    WelReportTick = HAL_GetTick();
+    if (WelConfig.Average == WEL_AVG_LINEAR)
+    {
+      WelFrames = 0U;
+      (void)memset(WelAccu, 0, sizeof(WelAccu));
+    }
+  }
+
+  return (WelQueueHead != WelQueueTail) ? 1U : 0U;
+}
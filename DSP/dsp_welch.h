@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file    dsp_welch.h
+  * @brief   Welch power spectral density estimator.
+  ******************************************************************************
+  * @attention
+  *
+  * Frames of FftSize samples are taken from the decimation output every
+  * FftSize * (100 - Overlap) / 100 samples, windowed, transformed with
+  * FFT_Real() and their power |X[k]|^2 accumulated in 64 bits:
+  *
+  *  - WEL_AVG_LINEAR: sum of the frames since the last report,
+  *  - WEL_AVG_EXP:    exponential average, weight 2^-ExpShift,
+  *  - WEL_AVG_PEAK:   maximum of each bin since the last reset.
+  *
+  * Every RateMs the one-sided spectrum (bins 0..FftSize/2) is sent as
+  * DFR_TAG_PSD frames of at most WEL_CHUNK_BINS uint32 mantissas, all the
+  * frames of a report or none. In FS^2/Hz (FS = int16 full scale):
+  *
+  *   PSD[FirstBin + i] = mantissa[i] * 2^Exp * Scale
+  *
+  * The FFT size is capped by WEL_FFT_MAX (RAM) and by the FFT limit of the
+  * clock profile in use.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_WELCH_H
+#define __DSP_WELCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef WEL_FFT_MAX
+#define WEL_FFT_MAX               1024U   /* Largest FFT, sizes the buffers    */
+#endif /* WEL_FFT_MAX */
+#define WEL_CHUNK_BINS            256U    /* Bins per DFR_TAG_PSD frame        */
+#define WEL_QUEUE_SIZE            8U      /* Frames waiting for the FFT        */
+#define WEL_LINEAR_SHIFT          7U      /* Power scaling of the linear sum   */
+#define WEL_LINEAR_FRAMES_MAX     256U    /* Then the sum is reported early    */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  WEL_AVG_LINEAR = 0,
+  WEL_AVG_EXP,
+  WEL_AVG_PEAK,
+  WEL_AVG_COUNT,
+} WEL_AverageTypeDef;
+
+typedef struct
+{
+  uint32_t           FftSize;   /* Power of two, FFT_SIZE_MIN..WEL_FFT_MAX  */
+  uint32_t           Overlap;   /* 0, 50 or 75 %                            */
+  WIN_WindowTypeDef  Window;
+  WEL_AverageTypeDef Average;
+  uint32_t           ExpShift;  /* 1..15, WEL_AVG_EXP weight 2^-ExpShift    */
+  uint32_t           RateMs;    /* Report period                            */
+} WEL_ConfigTypeDef;
+
+typedef enum
+{
+  WEL_OK = 0,
+  WEL_ERROR,
+} WEL_StatusTypeDef;
+
+/* DFR_TAG_PSD header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Seq;         /* Report number                                    */
+  uint32_t Tick;        /* HAL tick of the report                           */
+  uint32_t SampleRate;  /* mHz                                              */
+  uint32_t Frames;      /* Frames in the average                            */
+  float    Scale;       /* FS^2/Hz per mantissa LSB, before 2^Exp           */
+  uint16_t FftSize;
+  uint16_t FirstBin;
+  uint16_t Bins;        /* uint32_t mantissas following the header          */
+  uint8_t  Window;      /* WIN_WindowTypeDef                                */
+  uint8_t  Average;     /* WEL_AverageTypeDef                               */
+  int8_t   Exp;
+  int8_t   BlockExp;    /* FFT block exponent of the average, in Scale      */
+} WEL_FrameHeaderTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              WEL_Init(void);
+WEL_StatusTypeDef WEL_Configure(const WEL_ConfigTypeDef *config);
+void              WEL_GetConfig(WEL_ConfigTypeDef *config);
+void              WEL_Enable(uint8_t enable);
+void              WEL_Reset(void);
+uint8_t           WEL_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_WELCH_H */
@@ -0,0 +1,185 @@
+/**
+  ******************************************************************************
+  * @file    dsp_window.c
+  * @brief   Analysis windows for the spectral estimators.
+  ******************************************************************************
+  * @attention
+  *
+  * Coefficients of the generalised cosine windows in dsp_tables.c:
+  *
+  *   Hann             0.5, 0.5
+  *   Blackman-Harris  0.35875, 0.48829, 0.14128, 0.01168 (4 term, -92 dB)
+  *   Flat-top         0.21557895, 0.41663158, 0.277263158, 0.083578947,
+  *                    0.006947368 (HFT70 family, scallop loss < 0.01 dB)
+  *
+  * Coherent gain is a0; ENBW = N sum(w^2) / sum(w)^2.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "dsp_tables.h"
+#include "dsp_window.h"
+
+/* Private define ------------------------------------------------------------*/
+#define WIN_HALF                  (DSP_TABLE_SIZE / 2U)
+
+/* Private variables ---------------------------------------------------------*/
+static const WIN_InfoTypeDef WIN_Infos[WIN_COUNT] =
+{
+  { "hann",    TBL_HannQ15,            0.5f,        1.5f,        2U },
+  { "bh",      TBL_BlackmanHarrisQ15,  0.35875f,    2.00435294f, 4U },
+  { "flattop", TBL_FlatTopQ15,         0.21557895f, 3.77024645f, 5U },
+};
+
+#define WIN_Q30_TO_F32            9.313225746e-10f  /* 2^-30 */
+
+/* Private function prototypes -----------------------------------------------*/
+static void WIN_Segment(const int16_t *table, uint32_t step, uint32_t first,
+                        const int16_t *src, uint32_t len, int32_t *dst);
+static void WIN_SegmentF32(const int16_t *table, uint32_t step, uint32_t first,
+                           const int16_t *src, uint32_t len, float *dst);
+
+/* Private functions ---------------------------------------------------------*/
+/* dst[i] = src[i] * w[first + i], the table is mirrored past its centre */
+CCMRAM_TEXT static void WIN_Segment(const int16_t *table, uint32_t step, uint32_t first,
+                        const int16_t *src, uint32_t len, int32_t *dst)
+{
+  uint32_t j = first * step;
+  uint32_t i;
+
+  for (i = 0U; (i < len) && (j <= WIN_HALF); i++, j += step)
+  {
+    dst[i] = (int32_t)src[i] * table[j];
+  }
+  for (; i < len; i++, j += step)
+  {
+    dst[i] = (int32_t)src[i] * table[DSP_TABLE_SIZE - j];
+  }
+}
+
+/* Same, as float in full scale units */
+CCMRAM_TEXT static void WIN_SegmentF32(const int16_t *table, uint32_t step, uint32_t first,
+                           const int16_t *src, uint32_t len, float *dst)
+{
+  uint32_t j = first * step;
+  uint32_t i;
+
+  for (i = 0U; (i < len) && (j <= WIN_HALF); i++, j += step)
+  {
+    dst[i] = (float)((int32_t)src[i] * table[j]) * WIN_Q30_TO_F32;
+  }
+  for (; i < len; i++, j += step)
+  {
+    dst[i] = (float)((int32_t)src[i] * table[DSP_TABLE_SIZE - j]) * WIN_Q30_TO_F32;
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Window description
+  * @param  window: WIN_WindowTypeDef
+  * @retval Pointer to a constant descriptor
+  */
+const WIN_InfoTypeDef *WIN_GetInfo(WIN_WindowTypeDef window)
+{
+  return &WIN_Infos[(window < WIN_COUNT) ? window : WIN_HANN];
+}
+
+/**
+  * @brief  Looks a window up by name
+  * @param  name: "hann", "bh" or "flattop"
+  * @retval WIN_WindowTypeDef, WIN_COUNT if unknown
+  */
+WIN_WindowTypeDef WIN_Find(const char *name)
+{
+  uint32_t window;
+
+  for (window = 0U; window < WIN_COUNT; window++)
+  {
+    if (strcmp(name, WIN_Infos[window].Name) == 0)
+    {
+      break;
+    }
+  }
+  return (WIN_WindowTypeDef)window;
+}
+
+/**
+  * @brief  Windows n samples read from a ring buffer
+  * @note   The output is q30 (q15 x q15, not shifted), FFT_Real() scales
+  *         the block to its peak.
+  * @param  window: WIN_WindowTypeDef
+  * @param  n: Window length, power of two <= DSP_TABLE_SIZE
+  * @param  src1: First samples, up to the end of the ring
+  * @param  len1: Samples in src1, <= n
+  * @param  src2: Following n - len1 samples, start of the ring
+  * @param  dst: n q30 values
+  * @retval None
+  */
+void WIN_Apply(WIN_WindowTypeDef window, uint32_t n,
+               const int16_t *src1, uint32_t len1,
+               const int16_t *src2, int32_t *dst)
+{
+  const int16_t *table = WIN_GetInfo(window)->Table;
+  uint32_t step = DSP_TABLE_SIZE / n;
+
+  WIN_Segment(table, step, 0U, src1, len1, dst);
+  if (len1 < n)
+  {
+    WIN_Segment(table, step, len1, src2, n - len1, &dst[len1]);
+  }
+}
+
+/**
+  * @brief  Windows n samples read from a ring buffer, single precision
+  * @note   Same values as WIN_Apply() scaled by 2^-30: a full scale sample
+  *         is 1.0, the layout is the input of FFT_RealF32().
+  * @param  window: WIN_WindowTypeDef
+  * @param  n: Window length, power of two <= DSP_TABLE_SIZE
+  * @param  src1: First samples, up to the end of the ring
+  * @param  len1: Samples in src1, <= n
+  * @param  src2: Following n - len1 samples, start of the ring
+  * @param  dst: n float values
+  * @retval None
+  */
+void WIN_ApplyF32(WIN_WindowTypeDef window, uint32_t n,
+                  const int16_t *src1, uint32_t len1,
+                  const int16_t *src2, float *dst)
+{
+  const int16_t *table = WIN_GetInfo(window)->Table;
+  uint32_t step = DSP_TABLE_SIZE / n;
+
+  WIN_SegmentF32(table, step, 0U, src1, len1, dst);
+  if (len1 < n)
+  {
+    WIN_SegmentF32(table, step, len1, src2, n - len1, &dst[len1]);
+  }
+}
+
+/**
+  * @brief  Windows n complex samples
+  * @note   q30 output, as WIN_Apply().
+  * @param  window: WIN_WindowTypeDef
+  * @param  n: Window length, power of two <= DSP_TABLE_SIZE
+  * @param  iq: n interleaved I/Q pairs
+  * @param  dst: n interleaved q30 I/Q pairs
+  * @retval None
+  */
+void WIN_ApplyComplex(WIN_WindowTypeDef window, uint32_t n, const int16_t *iq, int32_t *dst)
+{
+  const int16_t *table = WIN_GetInfo(window)->Table;
+  uint32_t step = DSP_TABLE_SIZE / n;
+  uint32_t j = 0U;
+  int32_t w;
+  uint32_t i;
+
+  for (i = 0U; i < n; i++, j += step)
+  {
+    w = table[(j <= WIN_HALF) ? j : (DSP_TABLE_SIZE - j)];
+    dst[2U * i]        = (int32_t)iq[2U * i] * w;
+    dst[(2U * i) + 1U] = (int32_t)iq[(2U * i) + 1U] * w;
+  }
+}
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    dsp_window.h
+  * @brief   Analysis windows for the spectral estimators.
+  ******************************************************************************
+  * @attention
+  *
+  * Windows of any power of two length up to DSP_TABLE_SIZE are read from
+  * the q15 tables of dsp_tables.c. WIN_Apply() windows int16 samples taken
+  * from a ring buffer (two segments) into q30 values laid out as the
+  * packed input of FFT_Real(); WIN_ApplyComplex() does the same for
+  * interleaved I/Q samples and FFT_Complex(), WIN_ApplyF32() in float for
+  * FFT_RealF32().
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_WINDOW_H
+#define __DSP_WINDOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  WIN_HANN = 0,
+  WIN_BLACKMAN_HARRIS,
+  WIN_FLAT_TOP,
+  WIN_COUNT,
+} WIN_WindowTypeDef;
+
+typedef struct
+{
+  const char    *Name;
+  const int16_t *Table;
+  float          CoherentGain;  /* mean(w), amplitude correction          */
+  float          Enbw;          /* Equivalent noise bandwidth, bins       */
+  uint32_t       Lobe;          /* Half width of the main lobe, bins      */
+} WIN_InfoTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+const WIN_InfoTypeDef *WIN_GetInfo(WIN_WindowTypeDef window);
+WIN_WindowTypeDef      WIN_Find(const char *name);
+void                   WIN_Apply(WIN_WindowTypeDef window, uint32_t n,
+                                 const int16_t *src1, uint32_t len1,
+                                 const int16_t *src2, int32_t *dst);
+void                   WIN_ApplyF32(WIN_WindowTypeDef window, uint32_t n,
+                                    const int16_t *src1, uint32_t len1,
+                                    const int16_t *src2, float *dst);
+void                   WIN_ApplyComplex(WIN_WindowTypeDef window, uint32_t n,
+                                        const int16_t *iq, int32_t *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_WINDOW_H */
@@ -0,0 +1,349 @@
+/**
+  ******************************************************************************
+  * @file    dsp_xfer.c
+  * @brief   Cross spectrum, transfer function and coherence of the input pair.
+  ******************************************************************************
+  * @attention
+  *
+  * The two channels are interleaved into a frame of int16 I/Q pairs so
+  * that WIN_ApplyComplex() windows both at once. The spectra are scaled
+  * back by the block exponent of each FFT before they are averaged as
+  * float, frames of different exponents then add up; H and the coherence
+  * being ratios, no other normalisation is needed.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_fft.h"
+#include "dsp_frame.h"
+#include "dsp_xfer.h"
+
+/* Private define ------------------------------------------------------------*/
+#define XFR_BINS_MAX              ((XFR_FFT_MAX / 2U) + 1U)
+
+#if (XFR_FFT_MAX > DSP_SCRATCH_SIZE)
+#error "XFR_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+#if (XFR_CHUNK_BINS > DSP_SCRATCH_SIZE)   /* 8-byte bins over 8-byte values */
+#error "XFR_CHUNK_BINS does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static XFR_ConfigTypeDef XfrConfig =
+{
+  .FftSize = XFR_FFT_MAX,
+  .Window  = WIN_HANN,
+  .Average = 16U,
+  .RateMs  = 1000U,
+};
+
+static int16_t  XfrFrame[2U * XFR_FFT_MAX];   /* x, y pairs                  */
+
+/* Averaged spectra, FS^2 per bin of an unnormalised DFT */
+static float    XfrGxx[XFR_BINS_MAX];
+static float    XfrGyy[XFR_BINS_MAX];
+static float    XfrGxyRe[XFR_BINS_MAX];
+static float    XfrGxyIm[XFR_BINS_MAX];
+
+static uint8_t  XfrEnabled;
+static uint32_t XfrRead;
+static uint32_t XfrFrames;
+static uint32_t XfrSeq;
+static uint32_t XfrOverruns;
+static uint32_t XfrCycles;
+static uint32_t XfrReportTick;
+static float    XfrCoherence;   /* Mean over the bins of the last report   */
+
+/* Private function prototypes -----------------------------------------------*/
+static void    XFR_Frame(void);
+static void    XFR_Report(void);
+static int32_t XFR_Centi(float value);
+static int32_t XFR_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef XFR_ConsoleCommand =
+{
+  .Name    = "xfer",
+  .Help    = "xfer [on|off|n <size>|win <hann|bh|flattop>|avg <frames>|rate <ms>] - H1, H2, coherence y/x",
+  .Handler = XFR_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Transforms the next frame of both channels, adds it to the averages */
+static void XFR_Frame(void)
+{
+  FFT_CpxTypeDef *fft = DSP_GetScratch();
+  uint32_t n = XfrConfig.FftSize;
+  uint32_t done;
+  uint32_t len;
+  uint32_t i;
+  uint32_t k;
+  const int16_t *x;
+  const int16_t *y;
+  float scale;
+  float alpha;
+  float xr;
+  float xi;
+  float yr;
+  float yi;
+
+  for (done = 0U; done < n; done += len)
+  {
+    x = DSP_RingSamples(DSP_GetInput(), XfrRead + done, &len);
+    y = DSP_RingSamples(DSP_GetInputY(), XfrRead + done, &len);
+    if (len > (n - done))
+    {
+      len = n - done;
+    }
+    for (i = 0U; i < len; i++)
+    {
+      XfrFrame[2U * (done + i)]        = x[i];
+      XfrFrame[(2U * (done + i)) + 1U] = y[i];
+    }
+  }
+  WIN_ApplyComplex(XfrConfig.Window, n, XfrFrame, (int32_t *)fft);
+
+  /* Halves of the separation folded in: X, Y in full scale units */
+  scale = ldexpf(0.5f, FFT_Complex(fft, n) - 30);
+  XfrFrames++;
+  alpha = 1.0f / (float)((XfrFrames < XfrConfig.Average) ? XfrFrames : XfrConfig.Average);
+
+  for (k = 0U; k <= (n / 2U); k++)
+  {
+    i = (n - k) & (n - 1U);
+    xr = scale * ((float)fft[k].Re + (float)fft[i].Re);
+    xi = scale * ((float)fft[k].Im - (float)fft[i].Im);
+    yr = scale * ((float)fft[k].Im + (float)fft[i].Im);
+    yi = scale * ((float)fft[i].Re - (float)fft[k].Re);
+
+    XfrGxx[k]   += alpha * (((xr * xr) + (xi * xi)) - XfrGxx[k]);
+    XfrGyy[k]   += alpha * (((yr * yr) + (yi * yi)) - XfrGyy[k]);
+    XfrGxyRe[k] += alpha * (((xr * yr) + (xi * yi)) - XfrGxyRe[k]);
+    XfrGxyIm[k] += alpha * (((xr * yi) - (xi * yr)) - XfrGxyIm[k]);
+  }
+}
+
+/* H1, H2 and coherence of every bin, DFR_TAG_XFER frames */
+static void XFR_Report(void)
+{
+  XFR_FrameHeaderTypeDef header;
+  XFR_BinTypeDef *chunk = (XFR_BinTypeDef *)DSP_GetScratch();
+  uint32_t bins = (XfrConfig.FftSize / 2U) + 1U;
+  uint32_t chunks = (bins + XFR_CHUNK_BINS - 1U) / XFR_CHUNK_BINS;
+  uint32_t count;
+  uint32_t k;
+  uint32_t i;
+  float cross;
+  float power;
+  float sum = 0.0f;
+
+  header.Seq        = XfrSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = DSP_GetInput()->Rate;
+  header.Frames     = XfrFrames;
+  header.Average    = (uint16_t)XfrConfig.Average;
+  header.FftSize    = (uint16_t)XfrConfig.FftSize;
+  header.Window     = (uint8_t)XfrConfig.Window;
+  header.Reserved   = 0U;
+
+  if (DFR_Fits(chunks, (chunks * sizeof(header)) + (bins * sizeof(XFR_BinTypeDef))) == 0U)
+  {
+    DFR_Drop(chunks);
+    return;
+  }
+
+  for (k = 0U; k < bins; k += count)
+  {
+    count = ((bins - k) > XFR_CHUNK_BINS) ? XFR_CHUNK_BINS : (bins - k);
+    for (i = 0U; i < count; i++)
+    {
+      cross = (XfrGxyRe[k + i] * XfrGxyRe[k + i]) + (XfrGxyIm[k + i] * XfrGxyIm[k + i]);
+      power = XfrGxx[k + i] * XfrGyy[k + i];
+
+      /* |H1|^2 = |Gxy|^2 / Gxx^2, |H2|^2 = Gyy^2 / |Gxy|^2 */
+      chunk[i].H1 = XFR_LEVEL_MIN;
+      chunk[i].H2 = XFR_LEVEL_MIN;
+      if (cross > 0.0f)
+      {
+        chunk[i].H1 = (int16_t)XFR_Centi(10.0f * log10f(cross / (XfrGxx[k + i] * XfrGxx[k + i])));
+        chunk[i].H2 = (int16_t)XFR_Centi(10.0f * log10f((XfrGyy[k + i] * XfrGyy[k + i]) / cross));
+      }
+      chunk[i].Phase = (int16_t)lrintf(atan2f(XfrGxyIm[k + i], XfrGxyRe[k + i]) * (18000.0f / (float)M_PI));
+      power = (power > 0.0f) ? fminf(cross / power, 1.0f) : 0.0f;
+      chunk[i].Coherence = (uint16_t)lrintf(power * 65535.0f);
+      sum += power;
+    }
+    header.FirstBin = (uint16_t)k;
+    header.Bins     = (uint16_t)count;
+    (void)DFR_Send(DFR_TAG_XFER, &header, sizeof(header), chunk, count * sizeof(XFR_BinTypeDef));
+  }
+  XfrCoherence = sum / (float)bins;
+}
+
+/* Value x 100, rounded and kept within int16_t */
+static int32_t XFR_Centi(float value)
+{
+  value *= 100.0f;
+  if (value > (float)INT16_MAX)
+  {
+    return INT16_MAX;
+  }
+  return (value < (float)XFR_LEVEL_MIN) ? XFR_LEVEL_MIN : (int32_t)lrintf(value);
+}
+
+static int32_t XFR_Command(int32_t argc, char *argv[])
+{
+  XFR_ConfigTypeDef config = XfrConfig;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      config.FftSize = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "win") == 0) && (argc > 2))
+    {
+      config.Window = WIN_Find(argv[2]);
+    }
+    else if ((strcmp(argv[1], "avg") == 0) && (argc > 2))
+    {
+      config.Average = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      config.RateMs = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if (strcmp(argv[1], "on") == 0)
+    {
+      XFR_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      XFR_Enable(0U);
+    }
+    else
+    {
+      return 1;
+    }
+    if (XFR_Configure(&config) != XFR_OK)
+    {
+      return 1;
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"n\":%lu,\"win\":\"%s\",\"avg\":%lu,\"rate_ms\":%lu,\"frames\":%lu,"
+                   "\"reports\":%lu,\"overruns\":%lu,\"cycles\":%lu,\"coherence_x1000\":%lu}\r\n",
+                   XfrEnabled, (unsigned long)XfrConfig.FftSize, WIN_GetInfo(XfrConfig.Window)->Name,
+                   (unsigned long)XfrConfig.Average, (unsigned long)XfrConfig.RateMs,
+                   (unsigned long)XfrFrames, (unsigned long)XfrSeq, (unsigned long)XfrOverruns,
+                   (unsigned long)XfrCycles, (unsigned long)lrintf(XfrCoherence * 1000.0f));
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "xfer" command, the measurement starts disabled
+  * @retval None
+  */
+void XFR_Init(void)
+{
+  XFR_Reset();
+  (void)CON_Register(&XFR_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, restarts the averages
+  * @param  config: New settings
+  * @retval XFR_OK, XFR_ERROR if a setting is out of range
+  */
+XFR_StatusTypeDef XFR_Configure(const XFR_ConfigTypeDef *config)
+{
+  if ((config->FftSize < 16U) || (config->FftSize > XFR_FFT_MAX)
+      || ((config->FftSize & (config->FftSize - 1U)) != 0U) || (config->Window >= WIN_COUNT)
+      || (config->Average == 0U) || (config->Average > XFR_AVERAGE_MAX) || (config->RateMs == 0U))
+  {
+    return XFR_ERROR;
+  }
+
+  XfrConfig = *config;
+  XFR_Reset();
+  return XFR_OK;
+}
+
+/**
+  * @brief  Starts or stops the measurement
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void XFR_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (XfrEnabled == 0U))
+  {
+    XFR_Reset();
+  }
+  XfrEnabled = enable;
+}
+
+/**
+  * @brief  Drops the averages, restarts from the newest samples
+  * @retval None
+  */
+void XFR_Reset(void)
+{
+  (void)memset(XfrGxx, 0, sizeof(XfrGxx));
+  (void)memset(XfrGyy, 0, sizeof(XfrGyy));
+  (void)memset(XfrGxyRe, 0, sizeof(XfrGxyRe));
+  (void)memset(XfrGxyIm, 0, sizeof(XfrGxyIm));
+  XfrFrames = 0U;
+  XfrCoherence = 0.0f;
+  XfrRead = DSP_RingWriteIndex(DSP_GetInput());
+  XfrReportTick = HAL_GetTick();
+}
+
+/**
+  * @brief  Adds the next frame to the averages, reports every RateMs
+  * @note   Main loop only. One frame per call.
+  * @retval 1 if a full frame is left for the next pass
+  */
+uint8_t XFR_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  uint32_t hop = XfrConfig.FftSize / 2U;
+  uint32_t write;
+  uint32_t start;
+
+  if (XfrEnabled == 0U)
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if ((DSP_RingIsValid(input, XfrRead) == 0U) || (DSP_RingIsValid(DSP_GetInputY(), XfrRead) == 0U))
+  {
+    XfrRead = write;
+    XfrOverruns++;
+  }
+  if ((write - XfrRead) < XfrConfig.FftSize)
+  {
+    return 0U;
+  }
+
+  start = DWT->CYCCNT;
+  XFR_Frame();
+  XfrCycles = DWT->CYCCNT - start;
+  XfrRead += hop;
+
+  if ((HAL_GetTick() - XfrReportTick) >= XfrConfig.RateMs)
+  {
+    XFR_Report();
+    XfrReportTick = HAL_GetTick();
+  }
+
+  return ((write - XfrRead) >= XfrConfig.FftSize) ? 1U : 0U;
+}
@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file    dsp_xfer.h
+  * @brief   Cross spectrum, transfer function and coherence of the input pair.
+  ******************************************************************************
+  * @attention
+  *
+  * Frames of FftSize samples of both input channels, x (stimulus) and y
+  * (response), overlapping by half, are windowed and transformed together:
+  * x in the real part and y in the imaginary part of one FFT_Complex(),
+  * the two spectra are then separated with the symmetry of real signals,
+  *
+  *   X[k] = (Z[k] + conj(Z[N-k])) / 2
+  *   Y[k] = (Z[k] - conj(Z[N-k])) / 2j
+  *
+  * so both channels cost one complex FFT. For each bin the auto spectra
+  * Gxx, Gyy and the cross spectrum Gxy = conj(X) Y are averaged: linearly
+  * over the first Average frames, then exponentially with a time constant
+  * of Average frames. Every RateMs a set of DFR_TAG_XFER frames carries,
+  * from DC to fs / 2, one XFR_BinTypeDef per bin:
+  *
+  *   H1 = Gxy / Gxx         noise on y averages out (the usual estimator)
+  *   H2 = Gyy / conj(Gxy)   noise on x averages out
+  *   coherence = |Gxy|^2 / (Gxx Gyy)
+  *
+  * H1 and H2 have the same phase. A coherence well below 1 flags bins
+  * where the response is not linear in the stimulus, or lost in noise.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_XFER_H
+#define __DSP_XFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define XFR_FFT_MAX               512U    /* Real points per channel           */
+#define XFR_AVERAGE_MAX           1024U   /* Frames                            */
+#define XFR_CHUNK_BINS            128U    /* Bins per DFR_TAG_XFER frame       */
+#define XFR_LEVEL_MIN             (-20000) /* 0.01 dB, no signal               */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  XFR_OK = 0,
+  XFR_ERROR,
+} XFR_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t          FftSize;  /* Power of two, 16..XFR_FFT_MAX              */
+  WIN_WindowTypeDef Window;
+  uint32_t          Average;  /* Frames, 1..XFR_AVERAGE_MAX                 */
+  uint32_t          RateMs;   /* Report period                              */
+} XFR_ConfigTypeDef;
+
+/* DFR_TAG_XFER header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Seq;
+  uint32_t Tick;
+  uint32_t SampleRate;  /* mHz                                              */
+  uint32_t Frames;      /* Frames since start                               */
+  uint16_t Average;
+  uint16_t FftSize;
+  uint16_t FirstBin;    /* Bin k at k * SampleRate / FftSize                */
+  uint16_t Bins;
+  uint8_t  Window;      /* WIN_WindowTypeDef                                */
+  uint8_t  Reserved;
+} XFR_FrameHeaderTypeDef;
+
+/* DFR_TAG_XFER value, little endian */
+typedef struct __attribute__((packed))
+{
+  int16_t  H1;          /* |H1|, 0.01 dB                                    */
+  int16_t  H2;          /* |H2|, 0.01 dB                                    */
+  int16_t  Phase;       /* 0.01 degree, -18000..18000                       */
+  uint16_t Coherence;   /* 0..65535 for 0..1                                */
+} XFR_BinTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              XFR_Init(void);
+XFR_StatusTypeDef XFR_Configure(const XFR_ConfigTypeDef *config);
+void              XFR_Enable(uint8_t enable);
+void              XFR_Reset(void);
+uint8_t           XFR_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_XFER_H */
@@ -0,0 +1,435 @@
+/**
+  ******************************************************************************
+  * @file    dsp_zoom.c
+  * @brief   Zoom FFT of a sub-band of the input.
+  ******************************************************************************
+  * @attention
+  *
+  * The CORDIC runs the cosine function on q31 angles (1.0 = pi), which is
+  * the NCO phase accumulator read as a signed value. With one argument
+  * written per angle the modulus keeps its reset value of 1.0, and each
+  * angle gives cos then sin. 6 cycles (24 iterations) put the NCO spurs
+  * below -110 dBFS, under the 16-bit noise floor.
+  *
+  * The mixer computes x e^(-j phase): I = x cos, Q = -x sin, rounded to
+  * 16 bits. The FFT output is reordered so that bin FftSize / 2 is the
+  * centre frequency.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "main.h"
+#include "cordic.h"
+#include "console.h"
+#include "dsp_app.h"
+#include "dsp_decim.h"
+#include "dsp_fft.h"
+#include "dsp_frame.h"
+#include "dsp_zoom.h"
+
+/* Private define ------------------------------------------------------------*/
+#define ZOOM_CORDIC_TIMEOUT       10U     /* ms */
+
+#if (ZOOM_FFT_MAX > DSP_SCRATCH_SIZE)
+#error "ZOOM_FFT_MAX does not fit in the DSP scratch buffer"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static ZOOM_ConfigTypeDef ZoomConfig =
+{
+  .Centre  = 1000000U,
+  .Span    = 200000U,
+  .FftSize = ZOOM_FFT_MAX,
+  .Window  = WIN_HANN,
+  .RateMs  = 1000U,
+};
+
+static const CORDIC_ConfigTypeDef ZOOM_CordicConfig =
+{
+  .Function  = CORDIC_FUNCTION_COSINE,
+  .Scale     = CORDIC_SCALE_0,
+  .InSize    = CORDIC_INSIZE_32BITS,
+  .OutSize   = CORDIC_OUTSIZE_32BITS,
+  .NbWrite   = CORDIC_NBWRITE_1,
+  .NbRead    = CORDIC_NBREAD_2,
+  .Precision = CORDIC_PRECISION_6CYCLES,
+};
+
+static DEC_ChainTypeDef ZoomChainI;
+static DEC_ChainTypeDef ZoomChainQ;
+static int32_t  ZoomAngle[ZOOM_BATCH];
+static int32_t  ZoomNco[2U * ZOOM_BATCH];   /* cos, sin */
+static int16_t  ZoomI[ZOOM_BATCH];
+static int16_t  ZoomQ[ZOOM_BATCH];
+static int16_t  ZoomFrame[2U * ZOOM_FFT_MAX];
+static uint64_t ZoomAccu[ZOOM_FFT_MAX];
+
+static uint8_t  ZoomEnabled;
+static uint32_t ZoomRatio;
+static uint32_t ZoomRate;       /* Baseband rate, mHz                      */
+static uint32_t ZoomPhase;
+static uint32_t ZoomIncrement;
+static uint32_t ZoomRead;
+static uint32_t ZoomFill;       /* Complex samples in ZoomFrame            */
+static int32_t  ZoomExponent;   /* Block exponent of the sum               */
+
+static uint32_t ZoomFrames;
+static uint32_t ZoomSeq;
+static uint32_t ZoomOverruns;
+static uint32_t ZoomReportTick;
+static uint32_t ZoomCycles;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t ZOOM_Ratio(uint32_t rate, uint32_t span);
+static void     ZOOM_Mix(const int16_t *src, uint32_t n);
+static void     ZOOM_Frame(void);
+static void     ZOOM_Report(void);
+static int32_t  ZOOM_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef ZOOM_ConsoleCommand =
+{
+  .Name    = "zoom",
+  .Help    = "zoom [<centre_hz> <span_hz>|n <size>|win <hann|bh|flattop>|rate <ms>|off] - zoom FFT",
+  .Handler = ZOOM_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Largest power of two ratio whose +-0.4 fs_out band covers the span */
+static uint32_t ZOOM_Ratio(uint32_t rate, uint32_t span)
+{
+  uint32_t ratio = 2U;
+
+  while ((ratio < DEC_RATIO_MAX) && (((uint64_t)rate * 4U) >= ((uint64_t)span * 5U * (ratio * 2U))))
+  {
+    ratio *= 2U;
+  }
+  return ratio;
+}
+
+/* I/Q of one batch of input samples, NCO from the CORDIC */
+static void ZOOM_Mix(const int16_t *src, uint32_t n)
+{
+  uint32_t phase = ZoomPhase;
+  uint32_t i;
+
+  for (i = 0U; i < n; i++)
+  {
+    ZoomAngle[i] = (int32_t)phase;
+    phase += ZoomIncrement;
+  }
+  ZoomPhase = phase;
+
+  if (HAL_CORDIC_Calculate(&hcordic, ZoomAngle, ZoomNco, n, ZOOM_CORDIC_TIMEOUT) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  for (i = 0U; i < n; i++)
+  {
+    ZoomI[i] = (int16_t)__SSAT((int32_t)(((int64_t)src[i] * ZoomNco[2U * i]) >> 31), 16);
+    ZoomQ[i] = (int16_t)__SSAT((int32_t)(-(((int64_t)src[i] * ZoomNco[(2U * i) + 1U]) >> 31)), 16);
+  }
+}
+
+/* Transform the full frame and add its power, centre bin at FftSize / 2 */
+static void ZOOM_Frame(void)
+{
+  FFT_CpxTypeDef *fft = DSP_GetScratch();
+  uint32_t n = ZoomConfig.FftSize;
+  uint32_t start = DWT->CYCCNT;
+  uint32_t shift;
+  uint32_t k;
+  uint64_t p;
+  int32_t exponent;
+
+  WIN_ApplyComplex(ZoomConfig.Window, n, ZoomFrame, (int32_t *)fft);
+  exponent = FFT_Complex(fft, n);
+
+  /* The sum keeps the largest block exponent, powers move by 2 bits per step */
+  if (ZoomFrames == 0U)
+  {
+    ZoomExponent = exponent;
+  }
+  else if (exponent > ZoomExponent)
+  {
+    shift = 2U * (uint32_t)(exponent - ZoomExponent);
+    for (k = 0U; k < n; k++)
+    {
+      ZoomAccu[k] = (shift < 64U) ? (ZoomAccu[k] >> shift) : 0U;
+    }
+    ZoomExponent = exponent;
+  }
+  shift = ZOOM_LINEAR_SHIFT + (2U * (uint32_t)(ZoomExponent - exponent));
+
+  for (k = 0U; k < n; k++)
+  {
+    p = (uint64_t)((int64_t)fft[k].Re * fft[k].Re) + (uint64_t)((int64_t)fft[k].Im * fft[k].Im);
+    ZoomAccu[(k + (n / 2U)) & (n - 1U)] += (shift < 64U) ? (p >> shift) : 0U;
+  }
+  ZoomFrames++;
+  ZoomCycles = DWT->CYCCNT - start;
+}
+
+/* Sends the usable bins, all chunks or none; the scratch buffer holds them */
+static void ZOOM_Report(void)
+{
+  ZOOM_FrameHeaderTypeDef header;
+  const WIN_InfoTypeDef *win = WIN_GetInfo(ZoomConfig.Window);
+  uint32_t *chunk = (uint32_t *)DSP_GetScratch();
+  uint32_t n = ZoomConfig.FftSize;
+  uint32_t first = (n / 2U) - ((2U * n) / 5U);
+  uint32_t last = (n / 2U) + ((2U * n) / 5U);
+  uint32_t chunks = ((last - first) + ZOOM_CHUNK_BINS) / ZOOM_CHUNK_BINS;
+  uint64_t peak = 0U;
+  uint32_t shift = 0U;
+  uint32_t count;
+  uint32_t k;
+  uint32_t i;
+
+  for (k = first; k <= last; k++)
+  {
+    if (ZoomAccu[k] > peak)
+    {
+      peak = ZoomAccu[k];
+    }
+  }
+  if ((uint32_t)(peak >> 32U) != 0U)
+  {
+    shift = 32U - __CLZ((uint32_t)(peak >> 32U));
+  }
+
+  header.Seq        = ZoomSeq++;
+  header.Tick       = HAL_GetTick();
+  header.SampleRate = ZoomRate;
+  header.Centre     = ZoomConfig.Centre;
+  header.Frames     = ZoomFrames;
+  header.Scale      = ldexpf(2.0f, (2 * ZoomExponent) - 60 + (int32_t)ZOOM_LINEAR_SHIFT)
+                      / ((float)ZoomFrames * ((float)ZoomRate / 1000.0f) * (float)n
+                         * win->Enbw * win->CoherentGain * win->CoherentGain);
+  header.FftSize    = (uint16_t)n;
+  header.Window     = (uint8_t)ZoomConfig.Window;
+  header.Exp        = (int8_t)shift;
+  header.BlockExp   = (int8_t)ZoomExponent;
+
+  if (DFR_Fits(chunks, (chunks * sizeof(header)) + (((last - first) + 1U) * sizeof(uint32_t))) == 0U)
+  {
+    DFR_Drop(chunks);
+    return;
+  }
+
+  for (k = first; k <= last; k += count)
+  {
+    count = (((last - k) + 1U) > ZOOM_CHUNK_BINS) ? ZOOM_CHUNK_BINS : ((last - k) + 1U);
+    for (i = 0U; i < count; i++)
+    {
+      chunk[i] = (uint32_t)(ZoomAccu[k + i] >> shift);
+    }
+    header.FirstBin = (uint16_t)k;
+    header.Bins     = (uint16_t)count;
+    (void)DFR_Send(DFR_TAG_ZOOM, &header, sizeof(header), chunk, count * sizeof(uint32_t));
+  }
+}
+
+static int32_t ZOOM_Command(int32_t argc, char *argv[])
+{
+  ZOOM_ConfigTypeDef config = ZoomConfig;
+  uint8_t start = 0U;
+
+  if (argc > 1)
+  {
+    if ((strcmp(argv[1], "n") == 0) && (argc > 2))
+    {
+      config.FftSize = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if ((strcmp(argv[1], "win") == 0) && (argc > 2))
+    {
+      config.Window = WIN_Find(argv[2]);
+    }
+    else if ((strcmp(argv[1], "rate") == 0) && (argc > 2))
+    {
+      config.RateMs = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      ZOOM_Enable(0U);
+    }
+    else if (argc > 2)
+    {
+      config.Centre = (uint32_t)(strtof(argv[1], NULL) * 1000.0f);
+      config.Span   = (uint32_t)(strtof(argv[2], NULL) * 1000.0f);
+      start = 1U;
+    }
+    else
+    {
+      return 1;
+    }
+    if (ZOOM_Configure(&config) != ZOOM_OK)
+    {
+      return 1;
+    }
+    if (start != 0U)
+    {
+      ZOOM_Enable(1U);
+    }
+  }
+
+  (void)CON_Printf("{\"on\":%u,\"centre_mhz\":%lu,\"span_mhz\":%lu,\"ratio\":%lu,\"fs_out_mhz\":%lu,"
+                   "\"n\":%lu,\"rbw_mhz\":%lu,\"win\":\"%s\",\"rate_ms\":%lu,\"frames\":%lu,\"reports\":%lu,"
+                   "\"overruns\":%lu,\"cycles\":%lu}\r\n",
+                   ZoomEnabled, (unsigned long)ZoomConfig.Centre, (unsigned long)((ZoomRate / 5U) * 4U),
+                   (unsigned long)ZoomRatio, (unsigned long)ZoomRate, (unsigned long)ZoomConfig.FftSize,
+                   (unsigned long)(ZoomRate / ZoomConfig.FftSize), WIN_GetInfo(ZoomConfig.Window)->Name,
+                   (unsigned long)ZoomConfig.RateMs, (unsigned long)ZoomFrames, (unsigned long)ZoomSeq,
+                   (unsigned long)ZoomOverruns, (unsigned long)ZoomCycles);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "zoom" command, zoom starts disabled
+  * @note   Call after MX_CORDIC_Init().
+  * @retval None
+  */
+void ZOOM_Init(void)
+{
+  ZOOM_Reset();
+  (void)CON_Register(&ZOOM_ConsoleCommand);
+}
+
+/**
+  * @brief  Changes the settings, restarts the average
+  * @param  config: New settings
+  * @retval ZOOM_OK, ZOOM_ERROR if a setting is out of range
+  */
+ZOOM_StatusTypeDef ZOOM_Configure(const ZOOM_ConfigTypeDef *config)
+{
+  if ((config->FftSize < 16U) || (config->FftSize > ZOOM_FFT_MAX)
+      || ((config->FftSize & (config->FftSize - 1U)) != 0U)
+      || (config->Centre >= (DSP_GetInput()->Rate / 2U)) || (config->Span == 0U)
+      || (config->Window >= WIN_COUNT) || (config->RateMs == 0U))
+  {
+    return ZOOM_ERROR;
+  }
+
+  ZoomConfig = *config;
+  ZOOM_Reset();
+  return ZOOM_OK;
+}
+
+/**
+  * @brief  Starts or stops the zoom
+  * @param  enable: 1 to start
+  * @retval None
+  */
+void ZOOM_Enable(uint8_t enable)
+{
+  if ((enable != 0U) && (ZoomEnabled == 0U))
+  {
+    ZOOM_Reset();
+  }
+  ZoomEnabled = enable;
+}
+
+/**
+  * @brief  Applies the input rate, clears the filters and the average
+  * @retval None
+  */
+void ZOOM_Reset(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+
+  ZoomRatio = ZOOM_Ratio(input->Rate, ZoomConfig.Span);
+  ZoomRate = input->Rate / ZoomRatio;
+  ZoomIncrement = (input->Rate != 0U)
+                  ? (uint32_t)(((uint64_t)ZoomConfig.Centre << 32U) / input->Rate) : 0U;
+  ZoomPhase = 0U;
+  (void)DEC_ChainInit(&ZoomChainI, ZoomRatio);
+  (void)DEC_ChainInit(&ZoomChainQ, ZoomRatio);
+
+  ZoomRead = DSP_RingWriteIndex(input);
+  ZoomFill = 0U;
+  ZoomFrames = 0U;
+  ZoomReportTick = HAL_GetTick();
+  (void)memset(ZoomAccu, 0, sizeof(ZoomAccu));
+}
+
+/**
+  * @brief  Mixes and decimates the new input, reports when due
+  * @note   Main loop only.
+  * @retval 1 if input is left for the next pass
+  */
+uint8_t ZOOM_Process(void)
+{
+  const DSP_RingTypeDef *input = DSP_GetInput();
+  int16_t outI[ZOOM_BATCH / 2U];
+  int16_t outQ[ZOOM_BATCH / 2U];
+  const int16_t *src;
+  uint32_t write;
+  uint32_t done = 0U;
+  uint32_t count;
+  uint32_t len;
+  uint32_t n;
+  uint32_t i;
+
+  if (ZoomEnabled == 0U)
+  {
+    return 0U;
+  }
+
+  write = DSP_RingWriteIndex(input);
+  if (DSP_RingIsValid(input, ZoomRead) == 0U)
+  {
+    ZoomRead = write;
+    ZoomOverruns++;
+  }
+  if ((ZoomRead != write) && (HAL_CORDIC_Configure(&hcordic, &ZOOM_CordicConfig) != HAL_OK))
+  {
+    Error_Handler();
+  }
+
+  while ((ZoomRead != write) && (done < ZOOM_PASS_MAX))
+  {
+    src = DSP_RingSamples(input, ZoomRead, &len);
+    n = write - ZoomRead;
+    if (n > len)
+    {
+      n = len;
+    }
+    if (n > ZOOM_BATCH)
+    {
+      n = ZOOM_BATCH;
+    }
+
+    ZOOM_Mix(src, n);
+    count = DEC_ChainRun(&ZoomChainI, ZoomI, n, outI);
+    (void)DEC_ChainRun(&ZoomChainQ, ZoomQ, n, outQ);
+    for (i = 0U; i < count; i++)
+    {
+      ZoomFrame[2U * ZoomFill]        = outI[i];
+      ZoomFrame[(2U * ZoomFill) + 1U] = outQ[i];
+      if (++ZoomFill == ZoomConfig.FftSize)
+      {
+        ZOOM_Frame();
+        ZoomFill = 0U;
+      }
+    }
+
+    ZoomRead += n;
+    done += n;
+  }
+
+  if ((ZoomFrames != 0U)
+      && (((HAL_GetTick() - ZoomReportTick) >= ZoomConfig.RateMs) || (ZoomFrames >= ZOOM_FRAMES_MAX)))
+  {
+    ZOOM_Report();
+    ZoomReportTick = HAL_GetTick();
+    ZoomFrames = 0U;
+    (void)memset(ZoomAccu, 0, sizeof(ZoomAccu));
+  }
+
+  return (ZoomRead != write) ? 1U : 0U;
+}
@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    dsp_zoom.h
+  * @brief   Zoom FFT of a sub-band of the input.
+  ******************************************************************************
+  * @attention
+  *
+  * The input samples are shifted down by the centre frequency with a
+  * complex NCO whose cos/sin come from the CORDIC coprocessor, a batch at
+  * a time. I and Q then go through two decimation chains (DEC_ChainRun())
+  * and frames of FftSize baseband samples are windowed, transformed with
+  * FFT_Complex() and their power averaged. The resolution is
+  * fs / (Ratio * FftSize) for the cost of a short FFT.
+  *
+  * The ratio is the largest power of two for which the alias free band of
+  * the decimated signal (+-0.4 fs_out) covers the requested span. Every
+  * RateMs the usable bins, centred on the NCO frequency, are sent as
+  * DFR_TAG_ZOOM frames; as for the Welch PSD, in FS^2/Hz:
+  *
+  *   PSD(Centre + (FirstBin + i - FftSize/2) * SampleRate / FftSize)
+  *     = mantissa[i] * 2^Exp * Scale
+  *
+  * Scale includes the factor 2 of a one-sided density so that both
+  * outputs read the same for the same signal.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DSP_ZOOM_H
+#define __DSP_ZOOM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "dsp_window.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define ZOOM_FFT_MAX              512U    /* Complex points                    */
+#define ZOOM_BATCH                64U     /* NCO values per CORDIC run         */
+#define ZOOM_PASS_MAX             1024U   /* Input samples per ZOOM_Process()  */
+#define ZOOM_CHUNK_BINS           256U    /* Bins per DFR_TAG_ZOOM frame       */
+#define ZOOM_LINEAR_SHIFT         7U
+#define ZOOM_FRAMES_MAX           256U
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  ZOOM_OK = 0,
+  ZOOM_ERROR,
+} ZOOM_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t          Centre;   /* mHz, below fs / 2                          */
+  uint32_t          Span;     /* mHz, band to cover                         */
+  uint32_t          FftSize;  /* Power of two, 16..ZOOM_FFT_MAX             */
+  WIN_WindowTypeDef Window;
+  uint32_t          RateMs;   /* Report period                              */
+} ZOOM_ConfigTypeDef;
+
+/* DFR_TAG_ZOOM header, little endian */
+typedef struct __attribute__((packed))
+{
+  uint32_t Seq;
+  uint32_t Tick;
+  uint32_t SampleRate;  /* Baseband rate, mHz                               */
+  uint32_t Centre;      /* NCO frequency, mHz                               */
+  uint32_t Frames;      /* Frames in the average                            */
+  float    Scale;       /* FS^2/Hz per mantissa LSB, before 2^Exp           */
+  uint16_t FftSize;
+  uint16_t FirstBin;    /* 0 = Centre - SampleRate / 2                      */
+  uint16_t Bins;
+  uint8_t  Window;      /* WIN_WindowTypeDef                                */
+  int8_t   Exp;
+  int8_t   BlockExp;    /* FFT block exponent of the average, in Scale      */
+} ZOOM_FrameHeaderTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void               ZOOM_Init(void);
+ZOOM_StatusTypeDef ZOOM_Configure(const ZOOM_ConfigTypeDef *config);
+void               ZOOM_Enable(uint8_t enable);
+void               ZOOM_Reset(void);
+uint8_t            ZOOM_Process(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DSP_ZOOM_H */
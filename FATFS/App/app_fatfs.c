@@ -23,7 +23,10 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include <stdlib.h>
+#include "journal.h"
+#include "storage_bench.h"
+#include "console.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -38,7 +41,7 @@ typedef enum {
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+#define FS_BENCH_BUFFER_SIZE  (32U * 512U)  /* Raw tests run up to 32 sectors */
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -52,11 +55,20 @@ FIL USERFile;       /* File  object for USER */
 char USERPath[4];   /* USER logical drive path */
 /* USER CODE BEGIN PV */
 FS_FileOperationsTypeDef Appli_state = APPLICATION_IDLE;
+static uint32_t FS_BenchBuffer[FS_BENCH_BUFFER_SIZE / sizeof(uint32_t)];
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
+static int32_t FS_BenchCommand(int32_t argc, char *argv[]);
+static void FS_BenchOutput(const char *text, uint32_t len, void *ctx);
 
+static const CON_CommandTypeDef FS_BenchConsoleCommand =
+{
+  .Name    = "bench",
+  .Help    = "bench [seq_kB] [rand_ops] - storage benchmark, JSON output",
+  .Handler = FS_BenchCommand,
+};
 /* USER CODE END PFP */
 
 /**
@@ -76,6 +88,20 @@ if (FATFS_LinkDriver(&USER_Driver, USERPath) != 0)
   else
   {
     Appli_state = APPLICATION_INIT;
+    (void)CON_Register(&FS_BenchConsoleCommand);
+
+    /* Mount now so an interrupted capture is repaired before anything else
+       touches the volume. A missing card is not fatal. */
+    if (f_mount(&USERFatFs, USERPath, 1) != FR_OK)
+    {
+      Appli_state = APPLICATION_SD_UNPLUGGED;
+      return APP_OK;
+    }
+
+    if (JRN_Init(&USERFatFs, USERPath) != JRN_ERROR_IO)
+    {
+      Appli_state = APPLICATION_RUNNING;
+    }
     return APP_OK;
   }
   /* USER CODE END FATFS_Init */
@@ -109,5 +135,64 @@ DWORD get_fattime(void)
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN Application */
+/**
+  * @brief  Enumerates a directory with f_findfirst()/f_findnext()
+  * @param  path: Directory to scan
+  * @param  pattern: Name matching pattern ("*" lists everything)
+  * @param  callback: Invoked for each matched entry, the FILINFO (long name
+  *         included) is only valid during the call
+  * @param  ctx: User context forwarded to the callback
+  * @retval Number of matched entries or APP_ERROR
+  */
+int32_t FS_FindFiles(const TCHAR *path, const TCHAR *pattern, FS_FindCallbackTypeDef callback, void *ctx)
+{
+  DIR dir;
+  FILINFO fno;
+  FRESULT res;
+  int32_t count = 0;
+
+  res = f_findfirst(&dir, &fno, path, pattern);
+  while ((res == FR_OK) && (fno.fname[0] != 0))
+  {
+    if (callback != NULL)
+    {
+      callback(&fno, ctx);
+    }
+    count++;
+    res = f_findnext(&dir, &fno);
+  }
+  f_closedir(&dir);
+
+  return (res == FR_OK) ? count : APP_ERROR;
+}
+
+/* Console "bench" command */
+static int32_t FS_BenchCommand(int32_t argc, char *argv[])
+{
+  SBN_ConfigTypeDef cfg;
 
+  if (Appli_state != APPLICATION_RUNNING)
+  {
+    return SBN_ERROR_IO;
+  }
+
+  SBN_DefaultConfig(&cfg, (uint8_t *)FS_BenchBuffer, sizeof(FS_BenchBuffer));
+  cfg.Drive = USERPath;
+  if (argc > 1)
+  {
+    cfg.SeqBytes = (uint32_t)strtoul(argv[1], NULL, 0) * 1024U;
+  }
+  if (argc > 2)
+  {
+    cfg.RandOps = (uint32_t)strtoul(argv[2], NULL, 0);
+  }
+
+  return (int32_t)SBN_Run(&cfg, FS_BenchOutput, NULL);
+}
+
+static void FS_BenchOutput(const char *text, uint32_t len, void *ctx)
+{
+  UNUSED(ctx);
+  (void)CON_Write(text, len);
+}
 /* USER CODE END Application */
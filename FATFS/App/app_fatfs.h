@@ -33,7 +33,8 @@
 
 /* Exported types ------------------------------------------------------------*/
 /* USER CODE BEGIN ET */
-
+/* Called once per directory entry matched by FS_FindFiles() */
+typedef void (*FS_FindCallbackTypeDef)(const FILINFO *fno, void *ctx);
 /* USER CODE END ET */
 
 /* Exported constants --------------------------------------------------------*/
@@ -50,7 +51,7 @@
 int32_t MX_FATFS_Init(void);
 int32_t MX_FATFS_Process(void);
 /* USER CODE BEGIN EFP */
-
+int32_t FS_FindFiles(const TCHAR *path, const TCHAR *pattern, FS_FindCallbackTypeDef callback, void *ctx);
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
@@ -0,0 +1,906 @@
+/**
+  ******************************************************************************
+  * @file    capture_file.c
+  * @brief   Indexed capture container on the FatFs volume.
+  ******************************************************************************
+  * @attention
+  *
+  * See capture_file.h for the file layout. Seeking costs a binary search of
+  * the in-RAM footer, then one sector read per step over the index blocks of
+  * the selected footer interval, then a search inside one index block.
+  * Readers map the cluster chain once with _USE_FASTSEEK so every f_lseek()
+  * is resolved without walking the FAT.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "capture_file.h"
+#include "governor.h"
+#include "rng.h"
+
+/* Private define ------------------------------------------------------------*/
+_Static_assert(sizeof(CAP_FileHeaderTypeDef) == 64U, "CAP header layout");
+_Static_assert(sizeof(CAP_FrameHeaderTypeDef) == CAP_FRAME_HEADER_SIZE, "CAP frame header layout");
+_Static_assert(sizeof(CAP_IndexBlockTypeDef) == CAP_SECTOR_SIZE, "CAP index block layout");
+_Static_assert(sizeof(CAP_FooterTypeDef) == 32U, "CAP footer layout");
+_Static_assert(sizeof(CAP_TrailerTypeDef) == 32U, "CAP trailer layout");
+
+/* Private functions prototypes ----------------------------------------------*/
+static FSIZE_t CAP_GroupSpan(const CAP_FileTypeDef *cap);
+static FSIZE_t CAP_IndexOffset(const CAP_FileTypeDef *cap, uint32_t group, uint32_t count);
+static uint32_t CAP_GroupCount(const CAP_FileTypeDef *cap);
+static CAP_StatusTypeDef CAP_ReadAt(CAP_FileTypeDef *cap, FSIZE_t ofs, void *buf, UINT len);
+static CAP_StatusTypeDef CAP_Write(CAP_FileTypeDef *cap, const void *buf, UINT len);
+static CAP_StatusTypeDef CAP_Reserve(CAP_FileTypeDef *cap, FSIZE_t need);
+static void CAP_IndexReset(CAP_FileTypeDef *cap, uint32_t group);
+static void CAP_FooterAdd(CAP_FileTypeDef *cap, uint32_t group, uint64_t first);
+static CAP_StatusTypeDef CAP_FlushGroup(CAP_FileTypeDef *cap);
+static CAP_StatusTypeDef CAP_WriteFooter(CAP_FileTypeDef *cap);
+static CAP_StatusTypeDef CAP_ReadHeader(CAP_FileTypeDef *cap);
+static CAP_StatusTypeDef CAP_ReadFooter(CAP_FileTypeDef *cap);
+static uint32_t CAP_NewFileId(uint64_t start);
+static uint8_t CAP_IndexValid(CAP_FileTypeDef *cap, uint32_t group, uint32_t count, uint64_t after);
+static void CAP_ScanGroup(CAP_FileTypeDef *cap, uint32_t group, uint64_t after);
+static CAP_StatusTypeDef CAP_Rebuild(CAP_FileTypeDef *cap);
+static CAP_StatusTypeDef CAP_LoadIndex(CAP_FileTypeDef *cap, uint32_t group);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Creates a capture file and writes its header
+  * @param  cap: Capture handle
+  * @param  path: File name
+  * @param  cfg: Frame geometry and stream description
+  * @param  start: Timestamp of the first frame
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_Create(CAP_FileTypeDef *cap, const TCHAR *path, const CAP_ConfigTypeDef *cfg, uint64_t start)
+{
+  if ((cap == NULL) || (path == NULL) || (cfg == NULL) ||
+      (cfg->FrameSize == 0U) || ((cfg->FrameSize % CAP_SECTOR_SIZE) != 0U) ||
+      (cfg->FramesPerIndex == 0U) || (cfg->FramesPerIndex > CAP_INDEX_MAX_ENTRIES))
+  {
+    return CAP_ERROR_PARAM;
+  }
+
+  memset(cap, 0, sizeof(*cap));
+  strncpy(cap->Path, path, CAP_PATH_MAX - 1U);
+  cap->Header.Magic          = CAP_MAGIC_HEADER;
+  cap->Header.Version        = CAP_VERSION;
+  cap->Header.HeaderSize     = CAP_SECTOR_SIZE;
+  cap->Header.FrameSize      = cfg->FrameSize;
+  cap->Header.FramesPerIndex = cfg->FramesPerIndex;
+  cap->Header.TimeBase       = cfg->TimeBase;
+  cap->Header.SampleRate     = cfg->SampleRate;
+  cap->Header.Channels       = cfg->Channels;
+  cap->Header.SampleFormat   = cfg->SampleFormat;
+  cap->Header.StartTime      = start;
+  cap->Header.FileId         = CAP_NewFileId(start);
+  cap->SyncInterval          = cfg->SyncInterval;
+  cap->Stride                = 1U;
+
+  if (f_open(&cap->File, path, FA_CREATE_ALWAYS | FA_WRITE | FA_READ) != FR_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+  /* Contiguous first reservation when possible, else CAP_Reserve() takes
+     the clusters where it finds them on the first frame */
+  (void)f_expand(&cap->File, CAP_RESERVE_SIZE, 1);
+
+  /* The index block doubles as the zero padded header sector */
+  memcpy(&cap->Index, &cap->Header, sizeof(cap->Header));
+  if ((CAP_Write(cap, &cap->Index, CAP_SECTOR_SIZE) != CAP_OK) ||
+      (f_sync(&cap->File) != FR_OK))
+  {
+    f_close(&cap->File);
+    return CAP_ERROR_IO;
+  }
+
+  CAP_IndexReset(cap, 0U);
+  cap->Writing = 1U;
+  CAP_SyncCallback(cap, CAP_SYNC_CREATE);
+
+  return CAP_OK;
+}
+
+/**
+  * @brief  Appends one frame
+  * @param  cap: Capture handle opened by CAP_Create()
+  * @param  timestamp: Frame timestamp, must not decrease
+  * @param  flags: CAP_FRAME_FLAG_xxx
+  * @param  data: Payload
+  * @param  len: Payload size, at most FrameSize - CAP_FRAME_HEADER_SIZE
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_WriteFrame(CAP_FileTypeDef *cap, uint64_t timestamp, uint32_t flags, const void *data, uint32_t len)
+{
+  CAP_FrameHeaderTypeDef hdr;
+  uint32_t pad;
+
+  if ((cap == NULL) || (cap->Writing == 0U) ||
+      (len > (cap->Header.FrameSize - CAP_FRAME_HEADER_SIZE)) ||
+      ((cap->FrameCount != 0U) && (timestamp < cap->LastTime)))
+  {
+    return CAP_ERROR_PARAM;
+  }
+
+  /* Room for the frame and the index block it may complete */
+  if (CAP_Reserve(cap, cap->Header.FrameSize + CAP_SECTOR_SIZE) != CAP_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.Magic     = CAP_MAGIC_FRAME;
+  hdr.Sequence  = cap->FrameCount;
+  hdr.Timestamp = timestamp;
+  hdr.Length    = len;
+  hdr.Flags     = flags;
+  hdr.FileId    = cap->Header.FileId;
+
+  if ((CAP_Write(cap, &hdr, sizeof(hdr)) != CAP_OK) ||
+      ((len != 0U) && (CAP_Write(cap, data, len) != CAP_OK)))
+  {
+    return CAP_ERROR_IO;
+  }
+
+  /* Expand over the unused tail of the frame instead of writing zeros */
+  pad = cap->Header.FrameSize - CAP_FRAME_HEADER_SIZE - len;
+  if (pad != 0U)
+  {
+    FSIZE_t end = f_tell(&cap->File) + pad;
+
+    if ((f_lseek(&cap->File, end) != FR_OK) || (f_tell(&cap->File) != end))
+    {
+      return CAP_ERROR_IO;
+    }
+  }
+
+  cap->Index.Timestamp[cap->Index.Count++] = timestamp;
+  cap->FrameCount++;
+  cap->LastTime = timestamp;
+
+  if (cap->Index.Count == cap->Header.FramesPerIndex)
+  {
+    return CAP_FlushGroup(cap);
+  }
+
+  return CAP_OK;
+}
+
+/**
+  * @brief  Closes a capture, writing the last index block and the footer
+  *         when the file was opened for writing
+  * @param  cap: Capture handle
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_Close(CAP_FileTypeDef *cap)
+{
+  CAP_StatusTypeDef status = CAP_OK;
+  uint8_t writing;
+
+  if (cap == NULL)
+  {
+    return CAP_ERROR_PARAM;
+  }
+
+  writing = cap->Writing;
+  if (writing != 0U)
+  {
+    if (cap->Index.Count != 0U)
+    {
+      if (CAP_Write(cap, &cap->Index, CAP_SECTOR_SIZE) == CAP_OK)
+      {
+        CAP_FooterAdd(cap, cap->Index.Group, cap->Index.Timestamp[0]);
+      }
+      else
+      {
+        status = CAP_ERROR_IO;
+      }
+    }
+    if (status == CAP_OK)
+    {
+      status = CAP_WriteFooter(cap);
+    }
+    /* Release the reservation past the trailer */
+    if ((status == CAP_OK) && (f_truncate(&cap->File) != FR_OK))
+    {
+      status = CAP_ERROR_IO;
+    }
+    cap->Writing = 0U;
+  }
+
+  if (f_close(&cap->File) != FR_OK)
+  {
+    status = CAP_ERROR_IO;
+  }
+
+  if ((writing != 0U) && (status == CAP_OK))
+  {
+    CAP_SyncCallback(cap, CAP_SYNC_CLOSE);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  Opens a capture for reading
+  * @note   A missing or damaged footer is rebuilt in RAM, the file itself is
+  *         left untouched (see CAP_Recover()).
+  * @param  cap: Capture handle
+  * @param  path: File name
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_Open(CAP_FileTypeDef *cap, const TCHAR *path)
+{
+  CAP_StatusTypeDef status;
+
+  if ((cap == NULL) || (path == NULL))
+  {
+    return CAP_ERROR_PARAM;
+  }
+
+  memset(cap, 0, sizeof(*cap));
+  if (f_open(&cap->File, path, FA_READ) != FR_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+
+  /* Map the cluster chain once, a fragmented file just seeks the slow way */
+  cap->LinkMap[0] = CAP_LINKMAP_SIZE;
+  cap->File.cltbl = cap->LinkMap;
+  if (f_lseek(&cap->File, CREATE_LINKMAP) != FR_OK)
+  {
+    cap->File.cltbl = NULL;
+  }
+
+  status = CAP_ReadHeader(cap);
+  if (status == CAP_OK)
+  {
+    if (CAP_ReadFooter(cap) != CAP_OK)
+    {
+      status = CAP_Rebuild(cap);
+      if ((status == CAP_OK) && (cap->Index.Count != 0U))
+      {
+        CAP_FooterAdd(cap, cap->Index.Group, cap->Index.Timestamp[0]);
+      }
+    }
+  }
+
+  if (status != CAP_OK)
+  {
+    f_close(&cap->File);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  Repairs a capture left without footer by a power loss
+  * @note   Torn data after the last valid frame is truncated, then the index
+  *         block of the last group, the footer and the trailer are written.
+  *         The file is closed on return. Frames written past the last
+  *         checkpoint are kept unless the file is first cut back to its
+  *         committed size, as JRN_Repair() does.
+  * @param  cap: Capture handle used as work area
+  * @param  path: File name
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_Recover(CAP_FileTypeDef *cap, const TCHAR *path)
+{
+  CAP_StatusTypeDef status;
+  uint32_t group;
+
+  if ((cap == NULL) || (path == NULL))
+  {
+    return CAP_ERROR_PARAM;
+  }
+
+  memset(cap, 0, sizeof(*cap));
+  strncpy(cap->Path, path, CAP_PATH_MAX - 1U);
+  if (f_open(&cap->File, path, FA_OPEN_EXISTING | FA_READ | FA_WRITE) != FR_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+
+  status = CAP_ReadHeader(cap);
+  if ((status == CAP_OK) && (CAP_ReadFooter(cap) == CAP_OK))
+  {
+    /* Already consistent */
+    f_close(&cap->File);
+    return CAP_OK;
+  }
+
+  if (status == CAP_OK)
+  {
+    status = CAP_Rebuild(cap);
+  }
+
+  if (status == CAP_OK)
+  {
+    /* Cut after the last valid frame, CAP_Close() then appends the index
+       block of the last group and the footer */
+    group = cap->Index.Group;
+    if ((f_lseek(&cap->File, CAP_IndexOffset(cap, group, cap->Index.Count)) != FR_OK) ||
+        (f_truncate(&cap->File) != FR_OK))
+    {
+      status = CAP_ERROR_IO;
+    }
+  }
+
+  if (status == CAP_OK)
+  {
+    cap->Writing = 1U;
+    return CAP_Close(cap);
+  }
+
+  f_close(&cap->File);
+  return status;
+}
+
+/**
+  * @brief  Finds the last frame at or before a timestamp
+  * @param  cap: Capture handle opened by CAP_Open()
+  * @param  timestamp: Timestamp to look for
+  * @param  frame: Returns the frame number (0 when timestamp precedes the file)
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_Seek(CAP_FileTypeDef *cap, uint64_t timestamp, uint32_t *frame)
+{
+  uint32_t lo, hi, mid;
+  uint32_t groups;
+
+  if ((cap == NULL) || (frame == NULL))
+  {
+    return CAP_ERROR_PARAM;
+  }
+  if ((cap->FrameCount == 0U) || (cap->FooterCount == 0U))
+  {
+    return CAP_NOT_FOUND;
+  }
+  if (timestamp < cap->Footer[0])
+  {
+    *frame = 0U;
+    return CAP_OK;
+  }
+
+  /* Footer: last entry not after timestamp */
+  lo = 0U;
+  hi = cap->FooterCount - 1U;
+  while (lo < hi)
+  {
+    mid = (lo + hi + 1U) / 2U;
+    if (cap->Footer[mid] <= timestamp)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid - 1U;
+    }
+  }
+
+  /* Index blocks of that footer interval */
+  groups = CAP_GroupCount(cap);
+  hi = (lo + 1U) * cap->Stride;
+  hi = ((hi < groups) ? hi : groups) - 1U;
+  lo = lo * cap->Stride;
+  while (lo < hi)
+  {
+    mid = (lo + hi + 1U) / 2U;
+    if (CAP_LoadIndex(cap, mid) != CAP_OK)
+    {
+      return CAP_ERROR_FORMAT;
+    }
+    if (cap->Index.Timestamp[0] <= timestamp)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid - 1U;
+    }
+  }
+  if (CAP_LoadIndex(cap, lo) != CAP_OK)
+  {
+    return CAP_ERROR_FORMAT;
+  }
+
+  /* Entries of the index block */
+  mid = lo;
+  lo = 0U;
+  hi = cap->Index.Count - 1U;
+  while (lo < hi)
+  {
+    uint32_t k = (lo + hi + 1U) / 2U;
+
+    if (cap->Index.Timestamp[k] <= timestamp)
+    {
+      lo = k;
+    }
+    else
+    {
+      hi = k - 1U;
+    }
+  }
+
+  *frame = (mid * cap->Header.FramesPerIndex) + lo;
+
+  return CAP_OK;
+}
+
+/**
+  * @brief  Reads one frame
+  * @param  cap: Capture handle opened by CAP_Open()
+  * @param  frame: Frame number
+  * @param  hdr: Returns the frame header
+  * @param  data: Payload buffer, may be NULL to read the header only
+  * @param  size: Payload buffer size, the payload is truncated to it
+  * @retval CAP status
+  */
+CAP_StatusTypeDef CAP_ReadFrame(CAP_FileTypeDef *cap, uint32_t frame, CAP_FrameHeaderTypeDef *hdr, void *data, uint32_t size)
+{
+  UINT br;
+  uint32_t len;
+
+  if ((cap == NULL) || (hdr == NULL))
+  {
+    return CAP_ERROR_PARAM;
+  }
+  if (frame >= cap->FrameCount)
+  {
+    return CAP_NOT_FOUND;
+  }
+
+  if (CAP_ReadAt(cap, CAP_FrameOffset(cap, frame), hdr, sizeof(*hdr)) != CAP_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+  if ((hdr->Magic != CAP_MAGIC_FRAME) || (hdr->Sequence != frame) ||
+      (hdr->FileId != cap->Header.FileId) ||
+      (hdr->Length > (cap->Header.FrameSize - CAP_FRAME_HEADER_SIZE)))
+  {
+    return CAP_ERROR_FORMAT;
+  }
+
+  if (data != NULL)
+  {
+    len = (hdr->Length < size) ? hdr->Length : size;
+    if ((f_read(&cap->File, data, len, &br) != FR_OK) || (br != len))
+    {
+      return CAP_ERROR_IO;
+    }
+  }
+
+  return CAP_OK;
+}
+
+/**
+  * @brief  Returns the file offset of a frame
+  * @param  cap: Capture handle
+  * @param  frame: Frame number
+  * @retval Offset of the frame header
+  */
+FSIZE_t CAP_FrameOffset(const CAP_FileTypeDef *cap, uint32_t frame)
+{
+  uint32_t group = frame / cap->Header.FramesPerIndex;
+
+  return CAP_IndexOffset(cap, group, frame % cap->Header.FramesPerIndex);
+}
+
+/**
+  * @brief  Called once the written part of a capture is durable on disk
+  * @note   Weak, the metadata journal overrides it.
+  * @param  cap: Capture handle
+  * @param  event: Which step made the data durable
+  * @retval None
+  */
+__weak void CAP_SyncCallback(CAP_FileTypeDef *cap, CAP_SyncEventTypeDef event)
+{
+  UNUSED(cap);
+  UNUSED(event);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static FSIZE_t CAP_GroupSpan(const CAP_FileTypeDef *cap)
+{
+  return ((FSIZE_t)cap->Header.FramesPerIndex * cap->Header.FrameSize) + CAP_SECTOR_SIZE;
+}
+
+/* Offset of frame 'count' of a group, which is also where the index block
+   of a group holding 'count' frames starts */
+static FSIZE_t CAP_IndexOffset(const CAP_FileTypeDef *cap, uint32_t group, uint32_t count)
+{
+  return cap->Header.HeaderSize + ((FSIZE_t)group * CAP_GroupSpan(cap)) +
+         ((FSIZE_t)count * cap->Header.FrameSize);
+}
+
+static uint32_t CAP_GroupCount(const CAP_FileTypeDef *cap)
+{
+  return (cap->FrameCount + cap->Header.FramesPerIndex - 1U) / cap->Header.FramesPerIndex;
+}
+
+static CAP_StatusTypeDef CAP_ReadAt(CAP_FileTypeDef *cap, FSIZE_t ofs, void *buf, UINT len)
+{
+  UINT br;
+
+  if ((f_lseek(&cap->File, ofs) != FR_OK) ||
+      (f_read(&cap->File, buf, len, &br) != FR_OK) || (br != len))
+  {
+    return CAP_ERROR_IO;
+  }
+
+  return CAP_OK;
+}
+
+/* Large frames are split so that FatFs never issues a multi-sector write
+   longer than the governor allows on the current power budget */
+static CAP_StatusTypeDef CAP_Write(CAP_FileTypeDef *cap, const void *buf, UINT len)
+{
+  const BYTE *src = (const BYTE *)buf;
+  UINT burst = GOV_GetLimits()->SdBurstSectors * CAP_SECTOR_SIZE;
+  UINT chunk;
+  UINT bw;
+
+  while (len > 0U)
+  {
+    chunk = (len > burst) ? burst : len;
+    if ((f_write(&cap->File, src, chunk, &bw) != FR_OK) || (bw != chunk))
+    {
+      return CAP_ERROR_IO;
+    }
+    src += chunk;
+    len -= chunk;
+  }
+
+  return CAP_OK;
+}
+
+/* Makes sure 'need' bytes past the write position are allocated. The file
+   grows by CAP_RESERVE_SIZE and the new size is synced and journaled at
+   once, so that no cluster is ever allocated without the directory entry
+   covering it */
+static CAP_StatusTypeDef CAP_Reserve(CAP_FileTypeDef *cap, FSIZE_t need)
+{
+  FSIZE_t pos = f_tell(&cap->File);
+  FRESULT res;
+  uint8_t full;
+
+  if ((pos + need) <= f_size(&cap->File))
+  {
+    return CAP_OK;
+  }
+
+  /* Seeking past the end of a file open for writing allocates the clusters,
+     it stops short when the volume is full */
+  res  = f_lseek(&cap->File, pos + need + CAP_RESERVE_SIZE);
+  full = (f_tell(&cap->File) < (pos + need)) ? 1U : 0U;
+  if ((res != FR_OK) || (f_lseek(&cap->File, pos) != FR_OK) ||
+      (f_sync(&cap->File) != FR_OK))
+  {
+    return CAP_ERROR_IO;
+  }
+  CAP_SyncCallback(cap, CAP_SYNC_CHECKPOINT);
+
+  return (full != 0U) ? CAP_ERROR_IO : CAP_OK;
+}
+
+static void CAP_IndexReset(CAP_FileTypeDef *cap, uint32_t group)
+{
+  memset(&cap->Index, 0, sizeof(cap->Index));
+  cap->Index.Magic         = CAP_MAGIC_INDEX;
+  cap->Index.Group         = group;
+  cap->Index.FirstSequence = group * cap->Header.FramesPerIndex;
+  cap->Index.FileId        = cap->Header.FileId;
+  cap->IndexGroup          = group;
+}
+
+/* Keeps the first timestamp of every Stride-th group, halving the footer
+   resolution when it is full */
+static void CAP_FooterAdd(CAP_FileTypeDef *cap, uint32_t group, uint64_t first)
+{
+  uint32_t i;
+
+  if ((group % cap->Stride) != 0U)
+  {
+    return;
+  }
+
+  if (cap->FooterCount == CAP_FOOTER_MAX_ENTRIES)
+  {
+    for (i = 0U; i < (CAP_FOOTER_MAX_ENTRIES / 2U); i++)
+    {
+      cap->Footer[i] = cap->Footer[2U * i];
+    }
+    cap->FooterCount = CAP_FOOTER_MAX_ENTRIES / 2U;
+    cap->Stride *= 2U;
+    if ((group % cap->Stride) != 0U)
+    {
+      return;
+    }
+  }
+
+  cap->Footer[cap->FooterCount++] = first;
+}
+
+static CAP_StatusTypeDef CAP_FlushGroup(CAP_FileTypeDef *cap)
+{
+  uint32_t group = cap->Index.Group;
+
+  if (CAP_Write(cap, &cap->Index, CAP_SECTOR_SIZE) != CAP_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+  CAP_FooterAdd(cap, group, cap->Index.Timestamp[0]);
+  CAP_IndexReset(cap, group + 1U);
+
+  if ((cap->SyncInterval != 0U) && (((group + 1U) % cap->SyncInterval) == 0U))
+  {
+    if (f_sync(&cap->File) != FR_OK)
+    {
+      return CAP_ERROR_IO;
+    }
+    CAP_SyncCallback(cap, CAP_SYNC_CHECKPOINT);
+  }
+
+  return CAP_OK;
+}
+
+static CAP_StatusTypeDef CAP_WriteFooter(CAP_FileTypeDef *cap)
+{
+  CAP_FooterTypeDef footer;
+  CAP_TrailerTypeDef trailer;
+  UINT size = cap->FooterCount * sizeof(cap->Footer[0]);
+
+  memset(&footer, 0, sizeof(footer));
+  footer.Magic    = CAP_MAGIC_FOOTER;
+  footer.Entries  = cap->FooterCount;
+  footer.Stride   = cap->Stride;
+  footer.Frames   = cap->FrameCount;
+  footer.LastTime = cap->LastTime;
+
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.Magic        = CAP_MAGIC_TRAILER;
+  trailer.FooterOffset = f_tell(&cap->File);
+  trailer.FooterSize   = sizeof(footer) + size;
+
+  if ((CAP_Write(cap, &footer, sizeof(footer)) != CAP_OK) ||
+      ((size != 0U) && (CAP_Write(cap, cap->Footer, size) != CAP_OK)) ||
+      (CAP_Write(cap, &trailer, sizeof(trailer)) != CAP_OK))
+  {
+    return CAP_ERROR_IO;
+  }
+
+  return CAP_OK;
+}
+
+static CAP_StatusTypeDef CAP_ReadHeader(CAP_FileTypeDef *cap)
+{
+  if (CAP_ReadAt(cap, 0U, &cap->Header, sizeof(cap->Header)) != CAP_OK)
+  {
+    return CAP_ERROR_IO;
+  }
+  if ((cap->Header.Magic != CAP_MAGIC_HEADER) || (cap->Header.Version != CAP_VERSION) ||
+      (cap->Header.HeaderSize < sizeof(cap->Header)) ||
+      (cap->Header.FrameSize <= CAP_FRAME_HEADER_SIZE) ||
+      (cap->Header.FramesPerIndex == 0U) || (cap->Header.FramesPerIndex > CAP_INDEX_MAX_ENTRIES))
+  {
+    return CAP_ERROR_FORMAT;
+  }
+
+  cap->Stride     = 1U;
+  cap->IndexGroup = UINT32_MAX;
+
+  return CAP_OK;
+}
+
+static CAP_StatusTypeDef CAP_ReadFooter(CAP_FileTypeDef *cap)
+{
+  CAP_FooterTypeDef footer;
+  CAP_TrailerTypeDef trailer;
+  FSIZE_t fsize = f_size(&cap->File);
+  UINT br;
+
+  if (fsize < (cap->Header.HeaderSize + sizeof(footer) + sizeof(trailer)))
+  {
+    return CAP_ERROR_FORMAT;
+  }
+  if ((CAP_ReadAt(cap, fsize - sizeof(trailer), &trailer, sizeof(trailer)) != CAP_OK) ||
+      (trailer.Magic != CAP_MAGIC_TRAILER) ||
+      ((trailer.FooterOffset + trailer.FooterSize + sizeof(trailer)) != fsize) ||
+      (CAP_ReadAt(cap, trailer.FooterOffset, &footer, sizeof(footer)) != CAP_OK) ||
+      (footer.Magic != CAP_MAGIC_FOOTER) || (footer.Entries > CAP_FOOTER_MAX_ENTRIES) ||
+      (footer.Stride == 0U) ||
+      (trailer.FooterSize != (sizeof(footer) + (footer.Entries * sizeof(cap->Footer[0])))))
+  {
+    return CAP_ERROR_FORMAT;
+  }
+
+  if ((footer.Entries != 0U) &&
+      ((f_read(&cap->File, cap->Footer, footer.Entries * sizeof(cap->Footer[0]), &br) != FR_OK) ||
+       (br != (footer.Entries * sizeof(cap->Footer[0])))))
+  {
+    return CAP_ERROR_IO;
+  }
+
+  cap->FooterCount = footer.Entries;
+  cap->Stride      = footer.Stride;
+  cap->FrameCount  = footer.Frames;
+  cap->LastTime    = footer.LastTime;
+
+  return CAP_OK;
+}
+
+/* The RNG tells apart two captures written at the same place, a clock
+   error falls back on the tick and the start time */
+static uint32_t CAP_NewFileId(uint64_t start)
+{
+  uint32_t id;
+
+  if (HAL_RNG_GenerateRandomNumber(&hrng, &id) != HAL_OK)
+  {
+    id = HAL_GetTick() ^ (uint32_t)start ^ (uint32_t)(start >> 32);
+  }
+
+  return id;
+}
+
+/* Reads the index block of a group holding 'count' frames and checks that
+   it belongs to this file and that its timestamps keep increasing from
+   'after' */
+static uint8_t CAP_IndexValid(CAP_FileTypeDef *cap, uint32_t group, uint32_t count, uint64_t after)
+{
+  uint32_t i;
+
+  if ((CAP_ReadAt(cap, CAP_IndexOffset(cap, group, count), &cap->Index, CAP_SECTOR_SIZE) != CAP_OK) ||
+      (cap->Index.Magic != CAP_MAGIC_INDEX) || (cap->Index.Group != group) ||
+      (cap->Index.FileId != cap->Header.FileId) || (cap->Index.Count != count) ||
+      (cap->Index.FirstSequence != (group * cap->Header.FramesPerIndex)))
+  {
+    return 0U;
+  }
+  for (i = 0U; i < count; i++)
+  {
+    if (cap->Index.Timestamp[i] < after)
+    {
+      return 0U;
+    }
+    after = cap->Index.Timestamp[i];
+  }
+
+  return 1U;
+}
+
+/* Rebuilds the index of a group from its frame headers, stopping at the
+   first missing or torn frame, or at a frame of another file */
+static void CAP_ScanGroup(CAP_FileTypeDef *cap, uint32_t group, uint64_t after)
+{
+  CAP_FrameHeaderTypeDef hdr;
+  FSIZE_t fsize = f_size(&cap->File);
+  FSIZE_t ofs;
+  uint32_t seq;
+
+  CAP_IndexReset(cap, group);
+  while (cap->Index.Count < cap->Header.FramesPerIndex)
+  {
+    seq = cap->Index.FirstSequence + cap->Index.Count;
+    ofs = CAP_FrameOffset(cap, seq);
+    if (((ofs + cap->Header.FrameSize) > fsize) ||
+        (CAP_ReadAt(cap, ofs, &hdr, sizeof(hdr)) != CAP_OK) ||
+        (hdr.Magic != CAP_MAGIC_FRAME) || (hdr.Sequence != seq) ||
+        (hdr.FileId != cap->Header.FileId) || (hdr.Timestamp < after))
+    {
+      break;
+    }
+    cap->Index.Timestamp[cap->Index.Count++] = hdr.Timestamp;
+    after = hdr.Timestamp;
+  }
+}
+
+static CAP_StatusTypeDef CAP_Rebuild(CAP_FileTypeDef *cap)
+{
+  FSIZE_t fsize = f_size(&cap->File);
+  uint32_t complete = 0U;
+  uint32_t first = 0U;
+  uint32_t group = 0U;
+  uint32_t next;
+  uint64_t after = 0U;
+
+  if (fsize > cap->Header.HeaderSize)
+  {
+    complete = (uint32_t)((fsize - cap->Header.HeaderSize) / CAP_GroupSpan(cap));
+  }
+
+  /* The last complete group may have a torn index block, and the
+     reservation past it may hold the blocks of a deleted capture */
+  while ((complete != 0U) && (CAP_IndexValid(cap, complete - 1U, cap->Header.FramesPerIndex, 0U) == 0U))
+  {
+    complete--;
+  }
+
+  cap->Stride      = 1U;
+  cap->FooterCount = 0U;
+  while (((complete / cap->Stride) + 1U) > CAP_FOOTER_MAX_ENTRIES)
+  {
+    cap->Stride *= 2U;
+  }
+
+  /* Every Stride-th group and the last one, each starting after the
+     previous one checked. On a break, the groups since that one are
+     walked to find the first bad one, the file ends before it */
+  while (group < complete)
+  {
+    if (CAP_IndexValid(cap, group, cap->Header.FramesPerIndex, after) == 0U)
+    {
+      for (group = first; group < complete; group++)
+      {
+        if (CAP_IndexValid(cap, group, cap->Header.FramesPerIndex, after) == 0U)
+        {
+          break;
+        }
+        after = cap->Index.Timestamp[cap->Index.Count - 1U];
+      }
+      complete = group;
+      break;
+    }
+    CAP_FooterAdd(cap, group, cap->Index.Timestamp[0]);
+    after = cap->Index.Timestamp[cap->Index.Count - 1U];
+    first = group + 1U;
+    next  = group + cap->Stride;
+    group = ((next >= complete) && (group != (complete - 1U))) ? (complete - 1U) : next;
+  }
+
+  /* The last group stays in Index, its footer entry is left to the caller */
+  CAP_ScanGroup(cap, complete, after);
+  cap->FrameCount = (complete * cap->Header.FramesPerIndex) + cap->Index.Count;
+  cap->LastTime   = after;
+  if (cap->Index.Count != 0U)
+  {
+    cap->LastTime = cap->Index.Timestamp[cap->Index.Count - 1U];
+  }
+
+  return CAP_OK;
+}
+
+static CAP_StatusTypeDef CAP_LoadIndex(CAP_FileTypeDef *cap, uint32_t group)
+{
+  uint32_t groups = CAP_GroupCount(cap);
+  uint32_t count = cap->Header.FramesPerIndex;
+
+  if (group >= groups)
+  {
+    return CAP_NOT_FOUND;
+  }
+  if (group == cap->IndexGroup)
+  {
+    return CAP_OK;
+  }
+
+  if (group == (groups - 1U))
+  {
+    count = cap->FrameCount - (group * cap->Header.FramesPerIndex);
+  }
+
+  if (CAP_IndexValid(cap, group, count, 0U) != 0U)
+  {
+    cap->IndexGroup = group;
+    return CAP_OK;
+  }
+
+  /* The last group of an unrecovered file has no index block yet, the
+     order of its frames was checked by CAP_Rebuild() at open */
+  if (group == (groups - 1U))
+  {
+    CAP_ScanGroup(cap, group, 0U);
+    if (cap->Index.Count == count)
+    {
+      return CAP_OK;
+    }
+  }
+
+  cap->IndexGroup = UINT32_MAX;
+  return CAP_ERROR_FORMAT;
+}
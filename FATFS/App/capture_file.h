@@ -0,0 +1,196 @@
+/**
+  ******************************************************************************
+  * @file    capture_file.h
+  * @brief   Indexed capture container on the FatFs volume.
+  ******************************************************************************
+  * @attention
+  *
+  * File layout (all fields little endian):
+  *
+  *   [header sector]
+  *   [frame 0] ... [frame N-1] [index block 0]
+  *   [frame N] ... [frame 2N-1] [index block 1]
+  *   ...
+  *   [frames of the last group] [index block of the last group]
+  *   [footer] [trailer]
+  *
+  * Frames have a fixed size (multiple of 512 bytes) and start with a
+  * CAP_FrameHeaderTypeDef. After every FramesPerIndex frames a one sector
+  * index block lists the timestamp of each frame of the group, so the
+  * position of every complete group is computable from the header alone.
+  * The footer written at close holds the first timestamp of every Stride-th
+  * group and lets a reader locate a timestamp with a binary search of the
+  * footer, then of the index blocks, then inside one index block.
+  *
+  * A file without trailer (power loss) is still seekable: CAP_Open()
+  * rebuilds the footer from the index blocks and the frames of the last
+  * group, and CAP_Recover() also writes it back to the file.
+  * The rebuild only follows frames and index blocks stamped with the
+  * random FileId of the header whose timestamps keep increasing: the
+  * clusters past the last write may still hold a deleted capture of the
+  * same geometry, whose blocks sit at the same offsets with the same
+  * sequence and group numbers.
+  *
+  * While a capture is written, its clusters are reserved CAP_RESERVE_SIZE
+  * ahead of the write position (f_expand() at creation, contiguous when
+  * the volume allows it) and each new reservation is synced at once. The
+  * directory entry therefore covers every cluster the file owns, on FAT
+  * and exFAT alike, and the tail past the last committed byte can always
+  * be released by a truncation. CAP_Close() cuts the unused reservation.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CAPTURE_FILE_H
+#define __CAPTURE_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ff.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define CAP_SECTOR_SIZE           512U
+#define CAP_VERSION               2U
+
+#define CAP_MAGIC_HEADER          0x50414353U /* "SCAP" */
+#define CAP_MAGIC_FRAME           0x4D524643U /* "CFRM" */
+#define CAP_MAGIC_INDEX           0x58444943U /* "CIDX" */
+#define CAP_MAGIC_FOOTER          0x52544643U /* "CFTR" */
+#define CAP_MAGIC_TRAILER         0x444E4543U /* "CEND" */
+
+#define CAP_FRAME_HEADER_SIZE     32U
+#define CAP_INDEX_MAX_ENTRIES     ((CAP_SECTOR_SIZE - 32U) / 8U)
+#define CAP_FOOTER_MAX_ENTRIES    256U
+#define CAP_LINKMAP_SIZE          64U
+#define CAP_PATH_MAX              96U
+#define CAP_RESERVE_SIZE          (4UL * 1024UL * 1024UL) /* Allocated ahead of the writes */
+
+/* CAP_FrameHeaderTypeDef.Flags */
+#define CAP_FRAME_FLAG_OVERRUN    0x00000001U /* Samples were dropped before this frame */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  CAP_SYNC_CREATE = 0,      /* Header is on disk                       */
+  CAP_SYNC_CHECKPOINT,      /* f_sync() after an index block or a new
+                               reservation                             */
+  CAP_SYNC_CLOSE,           /* Footer written and file closed          */
+} CAP_SyncEventTypeDef;
+
+typedef enum
+{
+  CAP_OK = 0,
+  CAP_ERROR,
+  CAP_ERROR_PARAM,
+  CAP_ERROR_FORMAT,
+  CAP_ERROR_IO,
+  CAP_NOT_FOUND,
+} CAP_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* CAP_MAGIC_HEADER                        */
+  uint16_t Version;         /* CAP_VERSION                             */
+  uint16_t HeaderSize;      /* Bytes before frame 0 (CAP_SECTOR_SIZE)  */
+  uint32_t FrameSize;       /* Bytes per frame including its header    */
+  uint32_t FramesPerIndex;  /* Frames per group (1..60)                */
+  uint32_t TimeBase;        /* Timestamp ticks per second              */
+  uint32_t SampleRate;      /* Samples per second per channel          */
+  uint16_t Channels;
+  uint16_t SampleFormat;    /* Application defined                     */
+  uint32_t FileId;          /* Random, repeated in every frame and
+                               index block of the file                 */
+  uint64_t StartTime;       /* Timestamp of the first frame            */
+  uint32_t Reserved[6];
+} CAP_FileHeaderTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* CAP_MAGIC_FRAME                         */
+  uint32_t Sequence;        /* Frame number from 0                     */
+  uint64_t Timestamp;
+  uint32_t Length;          /* Payload bytes following the header      */
+  uint32_t Flags;           /* CAP_FRAME_FLAG_xxx                      */
+  uint32_t FileId;          /* CAP_FileHeaderTypeDef.FileId            */
+  uint32_t Reserved;
+} CAP_FrameHeaderTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* CAP_MAGIC_INDEX                         */
+  uint32_t Group;
+  uint32_t FirstSequence;
+  uint32_t Count;           /* Valid entries in Timestamp[]            */
+  uint32_t FileId;          /* CAP_FileHeaderTypeDef.FileId            */
+  uint32_t Reserved[3];
+  uint64_t Timestamp[CAP_INDEX_MAX_ENTRIES];
+} CAP_IndexBlockTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* CAP_MAGIC_FOOTER                        */
+  uint32_t Entries;         /* uint64_t timestamps following           */
+  uint32_t Stride;          /* Groups per footer entry                 */
+  uint32_t Frames;
+  uint64_t LastTime;
+  uint32_t Reserved[2];
+} CAP_FooterTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* CAP_MAGIC_TRAILER                       */
+  uint32_t FooterSize;
+  uint64_t FooterOffset;
+  uint32_t Reserved[4];
+} CAP_TrailerTypeDef;
+
+typedef struct
+{
+  uint32_t FrameSize;       /* Multiple of CAP_SECTOR_SIZE             */
+  uint32_t FramesPerIndex;  /* 1..CAP_INDEX_MAX_ENTRIES                */
+  uint32_t TimeBase;
+  uint32_t SampleRate;
+  uint16_t Channels;
+  uint16_t SampleFormat;
+  uint32_t SyncInterval;    /* f_sync() every n groups, 0: on close and
+                               when the reservation grows only          */
+} CAP_ConfigTypeDef;
+
+typedef struct
+{
+  FIL                   File;
+  TCHAR                 Path[CAP_PATH_MAX];
+  CAP_FileHeaderTypeDef Header;
+  CAP_IndexBlockTypeDef Index;      /* Open group (write) or last read block */
+  uint8_t               Writing;
+  uint32_t              SyncInterval;
+  uint32_t              FrameCount;
+  uint32_t              IndexGroup; /* Group held in Index (read)             */
+  uint64_t              LastTime;
+  uint32_t              Stride;
+  uint32_t              FooterCount;
+  uint64_t              Footer[CAP_FOOTER_MAX_ENTRIES];
+  DWORD                 LinkMap[CAP_LINKMAP_SIZE];
+} CAP_FileTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+CAP_StatusTypeDef CAP_Create(CAP_FileTypeDef *cap, const TCHAR *path, const CAP_ConfigTypeDef *cfg, uint64_t start);
+CAP_StatusTypeDef CAP_WriteFrame(CAP_FileTypeDef *cap, uint64_t timestamp, uint32_t flags, const void *data, uint32_t len);
+CAP_StatusTypeDef CAP_Close(CAP_FileTypeDef *cap);
+CAP_StatusTypeDef CAP_Open(CAP_FileTypeDef *cap, const TCHAR *path);
+CAP_StatusTypeDef CAP_Recover(CAP_FileTypeDef *cap, const TCHAR *path);
+CAP_StatusTypeDef CAP_Seek(CAP_FileTypeDef *cap, uint64_t timestamp, uint32_t *frame);
+CAP_StatusTypeDef CAP_ReadFrame(CAP_FileTypeDef *cap, uint32_t frame, CAP_FrameHeaderTypeDef *hdr, void *data, uint32_t size);
+FSIZE_t           CAP_FrameOffset(const CAP_FileTypeDef *cap, uint32_t frame);
+void              CAP_SyncCallback(CAP_FileTypeDef *cap, CAP_SyncEventTypeDef event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAPTURE_FILE_H */
@@ -0,0 +1,339 @@
+/**
+  ******************************************************************************
+  * @file    journal.c
+  * @brief   Write-ahead journal for recorder metadata.
+  ******************************************************************************
+  * @attention
+  *
+  * Records are appended from CAP_SyncCallback(), i.e. only after f_sync()
+  * made the described state durable. Each record is a single sector write
+  * so a brown-out leaves either the old or the new record, never a mix; the
+  * CRC rejects a sector torn by the card itself.
+  *
+  * Replay reads JRN_SECTORS sectors and touches only the interrupted file,
+  * so an unclean mount costs a few milliseconds instead of a volume scan.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include "journal.h"
+#include "diskio.h"
+#include "crc.h"
+#include "mempool.h"
+
+/* Private variables ---------------------------------------------------------*/
+static FATFS *JrnFs;
+static DWORD JrnBase;                                /* First journal sector */
+static uint32_t JrnSequence;
+static uint8_t JrnReady;
+static JRN_RecordTypeDef JrnLast;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t JRN_Crc(const JRN_RecordTypeDef *rec);
+static JRN_StatusTypeDef JRN_OpenArea(const TCHAR *drive);
+static JRN_StatusTypeDef JRN_Load(void);
+static JRN_StatusTypeDef JRN_Append(JRN_RecordKindTypeDef kind, const CAP_FileTypeDef *cap);
+static JRN_StatusTypeDef JRN_Repair(const JRN_RecordTypeDef *rec);
+
+_Static_assert(sizeof(JRN_RecordTypeDef) <= CAP_SECTOR_SIZE, "JRN record exceeds a sector");
+_Static_assert(CAP_SECTOR_SIZE == POOL_SECTOR_SIZE, "JRN sectors come from POOL_SECTOR");
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Opens the journal and replays it
+  * @note   Called once the volume is mounted, before any capture is opened.
+  * @param  fs: Mounted file system object
+  * @param  drive: Logical drive path, e.g. "0:/"
+  * @retval JRN_OK, JRN_RECOVERED when a capture was repaired, or an error
+  */
+JRN_StatusTypeDef JRN_Init(FATFS *fs, const TCHAR *drive)
+{
+  JRN_StatusTypeDef status;
+
+  JrnReady = 0U;
+  JrnFs = fs;
+
+  status = JRN_OpenArea(drive);
+  if (status == JRN_OK)
+  {
+    status = JRN_Load();
+  }
+  if (status != JRN_OK)
+  {
+    return status;
+  }
+
+  JrnReady = 1U;
+
+  if ((JrnLast.Magic == JRN_MAGIC) && (JrnLast.Kind != JRN_REC_CLOSE))
+  {
+    return JRN_Repair(&JrnLast);
+  }
+
+  return JRN_OK;
+}
+
+/**
+  * @brief  Returns the newest journal record
+  * @retval Record, Magic is 0 when the journal is empty
+  */
+const JRN_RecordTypeDef *JRN_GetLast(void)
+{
+  return &JrnLast;
+}
+
+/**
+  * @brief  Journals each durable step of a capture being written
+  * @param  cap: Capture handle
+  * @param  event: Step that completed
+  * @retval None
+  */
+void CAP_SyncCallback(CAP_FileTypeDef *cap, CAP_SyncEventTypeDef event)
+{
+  switch (event)
+  {
+    case CAP_SYNC_CREATE:
+      (void)JRN_Append(JRN_REC_CREATE, cap);
+      break;
+
+    case CAP_SYNC_CHECKPOINT:
+      (void)JRN_Append(JRN_REC_CHECKPOINT, cap);
+      break;
+
+    case CAP_SYNC_CLOSE:
+      (void)JRN_Append(JRN_REC_CLOSE, cap);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint32_t JRN_Crc(const JRN_RecordTypeDef *rec)
+{
+  return HAL_CRC_Calculate(&hcrc, (uint32_t *)(uintptr_t)rec, offsetof(JRN_RecordTypeDef, Crc));
+}
+
+/* Creates the journal as a contiguous file on first use and locates its
+   first sector so records can bypass the FAT layer. A journal recreated
+   or restored by a host tool may be fragmented, the raw writes would then
+   land in the clusters of other files: it is created again */
+static JRN_StatusTypeDef JRN_OpenArea(const TCHAR *drive)
+{
+  FIL fil;
+  TCHAR path[sizeof(JRN_FILE_NAME) + 4U];
+  DWORD map[4];                 /* Size, one fragment, terminator */
+  uint8_t contiguous = 0U;
+  uint8_t created = 0U;
+  uint8_t *sector;
+  uint32_t i;
+
+  if (strlen(drive) > 3U)
+  {
+    return JRN_ERROR;
+  }
+  strcpy(path, drive);
+  strcat(path, JRN_FILE_NAME);
+
+  /* FatFs leaves the last fragment count of an existing exFAT file unset,
+     the first f_lseek() would write a stale one to the FAT */
+  memset(&fil, 0, sizeof(fil));
+  if (f_open(&fil, path, FA_OPEN_ALWAYS | FA_READ | FA_WRITE) != FR_OK)
+  {
+    return JRN_ERROR_IO;
+  }
+
+  if (f_size(&fil) == (JRN_SECTORS * CAP_SECTOR_SIZE))
+  {
+    map[0] = sizeof(map) / sizeof(map[0]);
+    fil.cltbl = map;
+    if ((f_lseek(&fil, CREATE_LINKMAP) == FR_OK) && (map[0] == (sizeof(map) / sizeof(map[0]))))
+    {
+      contiguous = 1U;
+    }
+    fil.cltbl = NULL;
+  }
+
+  if (contiguous == 0U)
+  {
+    if ((f_truncate(&fil) != FR_OK) ||
+        (f_expand(&fil, JRN_SECTORS * CAP_SECTOR_SIZE, 1) != FR_OK))
+    {
+      f_close(&fil);
+      return JRN_ERROR_IO;
+    }
+    created = 1U;
+  }
+
+  JrnBase = JrnFs->database + ((fil.obj.sclust - 2U) * JrnFs->csize);
+  if (f_close(&fil) != FR_OK)
+  {
+    return JRN_ERROR_IO;
+  }
+
+  if (created != 0U)
+  {
+    sector = POOL_Alloc(POOL_SECTOR, "jrn");
+    if (sector == NULL)
+    {
+      return JRN_ERROR;
+    }
+    memset(sector, 0, CAP_SECTOR_SIZE);
+    for (i = 0U; i < JRN_SECTORS; i++)
+    {
+      if (disk_write(JrnFs->drv, (const BYTE *)sector, JrnBase + i, 1U) != RES_OK)
+      {
+        POOL_Free(sector);
+        return JRN_ERROR_IO;
+      }
+    }
+    POOL_Free(sector);
+    (void)disk_ioctl(JrnFs->drv, CTRL_SYNC, NULL);
+  }
+
+  return JRN_OK;
+}
+
+/* Finds the newest record with a valid CRC */
+static JRN_StatusTypeDef JRN_Load(void)
+{
+  JRN_RecordTypeDef *rec = POOL_Alloc(POOL_SECTOR, "jrn");
+  uint8_t found = 0U;
+  uint32_t i;
+
+  if (rec == NULL)
+  {
+    return JRN_ERROR;
+  }
+
+  memset(&JrnLast, 0, sizeof(JrnLast));
+  for (i = 0U; i < JRN_SECTORS; i++)
+  {
+    if (disk_read(JrnFs->drv, (BYTE *)rec, JrnBase + i, 1U) != RES_OK)
+    {
+      POOL_Free(rec);
+      return JRN_ERROR_IO;
+    }
+    if ((rec->Magic != JRN_MAGIC) || (rec->Crc != JRN_Crc(rec)))
+    {
+      continue;
+    }
+    if ((found == 0U) || ((int32_t)(rec->Sequence - JrnLast.Sequence) > 0))
+    {
+      JrnLast = *rec;
+      found = 1U;
+    }
+  }
+
+  POOL_Free(rec);
+  JrnSequence = (found != 0U) ? (JrnLast.Sequence + 1U) : 0U;
+
+  return JRN_OK;
+}
+
+static JRN_StatusTypeDef JRN_Append(JRN_RecordKindTypeDef kind, const CAP_FileTypeDef *cap)
+{
+  JRN_RecordTypeDef *rec;
+  JRN_StatusTypeDef status = JRN_OK;
+
+  if (JrnReady == 0U)
+  {
+    return JRN_ERROR;
+  }
+  rec = POOL_Alloc(POOL_SECTOR, "jrn");
+  if (rec == NULL)
+  {
+    return JRN_ERROR;
+  }
+
+  memset(rec, 0, CAP_SECTOR_SIZE);
+  rec->Magic         = JRN_MAGIC;
+  rec->Sequence      = JrnSequence;
+  rec->Kind          = kind;
+  rec->StartCluster  = cap->File.obj.sclust;
+  rec->CommittedSize = f_tell(&cap->File);
+  rec->LastTime      = cap->LastTime;
+  rec->FrameCount    = cap->FrameCount;
+  rec->IndexGroup    = cap->Index.Group;
+  rec->Extent        = f_size(&cap->File);
+  strncpy(rec->Path, cap->Path, CAP_PATH_MAX - 1U);
+  rec->Crc = JRN_Crc(rec);
+
+#if _FS_REENTRANT
+  if (!ff_req_grant(JrnFs->sobj))
+  {
+    POOL_Free(rec);
+    return JRN_ERROR;
+  }
+#endif
+  if ((disk_write(JrnFs->drv, (const BYTE *)rec, JrnBase + (rec->Sequence % JRN_SECTORS), 1U) != RES_OK) ||
+      (disk_ioctl(JrnFs->drv, CTRL_SYNC, NULL) != RES_OK))
+  {
+    status = JRN_ERROR_IO;
+  }
+#if _FS_REENTRANT
+  ff_rel_grant(JrnFs->sobj);
+#endif
+
+  if (status == JRN_OK)
+  {
+    JrnLast = *rec;
+    JrnSequence++;
+  }
+  POOL_Free(rec);
+
+  return status;
+}
+
+/* Brings the capture described by an open record back to a closed file */
+static JRN_StatusTypeDef JRN_Repair(const JRN_RecordTypeDef *rec)
+{
+  CAP_FileTypeDef cap; /* Only needed once at mount, kept off the BSS */
+  FIL *fil = &cap.File;
+  FSIZE_t size;
+  FRESULT res;
+
+  memset(&cap, 0, sizeof(cap));
+  res = f_open(fil, rec->Path, FA_OPEN_EXISTING | FA_READ | FA_WRITE);
+  if (res == FR_OK)
+  {
+    /* The directory entry covers every cluster of the capture, reservation
+       included (CAP_Reserve()), so cutting the file at the committed size
+       frees the tail through the FAT or the exFAT allocation bitmap */
+    size = f_size(fil);
+    if ((fil->obj.sclust == rec->StartCluster) && (size > rec->CommittedSize))
+    {
+      if ((f_lseek(fil, rec->CommittedSize) != FR_OK) ||
+          (f_truncate(fil) != FR_OK))
+      {
+        res = FR_DISK_ERR;
+      }
+    }
+    if (f_close(fil) != FR_OK)
+    {
+      res = FR_DISK_ERR;
+    }
+  }
+
+  if (res == FR_OK)
+  {
+    /* Cuts torn frames, writes the index and footer and journals the close */
+    (void)CAP_Recover(&cap, rec->Path);
+  }
+
+  if (JrnLast.Kind != JRN_REC_CLOSE)
+  {
+    /* File gone, unrecoverable or closed before its record: never retry */
+    memset(&cap, 0, sizeof(cap));
+    strncpy(cap.Path, rec->Path, CAP_PATH_MAX - 1U);
+    (void)JRN_Append(JRN_REC_CLOSE, &cap);
+  }
+
+  return ((res == FR_OK) || (res == FR_NO_FILE)) ? JRN_RECOVERED : JRN_ERROR_IO;
+}
@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @file    journal.h
+  * @brief   Write-ahead journal for recorder metadata.
+  ******************************************************************************
+  * @attention
+  *
+  * The journal is a contiguous, preallocated file whose sectors are written
+  * directly through the disk driver, one record per sector in a ring. Every
+  * record carries the state of the open capture (file, start cluster,
+  * committed size, index checkpoint) and a CRC-32 computed by the CRC
+  * peripheral. A record is only appended once the matching data is durable,
+  * so the newest valid record always describes a consistent file.
+  *
+  * At mount, JRN_Init() loads the newest record. If it is not a close
+  * record the capture was interrupted: the file is truncated to the
+  * committed size, which releases its reserved clusters on FAT and exFAT
+  * alike (see capture_file.h), and its index and footer are rebuilt with
+  * CAP_Recover().
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __JOURNAL_H
+#define __JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ff.h"
+#include "capture_file.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define JRN_FILE_NAME       "JOURNAL.SYS"
+#define JRN_SECTORS         16U
+#define JRN_MAGIC           0x4C4E524AU /* "JRNL" */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  JRN_OK = 0,
+  JRN_ERROR,
+  JRN_ERROR_IO,
+  JRN_RECOVERED,            /* An interrupted capture was repaired */
+} JRN_StatusTypeDef;
+
+typedef enum
+{
+  JRN_REC_CREATE = 1,
+  JRN_REC_CHECKPOINT,
+  JRN_REC_CLOSE,
+} JRN_RecordKindTypeDef;
+
+typedef struct
+{
+  uint32_t Magic;           /* JRN_MAGIC                               */
+  uint32_t Sequence;        /* Increments with every record            */
+  uint32_t Kind;            /* JRN_RecordKindTypeDef                   */
+  uint32_t StartCluster;    /* First cluster of the capture file       */
+  uint64_t CommittedSize;   /* Bytes durable at the time of the record,
+                               the write position after f_sync()       */
+  uint64_t LastTime;        /* Timestamp of the last committed frame   */
+  uint32_t FrameCount;      /* Frames committed                        */
+  uint32_t IndexGroup;      /* Groups whose index block is on disk     */
+  uint64_t Extent;          /* Size in the directory entry, including
+                               the reservation released on replay      */
+  TCHAR    Path[CAP_PATH_MAX];
+  uint32_t Crc;             /* CRC-32 of the fields above              */
+} JRN_RecordTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+JRN_StatusTypeDef JRN_Init(FATFS *fs, const TCHAR *drive);
+const JRN_RecordTypeDef *JRN_GetLast(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JOURNAL_H */
@@ -0,0 +1,470 @@
+/**
+  ******************************************************************************
+  * @file    storage_bench.c
+  * @brief   Throughput and latency benchmark of the disk I/O layer and FatFs.
+  ******************************************************************************
+  * @attention
+  *
+  * Output format (one object, rows streamed as they complete):
+  *
+  *   {"bench":"storage","fs":"exfat","cluster":32768,"timer_hz":170000000,
+  *    "seq":[{"sectors":1,"write_kBps":..,"read_kBps":..},...],
+  *    "rand":[{"sectors":1,"write_iops":..,"read_iops":..,
+  *             "write_max_us":..,"read_max_us":..},...],
+  *    "fwrite":[{"chunk":512,"p50_us":..,"p90_us":..,"p99_us":..,
+  *               "max_us":..,"close_us":..},...],
+  *    "alloc":{"clusters":..,"extend_us":..,"sync_us":..,"release_us":..,
+  *             "expand_us":..},
+  *    "status":0}
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "storage_bench.h"
+#include "diskio.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SBN_LINE_SIZE         192U
+#define SBN_PATH_SIZE         16U
+
+/* Private variables ---------------------------------------------------------*/
+static SBN_OutputTypeDef SBN_Out;
+static void *SBN_Ctx;
+static FATFS *SBN_Fs;
+static DWORD SBN_AreaBase;
+static uint32_t SBN_Random;
+static uint32_t SBN_Latency[SBN_LATENCY_SAMPLES];
+static char SBN_Line[SBN_LINE_SIZE];
+
+/* Private function prototypes -----------------------------------------------*/
+static void SBN_Emit(const char *fmt, ...);
+static uint32_t SBN_Micros(uint32_t ticks);
+static uint32_t SBN_Rate(uint32_t bytes, uint32_t ticks);
+static uint32_t SBN_NextRandom(void);
+static void SBN_MakePath(TCHAR *path, const TCHAR *drive, const char *name);
+static int SBN_CompareU32(const void *a, const void *b);
+static SBN_StatusTypeDef SBN_Prepare(const SBN_ConfigTypeDef *cfg, const TCHAR *path);
+static SBN_StatusTypeDef SBN_Raw(const SBN_ConfigTypeDef *cfg, uint32_t maxsect, uint8_t random);
+static SBN_StatusTypeDef SBN_WriteLatency(const SBN_ConfigTypeDef *cfg, const TCHAR *path);
+static SBN_StatusTypeDef SBN_Allocation(const SBN_ConfigTypeDef *cfg, const TCHAR *path);
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Fills a configuration with the defaults
+  * @param  cfg: Configuration to fill
+  * @param  buffer: Transfer buffer
+  * @param  size: Buffer size in bytes
+  * @retval None
+  */
+void SBN_DefaultConfig(SBN_ConfigTypeDef *cfg, uint8_t *buffer, uint32_t size)
+{
+  cfg->Drive         = "0:/";
+  cfg->Buffer        = buffer;
+  cfg->BufferSize    = size;
+  cfg->AreaSectors   = 8192U;            /* 4 MB */
+  cfg->SeqBytes      = 512U * 1024U;
+  cfg->RandOps       = 64U;
+  cfg->WriteChunks   = SBN_LATENCY_SAMPLES;
+  cfg->AllocClusters = 64U;
+  cfg->Seed          = 1U;
+}
+
+/**
+  * @brief  Runs the whole suite
+  * @note   Blocks for several seconds. Files named SBN_SCRATCH_NAME and
+  *         SBN_WRITE_NAME in the drive root are overwritten and removed.
+  * @param  cfg: Benchmark parameters
+  * @param  out: Receives the JSON text
+  * @param  ctx: Forwarded to out
+  * @retval SBN_OK or the first error
+  */
+SBN_StatusTypeDef SBN_Run(const SBN_ConfigTypeDef *cfg, SBN_OutputTypeDef out, void *ctx)
+{
+  TCHAR scratch[SBN_PATH_SIZE + sizeof(SBN_SCRATCH_NAME)];
+  TCHAR wfile[SBN_PATH_SIZE + sizeof(SBN_WRITE_NAME)];
+  SBN_StatusTypeDef status;
+  uint32_t maxsect;
+  DWORD nclst;
+
+  if ((cfg == NULL) || (out == NULL) || (cfg->Buffer == NULL) ||
+      (cfg->BufferSize < SBN_SECTOR_SIZE) || (cfg->AreaSectors < SBN_MAX_SECTORS) ||
+      (cfg->WriteChunks == 0U) || (cfg->WriteChunks > SBN_LATENCY_SAMPLES) ||
+      (strlen(cfg->Drive) >= SBN_PATH_SIZE))
+  {
+    return SBN_ERROR_PARAM;
+  }
+
+  SBN_Out = out;
+  SBN_Ctx = ctx;
+  SBN_Random = (cfg->Seed != 0U) ? cfg->Seed : 1U;
+  SBN_MakePath(scratch, cfg->Drive, SBN_SCRATCH_NAME);
+  SBN_MakePath(wfile, cfg->Drive, SBN_WRITE_NAME);
+
+  if (f_getfree(cfg->Drive, &nclst, &SBN_Fs) != FR_OK)
+  {
+    return SBN_ERROR_IO;
+  }
+
+  maxsect = cfg->BufferSize / SBN_SECTOR_SIZE;
+  if (maxsect > SBN_MAX_SECTORS)
+  {
+    maxsect = SBN_MAX_SECTORS;
+  }
+  memset(cfg->Buffer, 0xA5, maxsect * SBN_SECTOR_SIZE);
+  SBN_TimerInit();
+
+  SBN_Emit("{\"bench\":\"storage\",\"fs\":\"%s\",\"cluster\":%lu,\"free_clusters\":%lu,"
+           "\"timer_hz\":%lu,\"max_sectors\":%lu,\n",
+           (SBN_Fs->fs_type == FS_EXFAT) ? "exfat" : (SBN_Fs->fs_type == FS_FAT32) ? "fat32" : "fat",
+           (unsigned long)SBN_Fs->csize * SBN_SECTOR_SIZE, (unsigned long)nclst,
+           (unsigned long)SBN_TimerFreq(), (unsigned long)maxsect);
+
+  status = SBN_Prepare(cfg, scratch);
+  if (status == SBN_OK)
+  {
+    SBN_Emit("\"seq\":[");
+    status = SBN_Raw(cfg, maxsect, 0U);
+    SBN_Emit("],\n\"rand\":[");
+    if (status == SBN_OK)
+    {
+      status = SBN_Raw(cfg, maxsect, 1U);
+    }
+    SBN_Emit("],\n");
+    (void)f_unlink(scratch);
+  }
+  if (status == SBN_OK)
+  {
+    SBN_Emit("\"fwrite\":[");
+    status = SBN_WriteLatency(cfg, wfile);
+    SBN_Emit("],\n");
+  }
+  if (status == SBN_OK)
+  {
+    status = SBN_Allocation(cfg, wfile);
+  }
+  (void)f_unlink(wfile);
+
+  SBN_Emit("\"status\":%d}\n", (int)status);
+
+  return status;
+}
+
+/**
+  * @brief  Starts the benchmark time base
+  * @note   Weak, the default uses the DWT cycle counter.
+  * @retval None
+  */
+__weak void SBN_TimerInit(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+  * @brief  Reads the free running benchmark time base
+  * @retval Ticks, wrapping at 32 bits
+  */
+__weak uint32_t SBN_TimerRead(void)
+{
+#if defined(DWT)
+  return DWT->CYCCNT;
+#else
+  return 0U;
+#endif
+}
+
+/**
+  * @brief  Frequency of SBN_TimerRead()
+  * @retval Ticks per second
+  */
+__weak uint32_t SBN_TimerFreq(void)
+{
+#if defined(DWT)
+  return SystemCoreClock;
+#else
+  return 1U;
+#endif
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+static void SBN_Emit(const char *fmt, ...)
+{
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(SBN_Line, sizeof(SBN_Line), fmt, args);
+  va_end(args);
+
+  if (len > 0)
+  {
+    SBN_Out(SBN_Line, ((uint32_t)len < sizeof(SBN_Line)) ? (uint32_t)len : (sizeof(SBN_Line) - 1U), SBN_Ctx);
+  }
+}
+
+static uint32_t SBN_Micros(uint32_t ticks)
+{
+  return (uint32_t)(((uint64_t)ticks * 1000000U) / SBN_TimerFreq());
+}
+
+/* kB/s for bytes moved in ticks */
+static uint32_t SBN_Rate(uint32_t bytes, uint32_t ticks)
+{
+  if (ticks == 0U)
+  {
+    return 0U;
+  }
+  return (uint32_t)(((uint64_t)bytes * SBN_TimerFreq()) / ((uint64_t)ticks * 1024U));
+}
+
+/* xorshift32, reproducible across targets */
+static uint32_t SBN_NextRandom(void)
+{
+  SBN_Random ^= SBN_Random << 13;
+  SBN_Random ^= SBN_Random >> 17;
+  SBN_Random ^= SBN_Random << 5;
+
+  return SBN_Random;
+}
+
+static void SBN_MakePath(TCHAR *path, const TCHAR *drive, const char *name)
+{
+  strcpy(path, drive);
+  strcat(path, name);
+}
+
+static int SBN_CompareU32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/* Allocates the contiguous scratch area and locates its first sector */
+static SBN_StatusTypeDef SBN_Prepare(const SBN_ConfigTypeDef *cfg, const TCHAR *path)
+{
+  FIL fil;
+
+  if (f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+  {
+    return SBN_ERROR_IO;
+  }
+  if (f_expand(&fil, (FSIZE_t)cfg->AreaSectors * SBN_SECTOR_SIZE, 1) != FR_OK)
+  {
+    f_close(&fil);
+    (void)f_unlink(path);
+    return SBN_ERROR_IO;
+  }
+  SBN_AreaBase = SBN_Fs->database + ((fil.obj.sclust - 2U) * SBN_Fs->csize);
+
+  return (f_close(&fil) == FR_OK) ? SBN_OK : SBN_ERROR_IO;
+}
+
+/* Sequential (random == 0) or random sector transfers of 1..maxsect sectors */
+static SBN_StatusTypeDef SBN_Raw(const SBN_ConfigTypeDef *cfg, uint32_t maxsect, uint8_t random)
+{
+  SBN_StatusTypeDef status = SBN_OK;
+  uint32_t nsect;
+  uint32_t slots;
+  uint32_t ops;
+  uint32_t i;
+  uint32_t pass;
+  uint32_t seed;
+  uint32_t t0;
+  uint32_t t1;
+  uint32_t total[2];
+  uint32_t worst[2];
+  DWORD sector;
+  DRESULT res = RES_OK;
+
+#if _FS_REENTRANT
+  if (!ff_req_grant(SBN_Fs->sobj))
+  {
+    return SBN_ERROR;
+  }
+#endif
+
+  for (nsect = 1U; (nsect <= maxsect) && (status == SBN_OK); nsect <<= 1)
+  {
+    slots = cfg->AreaSectors / nsect;
+    if (random != 0U)
+    {
+      ops = cfg->RandOps;
+    }
+    else
+    {
+      ops = cfg->SeqBytes / (nsect * SBN_SECTOR_SIZE);
+    }
+    if (ops == 0U)
+    {
+      ops = 1U;
+    }
+
+    /* Pass 0 writes, pass 1 reads back the same offsets */
+    seed = SBN_Random;
+    for (pass = 0U; (pass < 2U) && (res == RES_OK); pass++)
+    {
+      SBN_Random = seed;
+      total[pass] = 0U;
+      worst[pass] = 0U;
+      for (i = 0U; (i < ops) && (res == RES_OK); i++)
+      {
+        sector = SBN_AreaBase + (((random != 0U) ? (SBN_NextRandom() % slots) : (i % slots)) * nsect);
+        t0 = SBN_TimerRead();
+        res = (pass == 0U) ? disk_write(SBN_Fs->drv, cfg->Buffer, sector, nsect) :
+                             disk_read(SBN_Fs->drv, cfg->Buffer, sector, nsect);
+        t1 = SBN_TimerRead() - t0;
+        total[pass] += t1;
+        if (t1 > worst[pass])
+        {
+          worst[pass] = t1;
+        }
+      }
+      if ((pass == 0U) && (res == RES_OK))
+      {
+        /* Data still in the card cache does not count as written */
+        t0 = SBN_TimerRead();
+        res = disk_ioctl(SBN_Fs->drv, CTRL_SYNC, NULL);
+        total[0] += SBN_TimerRead() - t0;
+      }
+    }
+    if (res != RES_OK)
+    {
+      status = SBN_ERROR_IO;
+      break;
+    }
+
+    if (random != 0U)
+    {
+      SBN_Emit("%s{\"sectors\":%lu,\"write_iops\":%lu,\"read_iops\":%lu,"
+               "\"write_max_us\":%lu,\"read_max_us\":%lu}",
+               (nsect == 1U) ? "" : ",\n", (unsigned long)nsect,
+               (unsigned long)(((uint64_t)ops * SBN_TimerFreq()) / (total[0] ? total[0] : 1U)),
+               (unsigned long)(((uint64_t)ops * SBN_TimerFreq()) / (total[1] ? total[1] : 1U)),
+               (unsigned long)SBN_Micros(worst[0]), (unsigned long)SBN_Micros(worst[1]));
+    }
+    else
+    {
+      SBN_Emit("%s{\"sectors\":%lu,\"write_kBps\":%lu,\"read_kBps\":%lu}",
+               (nsect == 1U) ? "" : ",\n", (unsigned long)nsect,
+               (unsigned long)SBN_Rate(ops * nsect * SBN_SECTOR_SIZE, total[0]),
+               (unsigned long)SBN_Rate(ops * nsect * SBN_SECTOR_SIZE, total[1]));
+    }
+  }
+
+#if _FS_REENTRANT
+  ff_rel_grant(SBN_Fs->sobj);
+#endif
+
+  return status;
+}
+
+/* f_write() latency distribution for a few chunk sizes */
+static SBN_StatusTypeDef SBN_WriteLatency(const SBN_ConfigTypeDef *cfg, const TCHAR *path)
+{
+  static const uint32_t chunks[] = { 512U, 4096U, 32768U };
+  FIL fil;
+  FRESULT res = FR_OK;
+  UINT bw;
+  uint32_t c;
+  uint32_t i;
+  uint32_t n = cfg->WriteChunks;
+  uint32_t t0;
+  uint32_t tclose;
+
+  for (c = 0U; (c < (sizeof(chunks) / sizeof(chunks[0]))) && (chunks[c] <= cfg->BufferSize); c++)
+  {
+    if (f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    {
+      return SBN_ERROR_IO;
+    }
+    for (i = 0U; (i < n) && (res == FR_OK); i++)
+    {
+      t0 = SBN_TimerRead();
+      res = f_write(&fil, cfg->Buffer, chunks[c], &bw);
+      SBN_Latency[i] = SBN_TimerRead() - t0;
+      if ((res == FR_OK) && (bw != chunks[c]))
+      {
+        res = FR_DENIED; /* Volume full */
+      }
+    }
+    t0 = SBN_TimerRead();
+    if ((f_close(&fil) != FR_OK) || (res != FR_OK))
+    {
+      return SBN_ERROR_IO;
+    }
+    tclose = SBN_TimerRead() - t0;
+
+    qsort(SBN_Latency, n, sizeof(SBN_Latency[0]), SBN_CompareU32);
+    SBN_Emit("%s{\"chunk\":%lu,\"p50_us\":%lu,\"p90_us\":%lu,\"p99_us\":%lu,"
+             "\"max_us\":%lu,\"close_us\":%lu}",
+             (c == 0U) ? "" : ",\n", (unsigned long)chunks[c],
+             (unsigned long)SBN_Micros(SBN_Latency[((n - 1U) * 50U) / 100U]),
+             (unsigned long)SBN_Micros(SBN_Latency[((n - 1U) * 90U) / 100U]),
+             (unsigned long)SBN_Micros(SBN_Latency[((n - 1U) * 99U) / 100U]),
+             (unsigned long)SBN_Micros(SBN_Latency[n - 1U]),
+             (unsigned long)SBN_Micros(tclose));
+  }
+
+  return SBN_OK;
+}
+
+/* Cost of linking clusters one by one, of releasing them and of a
+   contiguous preallocation of the same size */
+static SBN_StatusTypeDef SBN_Allocation(const SBN_ConfigTypeDef *cfg, const TCHAR *path)
+{
+  FIL fil;
+  FSIZE_t size = (FSIZE_t)cfg->AllocClusters * SBN_Fs->csize * SBN_SECTOR_SIZE;
+  uint32_t t0;
+  uint32_t textend;
+  uint32_t tsync;
+  uint32_t trelease;
+  uint32_t texpand;
+  uint8_t ok;
+
+  if (f_open(&fil, path, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+  {
+    return SBN_ERROR_IO;
+  }
+
+  /* Seeking past the end in write mode allocates without writing data */
+  t0 = SBN_TimerRead();
+  ok = (f_lseek(&fil, size) == FR_OK) && (f_tell(&fil) == size);
+  textend = SBN_TimerRead() - t0;
+
+  t0 = SBN_TimerRead();
+  ok = ok && (f_sync(&fil) == FR_OK);
+  tsync = SBN_TimerRead() - t0;
+
+  t0 = SBN_TimerRead();
+  ok = ok && (f_lseek(&fil, 0) == FR_OK) && (f_truncate(&fil) == FR_OK) && (f_sync(&fil) == FR_OK);
+  trelease = SBN_TimerRead() - t0;
+
+  t0 = SBN_TimerRead();
+  ok = ok && (f_expand(&fil, size, 1) == FR_OK);
+  texpand = SBN_TimerRead() - t0;
+
+  if ((f_close(&fil) != FR_OK) || !ok)
+  {
+    return SBN_ERROR_IO;
+  }
+
+  SBN_Emit("\"alloc\":{\"clusters\":%lu,\"extend_us\":%lu,\"sync_us\":%lu,"
+           "\"release_us\":%lu,\"expand_us\":%lu},\n",
+           (unsigned long)cfg->AllocClusters, (unsigned long)SBN_Micros(textend),
+           (unsigned long)SBN_Micros(tsync), (unsigned long)SBN_Micros(trelease),
+           (unsigned long)SBN_Micros(texpand));
+
+  return SBN_OK;
+}
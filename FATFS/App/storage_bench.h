@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    storage_bench.h
+  * @brief   Throughput and latency benchmark of the disk I/O layer and FatFs.
+  ******************************************************************************
+  * @attention
+  *
+  * The benchmark creates a contiguous scratch file and drives its sectors
+  * directly through disk_read()/disk_write(), so raw figures exclude the
+  * FAT layer while the volume contents stay intact. It then measures
+  * f_write() latency percentiles per chunk size and the cost of cluster
+  * allocation and release. Results are streamed as one JSON object through
+  * the output callback.
+  *
+  * Only ff.h/diskio.h and the weak timer hooks are used, so the module also
+  * runs on a host against a file-backed diskio with SBN_TimerRead() and
+  * SBN_TimerFreq() overridden.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STORAGE_BENCH_H
+#define __STORAGE_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ff.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define SBN_SECTOR_SIZE         512U
+#define SBN_MAX_SECTORS         128U  /* Largest request of the raw tests  */
+#define SBN_LATENCY_SAMPLES     256U  /* Upper bound of WriteChunks         */
+#define SBN_SCRATCH_NAME        "BENCH.TMP"
+#define SBN_WRITE_NAME          "BENCHW.TMP"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SBN_OK = 0,
+  SBN_ERROR,
+  SBN_ERROR_PARAM,
+  SBN_ERROR_IO,
+} SBN_StatusTypeDef;
+
+typedef void (*SBN_OutputTypeDef)(const char *text, uint32_t len, void *ctx);
+
+typedef struct
+{
+  const TCHAR *Drive;         /* Logical drive path, e.g. "0:/"               */
+  uint8_t     *Buffer;        /* Transfer buffer, 4-byte aligned              */
+  uint32_t     BufferSize;    /* Bytes, caps sector counts and chunk sizes    */
+  uint32_t     AreaSectors;   /* Scratch area of the raw tests                */
+  uint32_t     SeqBytes;      /* Bytes per sequential pass                    */
+  uint32_t     RandOps;       /* Requests per random pass                     */
+  uint32_t     WriteChunks;   /* f_write() calls per latency pass             */
+  uint32_t     AllocClusters; /* Clusters allocated by the allocation test    */
+  uint32_t     Seed;          /* Random offsets are reproducible per seed     */
+} SBN_ConfigTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              SBN_DefaultConfig(SBN_ConfigTypeDef *cfg, uint8_t *buffer, uint32_t size);
+SBN_StatusTypeDef SBN_Run(const SBN_ConfigTypeDef *cfg, SBN_OutputTypeDef out, void *ctx);
+void              SBN_TimerInit(void);
+uint32_t          SBN_TimerRead(void);
+uint32_t          SBN_TimerFreq(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STORAGE_BENCH_H */
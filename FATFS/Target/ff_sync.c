@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @file    ff_sync.c
+  * @brief   Cooperative FatFs synchronization handlers and LFN work areas.
+  ******************************************************************************
+  * @attention
+  *
+  * The firmware runs a single cooperative main loop, so the grant is a plain
+  * flag taken with LDREX/STREX and a busy volume is never waited for. See
+  * ff_sync.h for why.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "ff.h"
+#include "ff_sync.h"
+#include "main.h"
+#include "mempool.h"
+
+#if _FS_REENTRANT
+
+/* Private define ------------------------------------------------------------*/
+/* Size of one LFN working buffer as requested by ff.c (_USE_LFN == 3) */
+#if _FS_EXFAT
+#define FS_NAMEBUF_SIZE   ((_MAX_LFN + 1) * 2 + ((_MAX_LFN + 44U) / 15 * 32))
+#else
+#define FS_NAMEBUF_SIZE   ((_MAX_LFN + 1) * 2)
+#endif
+
+#if (FS_NAMEBUF_SIZE > POOL_FRAME_SIZE)
+#error "The LFN working buffer does not fit in a POOL_FRAME block"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static FS_SyncTypeDef FS_SyncObj[_VOLUMES];
+
+/* Name buffer of each volume, a POOL_FRAME block (1120 bytes with exFAT)
+   held only while ff.c runs a call with the grant */
+static void *FS_NameBuf[_VOLUMES];
+
+/* Private functions ---------------------------------------------------------*/
+static int FS_Sync_TryLock(FS_SyncTypeDef *sobj)
+{
+  do
+  {
+    if (__LDREXW(&sobj->Lock) != 0U)
+    {
+      __CLREX();
+      return 0;
+    }
+  } while (__STREXW(1U, &sobj->Lock) != 0U);
+  __DMB();
+
+  return 1;
+}
+
+/**
+  * @brief  Returns the contention counters of a volume
+  * @param  vol: Logical drive number
+  * @retval Pointer to the sync object or NULL
+  */
+const FS_SyncTypeDef *FS_Sync_GetStats(uint8_t vol)
+{
+  return (vol < _VOLUMES) ? &FS_SyncObj[vol] : NULL;
+}
+
+/*------------------------------------------------------------------------*/
+/* Create a Synchronization Object                                        */
+/*------------------------------------------------------------------------*/
+int ff_cre_syncobj(BYTE vol, _SYNC_t *sobj)
+{
+  if (vol >= _VOLUMES)
+  {
+    return 0;
+  }
+
+  FS_SyncObj[vol].Lock    = 0U;
+  FS_SyncObj[vol].Volume  = vol;
+  FS_SyncObj[vol].Grants  = 0U;
+  FS_SyncObj[vol].Refused = 0U;
+  FS_NameBuf[vol]         = NULL;
+  *sobj = &FS_SyncObj[vol];
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Delete a Synchronization Object                                        */
+/*------------------------------------------------------------------------*/
+int ff_del_syncobj(_SYNC_t sobj)
+{
+  if (sobj == NULL)
+  {
+    return 0;
+  }
+
+  sobj->Lock = 0U;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Request Grant to Access the Volume                                     */
+/*------------------------------------------------------------------------*/
+int ff_req_grant(_SYNC_t sobj)
+{
+  /* A busy volume is held by a call suspended below this one, see ff_sync.h */
+  if (FS_Sync_TryLock(sobj) == 0)
+  {
+    sobj->Refused++;
+    return 0;
+  }
+  sobj->Grants++;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Release Grant to Access the Volume                                     */
+/*------------------------------------------------------------------------*/
+void ff_rel_grant(_SYNC_t sobj)
+{
+  __DMB();
+  sobj->Lock = 0U;
+}
+
+/*------------------------------------------------------------------------*/
+/* LFN working buffers (ff_malloc/ff_free, see ffconf.h)                  */
+/*------------------------------------------------------------------------*/
+void *FS_NameBuf_Alloc(UINT msize)
+{
+  uint32_t vol;
+
+  if (msize > POOL_FRAME_SIZE)
+  {
+    return NULL;
+  }
+
+  for (vol = 0U; vol < _VOLUMES; vol++)
+  {
+    if ((FS_SyncObj[vol].Lock != 0U) && (FS_NameBuf[vol] == NULL))
+    {
+      FS_NameBuf[vol] = POOL_Alloc(POOL_FRAME, "lfn");
+      return FS_NameBuf[vol];
+    }
+  }
+
+  return NULL;
+}
+
+void FS_NameBuf_Free(void *mblock)
+{
+  uint32_t vol;
+
+  for (vol = 0U; vol < _VOLUMES; vol++)
+  {
+    if ((mblock != NULL) && (mblock == FS_NameBuf[vol]))
+    {
+      POOL_Free(mblock);
+      FS_NameBuf[vol] = NULL;
+    }
+  }
+}
+
+#endif /* _FS_REENTRANT */
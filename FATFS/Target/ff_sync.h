@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    ff_sync.h
+  * @brief   Cooperative synchronization object for the reentrant FatFs
+  *          configuration (_FS_REENTRANT = 1) without an RTOS.
+  ******************************************************************************
+  * @attention
+  *
+  * Every FatFs user (recorder, journal, console commands) runs in the one
+  * cooperative main loop, so in thread mode a volume is never found busy:
+  * the previous call has returned before the next one starts. The grant
+  * only guards against a call made while another one is in progress below
+  * it on the same stack, i.e. from an interrupt handler or a hook run from
+  * inside FatFs. The holder cannot resume before that call returns, so
+  * waiting would never succeed: the request is refused at once, the call
+  * fails with FR_TIMEOUT and is counted in Refused.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FF_SYNC_H
+#define __FF_SYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  volatile uint32_t Lock;         /* 0: free, 1: granted                    */
+  uint8_t           Volume;       /* Logical drive the object belongs to    */
+  uint32_t          Grants;       /* Number of successful grants            */
+  uint32_t          Refused;      /* Requests that found the volume busy    */
+} FS_SyncTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+const FS_SyncTypeDef *FS_Sync_GetStats(uint8_t vol);
+void                 *FS_NameBuf_Alloc(unsigned int msize);
+void                  FS_NameBuf_Free(void *mblock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FF_SYNC_H */
@@ -67,10 +67,6 @@
   */
 #define TRACE_SET_TAG_ID(_PORT_, _TAG_)         (((_PORT_) << TRACE_PORT_BIT_POSITION) | (_TAG_))
 
-#define TRACER_EMB_WRITE_DATA(_POSITION_,_DATA_)  do {                                        \
-                                                       TRACER_EMB_WriteData((_POSITION_),(_DATA_));\
-                                                       (_POSITION_) = ((_POSITION_) + 1u);         \
-                                                     } while(0)
 /**
   * @}
   */
@@ -130,13 +126,32 @@ void USBPD_TRACE_DeInit(void)
 void  USBPD_TRACE_Add(TRACE_EVENT Type, uint8_t PortNum, uint8_t Sop, uint8_t *Ptr, uint32_t Size)
 {
 #if defined(_TRACE)
+  static const uint8_t _eof[TLV_EOF_SIZE] = { TLV_EOF, TLV_EOF, TLV_EOF, TLV_EOF };
+  uint8_t _header[TLV_SOF_SIZE + TLV_HEADER_SIZE + TRACE_SIZE_HEADER_TRACE];
   uint32_t _time;
   int32_t _allocation;
-  uint16_t index;
 
   /*  Get trace timing */
   _time = HAL_GetTick();
 
+  /* Build SOF, TAG, LENGTH and the trace header, then copy the frame in three blocks */
+  _header[0]  = TLV_SOF;
+  _header[1]  = TLV_SOF;
+  _header[2]  = TLV_SOF;
+  _header[3]  = TLV_SOF;
+  _header[4]  = TRACE_SET_TAG_ID((PortNum + 1u), DEBUG_STACK_MESSAGE);
+  _header[5]  = (uint8_t)((Size + TRACE_SIZE_HEADER_TRACE) >> 8u);
+  _header[6]  = (uint8_t)(Size + TRACE_SIZE_HEADER_TRACE);
+  _header[7]  = (uint8_t)Type;
+  _header[8]  = (uint8_t)_time;
+  _header[9]  = (uint8_t)(_time >> 8u);
+  _header[10] = (uint8_t)(_time >> 16u);
+  _header[11] = (uint8_t)(_time >> 24u);
+  _header[12] = PortNum;
+  _header[13] = Sop;
+  _header[14] = (uint8_t)(Size >> 8u);
+  _header[15] = (uint8_t)Size;
+
   TRACER_EMB_Lock();
 
   /* Data are encapsulate inside a TLV string*/
@@ -149,42 +164,16 @@ void  USBPD_TRACE_Add(TRACE_EVENT Type, uint8_t PortNum, uint8_t Sop, uint8_t *P
   {
     uint16_t _writepos = (uint16_t)_allocation;
 
-    /* Copy SOF bytes */
-    for (index = 0u; index < TLV_SOF_SIZE; index++)
-    {
-      TRACER_EMB_WRITE_DATA(_writepos, TLV_SOF);
-    }
-    /* Copy the TAG */
-    TRACER_EMB_WRITE_DATA(_writepos, TRACE_SET_TAG_ID((PortNum + 1u), DEBUG_STACK_MESSAGE));
-    /* Copy the LENGTH */
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)((Size + TRACE_SIZE_HEADER_TRACE) >> 8u));
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)(Size + TRACE_SIZE_HEADER_TRACE));
-
-    /* Trace type */
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)Type);
-
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)_time);
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)(_time >> 8u));
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)(_time >> 16u));
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)(_time >> 24u));
+    TRACER_EMB_WriteBlock(_writepos, _header, sizeof(_header));
+    _writepos += (uint16_t)sizeof(_header);
 
-    TRACER_EMB_WRITE_DATA(_writepos, PortNum);
-    TRACER_EMB_WRITE_DATA(_writepos, Sop);
-
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)(Size >> 8u));
-    TRACER_EMB_WRITE_DATA(_writepos, (uint8_t)Size);
-
-    /* initialize the Ptr for Read/Write */
-    for (index = 0u; index < Size; index++)
+    if (Size != 0u)
     {
-      TRACER_EMB_WRITE_DATA(_writepos, Ptr[index]);
+      TRACER_EMB_WriteBlock(_writepos, Ptr, Size);
+      _writepos += (uint16_t)Size;
     }
 
-    /* Copy EOF bytes */
-    for (index = 0u; index < TLV_EOF_SIZE; index++)
-    {
-      TRACER_EMB_WRITE_DATA(_writepos, TLV_EOF);
-    }
+    TRACER_EMB_WriteBlock(_writepos, _eof, TLV_EOF_SIZE);
   }
 
   TRACER_EMB_UnLock();
@@ -24,7 +24,8 @@
 #include "../ff.h"
 
 
-#if _FS_REENTRANT
+/* Without CMSIS-RTOS the handlers are provided by FATFS/Target/ff_sync.c */
+#if _FS_REENTRANT && defined(osCMSIS)
 /*------------------------------------------------------------------------*/
 /* Create a Synchronization Object                                        */
 /*------------------------------------------------------------------------*/
@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    cmsis_compiler.h
+  * @brief   Host stand-in for the CMSIS compiler abstraction.
+  ******************************************************************************
+  * @attention
+  *
+  * Only the attribute macros used by the headers the host checks include
+  * (usbpd_def.h and friends, usbpd_dpm_core.c), spelled for GCC and Clang.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+/* Exported macro ------------------------------------------------------------*/
+#ifndef __PACKED
+#define __PACKED            __attribute__((packed))
+#endif
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT     struct __attribute__((packed))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)        __attribute__((aligned(x)))
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE     static inline
+#endif
+#ifndef __weak
+#define __weak              __attribute__((weak))
+#endif
+#ifndef __WEAK
+#define __WEAK              __attribute__((weak))
+#endif
+
+#endif /* __CMSIS_COMPILER_H */
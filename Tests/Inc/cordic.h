@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    cordic.h
+  * @brief   Host stand-in for Core/Inc/cordic.h and the HAL CORDIC driver.
+  ******************************************************************************
+  * @attention
+  *
+  * host_cordic.c computes the cosine function in the configuration the
+  * firmware uses it (q31 angle, 1.0 = pi, modulus 1.0, cos then sin per
+  * angle) in double precision, rounded to q31. Any other configuration
+  * is refused with HAL_ERROR.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CORDIC_H__
+#define __CORDIC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define CORDIC_FUNCTION_COSINE      0x00000000U
+#define CORDIC_FUNCTION_SINE        0x00000001U
+#define CORDIC_SCALE_0              0x00000000U
+#define CORDIC_INSIZE_32BITS        0x00000000U
+#define CORDIC_OUTSIZE_32BITS       0x00000000U
+#define CORDIC_NBWRITE_1            0x00000000U
+#define CORDIC_NBWRITE_2            0x00100000U
+#define CORDIC_NBREAD_1             0x00000000U
+#define CORDIC_NBREAD_2             0x00080000U
+#define CORDIC_PRECISION_6CYCLES    0x00000060U
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Function;
+  uint32_t Scale;
+  uint32_t InSize;
+  uint32_t OutSize;
+  uint32_t NbWrite;
+  uint32_t NbRead;
+  uint32_t Precision;
+} CORDIC_ConfigTypeDef;
+
+typedef struct
+{
+  CORDIC_ConfigTypeDef Config;
+  uint32_t             Configured;
+} CORDIC_HandleTypeDef;
+
+extern CORDIC_HandleTypeDef hcordic;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_CORDIC_Configure(CORDIC_HandleTypeDef *hcordic, const CORDIC_ConfigTypeDef *sConfig);
+HAL_StatusTypeDef HAL_CORDIC_Calculate(CORDIC_HandleTypeDef *hcordic, const int32_t *pInBuff, int32_t *pOutBuff,
+                                       uint32_t NbCalc, uint32_t Timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CORDIC_H__ */
@@ -0,0 +1,41 @@
+/**
+  ******************************************************************************
+  * @file    crc.h
+  * @brief   Host stand-in for Core/Inc/crc.h and the HAL CRC driver.
+  ******************************************************************************
+  * @attention
+  *
+  * host_crc.c computes the CRC in the configuration of MX_CRC_Init():
+  * default CRC-32 polynomial 0x04C11DB7 and initial value 0xFFFFFFFF,
+  * byte input, no bit reversal, no final XOR. BufferLength counts bytes.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CRC_H__
+#define __CRC_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Calls;
+} CRC_HandleTypeDef;
+
+extern CRC_HandleTypeDef hcrc;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC_H__ */
@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    fake_usbpd.h
+  * @brief   Fake PE/PRL/CAD of the USB PD library for the host checks.
+  ******************************************************************************
+  * @attention
+  *
+  * fake_usbpd.c implements the library entry points the DPM core and user
+  * code call (usbpd_core.h, usbpd_trace.h) and the VBUS side of the board
+  * (BSP_USBPD_PWR_*, HW_IF_PWR_*), so the real usbpd_dpm_core.c,
+  * usbpd_dpm_user.c and usbpd_pwr_if.c link on the host.
+  *
+  * A check plays the source and the cable: FAKE_Attach(), FAKE_Detach()
+  * and FAKE_Receive() queue an event and wake the CAD or PE task through
+  * the callbacks the DPM registered, the next USBPD_DPM_Run() pass hands
+  * it over exactly like the library would. Requests the DPM sends are
+  * captured in FAKE_PortTypeDef instead of going on the wire.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FAKE_USBPD_H
+#define __FAKE_USBPD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  FAKE_MSG_SRC_CAPS = 0,    /* Source_Capabilities                          */
+  FAKE_MSG_ACCEPT,
+  FAKE_MSG_REJECT,
+  FAKE_MSG_WAIT,
+  FAKE_MSG_PS_RDY,
+  FAKE_MSG_HARD_RESET,      /* Hard Reset signalled by the source           */
+} FAKE_MsgTypeDef;
+
+typedef struct
+{
+  uint32_t                    Requests;   /* Requests sent, cleared by the check  */
+  uint32_t                    Rdo;        /* Last request                         */
+  USBPD_CORE_PDO_Type_TypeDef Type;
+  uint32_t                    Tick;       /* HAL_GetTick() when it was sent       */
+  uint32_t                    Refused;    /* USBPD_PE_Send_Request() answered BUSY */
+  uint32_t                    PeTicks;    /* USBPD_PE_TimerCounter() calls        */
+  uint32_t                    PrlTicks;   /* USBPD_PRL_TimerCounter() calls       */
+  USBPD_FunctionalState       PowerReady; /* vSafe5V answer of the DPM at attach  */
+  uint32_t                    Vbus;       /* Virtual VBUS in mV                   */
+} FAKE_PortTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void              FAKE_Attach(uint8_t PortNum);
+void              FAKE_Detach(uint8_t PortNum);
+void              FAKE_Receive(uint8_t PortNum, FAKE_MsgTypeDef Msg, const uint32_t *Pdos, uint32_t Count);
+void              FAKE_Hold(uint8_t PortNum, uint8_t Hold);
+FAKE_PortTypeDef *FAKE_GetPort(uint8_t PortNum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FAKE_USBPD_H */
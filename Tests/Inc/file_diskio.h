@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file    file_diskio.h
+  * @brief   FatFs disk I/O on a host image file.
+  ******************************************************************************
+  * @attention
+  *
+  * Drive 0 is an image file of 512-byte sectors, created sparse at the
+  * requested size. Reads and writes are counted so that a check can tell
+  * which sectors a module touched. A snapshot copies the image as a power
+  * loss would leave it, now or in the middle of the writes to come, and
+  * HOST_DiskAttach() mounts it back.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FILE_DISKIO_H
+#define __FILE_DISKIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Reads;           /* disk_read() calls          */
+  uint32_t Writes;          /* disk_write() calls         */
+  uint32_t SectorsRead;
+  uint32_t SectorsWritten;
+} HOST_DiskStatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+int  HOST_DiskOpen(const char *path, uint32_t sectors);
+int  HOST_DiskAttach(const char *path);
+int  HOST_DiskSnapshot(const char *path);
+void HOST_DiskSnapshotAfter(uint32_t sectors, uint32_t bytes, const char *path);
+int  HOST_DiskSnapshotPending(void);
+void HOST_DiskClose(void);
+const HOST_DiskStatsTypeDef *HOST_DiskStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FILE_DISKIO_H */
@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    host_check.h
+  * @brief   Assertions of the host checks.
+  ******************************************************************************
+  * @attention
+  *
+  * CHECK() reports a failed condition with its location and carries on, so
+  * that one run lists every failure. A check program ends with
+  * "return HOST_CheckDone();", which prints the totals and gives the exit
+  * status make sees: 0 when every CHECK() held, 1 otherwise.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HOST_CHECK_H
+#define __HOST_CHECK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macro ------------------------------------------------------------*/
+#define CHECK(cond)             HOST_Check((cond) ? 1 : 0, #cond, __FILE__, __LINE__, NULL)
+#define CHECK_MSG(cond, ...)    HOST_Check((cond) ? 1 : 0, #cond, __FILE__, __LINE__, __VA_ARGS__)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void    HOST_Check(int ok, const char *expr, const char *file, int line, const char *fmt, ...);
+int     HOST_CheckDone(void);
+int32_t HOST_ConsoleRun(const char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_CHECK_H */
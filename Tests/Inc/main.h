@@ -0,0 +1,161 @@
+/**
+  ******************************************************************************
+  * @file    main.h
+  * @brief   Host stand-in for Core/Inc/main.h.
+  ******************************************************************************
+  * @attention
+  *
+  * Only the CMSIS and HAL pieces the portable modules rely on, on top of
+  * the C library. Exclusive access, interrupt masking and __WFI() are
+  * no-ops: the host checks run on one thread. The DSP intrinsics compute
+  * what the Cortex-M4 instructions do. HAL_GetTick() is the virtual tick of
+  * host_hal.c, it only moves when a check advances it.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported macro ------------------------------------------------------------*/
+#ifndef __weak
+#define __weak              __attribute__((weak))
+#endif
+#define UNUSED(X)           (void)X
+
+#define CCMRAM_TEXT
+#define CCMRAM_DATA
+#define CCMRAM_BSS
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  HAL_OK      = 0x00U,
+  HAL_ERROR   = 0x01U,
+  HAL_BUSY    = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* Exported functions --------------------------------------------------------*/
+static inline uint32_t __LDREXW(volatile uint32_t *addr)
+{
+  return *addr;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+{
+  *addr = value;
+  return 0U;
+}
+
+static inline void __CLREX(void)
+{
+}
+
+static inline void __DMB(void)
+{
+}
+
+static inline void __NOP(void)
+{
+}
+
+static inline uint32_t __get_PRIMASK(void)
+{
+  return 0U;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+  (void)primask;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+static inline void __enable_irq(void)
+{
+}
+
+static inline void __WFI(void)
+{
+}
+
+static inline uint32_t __get_IPSR(void)
+{
+  return 0U;
+}
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+  return (value == 0U) ? 32U : (uint32_t)__builtin_clz(value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+  uint32_t result = 0U;
+  uint32_t i;
+
+  for (i = 0U; i < 32U; i++)
+  {
+    result = (result << 1U) | ((value >> i) & 1U);
+  }
+  return result;
+}
+
+static inline int32_t __SSAT(int32_t value, uint32_t bits)
+{
+  const int32_t max = (int32_t)((1UL << (bits - 1U)) - 1U);
+
+  return (value > max) ? max : ((value < (-max - 1)) ? (-max - 1) : value);
+}
+
+/* Dual 16-bit multiply, both products added to a 64-bit accumulator */
+static inline uint64_t __SMLALD(uint32_t x, uint32_t y, uint64_t acc)
+{
+  return acc + (uint64_t)((int64_t)(int16_t)x * (int16_t)y)
+             + (uint64_t)((int64_t)(int16_t)(x >> 16) * (int16_t)(y >> 16));
+}
+
+/* Cycle counter of the DWT, never moves on the host */
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk          1UL
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+extern DWT_Type       HostDwt;
+extern CoreDebug_Type HostCoreDebug;
+#define DWT                 (&HostDwt)
+#define CoreDebug           (&HostCoreDebug)
+
+extern uint32_t SystemCoreClock;
+
+uint32_t HAL_GetTick(void);
+void     HAL_Delay(uint32_t delay);
+void     HOST_TickAdvance(uint32_t ms);
+void     Error_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file    rng.h
+  * @brief   Host stand-in for Core/Inc/rng.h and the HAL RNG driver.
+  ******************************************************************************
+  * @attention
+  *
+  * host_rng.c draws from a fixed xorshift sequence, so every run sees the
+  * same numbers. HOST_RngForce() makes the next draws return one value, to
+  * reproduce a collision; HAL_ERROR can be forced the same way.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t State;           /* xorshift32 state                        */
+  uint32_t Forced;          /* Draws left returning Value              */
+  uint32_t Value;
+  HAL_StatusTypeDef Status; /* Returned by the forced draws            */
+} RNG_HandleTypeDef;
+
+extern RNG_HandleTypeDef hrng;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit);
+void              HOST_RngForce(uint32_t draws, uint32_t value, HAL_StatusTypeDef status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RNG_H__ */
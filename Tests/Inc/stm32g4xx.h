@@ -0,0 +1,13 @@
+/**
+  ******************************************************************************
+  * @file    stm32g4xx.h
+  * @brief   Host stand-in for the CMSIS device header, see main.h.
+  ******************************************************************************
+  */
+
+#ifndef __STM32G4xx_H
+#define __STM32G4xx_H
+
+#include "main.h"
+
+#endif /* __STM32G4xx_H */
@@ -0,0 +1,13 @@
+/**
+  ******************************************************************************
+  * @file    stm32g4xx_hal.h
+  * @brief   Host stand-in for the HAL umbrella header, see main.h.
+  ******************************************************************************
+  */
+
+#ifndef __STM32G4xx_HAL_H
+#define __STM32G4xx_HAL_H
+
+#include "main.h"
+
+#endif /* __STM32G4xx_HAL_H */
@@ -0,0 +1,35 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_hw_if.h
+  * @brief   Host stand-in for the UCPD hardware interface of the PD library.
+  ******************************************************************************
+  * @attention
+  *
+  * Only the VBUS measurement entry points usbpd_pwr_if.c calls; the fake
+  * stack of fake_usbpd.c answers them from its virtual VBUS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_HW_IF_H_
+#define __USBPD_HW_IF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+#include "usbpd_pwr_user.h"
+#include "usbpd_pwr_if.h"
+
+/* Exported functions --------------------------------------------------------*/
+uint16_t HW_IF_PWR_GetVoltage(uint8_t PortNum);
+int16_t  HW_IF_PWR_GetCurrent(uint8_t PortNum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_HW_IF_H_ */
@@ -0,0 +1,502 @@
+/**
+  ******************************************************************************
+  * @file    fake_usbpd.c
+  * @brief   Fake PE/PRL/CAD of the USB PD library for the host checks.
+  ******************************************************************************
+  * @attention
+  *
+  * The fake follows the sink side of an explicit contract only:
+  *   - attach: the data role is UFP, the revision PD3.0, and the PE asks
+  *     the DPM whether VBUS is at vSafe5V before leaving PE_SNK_Startup;
+  *   - Source_Capabilities: stored through SetDataInfo, evaluated through
+  *     SNK_EvaluateCapabilities and the request is sent;
+  *   - a request is outstanding until Accept + PS_RDY, Reject or Wait,
+  *     USBPD_PE_Send_Request() answers USBPD_BUSY meanwhile, as it does
+  *     outside PE_SNK_Ready or while FAKE_Hold() simulates another AMS;
+  *   - Hard Reset: contract and RDO position dropped, DPM notified.
+  * One queued message is handled per PE pass. Everything else the library
+  * offers answers USBPD_ERROR.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "usbpd_core.h"
+#include "usbpd_trace.h"
+#include "usbpd_hw_if.h"
+#include "fake_usbpd.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FAKE_QUEUE_SIZE       4U
+#define FAKE_NO_DEADLINE      0xFFFFFFFFU
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  FAKE_MsgTypeDef Msg;
+  uint32_t        Pdos[USBPD_MAX_NB_PDO];
+  uint32_t        Count;
+} FAKE_EventTypeDef;
+
+typedef struct
+{
+  USBPD_ParamsTypeDef       *Params;
+  const USBPD_PE_Callbacks  *Cbs;
+  FAKE_EventTypeDef          Queue[FAKE_QUEUE_SIZE];
+  uint32_t                   Head;
+  uint32_t                   Tail;
+  uint32_t                   Pdos[USBPD_MAX_NB_PDO];  /* Last Source_Capabilities */
+  uint32_t                   PdoCount;
+  uint8_t                    Connected;
+  uint8_t                    Outstanding;             /* Request not answered yet */
+  uint8_t                    Contract;
+  uint8_t                    Hold;
+  uint8_t                    CadEvent;                /* 1 attach, 2 detach       */
+} FAKE_StackTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const USBPD_CAD_Callbacks *FakeCadCbs;
+static FAKE_StackTypeDef FakeStack[USBPD_PORT_COUNT];
+static FAKE_PortTypeDef  FakePort[USBPD_PORT_COUNT];
+
+/* Private functions ---------------------------------------------------------*/
+/* Voltage the source settles to under a request */
+static uint32_t FAKE_RequestVoltage(const FAKE_StackTypeDef *stack, uint32_t Rdo, USBPD_CORE_PDO_Type_TypeDef Type)
+{
+  USBPD_SNKRDO_TypeDef rdo;
+  USBPD_PDO_TypeDef pdo;
+
+  rdo.d32 = Rdo;
+  if (Type == USBPD_CORE_PDO_TYPE_APDO)
+  {
+    return rdo.ProgRDO.OutputVoltageIn20mV * 20U;
+  }
+  if ((rdo.GenericRDO.ObjectPosition == 0U) || (rdo.GenericRDO.ObjectPosition > stack->PdoCount))
+  {
+    return 5000U;
+  }
+  pdo.d32 = stack->Pdos[rdo.GenericRDO.ObjectPosition - 1U];
+  return pdo.SRCFixedPDO.VoltageIn50mVunits * 50U;
+}
+
+static void FAKE_Send(uint8_t PortNum, uint32_t Rdo, USBPD_CORE_PDO_Type_TypeDef Type)
+{
+  FakePort[PortNum].Requests++;
+  FakePort[PortNum].Rdo  = Rdo;
+  FakePort[PortNum].Type = Type;
+  FakePort[PortNum].Tick = HAL_GetTick();
+  FakeStack[PortNum].Outstanding  = 1U;
+  FakeStack[PortNum].Params->PE_Power = USBPD_POWER_TRANSITION;
+}
+
+static void FAKE_Handle(uint8_t PortNum, const FAKE_EventTypeDef *event)
+{
+  FAKE_StackTypeDef *stack = &FakeStack[PortNum];
+  const USBPD_PE_Callbacks *cbs = stack->Cbs;
+  uint32_t rdo = 0U;
+  uint32_t position = 0U;
+  USBPD_CORE_PDO_Type_TypeDef type = USBPD_CORE_PDO_TYPE_FIXED;
+
+  switch (event->Msg)
+  {
+    case FAKE_MSG_SRC_CAPS:
+      stack->PdoCount = event->Count;
+      (void)memcpy(stack->Pdos, event->Pdos, event->Count * sizeof(uint32_t));
+      cbs->USBPD_PE_SetDataInfo(PortNum, USBPD_CORE_DATATYPE_RCV_SRC_PDO, (uint8_t *)stack->Pdos,
+                                event->Count * sizeof(uint32_t));
+      cbs->USBPD_PE_SNK_EvaluateCapabilities(PortNum, &rdo, &type);
+      FAKE_Send(PortNum, rdo, type);
+      break;
+
+    case FAKE_MSG_ACCEPT:
+      cbs->USBPD_PE_Notify(PortNum, USBPD_NOTIFY_REQUEST_ACCEPTED);
+      break;
+
+    case FAKE_MSG_PS_RDY:
+      FakePort[PortNum].Vbus = FAKE_RequestVoltage(stack, FakePort[PortNum].Rdo, FakePort[PortNum].Type);
+      stack->Outstanding = 0U;
+      stack->Contract    = 1U;
+      stack->Params->PE_Power = USBPD_POWER_EXPLICITCONTRACT;
+      cbs->USBPD_PE_Notify(PortNum, USBPD_NOTIFY_POWER_EXPLICIT_CONTRACT);
+      break;
+
+    case FAKE_MSG_REJECT:
+    case FAKE_MSG_WAIT:
+      stack->Outstanding = 0U;
+      stack->Params->PE_Power = (stack->Contract != 0U) ? USBPD_POWER_EXPLICITCONTRACT : USBPD_POWER_DEFAULT5V;
+      cbs->USBPD_PE_Notify(PortNum, (event->Msg == FAKE_MSG_REJECT) ? USBPD_NOTIFY_REQUEST_REJECTED
+                                                                    : USBPD_NOTIFY_REQUEST_WAIT);
+      break;
+
+    case FAKE_MSG_HARD_RESET:
+      cbs->USBPD_PE_HardReset(PortNum, USBPD_PORTPOWERROLE_SNK, USBPD_HR_STATUS_START_ACK);
+      stack->Outstanding = 0U;
+      stack->Contract    = 0U;
+      stack->PdoCount    = 0U;
+      stack->Params->PE_Power = USBPD_POWER_DEFAULT5V;
+      FakePort[PortNum].Vbus  = 5000U;
+      cbs->USBPD_PE_SetDataInfo(PortNum, USBPD_CORE_DATATYPE_RDO_POSITION, (uint8_t *)&position, 4U);
+      cbs->USBPD_PE_Notify(PortNum, USBPD_NOTIFY_HARDRESET_RX);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Plugs a PD3.0 source in, VBUS at 5 V
+  * @param  PortNum Port number
+  * @retval None
+  */
+void FAKE_Attach(uint8_t PortNum)
+{
+  FakePort[PortNum].Vbus = 5000U;
+  FakeStack[PortNum].CadEvent = 1U;
+  FakeCadCbs->USBPD_CAD_WakeUp();
+}
+
+/**
+  * @brief  Unplugs the source, VBUS drops to 0 V
+  * @param  PortNum Port number
+  * @retval None
+  */
+void FAKE_Detach(uint8_t PortNum)
+{
+  FakePort[PortNum].Vbus = 0U;
+  FakeStack[PortNum].CadEvent = 2U;
+  FakeCadCbs->USBPD_CAD_WakeUp();
+}
+
+/**
+  * @brief  Queues a message from the source for the next PE pass
+  * @param  PortNum Port number
+  * @param  Msg     Message
+  * @param  Pdos    FAKE_MSG_SRC_CAPS: source PDOs, NULL otherwise
+  * @param  Count   FAKE_MSG_SRC_CAPS: number of PDOs
+  * @retval None
+  */
+void FAKE_Receive(uint8_t PortNum, FAKE_MsgTypeDef Msg, const uint32_t *Pdos, uint32_t Count)
+{
+  FAKE_StackTypeDef *stack = &FakeStack[PortNum];
+  FAKE_EventTypeDef *event = &stack->Queue[stack->Head % FAKE_QUEUE_SIZE];
+
+  if (((stack->Head - stack->Tail) >= FAKE_QUEUE_SIZE) || (Count > USBPD_MAX_NB_PDO))
+  {
+    Error_Handler();
+  }
+  event->Msg   = Msg;
+  event->Count = (Pdos != NULL) ? Count : 0U;
+  if (event->Count != 0U)
+  {
+    (void)memcpy(event->Pdos, Pdos, Count * sizeof(uint32_t));
+  }
+  stack->Head++;
+  stack->Cbs->USBPD_PE_WakeupCallback(PortNum);
+}
+
+/**
+  * @brief  Keeps the PE in another AMS: requests are refused while set
+  * @param  PortNum Port number
+  * @param  Hold    1 to refuse, 0 to release
+  * @retval None
+  */
+void FAKE_Hold(uint8_t PortNum, uint8_t Hold)
+{
+  FakeStack[PortNum].Hold = Hold;
+}
+
+/**
+  * @brief  Observed state of a port
+  * @param  PortNum Port number
+  * @retval Port state, writable so a check can clear the counters
+  */
+FAKE_PortTypeDef *FAKE_GetPort(uint8_t PortNum)
+{
+  return &FakePort[PortNum];
+}
+
+/* Library entry points ------------------------------------------------------*/
+uint32_t USBPD_PE_CheckLIB(uint32_t LibId)
+{
+  return (LibId == _LIB_ID) ? USBPD_TRUE : USBPD_FALSE;
+}
+
+uint32_t USBPD_PE_GetMemoryConsumption(void)
+{
+  return 0U;
+}
+
+USBPD_CAD_StatusTypeDef USBPD_CAD_Init(uint8_t PortNum, const USBPD_CAD_Callbacks *CallbackFunctions,
+                                       const USBPD_SettingsTypeDef *pSettings, USBPD_ParamsTypeDef *pParams)
+{
+  UNUSED(pSettings);
+
+  FakeCadCbs = CallbackFunctions;
+  FakeStack[PortNum].Params = pParams;
+
+  return USBPD_CAD_OK;
+}
+
+void USBPD_CAD_PortEnable(uint8_t PortNum, USBPD_CAD_activation State)
+{
+  UNUSED(PortNum);
+  UNUSED(State);
+}
+
+void USBPD_CAD_EnterErrorRecovery(uint8_t PortNum)
+{
+  FAKE_Detach(PortNum);
+}
+
+uint32_t USBPD_CAD_Process(void)
+{
+  uint8_t port;
+  uint8_t event;
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    event = FakeStack[port].CadEvent;
+    FakeStack[port].CadEvent = 0U;
+    if (event == 1U)
+    {
+      FakeCadCbs->USBPD_CAD_CallbackEvent(port, USBPD_CAD_EVENT_ATTACHED, CC1);
+    }
+    else if ((event == 2U) && (USBPD_PWR_IF_GetVBUSStatus(port, USBPD_PWR_SNKDETACH) == USBPD_TRUE))
+    {
+      FakeCadCbs->USBPD_CAD_CallbackEvent(port, USBPD_CAD_EVENT_DETACHED, CCNONE);
+    }
+  }
+
+  return FAKE_NO_DEADLINE;
+}
+
+USBPD_StatusTypeDef USBPD_PE_Init(uint8_t PortNum, USBPD_SettingsTypeDef *pSettings, USBPD_ParamsTypeDef *pParams,
+                                  const USBPD_PE_Callbacks *PECallbacks)
+{
+  UNUSED(pSettings);
+
+  (void)memset(&FakeStack[PortNum], 0, sizeof(FakeStack[PortNum]));
+  (void)memset(&FakePort[PortNum], 0, sizeof(FakePort[PortNum]));
+  FakeStack[PortNum].Params = pParams;
+  FakeStack[PortNum].Cbs    = PECallbacks;
+
+  return USBPD_OK;
+}
+
+void USBPD_PE_IsCableConnected(uint8_t PortNum, uint8_t IsConnected)
+{
+  FAKE_StackTypeDef *stack = &FakeStack[PortNum];
+
+  stack->Connected   = IsConnected;
+  stack->Outstanding = 0U;
+  stack->Contract    = 0U;
+  stack->PdoCount    = 0U;
+  stack->Tail        = stack->Head;
+  if (IsConnected != 0U)
+  {
+    stack->Params->PE_SpecRevision = USBPD_SPECIFICATION_REV3;
+    stack->Params->PE_DataRole     = USBPD_PORTDATAROLE_UFP;
+    FakePort[PortNum].PowerReady   = stack->Cbs->USBPD_PE_IsPowerReady(PortNum, USBPD_VSAFE_5V);
+    stack->Params->PE_Power        = USBPD_POWER_DEFAULT5V;
+  }
+}
+
+uint32_t USBPD_PE_StateMachine_SNK(uint8_t PortNum)
+{
+  FAKE_StackTypeDef *stack = &FakeStack[PortNum];
+
+  if ((stack->Connected == 0U) || (stack->Head == stack->Tail))
+  {
+    return FAKE_NO_DEADLINE;
+  }
+  FAKE_Handle(PortNum, &stack->Queue[stack->Tail % FAKE_QUEUE_SIZE]);
+  stack->Tail++;
+
+  return (stack->Head != stack->Tail) ? 0U : FAKE_NO_DEADLINE;
+}
+
+void USBPD_PE_TimerCounter(uint8_t PortNum)
+{
+  FakePort[PortNum].PeTicks++;
+}
+
+void USBPD_PRL_TimerCounter(uint8_t PortNum)
+{
+  FakePort[PortNum].PrlTicks++;
+}
+
+USBPD_StatusTypeDef USBPD_PE_Send_Request(uint8_t PortNum, uint32_t Rdo, USBPD_CORE_PDO_Type_TypeDef PWobject)
+{
+  FAKE_StackTypeDef *stack = &FakeStack[PortNum];
+
+  if ((stack->Connected == 0U) || (stack->Outstanding != 0U) || (stack->Hold != 0U)
+      || (stack->Params->PE_Power != USBPD_POWER_EXPLICITCONTRACT))
+  {
+    FakePort[PortNum].Refused++;
+    return USBPD_BUSY;
+  }
+  FAKE_Send(PortNum, Rdo, PWobject);
+
+  return USBPD_OK;
+}
+
+/* Not modelled: the DPM sink code does not depend on them */
+USBPD_StatusTypeDef USBPD_PE_Request_HardReset(uint8_t PortNum)
+{
+  UNUSED(PortNum);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_Request_CableReset(uint8_t PortNum)
+{
+  UNUSED(PortNum);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_Request_CtrlMessage(uint8_t PortNum, USBPD_ControlMsg_TypeDef CtrlMsg,
+                                                 USBPD_SOPType_TypeDef SOPType)
+{
+  UNUSED(PortNum);
+  UNUSED(CtrlMsg);
+  UNUSED(SOPType);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_Request_DataMessage(uint8_t PortNum, USBPD_DataMsg_TypeDef DataMsg, uint32_t *pData)
+{
+  UNUSED(PortNum);
+  UNUSED(DataMsg);
+  UNUSED(pData);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SendExtendedMessage(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType,
+                                                 USBPD_ExtendedMsg_TypeDef MessageType, uint8_t *pData,
+                                                 uint16_t Size)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(MessageType);
+  UNUSED(pData);
+  UNUSED(Size);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestIdentity(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestSVID(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestMode(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType, uint16_t SVID)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(SVID);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestModeEnter(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType, uint16_t SVID,
+                                                   uint8_t ModeIndex)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(SVID);
+  UNUSED(ModeIndex);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestModeExit(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType, uint16_t SVID,
+                                                  uint8_t ModeIndex)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(SVID);
+  UNUSED(ModeIndex);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestSpecific(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType,
+                                                  USBPD_VDM_Command_Typedef Command, uint16_t SVID)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(Command);
+  UNUSED(SVID);
+  return USBPD_ERROR;
+}
+
+USBPD_StatusTypeDef USBPD_PE_SVDM_RequestAttention(uint8_t PortNum, USBPD_SOPType_TypeDef SOPType, uint16_t SVID)
+{
+  UNUSED(PortNum);
+  UNUSED(SOPType);
+  UNUSED(SVID);
+  return USBPD_ERROR;
+}
+
+void USBPD_TRACE_Init(void)
+{
+}
+
+void USBPD_TRACE_Add(TRACE_EVENT Type, uint8_t PortNum, uint8_t Sop, uint8_t *Ptr, uint32_t Size)
+{
+  UNUSED(Type);
+  UNUSED(PortNum);
+  UNUSED(Sop);
+  UNUSED(Ptr);
+  UNUSED(Size);
+}
+
+/* Board VBUS ----------------------------------------------------------------*/
+int32_t BSP_USBPD_PWR_Init(uint32_t Instance)
+{
+  return (Instance < USBPD_PORT_COUNT) ? BSP_ERROR_NONE : BSP_ERROR_WRONG_PARAM;
+}
+
+int32_t BSP_USBPD_PWR_VBUSInit(uint32_t Instance)
+{
+  return (Instance < USBPD_PORT_COUNT) ? BSP_ERROR_NONE : BSP_ERROR_WRONG_PARAM;
+}
+
+int32_t BSP_USBPD_PWR_VBUSGetVoltage(uint32_t Instance, uint32_t *pVoltage)
+{
+  if (Instance >= USBPD_PORT_COUNT)
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  *pVoltage = FakePort[Instance].Vbus;
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_USBPD_PWR_VBUSGetCurrent(uint32_t Instance, int32_t *pCurrent)
+{
+  if (Instance >= USBPD_PORT_COUNT)
+  {
+    return BSP_ERROR_WRONG_PARAM;
+  }
+  *pCurrent = 0;
+  return BSP_ERROR_NONE;
+}
+
+uint16_t HW_IF_PWR_GetVoltage(uint8_t PortNum)
+{
+  return (uint16_t)FakePort[PortNum].Vbus;
+}
+
+int16_t HW_IF_PWR_GetCurrent(uint8_t PortNum)
+{
+  UNUSED(PortNum);
+  return 0;
+}
@@ -0,0 +1,254 @@
+/**
+  ******************************************************************************
+  * @file    file_diskio.c
+  * @brief   FatFs disk I/O on a host image file.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "ff.h"
+#include "diskio.h"
+#include "file_diskio.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DISK_SECTOR_SIZE  512U
+
+/* Private variables ---------------------------------------------------------*/
+static FILE *DiskFile;
+static uint32_t DiskSectors;
+static HOST_DiskStatsTypeDef DiskStats;
+static const char *DiskSnapPath;  /* Armed by HOST_DiskSnapshotAfter()   */
+static uint32_t DiskSnapSectors;
+static uint32_t DiskSnapBytes;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Creates or truncates the image behind drive 0
+  * @param  path: Image file
+  * @param  sectors: Size of the image in sectors
+  * @retval 0 on success
+  */
+int HOST_DiskOpen(const char *path, uint32_t sectors)
+{
+  static const uint8_t zero = 0U;
+
+  HOST_DiskClose();
+  DiskFile = fopen(path, "w+b");
+  if (DiskFile == NULL)
+  {
+    return -1;
+  }
+  /* Sparse: only the last byte is written */
+  if ((fseek(DiskFile, ((long)sectors * (long)DISK_SECTOR_SIZE) - 1L, SEEK_SET) != 0) ||
+      (fwrite(&zero, 1U, 1U, DiskFile) != 1U))
+  {
+    HOST_DiskClose();
+    return -1;
+  }
+  DiskSectors = sectors;
+  memset(&DiskStats, 0, sizeof(DiskStats));
+  return 0;
+}
+
+/**
+  * @brief  Opens an existing image as drive 0, e.g. a snapshot
+  * @param  path: Image file
+  * @retval 0 on success
+  */
+int HOST_DiskAttach(const char *path)
+{
+  long size;
+
+  HOST_DiskClose();
+  DiskFile = fopen(path, "r+b");
+  if (DiskFile == NULL)
+  {
+    return -1;
+  }
+  if ((fseek(DiskFile, 0L, SEEK_END) != 0) || ((size = ftell(DiskFile)) < (long)DISK_SECTOR_SIZE))
+  {
+    HOST_DiskClose();
+    return -1;
+  }
+  DiskSectors = (uint32_t)(size / (long)DISK_SECTOR_SIZE);
+  memset(&DiskStats, 0, sizeof(DiskStats));
+  return 0;
+}
+
+/**
+  * @brief  Copies the image as it is on the disk now, what a power loss
+  *         at this point would leave
+  * @param  path: Copy to create
+  * @retval 0 on success
+  */
+int HOST_DiskSnapshot(const char *path)
+{
+  static uint8_t buf[64U * DISK_SECTOR_SIZE];
+  FILE *copy;
+  size_t n;
+  int status = 0;
+
+  if ((DiskFile == NULL) || (fflush(DiskFile) != 0) || (fseek(DiskFile, 0L, SEEK_SET) != 0))
+  {
+    return -1;
+  }
+  copy = fopen(path, "wb");
+  if (copy == NULL)
+  {
+    return -1;
+  }
+  while ((n = fread(buf, 1U, sizeof(buf), DiskFile)) != 0U)
+  {
+    if (fwrite(buf, 1U, n, copy) != n)
+    {
+      status = -1;
+      break;
+    }
+  }
+  if (fclose(copy) != 0)
+  {
+    status = -1;
+  }
+  return status;
+}
+
+/**
+  * @brief  Takes a snapshot in the middle of the writes to come
+  * @note   The copy is made once 'sectors' more sectors were written, with
+  *         the first 'bytes' bytes of the next sector written over the old
+  *         content (a sector torn by the power loss). A sector write of
+  *         several sectors is cut between them.
+  * @param  sectors: Sectors written before the snapshot
+  * @param  bytes: Bytes of the next sector in the snapshot, below 512
+  * @param  path: Copy to create, must stay valid until it is taken
+  * @retval None
+  */
+void HOST_DiskSnapshotAfter(uint32_t sectors, uint32_t bytes, const char *path)
+{
+  DiskSnapPath    = path;
+  DiskSnapSectors = sectors;
+  DiskSnapBytes   = bytes;
+}
+
+/**
+  * @brief  Tells whether the snapshot armed by HOST_DiskSnapshotAfter()
+  *         is still to be taken
+  * @retval 1 when pending
+  */
+int HOST_DiskSnapshotPending(void)
+{
+  return (DiskSnapPath != NULL) ? 1 : 0;
+}
+
+void HOST_DiskClose(void)
+{
+  if (DiskFile != NULL)
+  {
+    (void)fclose(DiskFile);
+    DiskFile = NULL;
+  }
+  DiskSectors  = 0U;
+  DiskSnapPath = NULL;
+}
+
+const HOST_DiskStatsTypeDef *HOST_DiskStats(void)
+{
+  return &DiskStats;
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+  return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+  return ((pdrv == 0U) && (DiskFile != NULL)) ? 0U : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+  if ((disk_status(pdrv) != 0U) || ((sector + count) > DiskSectors))
+  {
+    return RES_PARERR;
+  }
+  if ((fseek(DiskFile, (long)sector * (long)DISK_SECTOR_SIZE, SEEK_SET) != 0) ||
+      (fread(buff, DISK_SECTOR_SIZE, count, DiskFile) != count))
+  {
+    return RES_ERROR;
+  }
+  DiskStats.Reads++;
+  DiskStats.SectorsRead += count;
+  return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+  UINT i;
+
+  if ((disk_status(pdrv) != 0U) || ((sector + count) > DiskSectors))
+  {
+    return RES_PARERR;
+  }
+  for (i = 0U; i < count; i++)
+  {
+    if ((DiskSnapPath != NULL) && (DiskSnapSectors == 0U))
+    {
+      if ((DiskSnapBytes != 0U) &&
+          ((fseek(DiskFile, (long)(sector + i) * (long)DISK_SECTOR_SIZE, SEEK_SET) != 0) ||
+           (fwrite(&buff[i * DISK_SECTOR_SIZE], 1U, DiskSnapBytes, DiskFile) != DiskSnapBytes)))
+      {
+        return RES_ERROR;
+      }
+      if (HOST_DiskSnapshot(DiskSnapPath) != 0)
+      {
+        return RES_ERROR;
+      }
+      DiskSnapPath = NULL;
+    }
+    if ((fseek(DiskFile, (long)(sector + i) * (long)DISK_SECTOR_SIZE, SEEK_SET) != 0) ||
+        (fwrite(&buff[i * DISK_SECTOR_SIZE], DISK_SECTOR_SIZE, 1U, DiskFile) != 1U))
+    {
+      return RES_ERROR;
+    }
+    if (DiskSnapPath != NULL)
+    {
+      DiskSnapSectors--;
+    }
+  }
+  DiskStats.Writes++;
+  DiskStats.SectorsWritten += count;
+  return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+  if (disk_status(pdrv) != 0U)
+  {
+    return RES_NOTRDY;
+  }
+  switch (cmd)
+  {
+    case CTRL_SYNC:
+      return (fflush(DiskFile) == 0) ? RES_OK : RES_ERROR;
+    case GET_SECTOR_COUNT:
+      *(DWORD *)buff = DiskSectors;
+      return RES_OK;
+    case GET_SECTOR_SIZE:
+      *(WORD *)buff = DISK_SECTOR_SIZE;
+      return RES_OK;
+    case GET_BLOCK_SIZE:
+      *(DWORD *)buff = 1U;
+      return RES_OK;
+    default:
+      return RES_PARERR;
+  }
+}
+
+DWORD get_fattime(void)
+{
+  /* 2025-01-01 00:00:00 */
+  return ((DWORD)(2025U - 1980U) << 25) | ((DWORD)1U << 21) | ((DWORD)1U << 16);
+}
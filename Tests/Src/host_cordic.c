@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file    host_cordic.c
+  * @brief   Software CORDIC for the host checks, see cordic.h.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include "cordic.h"
+
+/* Exported variables --------------------------------------------------------*/
+CORDIC_HandleTypeDef hcordic;
+
+/* Private functions ---------------------------------------------------------*/
+static int32_t HOST_CordicQ31(double value)
+{
+  double q = nearbyint(value * 2147483648.0);
+
+  return (q > 2147483647.0) ? INT32_MAX : (q < -2147483648.0) ? INT32_MIN : (int32_t)q;
+}
+
+/* Exported functions --------------------------------------------------------*/
+HAL_StatusTypeDef HAL_CORDIC_Configure(CORDIC_HandleTypeDef *hcordic, const CORDIC_ConfigTypeDef *sConfig)
+{
+  if ((sConfig->Function != CORDIC_FUNCTION_COSINE) || (sConfig->Scale != CORDIC_SCALE_0)
+      || (sConfig->InSize != CORDIC_INSIZE_32BITS) || (sConfig->OutSize != CORDIC_OUTSIZE_32BITS)
+      || (sConfig->NbWrite != CORDIC_NBWRITE_1) || (sConfig->NbRead != CORDIC_NBREAD_2))
+  {
+    return HAL_ERROR;
+  }
+  hcordic->Config = *sConfig;
+  hcordic->Configured = 1U;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CORDIC_Calculate(CORDIC_HandleTypeDef *hcordic, const int32_t *pInBuff, int32_t *pOutBuff,
+                                       uint32_t NbCalc, uint32_t Timeout)
+{
+  double angle;
+  uint32_t i;
+
+  (void)Timeout;
+  if (hcordic->Configured == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  for (i = 0U; i < NbCalc; i++)
+  {
+    angle = (M_PI * pInBuff[i]) / 2147483648.0;
+    pOutBuff[2U * i]        = HOST_CordicQ31(cos(angle));
+    pOutBuff[(2U * i) + 1U] = HOST_CordicQ31(sin(angle));
+  }
+  return HAL_OK;
+}
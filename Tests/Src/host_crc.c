@@ -0,0 +1,32 @@
+/**
+  ******************************************************************************
+  * @file    host_crc.c
+  * @brief   Software CRC-32 for the host checks, see crc.h.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crc.h"
+
+/* Exported variables --------------------------------------------------------*/
+CRC_HandleTypeDef hcrc;
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength)
+{
+  const uint8_t *data = (const uint8_t *)pBuffer;
+  uint32_t crc = 0xFFFFFFFFU;
+  uint32_t i;
+  uint32_t bit;
+
+  hcrc->Calls++;
+  for (i = 0U; i < BufferLength; i++)
+  {
+    crc ^= (uint32_t)data[i] << 24;
+    for (bit = 0U; bit < 8U; bit++)
+    {
+      crc = ((crc & 0x80000000U) != 0U) ? ((crc << 1) ^ 0x04C11DB7U) : (crc << 1);
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    host_dsp.c
+  * @brief   Host stand-in for the input side of dsp_app.c.
+  ******************************************************************************
+  * @attention
+  *
+  * The input rings and the FFT scratch buffer the analysis modules read,
+  * without the scheduler, the generator and the governor. A check is the
+  * producer: it fills the input through DSP_GetWriteBuffer() and
+  * DSP_Commit(), sets DSP_GetInput()->Rate itself, then calls the module
+  * functions it covers. The ring accessors are the firmware ones
+  * (dsp_ring.c).
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "dsp_app.h"
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t DspBuffer[DSP_RING_SIZE];
+static int16_t DspBufferY[DSP_RING_SIZE];
+static DSP_RingTypeDef DspInput = { DspBuffer, DSP_RING_SIZE, 0U, DSP_RATE_DEFAULT * 1000U };
+static DSP_RingTypeDef DspInputY = { DspBufferY, DSP_RING_SIZE, 0U, DSP_RATE_DEFAULT * 1000U };
+static FFT_CpxTypeDef DspScratch[DSP_SCRATCH_SIZE] __attribute__((aligned(8)));
+
+/* Exported functions --------------------------------------------------------*/
+DSP_RingTypeDef *DSP_GetInput(void)
+{
+  return &DspInput;
+}
+
+DSP_RingTypeDef *DSP_GetInputY(void)
+{
+  return &DspInputY;
+}
+
+FFT_CpxTypeDef *DSP_GetScratch(void)
+{
+  return DspScratch;
+}
+
+int16_t *DSP_GetWriteBuffer(uint32_t *count)
+{
+  return DSP_RingWritePtr(&DspInput, count);
+}
+
+int16_t *DSP_GetWriteBufferY(void)
+{
+  uint32_t count;
+
+  return DSP_RingWritePtr(&DspInputY, &count);
+}
+
+void DSP_Commit(uint32_t count)
+{
+  DSP_RingCommit(&DspInputY, count);
+  DSP_RingCommit(&DspInput, count);
+}
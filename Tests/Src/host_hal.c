@@ -0,0 +1,156 @@
+/**
+  ******************************************************************************
+  * @file    host_hal.c
+  * @brief   Virtual tick, console output and assertions of the host checks.
+  ******************************************************************************
+  * @attention
+  *
+  * Time only moves through HAL_Delay() and HOST_TickAdvance(), so a check
+  * runs the same way on any machine and timeouts cost no wall-clock time.
+  * The console writes to stdout; commands register into a table that
+  * HOST_ConsoleRun() searches.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "host_check.h"
+
+/* Private variables ---------------------------------------------------------*/
+uint32_t SystemCoreClock = 170000000U;
+DWT_Type HostDwt;
+CoreDebug_Type HostCoreDebug;
+
+static uint32_t HostTick;
+static uint32_t HostChecks;
+static uint32_t HostFailures;
+static const CON_CommandTypeDef *HostCommands[CON_COMMANDS_MAX];
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t HAL_GetTick(void)
+{
+  return HostTick;
+}
+
+void HAL_Delay(uint32_t delay)
+{
+  HostTick += delay;
+}
+
+/**
+  * @brief  Moves the virtual tick forward
+  * @param  ms: Milliseconds
+  * @retval None
+  */
+void HOST_TickAdvance(uint32_t ms)
+{
+  HostTick += ms;
+}
+
+void Error_Handler(void)
+{
+  fprintf(stderr, "Error_Handler() called\n");
+  exit(2);
+}
+
+CON_StatusTypeDef CON_Register(const CON_CommandTypeDef *cmd)
+{
+  uint32_t i;
+
+  for (i = 0U; i < CON_COMMANDS_MAX; i++)
+  {
+    if ((HostCommands[i] == NULL) || (HostCommands[i] == cmd))
+    {
+      HostCommands[i] = cmd;
+      return CON_OK;
+    }
+  }
+  return CON_ERROR_FULL;
+}
+
+void CON_Process(void)
+{
+}
+
+uint32_t CON_Write(const void *data, uint32_t len)
+{
+  return (uint32_t)fwrite(data, 1U, len, stdout);
+}
+
+int32_t CON_Printf(const char *fmt, ...)
+{
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vprintf(fmt, args);
+  va_end(args);
+
+  return len;
+}
+
+/**
+  * @brief  Runs a registered console command
+  * @param  line: Command line, split at spaces
+  * @retval Handler result, -1 when the command is unknown
+  */
+int32_t HOST_ConsoleRun(const char *line)
+{
+  char buf[CON_LINE_MAX];
+  char *argv[CON_ARGS_MAX];
+  int32_t argc = 0;
+  char *tok;
+  uint32_t i;
+
+  (void)snprintf(buf, sizeof(buf), "%s", line);
+  for (tok = strtok(buf, " "); (tok != NULL) && (argc < (int32_t)CON_ARGS_MAX); tok = strtok(NULL, " "))
+  {
+    argv[argc++] = tok;
+  }
+  if (argc == 0)
+  {
+    return -1;
+  }
+  for (i = 0U; (i < CON_COMMANDS_MAX) && (HostCommands[i] != NULL); i++)
+  {
+    if (strcmp(HostCommands[i]->Name, argv[0]) == 0)
+    {
+      return HostCommands[i]->Handler(argc, argv);
+    }
+  }
+  return -1;
+}
+
+void HOST_Check(int ok, const char *expr, const char *file, int line, const char *fmt, ...)
+{
+  va_list args;
+
+  HostChecks++;
+  if (ok != 0)
+  {
+    return;
+  }
+  HostFailures++;
+  fprintf(stderr, "%s:%d: CHECK(%s) failed", file, line, expr);
+  if (fmt != NULL)
+  {
+    fprintf(stderr, ": ");
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+  }
+  fprintf(stderr, "\n");
+}
+
+int HOST_CheckDone(void)
+{
+  fflush(stdout);
+  fprintf(stderr, "%lu checks, %lu failed\n", (unsigned long)HostChecks, (unsigned long)HostFailures);
+  return (HostFailures == 0U) ? 0 : 1;
+}
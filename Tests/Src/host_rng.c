@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file    host_rng.c
+  * @brief   Reproducible RNG for the host checks, see rng.h.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "rng.h"
+
+/* Exported variables --------------------------------------------------------*/
+RNG_HandleTypeDef hrng = { 0x2545F491U, 0U, 0U, HAL_OK };
+
+/* Exported functions --------------------------------------------------------*/
+HAL_StatusTypeDef HAL_RNG_GenerateRandomNumber(RNG_HandleTypeDef *hrng, uint32_t *random32bit)
+{
+  if (hrng->Forced != 0U)
+  {
+    hrng->Forced--;
+    if (hrng->Status == HAL_OK)
+    {
+      *random32bit = hrng->Value;
+    }
+    return hrng->Status;
+  }
+  hrng->State ^= hrng->State << 13;
+  hrng->State ^= hrng->State >> 17;
+  hrng->State ^= hrng->State << 5;
+  *random32bit = hrng->State;
+  return HAL_OK;
+}
+
+/**
+  * @brief  Makes the next draws return a given value or status
+  * @param  draws: Number of draws affected
+  * @param  value: Value returned when status is HAL_OK
+  * @param  status: Status returned
+  * @retval None
+  */
+void HOST_RngForce(uint32_t draws, uint32_t value, HAL_StatusTypeDef status)
+{
+  hrng.Forced = draws;
+  hrng.Value  = value;
+  hrng.Status = status;
+}
@@ -0,0 +1,456 @@
+/**
+  ******************************************************************************
+  * @file    test_capture.c
+  * @brief   Host check of the capture recovery after a power loss.
+  ******************************************************************************
+  * @attention
+  *
+  * A capture is deleted, then a new one of the same geometry is written
+  * over its clusters with the metadata journal running, and the disk
+  * image is copied as a power loss would leave it:
+  *   - mid-frame, the frame header sector torn after 16 bytes;
+  *   - mid-index-block, the block torn after 200 bytes;
+  *   - right after the frame that grew the reservation (CAP_Reserve()).
+  * Each copy is then mounted twice:
+  *   - as a PC reading the card: CAP_Open() rebuilds the footer in RAM
+  *     over the whole reservation and must find exactly the frames on
+  *     disk, none of the deleted capture;
+  *   - as the next boot: JRN_Init() must repair the file to the frames
+  *     of the last checkpoint, with footer and trailer, release the
+  *     reservation, and CAP_Seek() must land on the right frames with
+  *     one index block read per halving of the footer stride.
+  * A last copy is made with both captures given the same FileId and the
+  * deleted one holding earlier timestamps: the rebuild must then stop on
+  * the timestamps going back, inside a group and across groups.
+  *
+  * Both exFAT and FAT32 are checked. On FAT32, a journal fragmented by a
+  * host tool must be recreated contiguous.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "ff.h"
+#include "mempool.h"
+#include "governor.h"
+#include "rng.h"
+#include "capture_file.h"
+#include "journal.h"
+#include "file_diskio.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_IMAGE          "build/capture.img"
+#define TEST_SECTORS        (128UL * 1024UL)  /* 64 MB */
+#define TEST_PATH           "0:/REC.CAP"
+#define TEST_OLD_PATH       "0:/OLD.CAP"
+#define TEST_FRAME_SIZE     2048U
+#define TEST_PAYLOAD        (TEST_FRAME_SIZE - CAP_FRAME_HEADER_SIZE)
+#define TEST_PER_INDEX      4U
+#define TEST_SYNC_GROUPS    4U
+#define TEST_CHECKPOINT     (TEST_PER_INDEX * TEST_SYNC_GROUPS)  /* Frames */
+#define TEST_PERIOD         10U       /* Timestamp ticks per frame             */
+#define TEST_OLD_FRAMES     600U
+#define TEST_OLD_BASE       1000000000ULL
+#define TEST_MID_FRAME      101U      /* Second frame of group 25              */
+#define TEST_MID_INDEX      203U      /* Completes group 50, not a checkpoint  */
+#define TEST_COLLISION      96U       /* First frame of group 24               */
+#define TEST_FILE_ID        0x5EED1D5U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  const char *Name;
+  const char *Image;
+  uint32_t    Committed;    /* Frames at the last checkpoint           */
+  uint32_t    Written;      /* Frames complete on disk                 */
+} TEST_SnapshotTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static FATFS TestFs;
+static uint8_t TestWork[4096];
+static uint8_t TestPayload[TEST_PAYLOAD];
+static CAP_FileTypeDef TestCap;
+static const GOV_LimitsTypeDef TestLimits = { 170000000U, 48000U, 4096U, 8U };
+
+/* Private functions ---------------------------------------------------------*/
+static uint64_t TEST_Time(uint64_t base, uint32_t frame)
+{
+  return base + ((uint64_t)frame * TEST_PERIOD);
+}
+
+static void TEST_Mount(void)
+{
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  CHECK(f_mount(&TestFs, "0:", 1U) == FR_OK);
+}
+
+static DWORD TEST_Free(void)
+{
+  FATFS *fs;
+  DWORD free = 0U;
+
+  CHECK(f_getfree("0:", &free, &fs) == FR_OK);
+  return free;
+}
+
+static void TEST_Config(CAP_ConfigTypeDef *cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->FrameSize      = TEST_FRAME_SIZE;
+  cfg->FramesPerIndex = TEST_PER_INDEX;
+  cfg->TimeBase       = 1000U;
+  cfg->SampleRate     = 48000U;
+  cfg->Channels       = 2U;
+  cfg->SyncInterval   = TEST_SYNC_GROUPS;
+}
+
+/* Writes a closed capture and deletes it, its frames stay in the clusters
+   it gives back. Returns its first cluster */
+static DWORD TEST_OldCapture(uint64_t base)
+{
+  CAP_ConfigTypeDef cfg;
+  DWORD sclust;
+  uint32_t i;
+
+  TEST_Config(&cfg);
+  CHECK(CAP_Create(&TestCap, TEST_OLD_PATH, &cfg, base) == CAP_OK);
+  for (i = 0U; i < TEST_OLD_FRAMES; i++)
+  {
+    CHECK(CAP_WriteFrame(&TestCap, TEST_Time(base, i), 0U, TestPayload, TEST_PAYLOAD) == CAP_OK);
+  }
+  sclust = TestCap.File.obj.sclust;
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+  CHECK(f_unlink(TEST_OLD_PATH) == FR_OK);
+
+  /* Next boot: the allocator starts again from the first free cluster. On
+     FAT32 its hint survives in FSInfo, a host that deleted the file may
+     have pointed it back to the start */
+  TEST_Mount();
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_OK);
+  if (TestFs.fs_type == FS_FAT32)
+  {
+    TestFs.last_clst = 2U;
+  }
+  return sclust;
+}
+
+/* CAP_Seek() on exact, in-between and out of range timestamps, and the
+   number of sectors read to locate a frame */
+static void TEST_Seek(const char *name, uint32_t frames, uint8_t closed)
+{
+  const uint32_t probes[] = { 0U, frames / 3U, frames / 2U, frames - 1U };
+  const HOST_DiskStatsTypeDef *stats = HOST_DiskStats();
+  CAP_FrameHeaderTypeDef hdr;
+  uint32_t reads;
+  uint32_t bound = 2U;
+  uint32_t frame = UINT32_MAX;
+  uint32_t stride;
+  uint32_t p;
+
+  for (stride = TestCap.Stride; stride > 1U; stride /= 2U)
+  {
+    bound++;
+  }
+
+  for (p = 0U; p < (sizeof(probes) / sizeof(probes[0])); p++)
+  {
+    TestCap.IndexGroup = UINT32_MAX;
+    reads = stats->Reads;
+    CHECK(CAP_Seek(&TestCap, TEST_Time(0U, probes[p]), &frame) == CAP_OK);
+    reads = stats->Reads - reads;
+    CHECK_MSG(frame == probes[p], "%s: frame %lu at %lu", name, (unsigned long)frame,
+              (unsigned long)probes[p]);
+    CHECK_MSG((closed == 0U) || (reads <= bound), "%s: %lu reads, stride %lu", name,
+              (unsigned long)reads, (unsigned long)TestCap.Stride);
+    CHECK(CAP_Seek(&TestCap, TEST_Time(0U, probes[p]) + (TEST_PERIOD / 2U), &frame) == CAP_OK);
+    CHECK(frame == probes[p]);
+    CHECK(CAP_ReadFrame(&TestCap, probes[p], &hdr, NULL, 0U) == CAP_OK);
+    CHECK(hdr.Timestamp == TEST_Time(0U, probes[p]));
+  }
+  CHECK(CAP_Seek(&TestCap, TEST_OLD_BASE * 2U, &frame) == CAP_OK);
+  CHECK_MSG(frame == (frames - 1U), "%s: last frame %lu", name, (unsigned long)frame);
+  CHECK(CAP_ReadFrame(&TestCap, frames, &hdr, NULL, 0U) == CAP_NOT_FOUND);
+}
+
+/* The repaired file ends with a footer and trailer describing its frames,
+   and holds no cluster past them */
+static void TEST_Closed(const char *name, uint32_t frames, DWORD free_before)
+{
+  CAP_TrailerTypeDef trailer;
+  CAP_FooterTypeDef footer;
+  DWORD cluster = (DWORD)TestFs.csize * CAP_SECTOR_SIZE;
+  FIL fil;
+  FSIZE_t size;
+  UINT br = 0U;
+
+  memset(&fil, 0, sizeof(fil));     /* See JRN_OpenArea() */
+  CHECK(f_open(&fil, TEST_PATH, FA_READ) == FR_OK);
+  size = f_size(&fil);
+  CHECK((f_lseek(&fil, size - sizeof(trailer)) == FR_OK) &&
+        (f_read(&fil, &trailer, sizeof(trailer), &br) == FR_OK) && (br == sizeof(trailer)));
+  CHECK(trailer.Magic == CAP_MAGIC_TRAILER);
+  CHECK((trailer.FooterOffset + trailer.FooterSize + sizeof(trailer)) == size);
+  CHECK((f_lseek(&fil, trailer.FooterOffset) == FR_OK) &&
+        (f_read(&fil, &footer, sizeof(footer), &br) == FR_OK) && (br == sizeof(footer)));
+  CHECK(footer.Magic == CAP_MAGIC_FOOTER);
+  CHECK_MSG(footer.Frames == frames, "%s: footer %lu frames, expected %lu", name,
+            (unsigned long)footer.Frames, (unsigned long)frames);
+  CHECK(footer.LastTime == TEST_Time(0U, frames - 1U));
+  CHECK(f_close(&fil) == FR_OK);
+
+  CHECK_MSG(TEST_Free() == (free_before - (DWORD)((size + cluster - 1U) / cluster)),
+            "%s: reservation not released, %lu bytes", name, (unsigned long)size);
+}
+
+static void TEST_Recover(const TEST_SnapshotTypeDef *snap, DWORD free_before)
+{
+  printf("--- %s\n", snap->Name);
+
+  /* A PC reads the card: the reservation is still in the file */
+  CHECK(HOST_DiskAttach(snap->Image) == 0);
+  TEST_Mount();
+  CHECK(CAP_Open(&TestCap, TEST_PATH) == CAP_OK);
+  CHECK_MSG(TestCap.FrameCount == snap->Written, "%s: %lu frames read, %lu written", snap->Name,
+            (unsigned long)TestCap.FrameCount, (unsigned long)snap->Written);
+  TEST_Seek(snap->Name, snap->Written, 0U);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+
+  /* Next boot: the journal cuts the file at the last checkpoint */
+  TEST_Mount();
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_RECOVERED);
+  CHECK(JRN_GetLast()->Kind == JRN_REC_CLOSE);
+  TEST_Closed(snap->Name, snap->Committed, free_before);
+  CHECK(CAP_Open(&TestCap, TEST_PATH) == CAP_OK);
+  CHECK_MSG(TestCap.FrameCount == snap->Committed, "%s: %lu frames recovered, %lu committed",
+            snap->Name, (unsigned long)TestCap.FrameCount, (unsigned long)snap->Committed);
+  TEST_Seek(snap->Name, snap->Committed, 1U);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+
+  /* Repaired once only */
+  TEST_Mount();
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_OK);
+
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+  (void)remove(snap->Image);
+}
+
+static void TEST_Format(BYTE format)
+{
+  CHECK(HOST_DiskOpen(TEST_IMAGE, TEST_SECTORS) == 0);
+  CHECK(f_mkfs("0:", format, 0U, TestWork, sizeof(TestWork)) == FR_OK);
+  CHECK(f_mount(&TestFs, "0:", 1U) == FR_OK);
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_OK);
+  CHECK(JRN_GetLast()->Magic == 0U);
+}
+
+/* Mid-frame, mid-index-block and after a new reservation, over a deleted
+   capture of another FileId holding later timestamps */
+static void TEST_PowerLoss(BYTE format)
+{
+  static TEST_SnapshotTypeDef snaps[] =
+  {
+    { "mid-frame",   "build/capture_frame.img",   0U, 0U },
+    { "mid-index",   "build/capture_index.img",   0U, 0U },
+    { "reservation", "build/capture_reserve.img", 0U, 0U },
+  };
+  CAP_ConfigTypeDef cfg;
+  DWORD free_before;
+  DWORD old;
+  FSIZE_t size;
+  uint32_t s;
+  uint32_t i;
+
+  TEST_Format(format);
+  old = TEST_OldCapture(TEST_OLD_BASE);
+  free_before = TEST_Free();
+
+  TEST_Config(&cfg);
+  CHECK(CAP_Create(&TestCap, TEST_PATH, &cfg, 0U) == CAP_OK);
+  CHECK_MSG(TestCap.File.obj.sclust == old, "new capture not over the deleted one");
+
+  for (i = 0U; ; i++)
+  {
+    if (i == TEST_MID_FRAME)
+    {
+      /* Magic, sequence and timestamp reach the disk, not the FileId */
+      HOST_DiskSnapshotAfter(0U, 16U, snaps[0].Image);
+      snaps[0].Committed = (i / TEST_CHECKPOINT) * TEST_CHECKPOINT;
+      snaps[0].Written   = i;
+    }
+    if (i == TEST_MID_INDEX)
+    {
+      /* The four sectors of the frame, then the index block torn */
+      HOST_DiskSnapshotAfter(TEST_FRAME_SIZE / CAP_SECTOR_SIZE, 200U, snaps[1].Image);
+      snaps[1].Committed = (i / TEST_CHECKPOINT) * TEST_CHECKPOINT;
+      snaps[1].Written   = i + 1U;
+    }
+    size = f_size(&TestCap.File);
+    CHECK(CAP_WriteFrame(&TestCap, TEST_Time(0U, i), 0U, TestPayload, TEST_PAYLOAD) == CAP_OK);
+    CHECK(HOST_DiskSnapshotPending() == 0);
+    if (f_size(&TestCap.File) != size)
+    {
+      CHECK(HOST_DiskSnapshot(snaps[2].Image) == 0);
+      snaps[2].Committed = i;
+      snaps[2].Written   = i + 1U;
+      break;
+    }
+  }
+  CHECK(i > TEST_MID_INDEX);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+
+  for (s = 0U; s < (sizeof(snaps) / sizeof(snaps[0])); s++)
+  {
+    TEST_Recover(&snaps[s], free_before);
+  }
+}
+
+/* Both captures with the same FileId, the deleted one earlier in time */
+static void TEST_Collision(BYTE format)
+{
+  static const TEST_SnapshotTypeDef snap =
+  {
+    "same FileId", "build/capture_same.img", TEST_COLLISION, TEST_COLLISION
+  };
+  CAP_ConfigTypeDef cfg;
+  DWORD free_before;
+  DWORD old;
+  uint32_t i;
+
+  TEST_Format(format);
+  HOST_RngForce(2U, TEST_FILE_ID, HAL_OK);
+  old = TEST_OldCapture(0U);
+  free_before = TEST_Free();
+
+  TEST_Config(&cfg);
+  CHECK(CAP_Create(&TestCap, TEST_PATH, &cfg, TEST_OLD_BASE) == CAP_OK);
+  CHECK(TestCap.Header.FileId == TEST_FILE_ID);
+  CHECK(TestCap.File.obj.sclust == old);
+  for (i = 0U; i < TEST_COLLISION; i++)
+  {
+    CHECK(CAP_WriteFrame(&TestCap, TEST_Time(TEST_OLD_BASE, i), 0U, TestPayload, TEST_PAYLOAD) == CAP_OK);
+  }
+  CHECK(HOST_DiskSnapshot(snap.Image) == 0);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+
+  /* As TEST_Recover(), on timestamps from TEST_OLD_BASE */
+  printf("--- %s\n", snap.Name);
+  CHECK(HOST_DiskAttach(snap.Image) == 0);
+  TEST_Mount();
+  CHECK(CAP_Open(&TestCap, TEST_PATH) == CAP_OK);
+  CHECK_MSG(TestCap.FrameCount == snap.Written, "%s: %lu frames read", snap.Name,
+            (unsigned long)TestCap.FrameCount);
+  CHECK(TestCap.LastTime == TEST_Time(TEST_OLD_BASE, snap.Written - 1U));
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+
+  TEST_Mount();
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_RECOVERED);
+  CHECK(CAP_Open(&TestCap, TEST_PATH) == CAP_OK);
+  CHECK(TestCap.FrameCount == snap.Committed);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+  CHECK(TEST_Free() < free_before);
+
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+  (void)remove(snap.Image);
+}
+
+/* A journal copied back by a host tool, one cluster out of two */
+static void TEST_Fragmented(void)
+{
+  static uint8_t gap_data[4096];
+  DWORD map[CAP_LINKMAP_SIZE];
+  CAP_ConfigTypeDef cfg;
+  UINT cluster;
+  UINT chunk;
+  UINT bw = 0U;
+  FIL jrn;
+  FIL gap;
+  uint32_t done;
+
+  printf("--- fragmented journal\n");
+  TEST_Format(FM_FAT32);
+  cluster = (UINT)TestFs.csize * CAP_SECTOR_SIZE;
+  CHECK_MSG(cluster < (JRN_SECTORS * CAP_SECTOR_SIZE), "%u byte clusters", cluster);
+  CHECK(cluster <= sizeof(gap_data));
+  memset(gap_data, 0x5A, sizeof(gap_data));
+  memset(TestWork, 0, sizeof(TestWork));
+
+  CHECK(f_unlink("0:/" JRN_FILE_NAME) == FR_OK);
+  CHECK(f_open(&jrn, "0:/" JRN_FILE_NAME, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  CHECK(f_open(&gap, "0:/GAP.BIN", FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  for (done = 0U; done < (JRN_SECTORS * CAP_SECTOR_SIZE); done += chunk)
+  {
+    chunk = ((done + cluster) > (JRN_SECTORS * CAP_SECTOR_SIZE)) ? ((JRN_SECTORS * CAP_SECTOR_SIZE) - done) : cluster;
+    CHECK((f_write(&jrn, TestWork, chunk, &bw) == FR_OK) && (bw == chunk));
+    CHECK((f_write(&gap, gap_data, cluster, &bw) == FR_OK) && (bw == cluster));
+  }
+  CHECK(f_close(&gap) == FR_OK);
+  map[0] = CAP_LINKMAP_SIZE;
+  jrn.cltbl = map;
+  CHECK(f_lseek(&jrn, CREATE_LINKMAP) == FR_OK);
+  CHECK_MSG(map[0] > 4U, "journal not fragmented");
+  CHECK(f_close(&jrn) == FR_OK);
+
+  TEST_Mount();
+  CHECK(JRN_Init(&TestFs, "0:") == JRN_OK);
+  CHECK(f_open(&jrn, "0:/" JRN_FILE_NAME, FA_READ) == FR_OK);
+  CHECK(f_size(&jrn) == (JRN_SECTORS * CAP_SECTOR_SIZE));
+  map[0] = CAP_LINKMAP_SIZE;
+  jrn.cltbl = map;
+  CHECK_MSG((f_lseek(&jrn, CREATE_LINKMAP) == FR_OK) && (map[0] == 4U), "journal in %lu fragments",
+            (unsigned long)((map[0] - 2U) / 2U));
+  CHECK(f_close(&jrn) == FR_OK);
+
+  /* Records appended to the journal leave the file in the gaps alone */
+  TEST_Config(&cfg);
+  CHECK(CAP_Create(&TestCap, TEST_PATH, &cfg, 0U) == CAP_OK);
+  CHECK(CAP_Close(&TestCap) == CAP_OK);
+  CHECK(JRN_GetLast()->Kind == JRN_REC_CLOSE);
+  CHECK(f_open(&gap, "0:/GAP.BIN", FA_READ) == FR_OK);
+  for (done = 0U; done < f_size(&gap); done += bw)
+  {
+    CHECK((f_read(&gap, TestWork, cluster, &bw) == FR_OK) && (bw == cluster));
+    CHECK(memcmp(TestWork, gap_data, cluster) == 0);
+  }
+  CHECK(f_close(&gap) == FR_OK);
+
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* The governor of the PERF profile */
+const GOV_LimitsTypeDef *GOV_GetLimits(void)
+{
+  return &TestLimits;
+}
+
+int main(void)
+{
+  uint32_t i;
+
+  for (i = 0U; i < TEST_PAYLOAD; i++)
+  {
+    TestPayload[i] = (uint8_t)((i * 13U) ^ 0xA5U);
+  }
+  POOL_Init();
+
+  printf("--- exfat\n");
+  TEST_PowerLoss(FM_EXFAT);
+  TEST_Collision(FM_EXFAT);
+  printf("--- fat32\n");
+  TEST_PowerLoss(FM_FAT32);
+  TEST_Collision(FM_FAT32);
+  TEST_Fragmented();
+  (void)remove(TEST_IMAGE);
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file    test_dpm.c
+  * @brief   Host check of the sink DPM: recorded scenarios played against a
+  *          fake PE/PRL/CAD.
+  ******************************************************************************
+  * @attention
+  *
+  * usbpd_dpm_core.c, usbpd_dpm_user.c and usbpd_pwr_if.c are the firmware
+  * files, linked against fake_usbpd.c. Events reach the DPM the way the
+  * library delivers them: the fake queues them and wakes the CAD or PE
+  * task, and USBPD_DPM_Run() passes run until no task is due. Virtual time
+  * goes through HOST_TickAdvance() and USBPD_DPM_TimerCounter(), one call
+  * per millisecond like SysTick.
+  *
+  * The scenarios are the tables of usbpd_dpm_scenarios.c that the target
+  * "replay" command plays; the application modules the DPM user code
+  * drives (governor, partner info, low power, DSP, tracer) are stubbed
+  * below and only record what the DPM asked.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "usbpd_core.h"
+#include "usbpd_dpm_core.h"
+#include "usbpd_dpm_user.h"
+#include "usbpd_dpm_scenarios.h"
+#include "governor.h"
+#include "usbpd_partner_info.h"
+#include "usbpd_lowpower.h"
+#include "dsp_app.h"
+#include "tracer_emb.h"
+#include "fake_usbpd.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_PORT           USBPD_PORT_0
+#define TEST_MAX_PASSES     16U     /* USBPD_DPM_Run() passes for one event */
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t TestBudget;       /* Last GOV_SetBudget()/GOV_LimitBudget() */
+static uint32_t TestContracts;    /* PTN_Contract() calls                   */
+
+/* Private functions ---------------------------------------------------------*/
+/* Main loop passes until no CAD or PE task is due */
+static void TEST_Settle(void)
+{
+  uint32_t pass;
+
+  for (pass = 0U; pass < TEST_MAX_PASSES; pass++)
+  {
+    USBPD_DPM_Run();
+    if (USBPD_DPM_GetNextDeadline() != 0U)
+    {
+      return;
+    }
+  }
+  CHECK_MSG(0, "DPM still busy after %u passes", TEST_MAX_PASSES);
+}
+
+/* SysTick: one millisecond of virtual time */
+static void TEST_Advance(uint32_t ms)
+{
+  while (ms-- != 0U)
+  {
+    HOST_TickAdvance(1U);
+    USBPD_DPM_TimerCounter();
+    TEST_Settle();
+  }
+}
+
+static void TEST_Play(const RPL_ScenarioTypeDef *scenario)
+{
+  FAKE_PortTypeDef *port = FAKE_GetPort(TEST_PORT);
+  const RPL_StepTypeDef *step;
+  RPL_CaptureTypeDef capture;
+  uint32_t start = HAL_GetTick();
+  uint32_t index;
+
+  (void)memset(&capture, 0, sizeof(capture));
+  port->Requests = 0U;
+
+  for (index = 0U; index < scenario->Count; index++)
+  {
+    step = &scenario->Steps[index];
+    switch (step->Op)
+    {
+      case RPL_OP_ATTACH:
+        FAKE_Attach(TEST_PORT);
+        TEST_Settle();
+        CHECK_MSG(port->PowerReady == USBPD_ENABLE, "%s: vSafe5V not seen at attach", scenario->Name);
+        break;
+
+      case RPL_OP_SRC_CAPS:
+        capture.Pdos     = step->Pdos;
+        capture.PdoCount = step->Count;
+        FAKE_Receive(TEST_PORT, FAKE_MSG_SRC_CAPS, step->Pdos, step->Count);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_ACCEPT:
+        FAKE_Receive(TEST_PORT, FAKE_MSG_ACCEPT, NULL, 0U);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_REJECT:
+        FAKE_Receive(TEST_PORT, FAKE_MSG_REJECT, NULL, 0U);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_WAIT:
+        FAKE_Receive(TEST_PORT, FAKE_MSG_WAIT, NULL, 0U);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_PS_RDY:
+        FAKE_Receive(TEST_PORT, FAKE_MSG_PS_RDY, NULL, 0U);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_HARD_RESET:
+        FAKE_Receive(TEST_PORT, FAKE_MSG_HARD_RESET, NULL, 0U);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_DETACH:
+        FAKE_Detach(TEST_PORT);
+        TEST_Settle();
+        break;
+
+      case RPL_OP_ADVANCE:
+        TEST_Advance(step->Arg);
+        break;
+
+      case RPL_OP_LOAD:
+        USBPD_DPM_SetLoadPower(TEST_PORT, step->Arg);
+        TEST_Settle();
+        break;
+
+      default:
+        capture.Requests += port->Requests;
+        capture.Rdo       = port->Rdo;
+        capture.Type      = port->Type;
+        capture.Time      = port->Tick - start;
+        port->Requests    = 0U;
+        CHECK_MSG(RPL_Expect(step, &capture, HAL_GetTick() - start) == 0U, "%s: step %lu (%s)",
+                  scenario->Name, (unsigned long)index, RPL_GetOpName(step->Op));
+        break;
+    }
+  }
+
+  /* Every scenario ends detached, back on the Type-C default budget */
+  CHECK_MSG(DPM_Params[TEST_PORT].PE_Power == USBPD_POWER_NO, "%s: not detached", scenario->Name);
+  CHECK_MSG(TestBudget == GOV_DEFAULT_MW, "%s: budget %lu mW after detach", scenario->Name,
+            (unsigned long)TestBudget);
+  USBPD_DPM_SetLoadPower(TEST_PORT, 0U);
+}
+
+static void TEST_Init(void)
+{
+  CHECK(USBPD_DPM_InitCore() == USBPD_OK);
+  CHECK(USBPD_DPM_UserInit() == USBPD_OK);
+  CHECK(USBPD_DPM_InitOS() == USBPD_OK);
+  CHECK(DPM_Params[TEST_PORT].DPM_Initialized == USBPD_TRUE);
+  TEST_Settle();
+  CHECK(FAKE_GetPort(TEST_PORT)->Requests == 0U);
+}
+
+static void TEST_Scenarios(void)
+{
+  uint32_t index;
+
+  CHECK(RPL_GetScenarioCount() != 0U);
+  for (index = 0U; index < RPL_GetScenarioCount(); index++)
+  {
+    TEST_Play(RPL_GetScenario(index));
+  }
+}
+
+/* A request refused by a busy PE is retried on the next tick, not lost */
+static void TEST_BusyRetry(void)
+{
+  static const uint32_t pdos[] = { (100UL << 10) | 300U, (180UL << 10) | 300U }; /* 5 V, 9 V 3 A */
+  FAKE_PortTypeDef *port = FAKE_GetPort(TEST_PORT);
+  uint32_t ticks = port->PeTicks;
+
+  FAKE_Attach(TEST_PORT);
+  TEST_Settle();
+  FAKE_Receive(TEST_PORT, FAKE_MSG_SRC_CAPS, pdos, 2U);
+  FAKE_Receive(TEST_PORT, FAKE_MSG_ACCEPT, NULL, 0U);
+  FAKE_Receive(TEST_PORT, FAKE_MSG_PS_RDY, NULL, 0U);
+  TEST_Settle();
+  CHECK(port->Requests == 1U);
+  CHECK(port->Vbus == 9000U);
+  CHECK(DPM_Params[TEST_PORT].PE_Power == USBPD_POWER_EXPLICITCONTRACT);
+  CHECK(TestContracts != 0U);
+  CHECK(TestBudget != GOV_DEFAULT_MW);
+
+  port->Requests = 0U;
+  port->Refused  = 0U;
+  FAKE_Hold(TEST_PORT, 1U);
+  USBPD_DPM_SetLoadPower(TEST_PORT, 30000U);
+  TEST_Settle();
+  TEST_Advance(3U);
+  CHECK(port->Requests == 0U);
+  CHECK(port->Refused >= 2U);
+
+  FAKE_Hold(TEST_PORT, 0U);
+  TEST_Advance(1U);
+  CHECK(port->Requests == 1U);
+
+  /* SysTick drives the PE and PRL timers as well */
+  CHECK(port->PeTicks - ticks == 4U);
+  CHECK(port->PrlTicks == port->PeTicks);
+
+  FAKE_Detach(TEST_PORT);
+  TEST_Settle();
+  CHECK(DPM_Params[TEST_PORT].PE_Power == USBPD_POWER_NO);
+  CHECK(TestBudget == GOV_DEFAULT_MW);
+  USBPD_DPM_SetLoadPower(TEST_PORT, 0U);
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* Application modules driven by the DPM user code */
+void GOV_SetBudget(uint32_t power)
+{
+  TestBudget = power;
+}
+
+void GOV_LimitBudget(uint32_t power)
+{
+  if (power < TestBudget)
+  {
+    TestBudget = power;
+  }
+}
+
+void GOV_Process(void)
+{
+}
+
+void PTN_Init(void)
+{
+}
+
+void PTN_Reset(uint8_t PortNum)
+{
+  UNUSED(PortNum);
+}
+
+void PTN_Contract(uint8_t PortNum, uint32_t Rdo, uint8_t IsPPS)
+{
+  UNUSED(PortNum);
+  UNUSED(Rdo);
+  UNUSED(IsPPS);
+  TestContracts++;
+}
+
+uint8_t PTN_Store(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef DataId, const uint8_t *Ptr, uint32_t Size)
+{
+  UNUSED(PortNum);
+  UNUSED(DataId);
+  UNUSED(Ptr);
+  UNUSED(Size);
+  return 0U;
+}
+
+void PTN_Process(void)
+{
+}
+
+void LPM_Init(void)
+{
+}
+
+uint8_t DSP_Process(void)
+{
+  return 0U;
+}
+
+void TRACER_EMB_Process(void)
+{
+}
+
+int main(void)
+{
+  TEST_Init();
+  TEST_Scenarios();
+  TEST_BusyRetry();
+
+  return HOST_CheckDone();
+}
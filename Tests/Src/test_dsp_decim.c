@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file    test_dsp_decim.c
+  * @brief   Host check of the decimation chains: passband and alias rejection.
+  ******************************************************************************
+  * @attention
+  *
+  * Every ratio from 2 to DEC_RATIO_MAX is driven with -1 dBFS tones whose
+  * decimated frequency j / TEST_N * fs_out lands on an exact bin of the
+  * TEST_N output samples measured, so the output level at that frequency
+  * is a plain correlation, without window or leakage:
+  *   - passband: input at j / TEST_N * fs_out, j up to 0.4 TEST_N; the
+  *     gain must stay within the flatness of dsp_decim.h;
+  *   - aliases: input at k fs_out +- j / TEST_N * fs_out, every k up to
+  *     fs_in / 2; what folds onto the passband must be 78 dB down.
+  * The input is a table of round(A cos) over TEST_N * ratio samples, one
+  * period of every such tone.
+  *
+  * The last check runs the analysis chain of the scheduler, DEC_Process()
+  * on the input ring, against DEC_ChainRun() in other block sizes.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "dsp_app.h"
+#include "dsp_decim.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_N              256U      /* Output samples measured per tone      */
+#define TEST_SETTLE         64U       /* Output samples skipped, filter delay  */
+#define TEST_AMPLITUDE      29204.0   /* -1 dBFS                               */
+#define TEST_ALIAS_DB       (-78.0)
+#define TEST_PASS_BINS      ((TEST_N * 2U) / 5U)    /* 0.4 fs_out             */
+#define TEST_RING_SAMPLES   6000U
+
+/* Private variables ---------------------------------------------------------*/
+static int16_t TestTable[TEST_N * DEC_RATIO_MAX];
+static int16_t TestIn[DEC_BLOCK];
+static int16_t TestOut[TEST_SETTLE + TEST_N + DEC_BLOCK];
+
+/* Private functions ---------------------------------------------------------*/
+static double TEST_Db(double ratio)
+{
+  return 20.0 * log10(ratio);
+}
+
+static void TEST_Table(uint32_t ratio)
+{
+  const uint32_t period = TEST_N * ratio;
+  uint32_t i;
+
+  for (i = 0U; i < period; i++)
+  {
+    TestTable[i] = (int16_t)lrint(TEST_AMPLITUDE * cos((2.0 * M_PI * i) / period));
+  }
+}
+
+/* Output amplitude at j / TEST_N * fs_out for an input at m / (TEST_N * ratio) * fs_in */
+static double TEST_Tone(uint32_t ratio, uint32_t m, uint32_t j)
+{
+  const uint32_t period = TEST_N * ratio;
+  DEC_ChainTypeDef chain;
+  uint32_t phase = 0U;
+  uint32_t out = 0U;
+  uint32_t i;
+  double re = 0.0;
+  double im = 0.0;
+
+  (void)DEC_ChainInit(&chain, ratio);
+  while (out < (TEST_SETTLE + TEST_N))
+  {
+    for (i = 0U; i < DEC_BLOCK; i++)
+    {
+      TestIn[i] = TestTable[phase];
+      phase = (phase + m) % period;
+    }
+    out += DEC_ChainRun(&chain, TestIn, DEC_BLOCK, &TestOut[out]);
+  }
+
+  for (i = 0U; i < TEST_N; i++)
+  {
+    re += TestOut[TEST_SETTLE + i] * cos((2.0 * M_PI * j * i) / TEST_N);
+    im += TestOut[TEST_SETTLE + i] * sin((2.0 * M_PI * j * i) / TEST_N);
+  }
+  return (2.0 * sqrt((re * re) + (im * im))) / TEST_N;
+}
+
+/* Flatness of dsp_decim.h, peak to peak from DC to 0.4 fs_out */
+static double TEST_Flatness(uint32_t ratio)
+{
+  return (ratio <= 8U) ? 0.005 : 0.04;
+}
+
+static void TEST_Passband(uint32_t ratio)
+{
+  double gain;
+  double low = 1e9;
+  double high = -1e9;
+  uint32_t j;
+
+  for (j = 1U; j <= TEST_PASS_BINS; j++)
+  {
+    gain = TEST_Db(TEST_Tone(ratio, j, j) / TEST_AMPLITUDE);
+    low  = (gain < low) ? gain : low;
+    high = (gain > high) ? gain : high;
+  }
+  CHECK_MSG((high - low) <= TEST_Flatness(ratio), "ratio %lu: passband %.4f to %.4f dB",
+            (unsigned long)ratio, low, high);
+  CHECK_MSG(fabs(high) < 0.1, "ratio %lu: gain %.4f dB", (unsigned long)ratio, high);
+}
+
+static void TEST_Aliases(uint32_t ratio)
+{
+  static const uint32_t bins[] = { 1U, TEST_PASS_BINS / 3U, (2U * TEST_PASS_BINS) / 3U, TEST_PASS_BINS };
+  const uint32_t nyquist = (TEST_N * ratio) / 2U;
+  double worst = -200.0;
+  double level;
+  uint32_t worst_m = 0U;
+  uint32_t k;
+  uint32_t b;
+  uint32_t m;
+
+  for (k = 1U; (k * TEST_N) <= nyquist; k++)
+  {
+    for (b = 0U; b < (2U * (sizeof(bins) / sizeof(bins[0]))); b++)
+    {
+      m = (b & 1U) ? ((k * TEST_N) + bins[b / 2U]) : ((k * TEST_N) - bins[b / 2U]);
+      if (m >= nyquist)
+      {
+        continue;
+      }
+      level = TEST_Db(TEST_Tone(ratio, m, bins[b / 2U]) / TEST_AMPLITUDE);
+      if (level > worst)
+      {
+        worst = level;
+        worst_m = m;
+      }
+    }
+  }
+  CHECK_MSG(worst < TEST_ALIAS_DB, "ratio %lu: alias %.1f dB from %.4f fs_out", (unsigned long)ratio,
+            worst, (double)worst_m / TEST_N);
+}
+
+static void TEST_Ratios(void)
+{
+  uint32_t ratio;
+
+  for (ratio = 2U; ratio <= DEC_RATIO_MAX; ratio *= 2U)
+  {
+    TEST_Table(ratio);
+    TEST_Passband(ratio);
+    TEST_Aliases(ratio);
+  }
+}
+
+static void TEST_Config(void)
+{
+  DEC_ChainTypeDef chain;
+
+  CHECK(DEC_ChainInit(&chain, 0U) == DEC_ERROR);
+  CHECK(DEC_ChainInit(&chain, 3U) == DEC_ERROR);
+  CHECK(DEC_ChainInit(&chain, 2U * DEC_RATIO_MAX) == DEC_ERROR);
+  CHECK(DEC_ChainInit(&chain, DEC_RATIO_MAX) == DEC_OK);
+  CHECK(chain.Cic.Ratio == (DEC_RATIO_MAX / 8U));
+
+  CHECK(DEC_SetRatio(1U) == DEC_OK);
+  CHECK(DEC_GetOutput() == DSP_GetInput());
+  CHECK(DEC_Process() == 0U);
+}
+
+/* The analysis chain on the input ring matches a chain fed in other blocks */
+static void TEST_Process(void)
+{
+  static int16_t input[TEST_RING_SAMPLES];
+  static int16_t expected[TEST_RING_SAMPLES / 8U];
+  DSP_RingTypeDef *ring;
+  DEC_ChainTypeDef chain;
+  const int16_t *src;
+  int16_t *dst;
+  uint32_t count = 0U;
+  uint32_t done = 0U;
+  uint32_t read;
+  uint32_t chunk;
+  uint32_t len;
+  uint32_t n;
+  uint32_t i;
+
+  srand(1U);
+  for (i = 0U; i < TEST_RING_SAMPLES; i++)
+  {
+    input[i] = (int16_t)((rand() % 20001) - 10000);
+  }
+  (void)DEC_ChainInit(&chain, 8U);
+  for (i = 0U; i < TEST_RING_SAMPLES; i += n)
+  {
+    n = ((TEST_RING_SAMPLES - i) < 100U) ? (TEST_RING_SAMPLES - i) : 100U;
+    count += DEC_ChainRun(&chain, &input[i], n, &expected[count]);
+  }
+  CHECK(count == (TEST_RING_SAMPLES / 8U));
+
+  DSP_GetInput()->Rate = DSP_RATE_DEFAULT * 1000U;
+  CHECK(DEC_SetRatio(8U) == DEC_OK);
+  DEC_Reset();
+  ring = DEC_GetOutput();
+  read = DSP_RingWriteIndex(ring);
+  CHECK(ring->Rate == ((DSP_RATE_DEFAULT * 1000U) / 8U));
+
+  while (done < TEST_RING_SAMPLES)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    chunk = (chunk > 173U) ? 173U : chunk;
+    chunk = ((TEST_RING_SAMPLES - done) < chunk) ? (TEST_RING_SAMPLES - done) : chunk;
+    (void)memcpy(dst, &input[done], chunk * sizeof(int16_t));
+    DSP_Commit(chunk);
+    done += chunk;
+    while (DEC_Process() != 0U)
+    {
+    }
+  }
+
+  CHECK(DSP_RingWriteIndex(ring) - read == count);
+  for (i = 0U; i < count; i += len)
+  {
+    src = DSP_RingSamples(ring, read + i, &len);
+    len = (len > (count - i)) ? (count - i) : len;
+    CHECK_MSG(memcmp(src, &expected[i], len * sizeof(int16_t)) == 0, "output differs from %lu",
+              (unsigned long)i);
+  }
+  CHECK(DEC_GetOverruns() == 0U);
+}
+
+/* Exported functions --------------------------------------------------------*/
+int main(void)
+{
+  TEST_Config();
+  TEST_Ratios();
+  TEST_Process();
+
+  return HOST_CheckDone();
+}
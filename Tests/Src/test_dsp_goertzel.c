@@ -0,0 +1,288 @@
+/**
+  ******************************************************************************
+  * @file    test_dsp_goertzel.c
+  * @brief   Host check of the Goertzel detectors: levels and threshold events.
+  ******************************************************************************
+  * @attention
+  *
+  * Each case watches one tone, feeds exactly one block at 48 kHz and reads
+  * the level back from the DFR_TAG_TONE frame. The expected level is the
+  * DFT of the same 16-bit samples at the watched frequency, in double:
+  * 10 log10(4 |X|^2 / Block^2), x in FS units. It includes the leakage of
+  * the negative frequency image, which short blocks near DC and fs / 2
+  * cannot reject. The cases cover:
+  *   - tones near DC and near fs / 2, at the longest block;
+  *   - watched frequencies off the bins of the block, and a tone half a
+  *     bin away from the watched one (-3.92 dB);
+  *   - the shortest and the longest block;
+  *   - full scale sines and squares (+2.1 dB), which would overflow the
+  *     resonator if the input gain or the halving before each chunk were
+  *     wrong, and a -60 dBFS tone for the small signal accuracy.
+  *
+  * The threshold events are then checked on a 1 kHz tone stepped in
+  * level from one block to the next around a -20 dBFS threshold: one
+  * event on reaching it, none while the level stays within GTZ_HYSTERESIS
+  * below, one on falling further.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "dsp_app.h"
+#include "dsp_frame.h"
+#include "dsp_goertzel.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_RATE           48000U      /* Hz                                 */
+#define TEST_TOLERANCE      2           /* 0.01 dB, levels down to -10 dBFS   */
+#define TEST_TOLERANCE_LOW  10          /* 0.01 dB, levels down to -60 dBFS   */
+#define TEST_THRESHOLD      (-2000)     /* 0.01 dBFS                          */
+#define TEST_EVENTS_MAX     16U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  const char *Name;
+  uint32_t    Watch;      /* mHz                                            */
+  double      Tone;       /* Hz                                             */
+  double      Level;      /* dB re full scale sine                          */
+  uint8_t     Square;     /* Full swing square wave at Tone instead         */
+  uint32_t    Block;
+  double      Expected;   /* dB, level read for a long block, NAN if none   */
+} TEST_CaseTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const TEST_CaseTypeDef TestCases[] =
+{
+  { "on bin",           1000000U,  1000.0,    0.0, 0U,  480U,          0.0 },
+  { "off bin",          1234567U,  1234.567,  0.0, 0U,  4801U,         0.0 },
+  { "half bin away",    1234567U,  1239.566,  0.0, 0U,  4801U,      -3.92 },
+  { "near dc",            20000U,    20.0,    0.0, 0U,  GTZ_BLOCK_MAX, NAN },
+  { "near dc, 5 Hz",       5000U,     5.0,    0.0, 0U,  GTZ_BLOCK_MAX, NAN },
+  { "near fs/2",       23980000U, 23980.0,    0.0, 0U,  GTZ_BLOCK_MAX, NAN },
+  { "square near dc",     20000U,    20.0,    0.0, 1U,  GTZ_BLOCK_MAX, NAN },
+  { "square mid band",  1000000U,  1000.0,    0.0, 1U,  GTZ_BLOCK_MAX, 2.10 },
+  { "shortest block",   3000000U,  3000.0,    0.0, 0U,  GTZ_BLOCK_MIN, 0.0 },
+  { "shortest, near dc", 100000U,   100.0,    0.0, 0U,  GTZ_BLOCK_MIN, NAN },
+  { "shortest, fs/2",  23900000U, 23900.0,    0.0, 0U,  GTZ_BLOCK_MIN, NAN },
+  { "square shortest", 12000000U, 12000.0,    0.0, 1U,  GTZ_BLOCK_MIN, NAN },
+  { "-60 dBFS",         1000000U,  1000.0,  -60.0, 0U,  4800U,       -60.0 },
+};
+
+static int16_t  TestBlock[GTZ_BLOCK_MAX];
+static uint64_t TestSample;
+static GTZ_FrameHeaderTypeDef TestHeader;
+static int16_t  TestLevels[GTZ_TONES_MAX];
+static uint32_t TestFrames;
+static GTZ_EventTypeDef TestEvents[TEST_EVENTS_MAX];
+static uint32_t TestEventCount;
+
+/* Private functions ---------------------------------------------------------*/
+/* One block of the tone, continuous in phase with the previous one */
+static void TEST_Generate(double tone, double level, uint8_t square, uint32_t block)
+{
+  const double a = 32767.0 * pow(10.0, level / 20.0);
+  double phase;
+  uint32_t i;
+
+  for (i = 0U; i < block; i++)
+  {
+    phase = 2.0 * M_PI * fmod(((double)TestSample * tone) / TEST_RATE, 1.0);
+    if (square != 0U)
+    {
+      TestBlock[i] = (phase < M_PI) ? INT16_MAX : INT16_MIN;
+    }
+    else
+    {
+      TestBlock[i] = (int16_t)lrint(a * sin(phase));
+    }
+    TestSample++;
+  }
+}
+
+static void TEST_Feed(uint32_t count)
+{
+  const int16_t *src = TestBlock;
+  int16_t *dst;
+  uint32_t chunk;
+
+  while (count != 0U)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    chunk = (chunk > count) ? count : chunk;
+    (void)memcpy(dst, src, chunk * sizeof(int16_t));
+    DSP_Commit(chunk);
+    src += chunk;
+    count -= chunk;
+    while (GTZ_Process() != 0U)
+    {
+    }
+  }
+}
+
+/* Level of the last block from a DFR_TAG_TONE frame, 0.01 dBFS */
+static int16_t TEST_Level(uint32_t tone)
+{
+  TestFrames = 0U;
+  HOST_TickAdvance(1U);
+  (void)GTZ_Process();
+  CHECK(TestFrames == 1U);
+  CHECK(TestHeader.Tones == (tone + 1U));
+  return TestLevels[tone];
+}
+
+/* Level of the block in TestBlock at the watched frequency, dB */
+static double TEST_Reference(uint32_t watch, uint32_t block)
+{
+  const double w = (2.0 * M_PI * watch) / (TEST_RATE * 1000.0);
+  double re = 0.0;
+  double im = 0.0;
+  double p;
+  uint32_t i;
+
+  for (i = 0U; i < block; i++)
+  {
+    re += (TestBlock[i] / 32768.0) * cos(w * i);
+    im -= (TestBlock[i] / 32768.0) * sin(w * i);
+  }
+  p = (4.0 * ((re * re) + (im * im))) / ((double)block * block);
+  return 10.0 * log10(p);
+}
+
+static void TEST_Case(const TEST_CaseTypeDef *tc)
+{
+  GTZ_ToneTypeDef tone = { tc->Watch, INT16_MAX };
+  int tolerance = (tc->Level < -10.0) ? TEST_TOLERANCE_LOW : TEST_TOLERANCE;
+  double expected;
+  int16_t level;
+
+  CHECK(HOST_ConsoleRun("tone clear") == 0);
+  CHECK(GTZ_SetTone(0U, &tone) == GTZ_OK);
+  CHECK(GTZ_SetBlock(tc->Block) == GTZ_OK);
+
+  TEST_Generate(tc->Tone, tc->Level, tc->Square, tc->Block);
+  TEST_Feed(tc->Block);
+  level = TEST_Level(0U);
+  expected = TEST_Reference(tc->Watch, tc->Block);
+
+  CHECK_MSG(TestHeader.Block == tc->Block, "%s: block %lu", tc->Name, (unsigned long)TestHeader.Block);
+  CHECK_MSG(fabs((level / 100.0) - expected) <= (tolerance / 100.0), "%s: %d cdB, expected %.3f dB",
+            tc->Name, level, expected);
+  if (!isnan(tc->Expected))
+  {
+    CHECK_MSG(fabs(expected - tc->Expected) <= (tolerance / 100.0), "%s: reference %.3f dB", tc->Name, expected);
+  }
+  CHECK(TestEventCount == 0U);
+}
+
+/* One block at each level, the events raised by the last one */
+static uint32_t TEST_Step(double level)
+{
+  uint32_t events = TestEventCount;
+
+  TEST_Generate(1000.0, level, 0U, 480U);
+  TEST_Feed(480U);
+  return TestEventCount - events;
+}
+
+static void TEST_Hysteresis(void)
+{
+  const GTZ_ToneTypeDef tone = { 1000000U, TEST_THRESHOLD };
+  uint32_t first;
+  uint32_t i;
+
+  CHECK(HOST_ConsoleRun("tone clear") == 0);
+  CHECK(GTZ_SetBlock(480U) == GTZ_OK);
+  CHECK(GTZ_SetTone(3U, &tone) == GTZ_OK);
+  TestEventCount = 0U;
+
+  CHECK(TEST_Step(-30.0) == 0U);
+  CHECK(TEST_Step(-19.8) == 1U);        /* Reaches -20 dBFS                */
+  CHECK(TEST_Step(-19.0) == 0U);
+  CHECK(TEST_Step(-21.0) == 0U);        /* Within the 3 dB hysteresis      */
+  CHECK(TEST_Step(-22.8) == 0U);
+  CHECK(TEST_Step(-23.2) == 1U);        /* 3 dB below the threshold        */
+  CHECK(TEST_Step(-21.0) == 0U);        /* Still below the threshold       */
+  CHECK(TEST_Step(-20.2) == 0U);
+  CHECK(TEST_Step(-19.8) == 1U);
+  CHECK(TEST_Step(-60.0) == 1U);
+  CHECK(TEST_Step(-60.0) == 0U);
+
+  CHECK(TestEventCount == 4U);
+  if (TestEventCount != 4U)
+  {
+    return;
+  }
+  first = TestEvents[0].Blocks;
+  for (i = 0U; i < 4U; i++)
+  {
+    CHECK(TestEvents[i].Tone == 3U);
+    CHECK(TestEvents[i].Frequency == tone.Frequency);
+    CHECK(TestEvents[i].On == (((i % 2U) == 0U) ? 1U : 0U));
+  }
+  CHECK(TestEvents[1].Blocks == (first + 4U));
+  CHECK(TestEvents[2].Blocks == (first + 7U));
+  CHECK(TestEvents[3].Blocks == (first + 8U));
+  CHECK(abs(TestEvents[0].Level + 1980) <= TEST_TOLERANCE);
+  CHECK(abs(TestEvents[1].Level + 2320) <= TEST_TOLERANCE);
+  CHECK(abs(TestEvents[3].Level + 6000) <= TEST_TOLERANCE_LOW);
+}
+
+static void TEST_Goertzel(void)
+{
+  uint32_t c;
+
+  DSP_GetInput()->Rate = TEST_RATE * 1000U;
+  GTZ_Init();
+  CHECK(HOST_ConsoleRun("tone rate 1") == 0);
+  CHECK(HOST_ConsoleRun("tone on") == 0);
+
+  for (c = 0U; c < (sizeof(TestCases) / sizeof(TestCases[0])); c++)
+  {
+    TEST_Case(&TestCases[c]);
+  }
+  TEST_Hysteresis();
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* The CDC link: keep the last level frame and every event */
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len, const void *data, uint32_t len)
+{
+  const GTZ_FrameHeaderTypeDef *frame = header;
+
+  if (tag == DFR_TAG_TONE_EVENT)
+  {
+    CHECK(header_len == sizeof(GTZ_EventTypeDef));
+    CHECK(len == 0U);
+    if (TestEventCount < TEST_EVENTS_MAX)
+    {
+      TestEvents[TestEventCount] = *(const GTZ_EventTypeDef *)header;
+    }
+    TestEventCount++;
+    return DFR_OK;
+  }
+
+  CHECK(tag == DFR_TAG_TONE);
+  CHECK(header_len == sizeof(GTZ_FrameHeaderTypeDef));
+  CHECK(len == (frame->Tones * sizeof(int16_t)));
+  if (len <= sizeof(TestLevels))
+  {
+    TestHeader = *frame;
+    (void)memcpy(TestLevels, data, len);
+  }
+  TestFrames++;
+  return DFR_OK;
+}
+
+int main(void)
+{
+  TEST_Goertzel();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,192 @@
+/**
+  ******************************************************************************
+  * @file    test_dsp_thd.c
+  * @brief   Host check of the distortion measurement on a synthetic tone.
+  ******************************************************************************
+  * @attention
+  *
+  * The input is a -1 dBFS tone at 997 Hz, 48 kHz sampling (21.27 bins of
+  * a 1024 point frame, off the bin centre), with a 2nd harmonic at
+  * -60 dBc and a 3rd at -70 dBc, rounded to 16 bits: THD is
+  * 10 log10(10^-6 + 10^-7) = -59.59 dB. For each FFT engine and window
+  * the DFR_TAG_THD frame must give the level, the THD and the harmonic
+  * levels within the accuracy of dsp_thd.h (0.02 dB with Blackman-Harris,
+  * 0.05 dB with the flat-top), and the fundamental within its
+  * interpolation error.
+  *
+  * 1 kHz is then measured with the default window: 48 samples per
+  * period, so the rounding error is periodic and falls on the harmonics,
+  * within the 0.05 dB dsp_thd.h gives for such tones.
+  *
+  * The SNR is only bounded: with 16-bit samples it is limited by the
+  * leakage of the window (dsp_thd.h) before the quantisation noise.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "dsp_app.h"
+#include "dsp_engine.h"
+#include "dsp_frame.h"
+#include "dsp_thd.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_RATE           48000U      /* Hz                                 */
+#define TEST_TONE           997.0       /* Hz, not a divisor of the rate      */
+#define TEST_TONE_1K        1000.0      /* Hz, 48 samples per period          */
+#define TEST_LEVEL          (-1.0)      /* dB re full scale sine              */
+#define TEST_H2             (-60.0)     /* dBc                                */
+#define TEST_H3             (-70.0)     /* dBc                                */
+#define TEST_FFT            1024U
+#define TEST_AVERAGE        4U
+#define TEST_TOLERANCE_1K   0.05        /* dB                                 */
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  WIN_WindowTypeDef Window;
+  const char       *Name;         /* "thd win" argument                   */
+  float             Snr;          /* dB, leakage limit of dsp_thd.h       */
+  double            Error;        /* Bins, interpolation error, dsp_thd.h */
+  double            Tolerance;    /* dB, levels down to -70 dBc           */
+} TEST_WindowTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const TEST_WindowTypeDef TestWindows[] =
+{
+  { WIN_BLACKMAN_HARRIS, "bh",      85.0f, 0.005, 0.02 },
+  { WIN_FLAT_TOP,        "flattop", 78.0f, 0.15,  0.05 },
+};
+
+static THD_FrameHeaderTypeDef TestHeader;
+static int16_t  TestLevels[THD_HARMONICS_MAX - 1U];
+static uint32_t TestFrames;
+static uint32_t TestSample;
+static double   TestTone;
+
+/* Private functions ---------------------------------------------------------*/
+static double TEST_Amplitude(double db)
+{
+  return 32767.0 * pow(10.0, db / 20.0);
+}
+
+static void TEST_Feed(uint32_t count)
+{
+  const double a1 = TEST_Amplitude(TEST_LEVEL);
+  const double a2 = a1 * pow(10.0, TEST_H2 / 20.0);
+  const double a3 = a1 * pow(10.0, TEST_H3 / 20.0);
+  double phase;
+  int16_t *dst;
+  uint32_t chunk;
+  uint32_t i;
+
+  while (count != 0U)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    chunk = (chunk > count) ? count : chunk;
+    for (i = 0U; i < chunk; i++)
+    {
+      phase = 2.0 * M_PI * fmod(((double)TestSample * TestTone) / TEST_RATE, 1.0);
+      dst[i] = (int16_t)lrint((a1 * sin(phase)) + (a2 * sin(2.0 * phase)) + (a3 * sin(3.0 * phase)));
+      TestSample++;
+    }
+    DSP_Commit(chunk);
+    count -= chunk;
+    while (THD_Process() != 0U)
+    {
+    }
+  }
+}
+
+static void TEST_Measure(ENG_EngineTypeDef engine, const TEST_WindowTypeDef *win, double tone, double tolerance)
+{
+  const double thd = 10.0 * log10(pow(10.0, TEST_H2 / 10.0) + pow(10.0, TEST_H3 / 10.0));
+  const double bin = (double)TEST_RATE / TEST_FFT;
+  THD_ResultTypeDef last;
+  const THD_ResultTypeDef *result = &last;
+  char name[32];
+  char line[32];
+
+  (void)snprintf(name, sizeof(name), "%s/%s/%.0f Hz", (engine == ENG_FIXED) ? "fixed" : "float", win->Name, tone);
+  TestTone = tone;
+  ENG_SetEngine(engine);
+  (void)snprintf(line, sizeof(line), "thd win %s", win->Name);
+  CHECK(HOST_ConsoleRun(line) == 0);
+  TestFrames = 0U;
+
+  TEST_Feed(TEST_AVERAGE * TEST_FFT);
+  CHECK_MSG(TestFrames == 1U, "%s: %lu frames", name, (unsigned long)TestFrames);
+  if (TestFrames == 0U)
+  {
+    return;
+  }
+
+  CHECK(THD_GetResult(&last) == 1U);
+  CHECK(memcmp(&last, &TestHeader.Result, sizeof(last)) == 0);
+  CHECK(TestHeader.Window == win->Window);
+  CHECK(result->Frames == TEST_AVERAGE);
+  CHECK_MSG(fabs(result->Fundamental - tone) < (win->Error * bin), "%s: f0 %.3f Hz", name,
+            (double)result->Fundamental);
+  CHECK_MSG(fabs(result->Level - TEST_LEVEL) < tolerance, "%s: level %.4f dB", name, (double)result->Level);
+  CHECK_MSG(fabs(result->Thd - thd) < tolerance, "%s: THD %.4f dB, expected %.4f", name,
+            (double)result->Thd, thd);
+  CHECK_MSG(abs(TestLevels[0] - (int16_t)(TEST_H2 * 100.0)) <= (int)lrint(tolerance * 100.0),
+            "%s: H2 %d cdB", name, TestLevels[0]);
+  CHECK_MSG(abs(TestLevels[1] - (int16_t)(TEST_H3 * 100.0)) <= (int)lrint(tolerance * 100.0),
+            "%s: H3 %d cdB", name, TestLevels[1]);
+  CHECK_MSG(result->Snr > win->Snr, "%s: SNR %.1f dB", name, (double)result->Snr);
+  CHECK(result->ThdN > result->Thd);
+  CHECK(fabsf(result->Enob - ((result->Sinad - 1.76f) / 6.02f)) < 1e-3f);
+}
+
+static void TEST_Thd(void)
+{
+  uint32_t w;
+
+  DSP_GetInput()->Rate = TEST_RATE * 1000U;
+  ENG_Init();
+  THD_Init();
+  CHECK(HOST_ConsoleRun("thd n 1024") == 0);
+  CHECK(HOST_ConsoleRun("thd avg 4") == 0);
+  CHECK(HOST_ConsoleRun("thd harm 5") == 0);
+  CHECK(HOST_ConsoleRun("thd on") == 0);
+
+  for (w = 0U; w < (sizeof(TestWindows) / sizeof(TestWindows[0])); w++)
+  {
+    TEST_Measure(ENG_FIXED, &TestWindows[w], TEST_TONE, TestWindows[w].Tolerance);
+    TEST_Measure(ENG_FLOAT, &TestWindows[w], TEST_TONE, TestWindows[w].Tolerance);
+  }
+  TEST_Measure(ENG_FIXED, &TestWindows[0], TEST_TONE_1K, TEST_TOLERANCE_1K);
+  TEST_Measure(ENG_FLOAT, &TestWindows[0], TEST_TONE_1K, TEST_TOLERANCE_1K);
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* The CDC link: keep the last DFR_TAG_THD frame */
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len, const void *data, uint32_t len)
+{
+  const THD_FrameHeaderTypeDef *thd = header;
+
+  CHECK(tag == DFR_TAG_THD);
+  CHECK(header_len == sizeof(THD_FrameHeaderTypeDef));
+  CHECK(len == ((thd->Harmonics - 1U) * sizeof(int16_t)));
+  if (len <= sizeof(TestLevels))
+  {
+    TestHeader = *thd;
+    (void)memcpy(TestLevels, data, len);
+  }
+  TestFrames++;
+  return DFR_OK;
+}
+
+int main(void)
+{
+  TEST_Thd();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,207 @@
+/**
+  ******************************************************************************
+  * @file    test_dsp_xfer.c
+  * @brief   Host check of H1, H2, phase and coherence on a known system.
+  ******************************************************************************
+  * @attention
+  *
+  * x is white Gaussian noise at -18 dBFS. y is x through the FIR
+  * 0.25 + 0.5 z^-1 + 0.25 z^-2, delayed by TEST_DELAY samples, plus white
+  * noise TEST_NOISE below x that x does not see:
+  *
+  *   H = cos^2(w / 2) e^(-j w (TEST_DELAY + 1))
+  *   coherence = |H|^2 / (|H|^2 + TEST_NOISE^2)
+  *
+  * With the noise on y only, H1 = H and H2 = H / coherence. 1024 frames of
+  * 512 points are averaged. From the first bin to fs / 4, every bin must
+  * give |H1| and |H2| within 0.3 dB, the phase within 2 degrees and the
+  * coherence within 0.015, about three times the spread of the estimates
+  * over that many frames. The coherence stays below 1 everywhere,
+  * and drops below 0.5 above 3 fs / 16, where the response sinks into the
+  * noise.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include "main.h"
+#include "dsp_app.h"
+#include "dsp_frame.h"
+#include "dsp_xfer.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_RATE           48000U      /* Hz                                 */
+#define TEST_FFT            512U
+#define TEST_BINS           ((TEST_FFT / 2U) + 1U)
+#define TEST_AVERAGE        1024U       /* Frames                             */
+#define TEST_SIGMA          4096.0      /* x, -18 dBFS                        */
+#define TEST_NOISE          0.2         /* Noise on y, re x                   */
+#define TEST_DELAY          4U          /* Samples, before the FIR            */
+#define TEST_H_DB           0.3         /* |H1|, |H2|                         */
+#define TEST_PHASE          2.0         /* Degrees                            */
+#define TEST_COHERENCE      0.015
+
+/* Private variables ---------------------------------------------------------*/
+static XFR_FrameHeaderTypeDef TestHeader;
+static XFR_BinTypeDef TestBins[TEST_BINS];
+static uint32_t TestReceived;     /* Bins received in DFR_TAG_XFER frames  */
+static uint32_t TestFrames;
+static uint32_t TestRandom = 0x2545F491U;
+static double   TestHistory[TEST_DELAY + 3U]; /* x[n - 1] first           */
+
+/* Private functions ---------------------------------------------------------*/
+/* Standard normal deviate, Box-Muller over xorshift32 */
+static double TEST_Gauss(void)
+{
+  double u[2];
+  uint32_t i;
+
+  for (i = 0U; i < 2U; i++)
+  {
+    TestRandom ^= TestRandom << 13;
+    TestRandom ^= TestRandom >> 17;
+    TestRandom ^= TestRandom << 5;
+    u[i] = (TestRandom + 0.5) / 4294967296.0;
+  }
+  return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+/* Both channels, in chunks the size of the producer writes */
+static void TEST_Feed(uint32_t count)
+{
+  const uint32_t d = TEST_DELAY;
+  int16_t *dst;
+  int16_t *dst_y;
+  uint32_t chunk;
+  uint32_t i;
+  double x;
+  double y;
+
+  while (count != 0U)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    dst_y = DSP_GetWriteBufferY();
+    chunk = (chunk > count) ? count : chunk;
+    for (i = 0U; i < chunk; i++)
+    {
+      x = lrint(TEST_SIGMA * TEST_Gauss());
+      (void)memmove(&TestHistory[1], &TestHistory[0], sizeof(TestHistory) - sizeof(TestHistory[0]));
+      TestHistory[0] = x;
+      y = (0.25 * TestHistory[d]) + (0.5 * TestHistory[d + 1U]) + (0.25 * TestHistory[d + 2U])
+          + (TEST_NOISE * TEST_SIGMA * TEST_Gauss());
+      dst[i] = (int16_t)x;
+      dst_y[i] = (int16_t)lrint(y);
+    }
+    DSP_Commit(chunk);
+    count -= chunk;
+    while (XFR_Process() != 0U)
+    {
+    }
+  }
+}
+
+static void TEST_Xfer(void)
+{
+  const uint32_t hop = TEST_FFT / 2U;
+  double w;
+  double h2;
+  double coherence;
+  double phase;
+  double error;
+  uint32_t k;
+
+  DSP_GetInput()->Rate = TEST_RATE * 1000U;
+  XFR_Init();
+  CHECK(HOST_ConsoleRun("xfer n 512") == 0);
+  CHECK(HOST_ConsoleRun("xfer win hann") == 0);
+  CHECK(HOST_ConsoleRun("xfer avg 1024") == 0);
+  CHECK(HOST_ConsoleRun("xfer rate 1000") == 0);
+  CHECK(HOST_ConsoleRun("xfer on") == 0);
+
+  /* The last frame is completed after the tick moved: one report */
+  TEST_Feed(((TEST_AVERAGE - 1U) * hop) + hop);
+  CHECK(TestFrames == 0U);
+  HOST_TickAdvance(1000U);
+  TEST_Feed(hop);
+
+  CHECK(TestFrames == ((TEST_BINS + XFR_CHUNK_BINS - 1U) / XFR_CHUNK_BINS));
+  CHECK(TestReceived == TEST_BINS);
+  CHECK(TestHeader.Frames == TEST_AVERAGE);
+  CHECK(TestHeader.Average == TEST_AVERAGE);
+  CHECK(TestHeader.FftSize == TEST_FFT);
+  CHECK(TestHeader.Window == WIN_HANN);
+  CHECK(TestHeader.SampleRate == (TEST_RATE * 1000U));
+
+  for (k = 1U; k < TEST_BINS; k++)
+  {
+    w = (2.0 * M_PI * k) / TEST_FFT;
+    h2 = pow(cos(w / 2.0), 4.0);
+    coherence = h2 / (h2 + (TEST_NOISE * TEST_NOISE));
+    CHECK_MSG(TestBins[k].Coherence < 65535U, "bin %lu: coherence 1", (unsigned long)k);
+    if (k > ((3U * TEST_FFT) / 8U))
+    {
+      CHECK_MSG(TestBins[k].Coherence < 32768U, "bin %lu: coherence %.3f, expected %.3f", (unsigned long)k,
+                TestBins[k].Coherence / 65535.0, coherence);
+    }
+    if (k > (TEST_FFT / 4U))
+    {
+      continue;
+    }
+
+    CHECK_MSG(fabs((TestBins[k].H1 / 100.0) - (10.0 * log10(h2))) < TEST_H_DB, "bin %lu: |H1| %.2f dB, expected %.2f",
+              (unsigned long)k, TestBins[k].H1 / 100.0, 10.0 * log10(h2));
+    CHECK_MSG(fabs((TestBins[k].H2 / 100.0) - (10.0 * log10(h2 / (coherence * coherence)))) < TEST_H_DB,
+              "bin %lu: |H2| %.2f dB, expected %.2f", (unsigned long)k, TestBins[k].H2 / 100.0,
+              10.0 * log10(h2 / (coherence * coherence)));
+    phase = -w * (TEST_DELAY + 1U) * (180.0 / M_PI);
+    error = fmod((TestBins[k].Phase / 100.0) - phase, 360.0);
+    error = (error > 180.0) ? (error - 360.0) : ((error < -180.0) ? (error + 360.0) : error);
+    CHECK_MSG(fabs(error) < TEST_PHASE, "bin %lu: phase %.2f deg, expected %.2f", (unsigned long)k,
+              TestBins[k].Phase / 100.0, remainder(phase, 360.0));
+    CHECK_MSG(fabs((TestBins[k].Coherence / 65535.0) - coherence) < TEST_COHERENCE,
+              "bin %lu: coherence %.3f, expected %.3f", (unsigned long)k, TestBins[k].Coherence / 65535.0,
+              coherence);
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* The CDC link: keep the bins of the DFR_TAG_XFER frames */
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len, const void *data, uint32_t len)
+{
+  const XFR_FrameHeaderTypeDef *xfer = header;
+
+  CHECK(tag == DFR_TAG_XFER);
+  CHECK(header_len == sizeof(XFR_FrameHeaderTypeDef));
+  CHECK(len == (xfer->Bins * sizeof(XFR_BinTypeDef)));
+  if (((uint32_t)xfer->FirstBin + xfer->Bins) <= TEST_BINS)
+  {
+    TestHeader = *xfer;
+    (void)memcpy(&TestBins[xfer->FirstBin], data, len);
+    TestReceived += xfer->Bins;
+  }
+  TestFrames++;
+  return DFR_OK;
+}
+
+uint8_t DFR_Fits(uint32_t frames, uint32_t bytes)
+{
+  UNUSED(frames);
+  UNUSED(bytes);
+  return 1U;
+}
+
+void DFR_Drop(uint32_t frames)
+{
+  UNUSED(frames);
+  CHECK(0);
+}
+
+int main(void)
+{
+  TEST_Xfer();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @file    test_dsp_zoom.c
+  * @brief   Host check of the zoom FFT: peak bin, power and alias rejection.
+  ******************************************************************************
+  * @attention
+  *
+  * A -6 dBFS tone at 1003.2 Hz, sampled at 48 kHz, is zoomed at 1 kHz
+  * +-100 Hz with the "zoom" command: ratio 128, 512 points, 0.73 Hz bins.
+  * The DFR_TAG_ZOOM frames ZOOM_Process() sends are decoded back to a
+  * PSD the way the host tools read them (dsp_zoom.h), then:
+  *   - the peak is in the bin nearest to 1003.2 Hz;
+  *   - the PSD integrated around the peak is the tone power, 0.125 FS^2,
+  *     within 0.02 dB;
+  *   - away from the peak, where the mixer image (-2003.2 Hz) folds at
+  *     -128.2 Hz, every bin is 78 dB below the peak.
+  * The NCO comes from the software CORDIC of host_cordic.c.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <math.h>
+#include <string.h>
+#include "main.h"
+#include "dsp_app.h"
+#include "dsp_frame.h"
+#include "dsp_zoom.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_RATE           48000U      /* Hz                                 */
+#define TEST_TONE           1003.2      /* Hz                                 */
+#define TEST_AMPLITUDE      16384.0     /* -6 dBFS                            */
+#define TEST_FRAMES         4U          /* FFT frames in the average          */
+#define TEST_RATIO          128U
+#define TEST_FFT            512U
+#define TEST_TONE_BINS      4U          /* Hann main lobe and first sidelobes */
+#define TEST_SPUR_BINS      32U         /* Hann sidelobes below -78 dB beyond */
+#define TEST_SPUR_DB        (-78.0)
+
+/* Private variables ---------------------------------------------------------*/
+static ZOOM_FrameHeaderTypeDef TestHeader;
+static uint32_t TestBins[ZOOM_FFT_MAX];
+static uint32_t TestReceived;     /* Bins received in DFR_TAG_ZOOM frames  */
+static uint32_t TestFrames;
+static uint32_t TestSample;
+
+/* Private functions ---------------------------------------------------------*/
+/* Input samples of the tone, in chunks the size of the producer writes */
+static void TEST_Feed(uint32_t count)
+{
+  int16_t *dst;
+  uint32_t chunk;
+  uint32_t i;
+
+  while (count != 0U)
+  {
+    dst = DSP_GetWriteBuffer(&chunk);
+    chunk = (chunk > count) ? count : chunk;
+    for (i = 0U; i < chunk; i++)
+    {
+      dst[i] = (int16_t)lrint(TEST_AMPLITUDE
+                              * cos(2.0 * M_PI * fmod(((double)TestSample * TEST_TONE) / TEST_RATE, 1.0)));
+      TestSample++;
+    }
+    DSP_Commit(chunk);
+    count -= chunk;
+    while (ZOOM_Process() != 0U)
+    {
+    }
+  }
+}
+
+static double TEST_Psd(uint32_t bin)
+{
+  return ldexp((double)TestBins[bin] * TestHeader.Scale, TestHeader.Exp);
+}
+
+static void TEST_Zoom(void)
+{
+  const uint32_t first = (TEST_FFT / 2U) - ((2U * TEST_FFT) / 5U);
+  const uint32_t last = (TEST_FFT / 2U) + ((2U * TEST_FFT) / 5U);
+  double width;
+  double power = 0.0;
+  double spur = 0.0;
+  double peak = 0.0;
+  uint32_t nearest;
+  uint32_t bin = 0U;
+  uint32_t k;
+
+  DSP_GetInput()->Rate = TEST_RATE * 1000U;
+  ZOOM_Init();
+  CHECK(HOST_ConsoleRun("zoom 1000 200") == 0);
+  CHECK(HOST_ConsoleRun("zoom rate 1000") == 0);
+
+  TEST_Feed(TEST_FRAMES * TEST_FFT * TEST_RATIO);
+  CHECK(TestFrames == 0U);
+  HOST_TickAdvance(1000U);
+  TEST_Feed(1U);
+
+  CHECK(TestFrames == 2U);
+  CHECK(TestReceived == ((last - first) + 1U));
+  CHECK(TestHeader.FftSize == TEST_FFT);
+  CHECK(TestHeader.SampleRate == ((TEST_RATE * 1000U) / TEST_RATIO));
+  CHECK(TestHeader.Centre == 1000000U);
+  CHECK(TestHeader.Frames == TEST_FRAMES);
+  CHECK(TestHeader.Window == WIN_HANN);
+
+  width = (TestHeader.SampleRate / 1000.0) / TEST_FFT;
+  nearest = (TEST_FFT / 2U) + (uint32_t)lrint((TEST_TONE - (TestHeader.Centre / 1000.0)) / width);
+  for (k = first; k <= last; k++)
+  {
+    if (TEST_Psd(k) > peak)
+    {
+      peak = TEST_Psd(k);
+      bin = k;
+    }
+  }
+  CHECK_MSG(bin == nearest, "peak in bin %lu (%.3f Hz), expected %lu", (unsigned long)bin,
+            (TestHeader.Centre / 1000.0) + (((double)bin - (TEST_FFT / 2U)) * width), (unsigned long)nearest);
+
+  for (k = first; k <= last; k++)
+  {
+    if ((k + TEST_TONE_BINS >= bin) && (k <= bin + TEST_TONE_BINS))
+    {
+      power += TEST_Psd(k) * width;
+    }
+    else if (((k + TEST_SPUR_BINS) < bin) || (k > (bin + TEST_SPUR_BINS)))
+    {
+      spur = (TEST_Psd(k) > spur) ? TEST_Psd(k) : spur;
+    }
+  }
+  CHECK_MSG(fabs(10.0 * log10(power / 0.125)) < 0.02, "tone power %.4f dB off",
+            10.0 * log10(power / 0.125));
+  CHECK_MSG(10.0 * log10(spur / peak) < TEST_SPUR_DB, "spur %.1f dB", 10.0 * log10(spur / peak));
+}
+
+/* Exported functions --------------------------------------------------------*/
+/* The CDC link: keep the last DFR_TAG_ZOOM report */
+DFR_StatusTypeDef DFR_Send(uint8_t tag, const void *header, uint32_t header_len, const void *data, uint32_t len)
+{
+  const ZOOM_FrameHeaderTypeDef *zoom = header;
+
+  CHECK(tag == DFR_TAG_ZOOM);
+  CHECK(header_len == sizeof(ZOOM_FrameHeaderTypeDef));
+  CHECK(len == (zoom->Bins * sizeof(uint32_t)));
+  if (((uint32_t)zoom->FirstBin + zoom->Bins) <= ZOOM_FFT_MAX)
+  {
+    TestHeader = *zoom;
+    (void)memcpy(&TestBins[zoom->FirstBin], data, len);
+    TestReceived += zoom->Bins;
+  }
+  TestFrames++;
+  return DFR_OK;
+}
+
+uint8_t DFR_Fits(uint32_t frames, uint32_t bytes)
+{
+  UNUSED(frames);
+  UNUSED(bytes);
+  return 1U;
+}
+
+void DFR_Drop(uint32_t frames)
+{
+  UNUSED(frames);
+  CHECK(0);
+}
+
+int main(void)
+{
+  TEST_Zoom();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,265 @@
+/**
+  ******************************************************************************
+  * @file    test_pwr_calib.c
+  * @brief   Host check of the VBUS/IBUS conversion model.
+  ******************************************************************************
+  * @attention
+  *
+  * Uses the divider and current sense amplifier of the board
+  * (usbpd_pwr_sense.h). The trims are checked against a simulated board
+  * whose divider and amplifier are off nominal: codes are produced by the
+  * exact model of that board, the trims must then read the applied values
+  * back to within the ADC resolution.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usbpd_pwr_calib.h"
+#include "usbpd_pwr_sense.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_VDDA           3300U
+#define TEST_VREFINT_CAL    1655U    /* Typical factory code at 3.0 V */
+
+/* Simulated board: divider 1.5 % high plus 42 mV, amplifier 3 % high
+   with 37 mV at 0 A */
+#define TEST_TRUE_VBUS_GAIN     1.015
+#define TEST_TRUE_VBUS_OFFSET   42.0
+#define TEST_TRUE_IBUS_GAIN     1.03
+#define TEST_TRUE_IBUS_ZERO     37.0
+
+/* Private variables ---------------------------------------------------------*/
+static const PWRC_ModelTypeDef TestNominal =
+{
+  .VrefintCal      = TEST_VREFINT_CAL,
+  .VrefintCalVdda  = 3000U,
+  .DividerNum      = PWRS_DIVIDER_NUM,
+  .DividerDen      = PWRS_DIVIDER_DEN,
+  .VbusGain        = PWRC_GAIN_ONE,
+  .VbusOffset      = 0,
+  .IbusSensitivity = PWRS_IBUS_SENSITIVITY,
+  .IbusZero        = 0,
+  .IbusGain        = PWRC_GAIN_ONE,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t TEST_Code(double pin, uint32_t vdda)
+{
+  double code = (pin * PWRC_FULL_SCALE / vdda) + 0.5;
+
+  return (code < 0.0) ? 0U : (code > PWRC_FULL_SCALE) ? PWRC_FULL_SCALE : (uint32_t)code;
+}
+
+/* Code the simulated board reads with vbus (mV) applied */
+static uint32_t TEST_VbusCode(uint32_t vbus, uint32_t vdda)
+{
+  double pin = ((double)vbus - TEST_TRUE_VBUS_OFFSET) / TEST_TRUE_VBUS_GAIN
+               * PWRS_DIVIDER_DEN / PWRS_DIVIDER_NUM;
+
+  return TEST_Code(pin, vdda);
+}
+
+/* Code the simulated board reads with ibus (mA) flowing */
+static uint32_t TEST_IbusCode(int32_t ibus, uint32_t vdda)
+{
+  double pin = TEST_TRUE_IBUS_ZERO + (ibus * (PWRS_IBUS_SENSITIVITY * TEST_TRUE_IBUS_GAIN) / 1000.0);
+
+  return TEST_Code(pin, vdda);
+}
+
+static void TEST_Vdda(void)
+{
+  PWRC_ModelTypeDef model = TestNominal;
+
+  /* VDDA = 3.0 V * 1655 / code */
+  CHECK(PWRC_Vdda(&model, TEST_VREFINT_CAL) == 3000U);
+  CHECK_MSG(PWRC_Vdda(&model, 1505U) == 3299U, "%u", (unsigned)PWRC_Vdda(&model, 1505U));
+  CHECK(PWRC_Vdda(&model, 0U) == 3000U);
+  model.VrefintCal = 0U;
+  CHECK(PWRC_Vdda(&model, 1505U) == 3000U);
+}
+
+static void TEST_RoundTrip(void)
+{
+  static const int32_t gains[]   = { PWRC_GAIN_ONE, 66847, 64225 };
+  static const int32_t offsets[] = { 0, -35, 40 };
+  static const uint32_t vddas[]  = { 3000U, TEST_VDDA, 3600U };
+  PWRC_ModelTypeDef model = TestNominal;
+  uint32_t t;
+  uint32_t v;
+  uint32_t code;
+  uint32_t vbus;
+  uint32_t lsb;
+  uint32_t bad;
+
+  CHECK_MSG(PWRC_Vbus(&model, PWRC_FULL_SCALE, TEST_VDDA) == 25300U, "%u",
+            (unsigned)PWRC_Vbus(&model, PWRC_FULL_SCALE, TEST_VDDA));
+
+  for (t = 0U; t < (sizeof(gains) / sizeof(gains[0])); t++)
+  {
+    model.VbusGain   = gains[t];
+    model.VbusOffset = offsets[t];
+    for (v = 0U; v < (sizeof(vddas) / sizeof(vddas[0])); v++)
+    {
+      /* Every code converts back to itself (0 V clamps hide the lowest codes) */
+      bad = 0U;
+      for (code = 0U; code <= PWRC_FULL_SCALE; code++)
+      {
+        vbus = PWRC_Vbus(&model, code, vddas[v]);
+        if ((vbus != 0U) && (PWRC_VbusToCode(&model, vbus, vddas[v]) != code))
+        {
+          bad++;
+        }
+      }
+      CHECK_MSG(bad == 0U, "gain %ld offset %ld vdda %u: %u codes",
+                (long)gains[t], (long)offsets[t], (unsigned)vddas[v], (unsigned)bad);
+
+      /* Every voltage in range converts back to within half a code, plus
+         the 1 mV rounding of the result */
+      lsb = PWRC_Vbus(&model, PWRC_FULL_SCALE, vddas[v]);
+      lsb = (lsb + PWRC_FULL_SCALE - 1U) / PWRC_FULL_SCALE;
+      bad = 0U;
+      for (vbus = 100U; vbus < PWRC_Vbus(&model, PWRC_FULL_SCALE - 1U, vddas[v]); vbus++)
+      {
+        code = PWRC_VbusToCode(&model, vbus, vddas[v]);
+        if ((uint32_t)abs((int)PWRC_Vbus(&model, code, vddas[v]) - (int)vbus) > ((lsb / 2U) + 1U))
+        {
+          bad++;
+        }
+      }
+      CHECK_MSG(bad == 0U, "gain %ld offset %ld vdda %u: %u voltages",
+                (long)gains[t], (long)offsets[t], (unsigned)vddas[v], (unsigned)bad);
+    }
+  }
+}
+
+static void TEST_TrimVbus(void)
+{
+  PWRC_ModelTypeDef model = TestNominal;
+  PWRC_ModelTypeDef before;
+  uint32_t vbus;
+  int32_t err;
+  int32_t worst = 0;
+  int32_t worst_nominal = 0;
+
+  for (vbus = 5000U; vbus <= 20000U; vbus += 50U)
+  {
+    err = abs((int)PWRC_Vbus(&model, TEST_VbusCode(vbus, TEST_VDDA), TEST_VDDA) - (int)vbus);
+    worst_nominal = (err > worst_nominal) ? err : worst_nominal;
+  }
+
+  CHECK(PWRC_TrimVbus(&model, TEST_VbusCode(5000U, TEST_VDDA), 5000U,
+                      TEST_VbusCode(20000U, TEST_VDDA), 20000U, TEST_VDDA) == 0);
+  CHECK_MSG(abs(model.VbusGain - (int32_t)(TEST_TRUE_VBUS_GAIN * PWRC_GAIN_ONE)) < 100,
+            "gain %ld", (long)model.VbusGain);
+  CHECK_MSG(abs(model.VbusOffset - (int32_t)TEST_TRUE_VBUS_OFFSET) <= 10, "offset %ld", (long)model.VbusOffset);
+
+  /* Within one code (6.2 mV at 3.3 V) over the PD range, other VDDA too */
+  for (vbus = 5000U; vbus <= 20000U; vbus += 50U)
+  {
+    err = abs((int)PWRC_Vbus(&model, TEST_VbusCode(vbus, TEST_VDDA), TEST_VDDA) - (int)vbus);
+    worst = (err > worst) ? err : worst;
+    err = abs((int)PWRC_Vbus(&model, TEST_VbusCode(vbus, 3000U), 3000U) - (int)vbus);
+    worst = (err > worst) ? err : worst;
+  }
+  CHECK_MSG(worst <= 7, "worst %ld mV (untrimmed %ld mV)", (long)worst, (long)worst_nominal);
+  CHECK(worst_nominal > 100);
+
+  /* Thresholds land on the code the board reads at that voltage */
+  CHECK(abs((int)PWRC_VbusToCode(&model, 9000U, TEST_VDDA) - (int)TEST_VbusCode(9000U, TEST_VDDA)) <= 1);
+
+  /* Degenerate points leave the trim alone */
+  before = model;
+  CHECK(PWRC_TrimVbus(&model, 1000U, 5000U, 1000U, 20000U, TEST_VDDA) == -1);
+  CHECK(PWRC_TrimVbus(&model, 1000U, 5000U, 3000U, 5000U, TEST_VDDA) == -1);
+  CHECK(PWRC_TrimVbus(&model, 3000U, 5000U, 1000U, 20000U, TEST_VDDA) == -1);
+  CHECK(memcmp(&model, &before, sizeof(model)) == 0);
+}
+
+static void TEST_TrimIbus(void)
+{
+  static const int32_t points[] = { 0, 100, 500, 1000, 2000, 3000, 5000, -50 };
+  PWRC_ModelTypeDef model = TestNominal;
+  PWRC_ModelTypeDef before;
+  uint32_t i;
+  int32_t ibus;
+  int32_t tol;
+
+  CHECK(PWRC_TrimIbus(&model, TEST_IbusCode(0, TEST_VDDA), TEST_IbusCode(3000, TEST_VDDA), 3000, TEST_VDDA) == 0);
+  CHECK_MSG(abs(model.IbusZero - (int32_t)TEST_TRUE_IBUS_ZERO) <= 1, "zero %ld", (long)model.IbusZero);
+
+  /* One code is 1.6 mA, plus the gain error of a 3 A reference point;
+     -50 mA is still above 0 V at the amplifier output */
+  for (i = 0U; i < (sizeof(points) / sizeof(points[0])); i++)
+  {
+    ibus = PWRC_Ibus(&model, TEST_IbusCode(points[i], TEST_VDDA), TEST_VDDA);
+    tol  = 3 + (abs(points[i]) / 500);
+    CHECK_MSG(abs(ibus - points[i]) <= tol, "%ld mA read %ld mA", (long)points[i], (long)ibus);
+  }
+
+  /* Degenerate points leave the trim alone */
+  before = model;
+  CHECK(PWRC_TrimIbus(&model, 100U, 900U, 0, TEST_VDDA) == -1);
+  CHECK(PWRC_TrimIbus(&model, 100U, 100U, 3000, TEST_VDDA) == -1);
+  CHECK(PWRC_TrimIbus(&model, 900U, 100U, 3000, TEST_VDDA) == -1);
+  CHECK(memcmp(&model, &before, sizeof(model)) == 0);
+  model.IbusSensitivity = 0U;
+  CHECK(PWRC_TrimIbus(&model, 100U, 900U, 3000, TEST_VDDA) == -1);
+  CHECK(PWRC_Ibus(&model, 900U, TEST_VDDA) == 0);
+}
+
+static void TEST_Saturation(void)
+{
+  PWRC_ModelTypeDef model = TestNominal;
+
+  /* Negative results clamp to 0 V instead of wrapping */
+  model.VbusOffset = -35;
+  CHECK(PWRC_Vbus(&model, 0U, TEST_VDDA) == 0U);
+  CHECK(PWRC_Vbus(&model, 1U, TEST_VDDA) == 0U);
+  model.VbusOffset = 40;
+  CHECK(PWRC_VbusToCode(&model, 0U, TEST_VDDA) == 0U);
+  CHECK(PWRC_VbusToCode(&model, 40U, TEST_VDDA) == 0U);
+
+  /* Above the divider range: full scale, never a wrapped small code */
+  CHECK(PWRC_VbusToCode(&model, 26000U, TEST_VDDA) == PWRC_FULL_SCALE);
+  CHECK(PWRC_VbusToCode(&model, UINT32_MAX, TEST_VDDA) == PWRC_FULL_SCALE);
+  model.VbusGain = 1;
+  CHECK(PWRC_VbusToCode(&model, UINT32_MAX, TEST_VDDA) == PWRC_FULL_SCALE);
+  CHECK(PWRC_VbusToCode(&model, 5000U, TEST_VDDA) == PWRC_FULL_SCALE);
+
+  /* An unusable model never arms a threshold below full scale */
+  model = TestNominal;
+  model.VbusGain = 0;
+  CHECK(PWRC_VbusToCode(&model, 5000U, TEST_VDDA) == PWRC_FULL_SCALE);
+  model = TestNominal;
+  model.DividerNum = 0U;
+  CHECK(PWRC_VbusToCode(&model, 5000U, TEST_VDDA) == PWRC_FULL_SCALE);
+  model = TestNominal;
+  CHECK(PWRC_VbusToCode(&model, 5000U, 0U) == PWRC_FULL_SCALE);
+
+  /* Largest gain and VDDA still fit the 64-bit intermediates */
+  model.VbusGain = INT32_MAX;
+  CHECK(PWRC_Vbus(&model, PWRC_FULL_SCALE, 3600U) == (uint32_t)(27600.0 * INT32_MAX / PWRC_GAIN_ONE + 0.5));
+
+  /* Current below the zero point reads negative */
+  model = TestNominal;
+  model.IbusZero = 100;
+  CHECK(PWRC_Ibus(&model, 0U, TEST_VDDA) == -200);
+}
+
+/* Exported functions --------------------------------------------------------*/
+int main(void)
+{
+  TEST_Vdda();
+  TEST_RoundTrip();
+  TEST_TrimVbus();
+  TEST_TrimIbus();
+  TEST_Saturation();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  * @file    test_snk_policy.c
+  * @brief   Host check of the sink power policy with canned
+  *          Source_Capabilities.
+  ******************************************************************************
+  * @attention
+  *
+  * Source objects are encoded and the RDO decoded here from the bit layout
+  * of the USB PD 3.0 specification rather than through the usbpd_def.h
+  * unions, so a field misplaced in the policy shows up as a wrong request.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "usbpd_snk_policy.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define COUNT_OF(a)         (sizeof(a) / sizeof((a)[0]))
+
+/* Source objects (mV, mA, mW) */
+#define PDO_FIXED(mv, ma)              (((uint32_t)((mv) / 50U) << 10) | ((uint32_t)(ma) / 10U))
+#define PDO_VARIABLE(vmin, vmax, ma)   ((2UL << 30) | ((uint32_t)((vmax) / 50U) << 20) | \
+                                        ((uint32_t)((vmin) / 50U) << 10) | ((uint32_t)(ma) / 10U))
+#define PDO_BATTERY(vmin, vmax, mw)    ((1UL << 30) | ((uint32_t)((vmax) / 50U) << 20) | \
+                                        ((uint32_t)((vmin) / 50U) << 10) | ((uint32_t)(mw) / 250U))
+#define PDO_PPS(vmin, vmax, ma)        ((3UL << 30) | ((uint32_t)((vmax) / 100U) << 17) | \
+                                        ((uint32_t)((vmin) / 100U) << 8) | ((uint32_t)(ma) / 50U))
+
+/* Request Data Object fields */
+#define RDO_POSITION(rdo)       (((rdo) >> 28) & 0x7U)
+#define RDO_MISMATCH(rdo)       (((rdo) >> 26) & 0x1U)
+#define RDO_USB_COMM(rdo)       (((rdo) >> 25) & 0x1U)
+#define RDO_NO_SUSPEND(rdo)     (((rdo) >> 24) & 0x1U)
+#define RDO_OP(rdo)             (((rdo) >> 10) & 0x3FFU)  /* 10 mA or 250 mW */
+#define RDO_MAX(rdo)            ((rdo) & 0x3FFU)          /* 10 mA or 250 mW */
+#define RDO_PPS_MV(rdo)         ((((rdo) >> 9) & 0x7FFU) * 20U)
+#define RDO_PPS_MA(rdo)         (((rdo) & 0x7FU) * 50U)
+
+/* Private variables ---------------------------------------------------------*/
+/* 5-20 V input, prefers 9 V, 15 W to run and 27 W with the battery charging */
+static const USBPD_SNKPowerRequest_TypeDef TestSink =
+{
+  .MaxOperatingCurrentInmAunits = 3000U,
+  .OperatingVoltageInmVunits    = 9000U,
+  .MaxOperatingVoltageInmVunits = 20000U,
+  .MinOperatingVoltageInmVunits = 5000U,
+  .OperatingPowerInmWunits      = 15000U,
+  .MaxOperatingPowerInmWunits   = 27000U,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void TEST_FixedOnly(void)
+{
+  static const uint32_t caps[] =
+  {
+    PDO_FIXED(5000U, 3000U), PDO_FIXED(9000U, 3000U), PDO_FIXED(15000U, 3000U), PDO_FIXED(20000U, 2250U)
+  };
+  SNKP_SelectionTypeDef sel;
+
+  /* Every object covers 15 W, 9 V is the preferred voltage */
+  CHECK(SNKP_Evaluate(&TestSink, caps, COUNT_OF(caps), 0U, SNKP_FLAG_USB_COMM, &sel) == SNKP_OK);
+  CHECK(sel.Position == 2U);
+  CHECK((sel.PdoType == USBPD_CORE_PDO_TYPE_FIXED) && (sel.IsPPS == 0U) && (sel.Mismatch == 0U));
+  CHECK(sel.Voltage == 9000U);
+  CHECK(RDO_POSITION(sel.Rdo) == 2U);
+  CHECK((RDO_MISMATCH(sel.Rdo) == 0U) && (RDO_USB_COMM(sel.Rdo) == 1U) && (RDO_NO_SUSPEND(sel.Rdo) == 1U));
+  /* 15 W / 9 V = 1667 mA rounded up, 27 W / 9 V = 3 A */
+  CHECK_MSG(RDO_OP(sel.Rdo) == 167U, "op %u", (unsigned)RDO_OP(sel.Rdo));
+  CHECK_MSG(RDO_MAX(sel.Rdo) == 300U, "max %u", (unsigned)RDO_MAX(sel.Rdo));
+  CHECK(sel.Current == 1670U);
+
+  /* Without a 9 V object the closest one wins, then the most power */
+  CHECK(SNKP_Evaluate(&TestSink, &caps[2], 2U, 0U, 0U, &sel) == SNKP_OK);
+  CHECK(sel.Position == 1U);
+  CHECK(RDO_USB_COMM(sel.Rdo) == 0U);
+  /* 27 W / 15 V = 1.8 A */
+  CHECK((RDO_OP(sel.Rdo) == 100U) && (RDO_MAX(sel.Rdo) == 180U));
+
+  /* A sink current limit caps the request and the power of each object */
+  {
+    USBPD_SNKPowerRequest_TypeDef sink = TestSink;
+
+    sink.MaxOperatingCurrentInmAunits = 1500U;
+    CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+    /* 13.5 W at 9 V no longer covers the load, 22.5 W at 15 V does */
+    CHECK(sel.Position == 3U);
+    CHECK((RDO_OP(sel.Rdo) == 100U) && (RDO_MAX(sel.Rdo) == 150U));
+    CHECK(sel.Power == 22500U);
+  }
+}
+
+static void TEST_PpsPreferred(void)
+{
+  static const uint32_t caps[] =
+  {
+    PDO_FIXED(5000U, 3000U), PDO_FIXED(15000U, 3000U), PDO_FIXED(20000U, 3000U), PDO_PPS(3300U, 11000U, 3000U)
+  };
+  static const uint32_t caps9[] =
+  {
+    PDO_FIXED(5000U, 3000U), PDO_FIXED(9000U, 3000U), PDO_PPS(3300U, 11000U, 3000U)
+  };
+  SNKP_SelectionTypeDef sel;
+
+  /* Only the PPS reaches 9 V */
+  CHECK(SNKP_Evaluate(&TestSink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+  CHECK(sel.Position == 4U);
+  CHECK((sel.PdoType == USBPD_CORE_PDO_TYPE_APDO) && (sel.IsPPS == 1U) && (sel.Mismatch == 0U));
+  CHECK(sel.Voltage == 9000U);
+  CHECK(RDO_POSITION(sel.Rdo) == 4U);
+  CHECK_MSG(RDO_PPS_MV(sel.Rdo) == 9000U, "pps %u mV", (unsigned)RDO_PPS_MV(sel.Rdo));
+  /* The PPS current is the source limit: the 27 W budget, 3 A */
+  CHECK_MSG(RDO_PPS_MA(sel.Rdo) == 3000U, "pps %u mA", (unsigned)RDO_PPS_MA(sel.Rdo));
+  CHECK(sel.Current == 3000U);
+
+  /* A fixed 9 V object wins the tie: no keep-alive traffic */
+  CHECK(SNKP_Evaluate(&TestSink, caps9, COUNT_OF(caps9), 0U, 0U, &sel) == SNKP_OK);
+  CHECK((sel.Position == 2U) && (sel.IsPPS == 0U));
+
+  /* PPS ignored on request: 5 V is closer to 9 V than 15 V */
+  CHECK(SNKP_Evaluate(&TestSink, caps, COUNT_OF(caps), 0U, SNKP_FLAG_NO_PPS, &sel) == SNKP_OK);
+  CHECK((sel.Position == 1U) && (sel.IsPPS == 0U));
+}
+
+static void TEST_PpsStep(void)
+{
+  static const uint32_t caps[] = { PDO_FIXED(5000U, 3000U), PDO_PPS(3300U, 11000U, 3000U) };
+  USBPD_SNKPowerRequest_TypeDef sink = TestSink;
+  SNKP_SelectionTypeDef sel;
+  uint32_t mv;
+  uint32_t out;
+  uint32_t err;
+
+  /* The nearest 20 mV step of every preferred voltage above vSafe5V */
+  for (mv = 5020U; mv <= 11000U; mv += 7U)
+  {
+    sink.OperatingVoltageInmVunits = mv;
+    if (SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) != SNKP_OK)
+    {
+      CHECK_MSG(0, "%u mV: no selection", (unsigned)mv);
+      continue;
+    }
+    out = RDO_PPS_MV(sel.Rdo);
+    err = (out > mv) ? (out - mv) : (mv - out);
+    if ((sel.IsPPS == 0U) || (out != sel.Voltage) || (err > (SNKP_PPS_STEP_MV / 2U)))
+    {
+      CHECK_MSG(0, "%u mV: requested %u mV", (unsigned)mv, (unsigned)out);
+    }
+  }
+
+  /* One step: 9.02 V is not 9 V */
+  sink.OperatingVoltageInmVunits = 9020U;
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+  CHECK((RDO_PPS_MV(sel.Rdo) == 9020U) && (sel.Voltage == 9020U));
+
+  /* The step never leaves the sink window or the object range */
+  sink.OperatingVoltageInmVunits    = 9000U;
+  sink.MaxOperatingVoltageInmVunits = 8990U;
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+  CHECK_MSG(RDO_PPS_MV(sel.Rdo) == 8980U, "pps %u mV", (unsigned)RDO_PPS_MV(sel.Rdo));
+  sink.OperatingVoltageInmVunits    = 3290U;
+  sink.MaxOperatingVoltageInmVunits = 20000U;
+  sink.MinOperatingVoltageInmVunits = 3290U;
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 9000U, 0U, &sel) == SNKP_OK);
+  CHECK_MSG(RDO_PPS_MV(sel.Rdo) == 3300U, "pps %u mV", (unsigned)RDO_PPS_MV(sel.Rdo));
+  sink.OperatingVoltageInmVunits    = 11010U;
+  sink.MinOperatingVoltageInmVunits = 11010U;
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_MISMATCH);
+  CHECK((sel.Position == 1U) && (sel.IsPPS == 0U));
+}
+
+static void TEST_LoadNotCovered(void)
+{
+  static const uint32_t caps[] = { PDO_FIXED(5000U, 1500U), PDO_FIXED(9000U, 1000U) };
+  USBPD_SNKPowerRequest_TypeDef sink = TestSink;
+  SNKP_SelectionTypeDef sel;
+
+  /* 7.5 W and 9 W for a 15 W load: the most power, Capability Mismatch */
+  CHECK(SNKP_Evaluate(&TestSink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_MISMATCH);
+  CHECK((sel.Position == 2U) && (sel.Mismatch == 1U));
+  CHECK((RDO_POSITION(sel.Rdo) == 2U) && (RDO_MISMATCH(sel.Rdo) == 1U));
+  /* Operating current capped by the object, maximum states the real need */
+  CHECK((RDO_OP(sel.Rdo) == 100U) && (RDO_MAX(sel.Rdo) == 300U));
+
+  /* A lower load budget is covered again */
+  CHECK(SNKP_Evaluate(&TestSink, caps, COUNT_OF(caps), 9000U, 0U, &sel) == SNKP_OK);
+  CHECK((sel.Position == 2U) && (RDO_MISMATCH(sel.Rdo) == 0U));
+
+  /* Nothing in the voltage window: vSafe5V with Capability Mismatch */
+  sink.MinOperatingVoltageInmVunits = 9000U;
+  CHECK(SNKP_Evaluate(&sink, caps, 1U, 0U, 0U, &sel) == SNKP_MISMATCH);
+  CHECK((sel.Position == 1U) && (RDO_POSITION(sel.Rdo) == 1U) && (RDO_MISMATCH(sel.Rdo) == 1U));
+  CHECK(sel.Voltage == 5000U);
+}
+
+static void TEST_BatteryVariable(void)
+{
+  static const uint32_t caps[] =
+  {
+    PDO_FIXED(5000U, 3000U), PDO_VARIABLE(9000U, 12000U, 2000U), PDO_BATTERY(9000U, 12000U, 30000U)
+  };
+  USBPD_SNKPowerRequest_TypeDef sink = TestSink;
+  SNKP_SelectionTypeDef sel;
+
+  sink.OperatingVoltageInmVunits = 10000U;
+
+  /* Variable (18 W at 9 V) and battery are as close: variable ranks first */
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+  CHECK((sel.Position == 2U) && (sel.PdoType == USBPD_CORE_PDO_TYPE_VARIABLE));
+  CHECK(sel.Voltage == 9000U);
+  /* Currents sized at the lowest voltage of the range */
+  CHECK((RDO_OP(sel.Rdo) == 167U) && (RDO_MAX(sel.Rdo) == 200U));
+
+  /* 20 W only fits the battery object, RDO in 250 mW units */
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 20000U, 0U, &sel) == SNKP_OK);
+  CHECK((sel.Position == 3U) && (sel.PdoType == USBPD_CORE_PDO_TYPE_BATTERY));
+  CHECK(sel.Power == 30000U);
+  CHECK_MSG((RDO_OP(sel.Rdo) == 80U) && (RDO_MAX(sel.Rdo) == 108U),
+            "op %u max %u", (unsigned)RDO_OP(sel.Rdo), (unsigned)RDO_MAX(sel.Rdo));
+  CHECK(sel.Current == 2223U);
+
+  /* A range reaching past the sink window is not usable */
+  sink.MaxOperatingVoltageInmVunits = 11000U;
+  CHECK(SNKP_Evaluate(&sink, caps, COUNT_OF(caps), 0U, 0U, &sel) == SNKP_OK);
+  CHECK(sel.Position == 1U);
+}
+
+static void TEST_Errors(void)
+{
+  static const uint32_t caps[] = { PDO_PPS(3300U, 11000U, 3000U) };
+  SNKP_SelectionTypeDef sel;
+
+  CHECK(SNKP_Evaluate(NULL, caps, 1U, 0U, 0U, &sel) == SNKP_ERROR);
+  CHECK(SNKP_Evaluate(&TestSink, caps, 0U, 0U, 0U, &sel) == SNKP_ERROR);
+  /* No fixed vSafe5V object to fall back on */
+  CHECK(SNKP_Evaluate(&TestSink, caps, 1U, 0U, SNKP_FLAG_NO_PPS, &sel) == SNKP_ERROR);
+}
+
+/* Exported functions --------------------------------------------------------*/
+int main(void)
+{
+  TEST_FixedOnly();
+  TEST_PpsPreferred();
+  TEST_PpsStep();
+  TEST_LoadNotCovered();
+  TEST_BatteryVariable();
+  TEST_Errors();
+
+  return HOST_CheckDone();
+}
@@ -0,0 +1,145 @@
+/**
+  ******************************************************************************
+  * @file    test_storage_bench.c
+  * @brief   Host check of the storage benchmark against a file-backed disk.
+  ******************************************************************************
+  * @attention
+  *
+  * Formats an image as exFAT and as FAT32 with the firmware FatFs
+  * configuration (ffconf.h, ff_sync.c, the memory pools), then runs the
+  * whole suite on it. The suite must complete, emit every section of its
+  * JSON report, remove its scratch files, give back every cluster it took
+  * and leave the files already on the volume untouched. The timer is the
+  * host monotonic clock, so the figures printed are those of the host.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ff.h"
+#include "mempool.h"
+#include "storage_bench.h"
+#include "file_diskio.h"
+#include "host_check.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_IMAGE          "build/storage.img"
+#define TEST_SECTORS        (128UL * 1024UL)  /* 64 MB */
+#define TEST_KEEP_NAME      "0:/KEEP.BIN"
+#define TEST_KEEP_SIZE      (64U * 1024U)
+#define TEST_REPORT_SIZE    16384U
+
+/* Private variables ---------------------------------------------------------*/
+static FATFS TestFs;
+static uint8_t TestWork[4096];
+static uint8_t TestBuffer[SBN_MAX_SECTORS * SBN_SECTOR_SIZE];
+static uint8_t TestKeep[TEST_KEEP_SIZE];
+static char TestReport[TEST_REPORT_SIZE];
+static uint32_t TestReportLen;
+
+/* Private functions ---------------------------------------------------------*/
+uint32_t SBN_TimerRead(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U));
+}
+
+uint32_t SBN_TimerFreq(void)
+{
+  return 1000000U;
+}
+
+static void TEST_Output(const char *text, uint32_t len, void *ctx)
+{
+  (void)ctx;
+  if ((TestReportLen + len) < TEST_REPORT_SIZE)
+  {
+    memcpy(&TestReport[TestReportLen], text, len);
+    TestReportLen += len;
+    TestReport[TestReportLen] = '\0';
+  }
+  (void)fwrite(text, 1U, len, stdout);
+}
+
+static int TEST_KeepMatches(void)
+{
+  static uint8_t back[TEST_KEEP_SIZE];
+  FIL fil;
+  UINT br = 0U;
+
+  if (f_open(&fil, TEST_KEEP_NAME, FA_READ) != FR_OK)
+  {
+    return 0;
+  }
+  (void)f_read(&fil, back, sizeof(back), &br);
+  (void)f_close(&fil);
+  return (br == sizeof(back)) && (memcmp(back, TestKeep, sizeof(back)) == 0);
+}
+
+static void TEST_Run(BYTE format, const char *name)
+{
+  SBN_ConfigTypeDef cfg;
+  SBN_StatusTypeDef status;
+  FATFS *fs;
+  DWORD free_before = 0U;
+  DWORD free_after = 0U;
+  FILINFO fno;
+  FIL fil;
+  UINT bw = 0U;
+  uint32_t i;
+
+  printf("--- %s\n", name);
+  CHECK(HOST_DiskOpen(TEST_IMAGE, TEST_SECTORS) == 0);
+  CHECK(f_mkfs("0:", format, 0U, TestWork, sizeof(TestWork)) == FR_OK);
+  CHECK(f_mount(&TestFs, "0:", 1U) == FR_OK);
+  CHECK_MSG(TestFs.fs_type == ((format == FM_EXFAT) ? FS_EXFAT : FS_FAT32), "fs_type %u", TestFs.fs_type);
+
+  for (i = 0U; i < TEST_KEEP_SIZE; i++)
+  {
+    TestKeep[i] = (uint8_t)((i * 7U) ^ (i >> 8));
+  }
+  CHECK(f_open(&fil, TEST_KEEP_NAME, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+  CHECK((f_write(&fil, TestKeep, sizeof(TestKeep), &bw) == FR_OK) && (bw == sizeof(TestKeep)));
+  CHECK(f_close(&fil) == FR_OK);
+  CHECK(f_getfree("0:", &free_before, &fs) == FR_OK);
+
+  SBN_DefaultConfig(&cfg, TestBuffer, sizeof(TestBuffer));
+  TestReportLen = 0U;
+  TestReport[0] = '\0';
+  status = SBN_Run(&cfg, TEST_Output, NULL);
+
+  CHECK_MSG(status == SBN_OK, "status %d", (int)status);
+  CHECK(strstr(TestReport, "\"bench\":\"storage\"") != NULL);
+  CHECK(strstr(TestReport, "\"seq\":[{") != NULL);
+  CHECK(strstr(TestReport, "\"rand\":[{") != NULL);
+  CHECK(strstr(TestReport, "\"fwrite\":[{") != NULL);
+  CHECK(strstr(TestReport, "\"status\":0}") != NULL);
+  CHECK(strstr(TestReport, (format == FM_EXFAT) ? "\"fs\":\"exfat\"" : "\"fs\":\"fat32\"") != NULL);
+
+  /* Scratch files removed, every cluster given back, other files intact */
+  CHECK(f_stat("0:/" SBN_SCRATCH_NAME, &fno) == FR_NO_FILE);
+  CHECK(f_stat("0:/" SBN_WRITE_NAME, &fno) == FR_NO_FILE);
+  CHECK(f_getfree("0:", &free_after, &fs) == FR_OK);
+  CHECK_MSG(free_after == free_before, "free clusters %lu -> %lu",
+            (unsigned long)free_before, (unsigned long)free_after);
+  CHECK(TEST_KeepMatches());
+
+  CHECK(f_mount(NULL, "0:", 0U) == FR_OK);
+  HOST_DiskClose();
+}
+
+/* Exported functions --------------------------------------------------------*/
+int main(void)
+{
+  POOL_Init();
+  TEST_Run(FM_EXFAT, "exfat");
+  TEST_Run(FM_FAT32, "fat32");
+  (void)remove(TEST_IMAGE);
+
+  return HOST_CheckDone();
+}
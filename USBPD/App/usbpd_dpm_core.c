@@ -29,6 +29,8 @@
 
 #if defined(USE_STM32_UTILITY_OS)
 #include "utilities_conf.h"
+#else
+#include "main.h"
 #endif /* USE_STM32_UTILITY_OS */
 
 /* Generic STM32 prototypes */
@@ -71,8 +73,14 @@ UTIL_TIMER_Object_t TimerPE0, TimerPE1;
 /* Private variables ---------------------------------------------------------*/
 #if !defined(USE_STM32_UTILITY_OS)
 #define OFFSET_CAD 1U
+#define DPM_TASK_CAD      USBPD_PORT_COUNT
+#define DPM_TASK_USER     (USBPD_PORT_COUNT + OFFSET_CAD)
+#define DPM_NO_DEADLINE   0xFFFFFFFFU
 static uint32_t DPM_Sleep_time[USBPD_PORT_COUNT + OFFSET_CAD];
 static uint32_t DPM_Sleep_start[USBPD_PORT_COUNT + OFFSET_CAD];
+/* Bit n set: task n (PE ports, then CAD) was woken by an event, bit
+   DPM_TASK_USER: the application asked for another pass */
+static volatile uint32_t DPM_WakeFlags;
 #endif /* !USE_STM32_UTILITY_OS */
 
 USBPD_ParamsTypeDef   DPM_Params[USBPD_PORT_COUNT];
@@ -82,6 +90,11 @@ static void USBPD_PE_TaskWakeUp(uint8_t PortNum);
 static void DPM_ManageAttachedState(uint8_t PortNum, USBPD_CAD_EVENT State, CCxPin_TypeDef Cc);
 void USBPD_DPM_CADCallback(uint8_t PortNum, USBPD_CAD_EVENT State, CCxPin_TypeDef Cc);
 static void USBPD_DPM_CADTaskWakeUp(void);
+#if !defined(USE_STM32_UTILITY_OS)
+static void DPM_SetWake(uint32_t Task);
+static uint32_t DPM_TakeWake(uint32_t Task);
+static void DPM_RunTask(uint32_t Task);
+#endif /* !USE_STM32_UTILITY_OS */
 
 /**
   * @brief  Initialize the core stack (port power role, PWR_IF, CAD and PE Init procedures)
@@ -130,6 +143,11 @@ USBPD_StatusTypeDef USBPD_DPM_InitCore(void)
     return USBPD_ERROR;
   }
 
+#if defined(_TRACE)
+  /* Initialize trace */
+  USBPD_TRACE_Init();
+#endif /* _TRACE */
+
   /* to get how much memory are dynamically allocated by the stack
      the memory return is corresponding to 2 ports so if the application
      managed only one port divide the value return by 2                   */
@@ -303,30 +321,31 @@ void USBPD_DPM_Run(void)
     UTIL_SEQ_Run(~0);
   } while (1u == 1u);
 #else /* !USE_STM32_UTILITY_OS */
-  do
-  {
-
-    if ((HAL_GetTick() - DPM_Sleep_start[USBPD_PORT_COUNT]) >= DPM_Sleep_time[USBPD_PORT_COUNT])
-    {
-      DPM_Sleep_time[USBPD_PORT_COUNT] = USBPD_CAD_Process();
-      DPM_Sleep_start[USBPD_PORT_COUNT] = HAL_GetTick();
-    }
+  uint32_t task;
+  uint32_t next;
 
-    uint32_t port = 0;
+  /* One pass per call: main() loops on it, so the application runs from
+     USBPD_DPM_UserExecute() between PD events instead of being starved */
 
-    for (port = 0; port < USBPD_PORT_COUNT; port++)
-    {
-      if ((HAL_GetTick() - DPM_Sleep_start[port]) >= DPM_Sleep_time[port])
-      {
-        DPM_Sleep_time[port] =
-          USBPD_PE_StateMachine_SNK(port);
-        DPM_Sleep_start[port] = HAL_GetTick();
-      }
-    }
+  /* CAD first so that an attach or detach is seen by the PE in this pass */
+  DPM_RunTask(DPM_TASK_CAD);
+  for (task = 0U; task < USBPD_PORT_COUNT; task++)
+  {
+    DPM_RunTask(task);
+  }
 
-    USBPD_DPM_UserExecute(NULL);
+  (void)DPM_TakeWake(DPM_TASK_USER);
+  USBPD_DPM_UserExecute(NULL);
 
-  } while (1u == 1u);
+  /* Sleep until the next deadline or any interrupt. Interrupts are masked
+     so that a wake-up raised after the check still ends the WFI. */
+  __disable_irq();
+  next = USBPD_DPM_GetNextDeadline();
+  if (next != 0U)
+  {
+    USBPD_DPM_EnterIdle(next);
+  }
+  __enable_irq();
 #endif /* USE_STM32_UTILITY_OS */
 }
 
@@ -364,7 +383,7 @@ static void USBPD_PE_TaskWakeUp(uint8_t PortNum)
 #if defined(USE_STM32_UTILITY_OS)
   UTIL_SEQ_SetTask(PortNum == 0 ? TASK_PE_0 : TASK_PE_1, 0);
 #else
-  DPM_Sleep_time[PortNum] = 0;
+  DPM_SetWake(PortNum);
 #endif /* USE_STM32_UTILITY_OS */
 }
 
@@ -377,7 +396,7 @@ static void USBPD_DPM_CADTaskWakeUp(void)
 #if defined(USE_STM32_UTILITY_OS)
   UTIL_SEQ_SetTask(TASK_CAD, 0);
 #else
-  DPM_Sleep_time[USBPD_PORT_COUNT] = 0;
+  DPM_SetWake(DPM_TASK_CAD);
 #endif /* USE_STM32_UTILITY_OS */
 }
 
@@ -416,7 +435,8 @@ void USBPD_DPM_CADCallback(uint8_t PortNum, USBPD_CAD_EVENT State, CCxPin_TypeDe
 #if defined(USE_STM32_UTILITY_OS)
       UTIL_SEQ_PauseTask(PortNum == 0 ? TASK_PE_0 : TASK_PE_1);
 #else
-      DPM_Sleep_time[PortNum] = 0xFFFFFFFFU;
+      DPM_Sleep_time[PortNum] = DPM_NO_DEADLINE;
+      (void)DPM_TakeWake(PortNum);
 #endif /* USE_STM32_UTILITY_OS */
       DPM_Params[PortNum].PE_SwapOngoing = USBPD_FALSE;
       DPM_Params[PortNum].ActiveCCIs = CCNONE;
@@ -458,6 +478,108 @@ static void DPM_ManageAttachedState(uint8_t PortNum, USBPD_CAD_EVENT State, CCxP
   /* Enable task execution */
   UTIL_SEQ_SetTask(PortNum == 0 ? TASK_PE_0 : TASK_PE_1, 0);
 #else
-  DPM_Sleep_time[PortNum] = 0U;
+  DPM_SetWake(PortNum);
 #endif /* USE_STM32_UTILITY_OS */
 }
+
+#if !defined(USE_STM32_UTILITY_OS)
+/**
+  * @brief  Requests another scheduler pass without sleeping
+  * @note   For work produced by the main loop itself; work signalled by an
+  *         interrupt already ends the sleep. Callable from interrupts.
+  * @retval None
+  */
+void USBPD_DPM_UserWakeUp(void)
+{
+  DPM_SetWake(DPM_TASK_USER);
+}
+
+/**
+  * @brief  Time until the next CAD or PE deadline
+  * @retval Milliseconds, 0 when a task is due, 0xFFFFFFFF without deadline
+  */
+uint32_t USBPD_DPM_GetNextDeadline(void)
+{
+  uint32_t task;
+  uint32_t elapsed;
+  uint32_t remaining;
+  uint32_t next = DPM_NO_DEADLINE;
+  uint32_t now = HAL_GetTick();
+
+  if (DPM_WakeFlags != 0U)
+  {
+    return 0U;
+  }
+  for (task = 0U; task < (USBPD_PORT_COUNT + OFFSET_CAD); task++)
+  {
+    if (DPM_Sleep_time[task] == DPM_NO_DEADLINE)
+    {
+      continue;
+    }
+    elapsed = now - DPM_Sleep_start[task];
+    remaining = (elapsed >= DPM_Sleep_time[task]) ? 0U : (DPM_Sleep_time[task] - elapsed);
+    if (remaining < next)
+    {
+      next = remaining;
+    }
+  }
+
+  return next;
+}
+
+/**
+  * @brief  Waits for an interrupt when no PD task is due
+  * @note   Called with interrupts masked. Weak, a low-power manager may stop
+  *         more clocks as long as it wakes up within Timeout.
+  * @param  Timeout  Milliseconds until the next PD deadline (0xFFFFFFFF: none)
+  * @retval None
+  */
+__WEAK void USBPD_DPM_EnterIdle(uint32_t Timeout)
+{
+  (void)Timeout;
+  __WFI();
+}
+
+static void DPM_SetWake(uint32_t Task)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  DPM_WakeFlags |= (1UL << Task);
+  __set_PRIMASK(primask);
+}
+
+/* Clears the wake flag of a task and returns its previous state */
+static uint32_t DPM_TakeWake(uint32_t Task)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint32_t flag;
+
+  __disable_irq();
+  flag = DPM_WakeFlags & (1UL << Task);
+  DPM_WakeFlags &= ~(1UL << Task);
+  __set_PRIMASK(primask);
+
+  return flag;
+}
+
+/* Runs a CAD/PE task if it was woken or its deadline passed */
+static void DPM_RunTask(uint32_t Task)
+{
+  uint32_t elapsed = HAL_GetTick() - DPM_Sleep_start[Task];
+
+  if ((DPM_TakeWake(Task) != 0U) ||
+      ((DPM_Sleep_time[Task] != DPM_NO_DEADLINE) && (elapsed >= DPM_Sleep_time[Task])))
+  {
+    if (Task == DPM_TASK_CAD)
+    {
+      DPM_Sleep_time[Task] = USBPD_CAD_Process();
+    }
+    else
+    {
+      DPM_Sleep_time[Task] = USBPD_PE_StateMachine_SNK((uint8_t)Task);
+    }
+    DPM_Sleep_start[Task] = HAL_GetTick();
+  }
+}
+#endif /* !USE_STM32_UTILITY_OS */
@@ -64,7 +64,11 @@ void                USBPD_DPM_Run(void);
 void                USBPD_DPM_TimerCounter(void);
 __WEAK void         USBPD_DPM_ErrorHandler(void);
 /* USER CODE BEGIN functions */
-
+#if !defined(USE_STM32_UTILITY_OS)
+void                USBPD_DPM_UserWakeUp(void);
+uint32_t            USBPD_DPM_GetNextDeadline(void);
+void                USBPD_DPM_EnterIdle(uint32_t Timeout);
+#endif /* !USE_STM32_UTILITY_OS */
 /* USER CODE END functions */
 
 #ifdef __cplusplus
@@ -0,0 +1,220 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_dpm_scenarios.c
+  * @brief   Recorded PD sequences played into the sink DPM.
+  ******************************************************************************
+  * @attention
+  *
+  * Expectations are written against the DPM_USER_Settings of the board
+  * (usbpd_dpm_user.h): changing the requested power changes the expected
+  * operating currents.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "console.h"
+#include "usbpd_snk_policy.h"
+#include "usbpd_dpm_scenarios.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Source PDO encoders for the scenario tables */
+#define RPL_FIXED(_MV_, _MA_)         (USBPD_PDO_TYPE_FIXED \
+                                       | (((_MV_) / 50U) << USBPD_PDO_SRC_FIXED_VOLTAGE_Pos) \
+                                       | (((_MA_) / 10U) << USBPD_PDO_SRC_FIXED_MAX_CURRENT_Pos))
+#define RPL_PPS(_MIN_, _MAX_, _MA_)   (USBPD_PDO_TYPE_APDO \
+                                       | (((_MAX_) / 100U) << USBPD_PDO_SRC_APDO_MAX_VOLTAGE_Pos) \
+                                       | (((_MIN_) / 100U) << USBPD_PDO_SRC_APDO_MIN_VOLTAGE_Pos) \
+                                       | (((_MA_) / 50U) << USBPD_PDO_SRC_APDO_MAX_CURRENT_Pos))
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const RPL_OpNames[] =
+{
+  "attach", "src_caps", "accept", "reject", "wait", "ps_rdy", "hard_reset", "detach",
+  "advance", "load", "expect_request", "expect_none"
+};
+
+/* 65 W charger without PPS */
+static const uint32_t RPL_Pdos65W[] =
+{
+  RPL_FIXED(5000U, 3000U), RPL_FIXED(9000U, 3000U), RPL_FIXED(15000U, 3000U), RPL_FIXED(20000U, 2250U)
+};
+
+/* 5 V charger with a PPS range */
+static const uint32_t RPL_PdosPPS[] =
+{
+  RPL_FIXED(5000U, 3000U), RPL_PPS(3300U, 11000U, 3000U)
+};
+
+/* USB port, nothing above vSafe5V */
+static const uint32_t RPL_Pdos5V[] =
+{
+  RPL_FIXED(5000U, 900U)
+};
+
+static const RPL_StepTypeDef RPL_FixedSteps[] =
+{
+  RPL_STEP(RPL_OP_ATTACH, 0U),
+  RPL_CAPS(RPL_Pdos65W),
+  RPL_EXPECT(2U, 9000U, 840U, 0U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, 10000U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+  RPL_STEP(RPL_OP_LOAD, 30000U),
+  RPL_EXPECT(2U, 9000U, 3000U, 1U),
+  RPL_STEP(RPL_OP_WAIT, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, 99U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, 1U),
+  RPL_EXPECT(2U, 9000U, 3000U, 1U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_DETACH, 0U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+};
+
+static const RPL_StepTypeDef RPL_PPSSteps[] =
+{
+  RPL_STEP(RPL_OP_ATTACH, 0U),
+  RPL_CAPS(RPL_PdosPPS),
+  RPL_EXPECT(2U, 9000U, 1700U, 0U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, SNKP_PPS_KEEPALIVE_MS - 1U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, 1U),
+  RPL_EXPECT(2U, 9000U, 1700U, 0U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_LOAD, 20000U),
+  RPL_EXPECT(2U, 9000U, 2250U, 0U),
+  RPL_STEP(RPL_OP_REJECT, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, SNKP_PPS_KEEPALIVE_MS),
+  RPL_EXPECT(2U, 9000U, 2250U, 0U),
+  RPL_STEP(RPL_OP_DETACH, 0U),
+};
+
+static const RPL_StepTypeDef RPL_HardResetSteps[] =
+{
+  RPL_STEP(RPL_OP_ATTACH, 0U),
+  RPL_CAPS(RPL_PdosPPS),
+  RPL_EXPECT(2U, 9000U, 1700U, 0U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_HARD_RESET, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, SNKP_PPS_KEEPALIVE_MS + 1000U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+  RPL_CAPS(RPL_Pdos5V),
+  RPL_EXPECT(1U, 5000U, 900U, 1U),
+  RPL_STEP(RPL_OP_ACCEPT, 0U),
+  RPL_STEP(RPL_OP_PS_RDY, 0U),
+  RPL_STEP(RPL_OP_ADVANCE, SNKP_PPS_KEEPALIVE_MS + 1000U),
+  RPL_STEP(RPL_OP_EXPECT_NONE, 0U),
+  RPL_STEP(RPL_OP_DETACH, 0U),
+};
+
+static const RPL_ScenarioTypeDef RPL_Scenarios[] =
+{
+  { "fixed",      RPL_FixedSteps,     sizeof(RPL_FixedSteps) / sizeof(RPL_FixedSteps[0]) },
+  { "pps",        RPL_PPSSteps,       sizeof(RPL_PPSSteps) / sizeof(RPL_PPSSteps[0]) },
+  { "hard_reset", RPL_HardResetSteps, sizeof(RPL_HardResetSteps) / sizeof(RPL_HardResetSteps[0]) },
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Number of recorded scenarios
+  * @retval Count
+  */
+uint32_t RPL_GetScenarioCount(void)
+{
+  return sizeof(RPL_Scenarios) / sizeof(RPL_Scenarios[0]);
+}
+
+/**
+  * @brief  Returns a recorded scenario
+  * @param  Index  0 to RPL_GetScenarioCount() - 1
+  * @retval Scenario or NULL
+  */
+const RPL_ScenarioTypeDef *RPL_GetScenario(uint32_t Index)
+{
+  return (Index < RPL_GetScenarioCount()) ? &RPL_Scenarios[Index] : NULL;
+}
+
+/**
+  * @brief  Name of a step operation, for failure reports
+  * @param  Op  Operation
+  * @retval Name
+  */
+const char *RPL_GetOpName(RPL_OpTypeDef Op)
+{
+  return ((uint32_t)Op < (sizeof(RPL_OpNames) / sizeof(RPL_OpNames[0]))) ? RPL_OpNames[Op] : "?";
+}
+
+/**
+  * @brief  Checks the requests captured since the previous expectation
+  * @note   Prints a line per failure and clears Capture->Requests.
+  * @param  Step     RPL_OP_EXPECT_REQUEST or RPL_OP_EXPECT_NONE step
+  * @param  Capture  Requests sent by the DPM
+  * @param  Time     Virtual ms, for the report
+  * @retval Number of failed checks, 0 or 1
+  */
+uint32_t RPL_Expect(const RPL_StepTypeDef *Step, RPL_CaptureTypeDef *Capture, uint32_t Time)
+{
+  USBPD_SNKRDO_TypeDef rdo;
+  USBPD_PDO_TypeDef pdo;
+  uint32_t position;
+  uint32_t voltage = 0U;
+  uint32_t current;
+  uint32_t count = Capture->Requests;
+
+  Capture->Requests = 0U;
+
+  if (Step->Op == RPL_OP_EXPECT_NONE)
+  {
+    if (count == 0U)
+    {
+      return 0U;
+    }
+    (void)CON_Printf("  t=%lu expect_none: %lu request(s) sent\r\n", (unsigned long)Time, (unsigned long)count);
+    return 1U;
+  }
+
+  if (count != 1U)
+  {
+    (void)CON_Printf("  t=%lu expect_request: %lu request(s) sent\r\n", (unsigned long)Time, (unsigned long)count);
+    return 1U;
+  }
+
+  rdo.d32  = Capture->Rdo;
+  position = rdo.GenericRDO.ObjectPosition;
+  if (Capture->Type == USBPD_CORE_PDO_TYPE_APDO)
+  {
+    voltage = rdo.ProgRDO.OutputVoltageIn20mV * 20U;
+    current = rdo.ProgRDO.OperatingCurrentIn50mAunits * 50U;
+  }
+  else
+  {
+    if ((position != 0U) && (position <= Capture->PdoCount) && (Capture->Type == USBPD_CORE_PDO_TYPE_FIXED))
+    {
+      pdo.d32 = Capture->Pdos[position - 1U];
+      voltage = pdo.SRCFixedPDO.VoltageIn50mVunits * 50U;
+    }
+    current = rdo.FixedVariableRDO.OperatingCurrentIn10mAunits * 10U;
+  }
+
+  if ((position != Step->Arg)
+      || (rdo.GenericRDO.CapabilityMismatch != Step->Mismatch)
+      || ((Step->Voltage != 0U) && (voltage != Step->Voltage))
+      || ((Step->Current != 0U) && (current != Step->Current)))
+  {
+    (void)CON_Printf("  t=%lu expect_request: PDO%lu %lumV %lumA mm%u, got PDO%lu %lumV %lumA mm%u at t=%lu\r\n",
+                     (unsigned long)Time, (unsigned long)Step->Arg, (unsigned long)Step->Voltage,
+                     (unsigned long)Step->Current, (unsigned)Step->Mismatch,
+                     (unsigned long)position, (unsigned long)voltage, (unsigned long)current,
+                     (unsigned)rdo.GenericRDO.CapabilityMismatch, (unsigned long)Capture->Time);
+    return 1U;
+  }
+  return 0U;
+}
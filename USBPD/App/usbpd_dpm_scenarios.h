@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_dpm_scenarios.h
+  * @brief   Recorded PD sequences played into the sink DPM.
+  ******************************************************************************
+  * @attention
+  *
+  * A scenario is a list of events a source and a cable produce (attach,
+  * Source_Capabilities, Accept, PS_RDY, hard reset, detach), of virtual
+  * time and load changes, and of expectations on the requests the DPM
+  * sends in answer. The tables only depend on usbpd_def.h and are played
+  * by two engines:
+  *   - the "replay" console command (usbpd_dpm_replay.c, DPM_REPLAY), which
+  *     stands in for the PE on the target and times the DPM callbacks;
+  *   - the host check Tests/Src/test_dpm.c, which runs the DPM core and
+  *     user code against a fake PE/PRL/CAD.
+  * Both feed the requests they capture to RPL_Expect().
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_DPM_SCENARIOS_H
+#define __USBPD_DPM_SCENARIOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  RPL_OP_ATTACH = 0,        /* CAD attach, PD3.0 source, sink is UFP          */
+  RPL_OP_SRC_CAPS,          /* Source_Capabilities, DPM builds the request    */
+  RPL_OP_ACCEPT,
+  RPL_OP_REJECT,
+  RPL_OP_WAIT,
+  RPL_OP_PS_RDY,            /* Explicit contract                              */
+  RPL_OP_HARD_RESET,
+  RPL_OP_DETACH,
+  RPL_OP_ADVANCE,           /* Arg ms of virtual time                         */
+  RPL_OP_LOAD,              /* Arg mW load budget                             */
+  RPL_OP_EXPECT_REQUEST,    /* Exactly one request since the last check       */
+  RPL_OP_EXPECT_NONE,       /* No request since the last check                */
+} RPL_OpTypeDef;
+
+typedef struct
+{
+  RPL_OpTypeDef   Op;
+  uint32_t        Arg;      /* ADVANCE: ms, LOAD: mW, EXPECT_REQUEST: object position */
+  const uint32_t *Pdos;     /* SRC_CAPS: source PDOs                                  */
+  uint8_t         Count;    /* SRC_CAPS: number of PDOs                               */
+  uint8_t         Mismatch; /* EXPECT_REQUEST: capability mismatch bit                */
+  uint16_t        Voltage;  /* EXPECT_REQUEST: mV, 0 not checked                      */
+  uint16_t        Current;  /* EXPECT_REQUEST: mA, 0 not checked                      */
+} RPL_StepTypeDef;
+
+typedef struct
+{
+  const char            *Name;
+  const RPL_StepTypeDef *Steps;
+  uint32_t               Count;
+} RPL_ScenarioTypeDef;
+
+/* Requests sent by the DPM, filled by the engine playing the scenario */
+typedef struct
+{
+  uint32_t                    Requests; /* Sent since the last expectation    */
+  uint32_t                    Rdo;      /* Last one                           */
+  USBPD_CORE_PDO_Type_TypeDef Type;
+  uint32_t                    Time;     /* Virtual ms at which it was sent    */
+  const uint32_t             *Pdos;     /* Source_Capabilities it answers     */
+  uint32_t                    PdoCount;
+} RPL_CaptureTypeDef;
+
+/* Exported macros -----------------------------------------------------------*/
+#define RPL_STEP(_OP_, _ARG_)                  { (_OP_), (_ARG_), NULL, 0U, 0U, 0U, 0U }
+#define RPL_CAPS(_PDOS_)                       { RPL_OP_SRC_CAPS, 0U, (_PDOS_), \
+                                                 (uint8_t)(sizeof(_PDOS_) / sizeof((_PDOS_)[0])), 0U, 0U, 0U }
+#define RPL_EXPECT(_POS_, _MV_, _MA_, _MM_)    { RPL_OP_EXPECT_REQUEST, (_POS_), NULL, 0U, (_MM_), (_MV_), (_MA_) }
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t                   RPL_GetScenarioCount(void);
+const RPL_ScenarioTypeDef *RPL_GetScenario(uint32_t Index);
+const char                *RPL_GetOpName(RPL_OpTypeDef Op);
+uint32_t                   RPL_Expect(const RPL_StepTypeDef *Step, RPL_CaptureTypeDef *Capture, uint32_t Time);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_DPM_SCENARIOS_H */
@@ -34,7 +34,7 @@
 
 /* Define   ------------------------------------------------------------------*/
 #define PORT0_NB_SOURCEPDO         0U   /* Number of Source PDOs (applicable for port 0)   */
-#define PORT0_NB_SINKPDO           1U   /* Number of Sink PDOs (applicable for port 0)     */
+#define PORT0_NB_SINKPDO           3U   /* Number of Sink PDOs (applicable for port 0)     */
 #define PORT1_NB_SOURCEPDO         0U   /* Number of Source PDOs (applicable for port 1)   */
 #define PORT1_NB_SINKPDO           0U   /* Number of Sink PDOs (applicable for port 1)     */
 
@@ -109,20 +109,31 @@ uint32_t PORT0_PDO_ListSNK[USBPD_MAX_NB_PDO] =
     USBPD_PDO_TYPE_FIXED                 | /* Fixed supply PDO            */
 
     USBPD_PDO_SNK_FIXED_SET_VOLTAGE(5000U)         | /* Voltage in mV               */
-    USBPD_PDO_SNK_FIXED_SET_OP_CURRENT(0U)     | /* Operating current in  mA            */
+    USBPD_PDO_SNK_FIXED_SET_OP_CURRENT(USBPD_CORE_PDO_SNK_FIXED_MAX_CURRENT) | /* Operating current in  mA            */
 
     /* Common definitions applicable to all PDOs, defined only in PDO 1 */
     USBPD_PDO_SNK_FIXED_FRS_NOT_SUPPORTED          | /* Fast Role Swap				 */
     USBPD_PDO_SNK_FIXED_DRD_SUPPORTED          | /* Dual-Role Data              */
-    USBPD_PDO_SNK_FIXED_USBCOMM_NOT_SUPPORTED      | /* USB Communications          */
+    USBPD_PDO_SNK_FIXED_USBCOMM_SUPPORTED          | /* USB Communications          */
     USBPD_PDO_SNK_FIXED_EXT_POWER_NOT_AVAILABLE    | /* External Power              */
-    USBPD_PDO_SNK_FIXED_HIGHERCAPAB_NOT_SUPPORTED   | /* Higher Capability           */
+    USBPD_PDO_SNK_FIXED_HIGHERCAPAB_SUPPORTED       | /* Higher Capability           */
     USBPD_PDO_SNK_FIXED_DRP_NOT_SUPPORTED            /* Dual-Role Power             */
   ),
 
-  /* PDO 2 */ (0x00000000U),
+  /* PDO 2 */
+  (
+    USBPD_PDO_TYPE_FIXED                 | /* Fixed supply PDO            */
+    USBPD_PDO_SNK_FIXED_SET_VOLTAGE(9000U)         | /* Voltage in mV               */
+    USBPD_PDO_SNK_FIXED_SET_OP_CURRENT(1670U)      /* Operating current in  mA    */
+  ),
 
-  /* PDO 3 */ (0x00000000U),
+  /* PDO 3 */
+  (
+    USBPD_PDO_TYPE_APDO                  | /* Programmable supply APDO    */
+    USBPD_PDO_SNK_APDO_SET_MIN_VOLTAGE(5000U)      | /* Min voltage in mV           */
+    USBPD_PDO_SNK_APDO_SET_MAX_VOLTAGE(12000U)     | /* Max voltage in mV           */
+    USBPD_PDO_SNK_APDO_SET_MAX_CURRENT(3000U)        /* Max current in mA           */
+  ),
 
   /* PDO 4 */ (0x00000000U),
 
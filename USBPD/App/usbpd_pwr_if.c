@@ -115,7 +115,18 @@
 USBPD_StatusTypeDef USBPD_PWR_IF_Init(void)
 {
 /* USER CODE BEGIN USBPD_PWR_IF_Init */
-  return USBPD_ERROR;
+  USBPD_StatusTypeDef status = USBPD_OK;
+  uint8_t port;
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    if ((BSP_USBPD_PWR_Init(port) != BSP_ERROR_NONE)
+        || (BSP_USBPD_PWR_VBUSInit(port) != BSP_ERROR_NONE))
+    {
+      status = USBPD_ERROR;
+    }
+  }
+  return status;
 /* USER CODE END USBPD_PWR_IF_Init */
 }
 
@@ -163,7 +174,18 @@ USBPD_StatusTypeDef USBPD_PWR_IF_SupplyReady(uint8_t PortNum, USBPD_VSAFE_Status
 USBPD_StatusTypeDef USBPD_PWR_IF_ReadVA(uint8_t PortNum, uint16_t *pVoltage, uint16_t *pCurrent)
 {
 /* USER CODE BEGIN USBPD_PWR_IF_ReadVA */
-  return USBPD_ERROR;
+  uint32_t voltage;
+  int32_t current;
+
+  if ((!USBPD_PORT_IsValid(PortNum))
+      || (BSP_USBPD_PWR_VBUSGetVoltage(PortNum, &voltage) != BSP_ERROR_NONE)
+      || (BSP_USBPD_PWR_VBUSGetCurrent(PortNum, &current) != BSP_ERROR_NONE))
+  {
+    return USBPD_ERROR;
+  }
+  *pVoltage = (uint16_t)voltage;
+  *pCurrent = (uint16_t)((current > 0) ? current : 0);
+  return USBPD_OK;
 /* USER CODE END USBPD_PWR_IF_ReadVA */
 }
 
@@ -0,0 +1,341 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_snk_policy.c
+  * @brief   Sink power policy: selection of a source PDO and RDO build.
+  ******************************************************************************
+  * @attention
+  *
+  * All quantities are handled in mV, mA and mW with integer arithmetic.
+  * Currents derived from a power are rounded up so the request never
+  * under-states the load. See usbpd_snk_policy.h for the selection rules.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include "usbpd_snk_policy.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SNKP_RDO_FIELD_MAX        1023U /* 10-bit current/power RDO fields     */
+#define SNKP_RDO_PPS_CURRENT_MAX  127U  /* 7-bit PPS operating current field   */
+
+/* Tie-break rank, lower is preferred */
+#define SNKP_RANK_FIXED           0U
+#define SNKP_RANK_PPS             1U
+#define SNKP_RANK_VARIABLE        2U
+#define SNKP_RANK_BATTERY         3U
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint8_t  Position;
+  uint8_t  Rank;
+  uint8_t  Covers;          /* Power >= load                           */
+  uint32_t Pdo;
+  uint32_t Voltage;         /* Worst case (lowest) or programmed mV    */
+  uint32_t Distance;        /* Worst case deviation from OperatingVoltage */
+  uint32_t MaxCurrent;      /* mA, 0 for battery objects               */
+  uint32_t Power;           /* mW                                      */
+} SNKP_CandidateTypeDef;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t SNKP_Distance(uint32_t vmin, uint32_t vmax, uint32_t target);
+static uint8_t  SNKP_Parse(const USBPD_SNKPowerRequest_TypeDef *req, uint32_t pdo, uint32_t flags,
+                           SNKP_CandidateTypeDef *cand);
+static uint8_t  SNKP_Better(const SNKP_CandidateTypeDef *a, const SNKP_CandidateTypeDef *b);
+static void     SNKP_Build(const SNKP_CandidateTypeDef *cand, uint32_t load, uint32_t maxload,
+                           uint8_t mismatch, uint32_t flags, SNKP_SelectionTypeDef *sel);
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t SNKP_DivCeil(uint32_t num, uint32_t den)
+{
+  return (den == 0U) ? 0U : ((num + den - 1U) / den);
+}
+
+static uint32_t SNKP_Min(uint32_t a, uint32_t b)
+{
+  return (a < b) ? a : b;
+}
+
+static uint32_t SNKP_Max(uint32_t a, uint32_t b)
+{
+  return (a > b) ? a : b;
+}
+
+/* Largest deviation from target over [vmin, vmax] */
+static uint32_t SNKP_Distance(uint32_t vmin, uint32_t vmax, uint32_t target)
+{
+  uint32_t lo = (vmin > target) ? (vmin - target) : (target - vmin);
+  uint32_t hi = (vmax > target) ? (vmax - target) : (target - vmax);
+
+  return SNKP_Max(lo, hi);
+}
+
+/**
+  * @brief  Decodes one source object and checks it against the sink window
+  * @retval 1 if the object is usable
+  */
+static uint8_t SNKP_Parse(const USBPD_SNKPowerRequest_TypeDef *req, uint32_t pdo, uint32_t flags,
+                          SNKP_CandidateTypeDef *cand)
+{
+  USBPD_PDO_TypeDef obj;
+  uint32_t vmin;
+  uint32_t vmax;
+
+  obj.d32 = pdo;
+  cand->Pdo = pdo;
+
+  switch (obj.GenericPDO.PowerObject)
+  {
+    case USBPD_CORE_PDO_TYPE_FIXED:
+      vmin = obj.SRCFixedPDO.VoltageIn50mVunits * 50U;
+      vmax = vmin;
+      cand->Rank = SNKP_RANK_FIXED;
+      cand->MaxCurrent = obj.SRCFixedPDO.MaxCurrentIn10mAunits * 10U;
+      cand->Power = (vmin * cand->MaxCurrent) / 1000U;
+      break;
+
+    case USBPD_CORE_PDO_TYPE_VARIABLE:
+      vmin = obj.SRCVariablePDO.MinVoltageIn50mVunits * 50U;
+      vmax = obj.SRCVariablePDO.MaxVoltageIn50mVunits * 50U;
+      cand->Rank = SNKP_RANK_VARIABLE;
+      cand->MaxCurrent = obj.SRCVariablePDO.MaxCurrentIn10mAunits * 10U;
+      cand->Power = (vmin * cand->MaxCurrent) / 1000U;
+      break;
+
+    case USBPD_CORE_PDO_TYPE_BATTERY:
+      vmin = obj.SRCBatteryPDO.MinVoltageIn50mVunits * 50U;
+      vmax = obj.SRCBatteryPDO.MaxVoltageIn50mVunits * 50U;
+      cand->Rank = SNKP_RANK_BATTERY;
+      cand->MaxCurrent = 0U;
+      cand->Power = obj.SRCBatteryPDO.MaxAllowablePowerIn250mWunits * 250U;
+      break;
+
+#if defined(USBPD_REV30_SUPPORT) && defined(USBPDCORE_PPS)
+    case USBPD_CORE_PDO_TYPE_APDO:
+      /* Only SPR programmable supplies are understood */
+      if (((flags & SNKP_FLAG_NO_PPS) != 0U) || (obj.SRCSNKAPDO.ProgrammablePowerSupply != 0U))
+      {
+        return 0U;
+      }
+      vmin = SNKP_Max(obj.SRCSNKAPDO.MinVoltageIn100mV * 100U, req->MinOperatingVoltageInmVunits);
+      vmax = SNKP_Min(obj.SRCSNKAPDO.MaxVoltageIn100mV * 100U, req->MaxOperatingVoltageInmVunits);
+      if (vmin > vmax)
+      {
+        return 0U;
+      }
+      /* Closest programmable step to the preferred voltage */
+      cand->Voltage = SNKP_Min(SNKP_Max(req->OperatingVoltageInmVunits, vmin), vmax);
+      cand->Voltage = ((cand->Voltage + (SNKP_PPS_STEP_MV / 2U)) / SNKP_PPS_STEP_MV) * SNKP_PPS_STEP_MV;
+      if (cand->Voltage > vmax)
+      {
+        cand->Voltage -= SNKP_PPS_STEP_MV;
+      }
+      else if (cand->Voltage < vmin)
+      {
+        cand->Voltage += SNKP_PPS_STEP_MV;
+      }
+      if ((cand->Voltage < vmin) || (cand->Voltage > vmax) || (cand->Voltage == 0U))
+      {
+        return 0U;
+      }
+      cand->Rank = SNKP_RANK_PPS;
+      cand->MaxCurrent = obj.SRCSNKAPDO.MaxCurrentIn50mAunits * 50U;
+      cand->Power = (cand->Voltage * cand->MaxCurrent) / 1000U;
+      cand->Distance = SNKP_Distance(cand->Voltage, cand->Voltage, req->OperatingVoltageInmVunits);
+      return 1U;
+#endif /* USBPD_REV30_SUPPORT && USBPDCORE_PPS */
+
+    default:
+      return 0U;
+  }
+
+  if ((vmin == 0U) || (vmin > vmax)
+      || (vmin < req->MinOperatingVoltageInmVunits) || (vmax > req->MaxOperatingVoltageInmVunits))
+  {
+    return 0U;
+  }
+
+  cand->Voltage  = vmin;
+  cand->Distance = SNKP_Distance(vmin, vmax, req->OperatingVoltageInmVunits);
+
+  return 1U;
+}
+
+/**
+  * @brief  Orders two usable candidates
+  * @retval 1 if a is preferred over b
+  */
+static uint8_t SNKP_Better(const SNKP_CandidateTypeDef *a, const SNKP_CandidateTypeDef *b)
+{
+  if (a->Covers != b->Covers)
+  {
+    return a->Covers;
+  }
+
+  /* Best effort: the most power first */
+  if ((a->Covers == 0U) && (a->Power != b->Power))
+  {
+    return (a->Power > b->Power) ? 1U : 0U;
+  }
+
+  if (a->Distance != b->Distance)
+  {
+    return (a->Distance < b->Distance) ? 1U : 0U;
+  }
+  if (a->Rank != b->Rank)
+  {
+    return (a->Rank < b->Rank) ? 1U : 0U;
+  }
+
+  return (a->Power > b->Power) ? 1U : 0U;
+}
+
+/**
+  * @brief  Fills the selection and its RDO from a candidate
+  * @retval None
+  */
+static void SNKP_Build(const SNKP_CandidateTypeDef *cand, uint32_t load, uint32_t maxload,
+                       uint8_t mismatch, uint32_t flags, SNKP_SelectionTypeDef *sel)
+{
+  USBPD_PDO_TypeDef    obj;
+  USBPD_SNKRDO_TypeDef rdo;
+  uint32_t op;
+  uint32_t maxop;
+
+  obj.d32 = cand->Pdo;
+  rdo.d32 = 0U;
+
+  sel->PdoType  = obj.GenericPDO.PowerObject;
+  sel->Position = cand->Position;
+  sel->Mismatch = mismatch;
+  sel->IsPPS    = (cand->Rank == SNKP_RANK_PPS) ? 1U : 0U;
+  sel->Voltage  = cand->Voltage;
+  sel->Power    = cand->Power;
+
+  rdo.GenericRDO.ObjectPosition           = cand->Position;
+  rdo.GenericRDO.NoUSBSuspend             = 1U;
+  rdo.GenericRDO.USBCommunicationsCapable = ((flags & SNKP_FLAG_USB_COMM) != 0U) ? 1U : 0U;
+  rdo.GenericRDO.CapabilityMismatch       = mismatch;
+
+  if (cand->Rank == SNKP_RANK_BATTERY)
+  {
+    op    = SNKP_Min(load, cand->Power);
+    maxop = (mismatch != 0U) ? maxload : SNKP_Min(maxload, cand->Power);
+    rdo.BatteryRDO.OperatingPowerIn250mWunits    = SNKP_Min(SNKP_DivCeil(op, 250U), SNKP_RDO_FIELD_MAX);
+    rdo.BatteryRDO.MaxOperatingPowerIn250mWunits = SNKP_Min(SNKP_DivCeil(SNKP_Max(op, maxop), 250U),
+                                                            SNKP_RDO_FIELD_MAX);
+    sel->Current = SNKP_DivCeil(op * 1000U, cand->Voltage);
+  }
+#if defined(USBPD_REV30_SUPPORT) && defined(USBPDCORE_PPS)
+  else if (cand->Rank == SNKP_RANK_PPS)
+  {
+    /* The operating current is the source current limit: ask for the budget */
+    op = SNKP_Min(SNKP_DivCeil(maxload * 1000U, cand->Voltage), cand->MaxCurrent);
+    rdo.ProgRDO.OperatingCurrentIn50mAunits = SNKP_Min(SNKP_DivCeil(op, 50U), SNKP_RDO_PPS_CURRENT_MAX);
+    rdo.ProgRDO.OutputVoltageIn20mV         = cand->Voltage / SNKP_PPS_STEP_MV;
+    sel->Current = rdo.ProgRDO.OperatingCurrentIn50mAunits * 50U;
+  }
+#endif /* USBPD_REV30_SUPPORT && USBPDCORE_PPS */
+  else
+  {
+    op    = SNKP_Min(SNKP_DivCeil(load * 1000U, cand->Voltage), cand->MaxCurrent);
+    maxop = SNKP_DivCeil(maxload * 1000U, cand->Voltage);
+    if (mismatch == 0U)
+    {
+      maxop = SNKP_Min(maxop, cand->MaxCurrent);
+    }
+    rdo.FixedVariableRDO.OperatingCurrentIn10mAunits  = SNKP_Min(SNKP_DivCeil(op, 10U), SNKP_RDO_FIELD_MAX);
+    rdo.FixedVariableRDO.MaxOperatingCurrent10mAunits = SNKP_Min(SNKP_DivCeil(SNKP_Max(op, maxop), 10U),
+                                                                 SNKP_RDO_FIELD_MAX);
+    sel->Current = rdo.FixedVariableRDO.OperatingCurrentIn10mAunits * 10U;
+  }
+
+  sel->Rdo = rdo.d32;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Selects the source object to request
+  * @param  req: Sink voltage window and power budget
+  * @param  pdos: Received source objects, object 1 first
+  * @param  count: Number of objects (1..USBPD_MAX_NB_PDO)
+  * @param  load: Power to cover in mW, 0 for req->OperatingPowerInmWunits
+  * @param  flags: SNKP_FLAG_xxx
+  * @param  sel: Filled with the chosen object and its RDO
+  * @retval SNKP_OK, SNKP_MISMATCH (sel still valid) or SNKP_ERROR
+  */
+SNKP_StatusTypeDef SNKP_Evaluate(const USBPD_SNKPowerRequest_TypeDef *req, const uint32_t *pdos, uint32_t count,
+                                 uint32_t load, uint32_t flags, SNKP_SelectionTypeDef *sel)
+{
+  SNKP_CandidateTypeDef best;
+  SNKP_CandidateTypeDef cand;
+  USBPD_PDO_TypeDef     first;
+  uint32_t maxload;
+  uint32_t index;
+  uint8_t  found = 0U;
+
+  if ((req == NULL) || (pdos == NULL) || (sel == NULL) || (count == 0U))
+  {
+    return SNKP_ERROR;
+  }
+  if (count > USBPD_MAX_NB_PDO)
+  {
+    count = USBPD_MAX_NB_PDO;
+  }
+
+  if (load == 0U)
+  {
+    load = req->OperatingPowerInmWunits;
+  }
+  maxload = SNKP_Max(load, req->MaxOperatingPowerInmWunits);
+
+  for (index = 0U; index < count; index++)
+  {
+    if (SNKP_Parse(req, pdos[index], flags, &cand) == 0U)
+    {
+      continue;
+    }
+    cand.Position = (uint8_t)(index + 1U);
+    cand.Covers   = (cand.Power >= load) ? 1U : 0U;
+
+    /* Never ask a supply for more than the sink may draw */
+    if ((req->MaxOperatingCurrentInmAunits != 0U) && (cand.MaxCurrent > req->MaxOperatingCurrentInmAunits))
+    {
+      cand.MaxCurrent = req->MaxOperatingCurrentInmAunits;
+      cand.Power      = (cand.Voltage * cand.MaxCurrent) / 1000U;
+      cand.Covers     = (cand.Power >= load) ? 1U : 0U;
+    }
+
+    if ((found == 0U) || (SNKP_Better(&cand, &best) != 0U))
+    {
+      best  = cand;
+      found = 1U;
+    }
+  }
+
+  if (found != 0U)
+  {
+    SNKP_Build(&best, load, maxload, (best.Covers != 0U) ? 0U : 1U, flags, sel);
+    return (best.Covers != 0U) ? SNKP_OK : SNKP_MISMATCH;
+  }
+
+  /* Nothing fits the voltage window: vSafe5V with Capability Mismatch */
+  first.d32 = pdos[0];
+  if ((first.GenericPDO.PowerObject != USBPD_CORE_PDO_TYPE_FIXED) || (first.SRCFixedPDO.VoltageIn50mVunits == 0U))
+  {
+    return SNKP_ERROR;
+  }
+  best.Pdo        = pdos[0];
+  best.Position   = 1U;
+  best.Rank       = SNKP_RANK_FIXED;
+  best.Covers     = 0U;
+  best.Voltage    = first.SRCFixedPDO.VoltageIn50mVunits * 50U;
+  best.Distance   = 0U;
+  best.MaxCurrent = first.SRCFixedPDO.MaxCurrentIn10mAunits * 10U;
+  best.Power      = (best.Voltage * best.MaxCurrent) / 1000U;
+  SNKP_Build(&best, load, maxload, 1U, flags, sel);
+
+  return SNKP_MISMATCH;
+}
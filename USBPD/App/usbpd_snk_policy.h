@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_snk_policy.h
+  * @brief   Sink power policy: selection of a source PDO and RDO build.
+  ******************************************************************************
+  * @attention
+  *
+  * The policy only depends on usbpd_def.h so it can be built on a host with
+  * canned Source_Capabilities. It is called by the DPM user code on every
+  * Source_Capabilities message and whenever the load budget changes.
+  *
+  * Selection rules, applied to the objects whose voltage range lies inside
+  * [MinOperatingVoltage, MaxOperatingVoltage] of the sink:
+  *   1. objects able to deliver the load power win over the others;
+  *   2. among them, the one closest to OperatingVoltage wins;
+  *   3. then fixed > PPS > variable > battery (PPS needs keep-alive traffic);
+  *   4. then the highest available power.
+  * When no object can deliver the load, the most powerful one is requested
+  * with the Capability Mismatch bit set. vSafe5V (object 1) is the fallback
+  * when nothing fits the voltage window.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_SNK_POLICY_H
+#define __USBPD_SNK_POLICY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* SNKP_Evaluate() flags */
+#define SNKP_FLAG_USB_COMM        0x01U /* Sink uses USB communications        */
+#define SNKP_FLAG_NO_PPS          0x02U /* Ignore programmable supplies        */
+
+#define SNKP_PPS_STEP_MV          20U   /* PPS output voltage resolution       */
+#define SNKP_PPS_KEEPALIVE_MS     8000U /* Re-request period, tPPSRequest=10 s */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  SNKP_OK = 0,              /* Request covers the load                 */
+  SNKP_MISMATCH,            /* Best effort, Capability Mismatch set    */
+  SNKP_ERROR,               /* No usable source object                 */
+} SNKP_StatusTypeDef;
+
+typedef struct
+{
+  uint32_t                    Rdo;        /* Request Data Object to send           */
+  USBPD_CORE_PDO_Type_TypeDef PdoType;    /* USBPD_CORE_PDO_TYPE_xxx               */
+  uint8_t                     Position;   /* Object position 1..7                  */
+  uint8_t                     Mismatch;
+  uint8_t                     IsPPS;
+  uint32_t                    Voltage;    /* Requested (PPS) or minimum voltage mV */
+  uint32_t                    Current;    /* Operating current mA                  */
+  uint32_t                    Power;      /* Power available from the object mW    */
+} SNKP_SelectionTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+SNKP_StatusTypeDef SNKP_Evaluate(const USBPD_SNKPowerRequest_TypeDef *req, const uint32_t *pdos, uint32_t count,
+                                 uint32_t load, uint32_t flags, SNKP_SelectionTypeDef *sel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_SNK_POLICY_H */
@@ -0,0 +1,379 @@
+/**
+  ******************************************************************************
+  * @file    tracer_emb.c
+  * @brief   Embedded tracer back end for the USBPD TLV trace stream.
+  ******************************************************************************
+  * @attention
+  *
+  * Ring indexes are free running 32-bit counters, masked on access:
+  *   TracerRead <= TracerCommit <= TracerReserve
+  * Reserve is advanced by producers (LDREX/STREX), Commit is published by
+  * the outermost producer once every nested producer has finished copying,
+  * Read is only written by TRACER_EMB_Process().
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "cdc_acm_ringbuffer.h"
+#include "usbpd_core.h"
+#include "usbpd_dpm_core.h"
+#include "tracer_emb.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TRACER_MASK               (TRACER_EMB_BUFFER_SIZE - 1U)
+#define TRACER_BUSID              0U
+
+/* TLV framing of usbpd_trace.c: SOF x4, TAG, LENGTH (2, MSB first), VALUE, EOF x4 */
+#define TRACER_SOF                0xFDU
+#define TRACER_LENGTH_OFFSET      5U
+#define TRACER_FRAME_OVERHEAD     11U
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t TracerPool[TRACER_EMB_BUFFER_SIZE];
+static volatile uint32_t TracerReserve;
+static volatile uint32_t TracerCommit;
+static volatile uint32_t TracerRead;
+static volatile uint32_t TracerNesting;
+static volatile uint8_t  TracerEnabled;
+
+static volatile uint32_t TracerFrames;
+static volatile uint32_t TracerBytes;
+static volatile uint32_t TracerDroppedFrames;
+static volatile uint32_t TracerDroppedBytes;
+static uint32_t TracerDropsReported;
+static uint32_t TracerOverflows;
+static uint32_t TracerHighWater;
+
+static const uint8_t *TracerOverflowFrame;
+static uint8_t TracerOverflowSize;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TRACER_AtomicAdd(volatile uint32_t *value, uint32_t delta);
+static uint8_t  TRACER_Peek(uint32_t index);
+static void     TRACER_Send(uint32_t index, uint32_t size);
+static int32_t  TRACER_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef TRACER_ConsoleCommand =
+{
+  .Name    = "pdtrace",
+  .Help    = "pdtrace [on|off] - binary PD trace on the CDC port, drop counters",
+  .Handler = TRACER_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Interrupt safe add, returns the new value */
+static uint32_t TRACER_AtomicAdd(volatile uint32_t *value, uint32_t delta)
+{
+  uint32_t result;
+
+  do
+  {
+    result = __LDREXW(value) + delta;
+  } while (__STREXW(result, value) != 0U);
+
+  return result;
+}
+
+static uint8_t TRACER_Peek(uint32_t index)
+{
+  return TracerPool[index & TRACER_MASK];
+}
+
+/* Bulk copy of a ring span to the CDC pipe, caller checked the free space */
+static void TRACER_Send(uint32_t index, uint32_t size)
+{
+  uint32_t offset = index & TRACER_MASK;
+  uint32_t first = TRACER_EMB_BUFFER_SIZE - offset;
+
+  if (first > size)
+  {
+    first = size;
+  }
+  (void)cdc_acm_send_data(TRACER_BUSID, &TracerPool[offset], first);
+  if (size > first)
+  {
+    (void)cdc_acm_send_data(TRACER_BUSID, TracerPool, size - first);
+  }
+}
+
+static int32_t TRACER_Command(int32_t argc, char *argv[])
+{
+  TRACER_EMB_StatsTypeDef stats;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "on") == 0)
+    {
+      TRACER_EMB_Enable(1U);
+    }
+    else if (strcmp(argv[1], "off") == 0)
+    {
+      TRACER_EMB_Enable(0U);
+    }
+    else
+    {
+      return 1;
+    }
+  }
+
+  TRACER_EMB_GetStats(&stats);
+  (void)CON_Printf("{\"enabled\":%u,\"frames\":%lu,\"bytes\":%lu,\"dropped_frames\":%lu,\"dropped_bytes\":%lu,"
+                   "\"overflows\":%lu,\"pending\":%lu,\"high_water\":%lu,\"size\":%u}\r\n",
+                   (unsigned)TracerEnabled, (unsigned long)stats.Frames, (unsigned long)stats.Bytes,
+                   (unsigned long)stats.DroppedFrames, (unsigned long)stats.DroppedBytes,
+                   (unsigned long)stats.Overflows, (unsigned long)stats.Pending,
+                   (unsigned long)stats.HighWater, (unsigned)TRACER_EMB_BUFFER_SIZE);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Resets the ring and registers the console command
+  * @note   The trace channel starts disabled, "pdtrace on" enables it.
+  * @retval None
+  */
+void TRACER_EMB_Init(void)
+{
+  TracerEnabled = 0U;
+  TracerReserve = 0U;
+  TracerCommit  = 0U;
+  TracerRead    = 0U;
+  TracerNesting = 0U;
+
+  (void)CON_Register(&TRACER_ConsoleCommand);
+}
+
+/**
+  * @brief  Stops accepting frames
+  * @retval None
+  */
+void TRACER_EMB_DeInit(void)
+{
+  TracerEnabled = 0U;
+}
+
+/**
+  * @brief  Enters a producer section
+  * @note   Does not mask interrupts, it only defers the publication of the
+  *         frames written by nested producers until this one is complete.
+  * @retval None
+  */
+void TRACER_EMB_Lock(void)
+{
+  (void)TRACER_AtomicAdd(&TracerNesting, 1U);
+}
+
+/**
+  * @brief  Leaves a producer section, publishes the frames when outermost
+  * @retval None
+  */
+void TRACER_EMB_UnLock(void)
+{
+  uint32_t reserve;
+  uint32_t commit;
+
+  if (TRACER_AtomicAdd(&TracerNesting, (uint32_t)-1) != 0U)
+  {
+    return;
+  }
+
+  /* Frame bytes must be visible before the index that publishes them */
+  __DMB();
+
+  /* Only move Commit forward: a nested producer may have published a later index */
+  reserve = TracerReserve;
+  do
+  {
+    commit = __LDREXW(&TracerCommit);
+    if ((int32_t)(reserve - commit) <= 0)
+    {
+      __CLREX();
+      break;
+    }
+  } while (__STREXW(reserve, &TracerCommit) != 0U);
+}
+
+/**
+  * @brief  Reserves room for a complete frame
+  * @param  Size: Frame size in bytes
+  * @retval Ring position of the frame, -1 if disabled or full (frame dropped)
+  */
+int32_t TRACER_EMB_AllocateBufer(uint32_t Size)
+{
+  uint32_t reserve;
+  uint32_t used;
+
+  if ((TracerEnabled == 0U) || (Size == 0U))
+  {
+    return -1;
+  }
+
+  do
+  {
+    reserve = __LDREXW(&TracerReserve);
+    used = reserve - TracerRead;
+    if ((TRACER_EMB_BUFFER_SIZE - used) < Size)
+    {
+      __CLREX();
+      (void)TRACER_AtomicAdd(&TracerDroppedFrames, 1U);
+      (void)TRACER_AtomicAdd(&TracerDroppedBytes, Size);
+      return -1;
+    }
+  } while (__STREXW(reserve + Size, &TracerReserve) != 0U);
+
+  (void)TRACER_AtomicAdd(&TracerFrames, 1U);
+  (void)TRACER_AtomicAdd(&TracerBytes, Size);
+  if ((used + Size) > TracerHighWater)
+  {
+    TracerHighWater = used + Size;
+  }
+
+  return (int32_t)(reserve & TRACER_MASK);
+}
+
+/**
+  * @brief  Stores one byte of a reserved frame
+  * @param  pos: Ring position, wraps around
+  * @param  data: Byte
+  * @retval None
+  */
+void TRACER_EMB_WriteData(uint16_t pos, uint8_t data)
+{
+  TracerPool[pos & TRACER_MASK] = data;
+}
+
+/**
+  * @brief  Stores a block of a reserved frame
+  * @param  pos: Ring position, wraps around
+  * @param  data: Bytes
+  * @param  size: Number of bytes
+  * @retval None
+  */
+void TRACER_EMB_WriteBlock(uint16_t pos, const uint8_t *data, uint32_t size)
+{
+  uint32_t offset = pos & TRACER_MASK;
+  uint32_t first = TRACER_EMB_BUFFER_SIZE - offset;
+
+  if (first > size)
+  {
+    first = size;
+  }
+  (void)memcpy(&TracerPool[offset], data, first);
+  if (size > first)
+  {
+    (void)memcpy(TracerPool, &data[first], size - first);
+  }
+}
+
+/**
+  * @brief  Signals that frames are ready
+  * @note   Callable from interrupts: the transfer itself is done by
+  *         TRACER_EMB_Process() on the next pass of the main loop.
+  * @retval None
+  */
+void TRACER_EMB_SendData(void)
+{
+  if (TracerEnabled != 0U)
+  {
+    USBPD_DPM_UserWakeUp();
+  }
+}
+
+/**
+  * @brief  Registers the frame sent to the host after frames were dropped
+  * @param  Data: Complete TLV frame, must stay valid
+  * @param  Size: Frame size
+  * @retval 0
+  */
+uint32_t TRACER_EMB_EnableOverFlow(const uint8_t *Data, uint8_t Size)
+{
+  TracerOverflowFrame = Data;
+  TracerOverflowSize  = Size;
+  return 0U;
+}
+
+/**
+  * @brief  Enables or disables the trace channel
+  * @param  enable: 0 to disable, pending frames are discarded
+  * @retval None
+  */
+void TRACER_EMB_Enable(uint8_t enable)
+{
+  TracerEnabled = (enable != 0U) ? 1U : 0U;
+  TracerDropsReported = TracerDroppedFrames;
+  TRACER_EMB_SendData();
+}
+
+/**
+  * @brief  Moves complete frames from the ring to the CDC pipe
+  * @note   Called from the main loop only. A frame is copied only when the
+  *         CDC transmit ring can take all of it, so frames never interleave
+  *         with console output.
+  * @retval None
+  */
+void TRACER_EMB_Process(void)
+{
+  uint32_t commit = TracerCommit;
+  uint32_t read = TracerRead;
+  uint32_t size;
+
+  if (TracerEnabled == 0U)
+  {
+    TracerRead = commit;
+    return;
+  }
+  __DMB();
+
+  /* Tell the decoder that frames are missing before the next one */
+  if ((TracerDroppedFrames != TracerDropsReported) && (TracerOverflowFrame != NULL))
+  {
+    if (cdc_acm_get_tx_free() < TracerOverflowSize)
+    {
+      return;
+    }
+    (void)cdc_acm_send_data(TRACER_BUSID, TracerOverflowFrame, TracerOverflowSize);
+    TracerDropsReported = TracerDroppedFrames;
+    TracerOverflows++;
+  }
+
+  while (read != commit)
+  {
+    size = (((uint32_t)TRACER_Peek(read + TRACER_LENGTH_OFFSET) << 8U)
+            | TRACER_Peek(read + TRACER_LENGTH_OFFSET + 1U)) + TRACER_FRAME_OVERHEAD;
+
+    /* Not a frame start: cannot happen unless memory was corrupted, resync */
+    if ((TRACER_Peek(read) != TRACER_SOF) || (size > (commit - read)))
+    {
+      read = commit;
+      break;
+    }
+    if (cdc_acm_get_tx_free() < size)
+    {
+      break;
+    }
+    TRACER_Send(read, size);
+    read += size;
+  }
+
+  TracerRead = read;
+}
+
+/**
+  * @brief  Counters of the trace channel
+  * @param  stats: Filled with the counters
+  * @retval None
+  */
+void TRACER_EMB_GetStats(TRACER_EMB_StatsTypeDef *stats)
+{
+  stats->Frames        = TracerFrames;
+  stats->Bytes         = TracerBytes;
+  stats->DroppedFrames = TracerDroppedFrames;
+  stats->DroppedBytes  = TracerDroppedBytes;
+  stats->Overflows     = TracerOverflows;
+  stats->Pending       = TracerReserve - TracerRead;
+  stats->HighWater     = TracerHighWater;
+}
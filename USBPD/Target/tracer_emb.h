@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    tracer_emb.h
+  * @brief   Embedded tracer back end for the USBPD TLV trace stream.
+  ******************************************************************************
+  * @attention
+  *
+  * Implements the TRACER_EMB interface used by usbpd_trace.c. Frames are
+  * stored in a lock-free ring and drained by TRACER_EMB_Process() into the
+  * CDC ACM pipe, where they are multiplexed with the console text: every
+  * frame is delimited by 4 x 0xFD / 4 x 0xA5 as in STM32CubeMonitor-UCPD
+  * and is always written whole, so console lines only appear between
+  * frames.
+  *
+  * Producers may run at any interrupt level. A producer reserves space with
+  * an exclusive access on the write index, copies its frame without any
+  * lock and publishes it when the outermost producer completes. The main
+  * loop is the only consumer.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TRACER_EMB_H
+#define __TRACER_EMB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define TRACER_EMB_BUFFER_SIZE    2048U   /* Power of two                       */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Frames;          /* Frames accepted                         */
+  uint32_t Bytes;           /* Bytes accepted                          */
+  uint32_t DroppedFrames;   /* Frames lost, ring full                  */
+  uint32_t DroppedBytes;
+  uint32_t Overflows;       /* Overflow markers sent to the host       */
+  uint32_t Pending;         /* Bytes waiting in the ring               */
+  uint32_t HighWater;       /* Maximum ring occupancy                  */
+} TRACER_EMB_StatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void     TRACER_EMB_Init(void);
+void     TRACER_EMB_DeInit(void);
+void     TRACER_EMB_Lock(void);
+void     TRACER_EMB_UnLock(void);
+int32_t  TRACER_EMB_AllocateBufer(uint32_t Size);
+void     TRACER_EMB_WriteData(uint16_t pos, uint8_t data);
+void     TRACER_EMB_WriteBlock(uint16_t pos, const uint8_t *data, uint32_t size);
+void     TRACER_EMB_SendData(void);
+uint32_t TRACER_EMB_EnableOverFlow(const uint8_t *Data, uint8_t Size);
+
+void     TRACER_EMB_Enable(uint8_t enable);
+void     TRACER_EMB_Process(void);
+void     TRACER_EMB_GetStats(TRACER_EMB_StatsTypeDef *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRACER_EMB_H */
@@ -43,6 +43,7 @@
 
 /* USER CODE BEGIN Define */
 /* Section where Define can be added */
+#define _MANU_INFO 1            /*!< Answer Get_Manufacturer_Info with DPM_ManuInfoPort     */
 
 /* USER CODE END Define */
 
@@ -77,11 +78,11 @@ USBPD_SettingsTypeDef       DPM_Settings[USBPD_PORT_COUNT] =
     {
       .PE_UnchunkSupport                = USBPD_FALSE,  /* support Unchunked mode (valid only spec revision 3.0)   */
       .PE_FastRoleSwapSupport           = USBPD_FALSE,   /* support fast role swap only spec revision 3.0            */
-      .Is_GetPPSStatus_Supported        = USBPD_FALSE,  /*!< PPS message NOT supported by PE stack */
-      .Is_SrcCapaExt_Supported          = USBPD_FALSE,  /*!< Source_Capabilities_Extended message supported or not by DPM */
-      .Is_Alert_Supported               = USBPD_FALSE,   /*!< Alert message supported or not by DPM */
-      .Is_GetStatus_Supported           = USBPD_FALSE,   /*!< Status message supported or not by DPM (Is_Alert_Supported should be enabled) */
-      .Is_GetManufacturerInfo_Supported = USBPD_FALSE,  /*!< Manufacturer_Info message supported or not by DPM */
+      .Is_GetPPSStatus_Supported        = USBPD_TRUE,   /*!< PPS message supported by PE stack */
+      .Is_SrcCapaExt_Supported          = USBPD_TRUE,   /*!< Source_Capabilities_Extended message supported or not by DPM */
+      .Is_Alert_Supported               = USBPD_TRUE,    /*!< Alert message supported or not by DPM */
+      .Is_GetStatus_Supported           = USBPD_TRUE,    /*!< Status message supported or not by DPM (Is_Alert_Supported should be enabled) */
+      .Is_GetManufacturerInfo_Supported = USBPD_TRUE,   /*!< Manufacturer_Info message supported or not by DPM */
       .Is_GetCountryCodes_Supported     = USBPD_FALSE,  /*!< Country_Codes message supported or not by DPM */
       .Is_GetCountryInfo_Supported      = USBPD_FALSE,  /*!< Country_Info message supported or not by DPM */
       .Is_SecurityRequest_Supported     = USBPD_FALSE,  /*!< Security_Response message supported or not by DPM */
@@ -110,6 +111,15 @@ USBPD_USER_SettingsTypeDef       DPM_USER_Settings[USBPD_PORT_COUNT] =
     .PE_VconnSwap = USBPD_FALSE,                 /* support VCONN swap                                  */
     .PE_DR_Swap_To_DFP = USBPD_TRUE,                  /*  Support of DR Swap to DFP                                  */
     .PE_DR_Swap_To_UFP = USBPD_TRUE,                  /*  Support of DR Swap to UFP                                  */
+    .DPM_SNKRequestedPower =                     /*!< Sink power budget used by the policy (usbpd_snk_policy.h) */
+    {
+      .MaxOperatingCurrentInmAunits = 3000U,     /*!< Input stage limit                           */
+      .OperatingVoltageInmVunits    = 9000U,     /*!< Preferred VBUS                              */
+      .MaxOperatingVoltageInmVunits = 12000U,    /*!< Input stage rating                          */
+      .MinOperatingVoltageInmVunits = 5000U,
+      .OperatingPowerInmWunits      = 7500U,     /*!< SD writes + analogue front end, default load */
+      .MaxOperatingPowerInmWunits   = 15000U,    /*!< Peak budget                                 */
+    },
      .DPM_SNKExtendedCapa =                        /*!< SNK Extended Capability        */
 	 {
 	   .VID                    = USBPD_VID,  /*!< Vendor ID (assigned by the USB-IF)                      */
@@ -132,12 +142,12 @@ USBPD_USER_SettingsTypeDef       DPM_USER_Settings[USBPD_PORT_COUNT] =
        .Touchtemp              = USBPD_SKEDB_TOUCHTEMP_NA,  /*< Touch Temp based on @ref USBPD_SKEDB_TOUCHTEMP   */
        .BatteryInfo            = 0,          /*!< Battery info                                                   */
        .SinkModes              = 0,          /*!< Sink Modes based on combination of @ref USBPD_SKEDB_SINKMODES  */
-       .SinkMinimumPDP        = 0,          /*!< The Minimum PDP required by the Sink to operate without
+       .SinkMinimumPDP        = 3,          /*!< The Minimum PDP required by the Sink to operate without
                                                   consuming any power from its Battery(s) should it have one     */
-       .SinkOperationalPDP     = 0,          /*!< The PDP the Sink requires to operate normally. For Sinks with
+       .SinkOperationalPDP     = 8,          /*!< The PDP the Sink requires to operate normally. For Sinks with
                                                   a Battery, it is the PDP rating of the charger supplied with
                                                   it or recommended for it.                                      */
-       .SinkMaximumPDP         = 0,          /*!< The Maximum PDP the Sink can consume to operate and
+       .SinkMaximumPDP         = 15,         /*!< The Maximum PDP the Sink can consume to operate and
                                                   charge its Battery(s) should it have one                       */
       },
 #if defined(USBPD_REV30_SUPPORT)
@@ -0,0 +1,353 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_dpm_replay.c
+  * @brief   Replay of recorded PD sequences into the sink DPM (DPM_REPLAY).
+  ******************************************************************************
+  * @attention
+  *
+  * The injector replaces the PE in the DPM_Params fields the DPM reads
+  * (PE_Power, PE_SpecRevision, PE_DataRole) and restores them at the end
+  * of each scenario. Real SysTick calls to USBPD_DPM_UserTimerCounter()
+  * are ignored while a scenario runs so only virtual time advances the
+  * DPM timers.
+  *
+  ******************************************************************************
+  */
+
+#if defined(DPM_REPLAY)
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "usbpd_core.h"
+#include "usbpd_dpm_core.h"
+#include "usbpd_dpm_user.h"
+#include "usbpd_dpm_replay.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  RPL_CB_CABLE = 0,         /* UserCableDetection                      */
+  RPL_CB_CAPS,              /* SetDataInfo + SNK_EvaluateCapabilities  */
+  RPL_CB_NOTIFY,            /* Notification, HardReset                 */
+  RPL_CB_TIMER,             /* UserTimerCounter                        */
+  RPL_CB_EXECUTE,           /* Sink part of UserExecute                */
+  RPL_CB_LOAD,              /* SetLoadPower                            */
+  RPL_CB_NB
+} RPL_CallbackTypeDef;
+
+typedef struct
+{
+  uint32_t Calls;
+  uint32_t Min;             /* Cycles */
+  uint32_t Max;
+  uint32_t Total;
+} RPL_LatencyTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const RPL_CallbackNames[RPL_CB_NB] =
+{
+  "cable", "caps", "notify", "timer", "execute", "load"
+};
+
+static volatile uint8_t RplActive;
+static volatile uint8_t RplVirtualTick;
+static uint8_t  RplPort;
+static uint32_t RplTime;
+static uint32_t RplPdos[USBPD_MAX_NB_PDO];
+static RPL_CaptureTypeDef RplCapture;
+static RPL_LatencyTypeDef RplLatency[RPL_CB_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+static void     RPL_TimerStart(void);
+static uint32_t RPL_CyclesToUs(uint32_t cycles);
+static void     RPL_Account(RPL_CallbackTypeDef cb, uint32_t start);
+static void     RPL_Execute(void);
+static uint32_t RPL_Step(const RPL_StepTypeDef *step);
+static int32_t  RPL_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef RPL_ConsoleCommand =
+{
+  .Name    = "replay",
+  .Help    = "replay [scenario] - replay PD sequences into the DPM, no cable attached",
+  .Handler = RPL_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void RPL_TimerStart(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t RPL_CyclesToUs(uint32_t cycles)
+{
+  uint32_t mhz = SystemCoreClock / 1000000U;
+
+  return (mhz != 0U) ? ((cycles + (mhz / 2U)) / mhz) : 0U;
+}
+
+static void RPL_Account(RPL_CallbackTypeDef cb, uint32_t start)
+{
+  uint32_t cycles = DWT->CYCCNT - start;
+  RPL_LatencyTypeDef *lat = &RplLatency[cb];
+
+  if ((lat->Calls == 0U) || (cycles < lat->Min))
+  {
+    lat->Min = cycles;
+  }
+  if (cycles > lat->Max)
+  {
+    lat->Max = cycles;
+  }
+  lat->Total += cycles;
+  lat->Calls++;
+}
+
+/* What USBPD_DPM_UserExecute() would do on this pass */
+static void RPL_Execute(void)
+{
+  uint32_t start = DWT->CYCCNT;
+
+  USBPD_DPM_ReplayExecute();
+  RPL_Account(RPL_CB_EXECUTE, start);
+}
+
+/* Plays one step, returns the number of failed checks */
+static uint32_t RPL_Step(const RPL_StepTypeDef *step)
+{
+  USBPD_ParamsTypeDef *params = &DPM_Params[RplPort];
+  uint32_t start;
+  uint32_t rdo;
+  uint32_t ms;
+  USBPD_CORE_PDO_Type_TypeDef type;
+
+  start = DWT->CYCCNT;
+  switch (step->Op)
+  {
+    case RPL_OP_ATTACH:
+      params->PE_SpecRevision = USBPD_SPECIFICATION_REV3;
+      params->PE_DataRole     = USBPD_PORTDATAROLE_UFP;
+      params->PE_Power        = USBPD_POWER_DEFAULT5V;
+      USBPD_DPM_UserCableDetection(RplPort, USBPD_CAD_EVENT_ATTACHED);
+      RPL_Account(RPL_CB_CABLE, start);
+      break;
+
+    case RPL_OP_SRC_CAPS:
+      RplCapture.PdoCount = step->Count;
+      (void)memcpy(RplPdos, step->Pdos, RplCapture.PdoCount * sizeof(uint32_t));
+      USBPD_DPM_SetDataInfo(RplPort, USBPD_CORE_DATATYPE_RCV_SRC_PDO, (uint8_t *)RplPdos,
+                            RplCapture.PdoCount * sizeof(uint32_t));
+      USBPD_DPM_SNK_EvaluateCapabilities(RplPort, &rdo, &type);
+      RPL_Account(RPL_CB_CAPS, start);
+      /* The PE sends the Request built by the DPM */
+      (void)RPL_SendRequest(RplPort, rdo, type);
+      params->PE_Power = USBPD_POWER_TRANSITION;
+      break;
+
+    case RPL_OP_ACCEPT:
+      USBPD_DPM_Notification(RplPort, USBPD_NOTIFY_REQUEST_ACCEPTED);
+      RPL_Account(RPL_CB_NOTIFY, start);
+      break;
+
+    case RPL_OP_REJECT:
+    case RPL_OP_WAIT:
+      USBPD_DPM_Notification(RplPort, (step->Op == RPL_OP_REJECT) ? USBPD_NOTIFY_REQUEST_REJECTED
+                                                                  : USBPD_NOTIFY_REQUEST_WAIT);
+      RPL_Account(RPL_CB_NOTIFY, start);
+      params->PE_Power = USBPD_POWER_EXPLICITCONTRACT;
+      RPL_Execute();
+      break;
+
+    case RPL_OP_PS_RDY:
+      params->PE_Power = USBPD_POWER_EXPLICITCONTRACT;
+      USBPD_DPM_Notification(RplPort, USBPD_NOTIFY_POWER_EXPLICIT_CONTRACT);
+      RPL_Account(RPL_CB_NOTIFY, start);
+      RPL_Execute();
+      break;
+
+    case RPL_OP_HARD_RESET:
+      params->PE_Power = USBPD_POWER_DEFAULT5V;
+      USBPD_DPM_HardReset(RplPort, USBPD_PORTPOWERROLE_SNK, USBPD_HR_STATUS_START_ACK);
+      USBPD_DPM_Notification(RplPort, USBPD_NOTIFY_HARDRESET_RX);
+      RPL_Account(RPL_CB_NOTIFY, start);
+      break;
+
+    case RPL_OP_DETACH:
+      params->PE_Power = USBPD_POWER_NO;
+      USBPD_DPM_UserCableDetection(RplPort, USBPD_CAD_EVENT_DETACHED);
+      RPL_Account(RPL_CB_CABLE, start);
+      RPL_Execute();
+      break;
+
+    case RPL_OP_ADVANCE:
+      for (ms = 0U; ms < step->Arg; ms++)
+      {
+        RplTime++;
+        start = DWT->CYCCNT;
+        RplVirtualTick = 1U;
+        USBPD_DPM_UserTimerCounter(RplPort);
+        RplVirtualTick = 0U;
+        RPL_Account(RPL_CB_TIMER, start);
+        RPL_Execute();
+      }
+      break;
+
+    case RPL_OP_LOAD:
+      USBPD_DPM_SetLoadPower(RplPort, step->Arg);
+      RPL_Account(RPL_CB_LOAD, start);
+      RPL_Execute();
+      break;
+
+    default:
+      return RPL_Expect(step, &RplCapture, RplTime);
+  }
+
+  return 0U;
+}
+
+static int32_t RPL_Command(int32_t argc, char *argv[])
+{
+  uint32_t index;
+  uint32_t failures = 0U;
+  uint32_t found = 0U;
+
+  if (DPM_Params[0].PE_IsConnected != 0U)
+  {
+    (void)CON_Printf("ERR detach the cable first\r\n");
+    return 1;
+  }
+
+  for (index = 0U; index < RPL_GetScenarioCount(); index++)
+  {
+    if ((argc > 1) && (strcmp(argv[1], RPL_GetScenario(index)->Name) != 0))
+    {
+      continue;
+    }
+    found++;
+    failures += RPL_Run(0U, RPL_GetScenario(index));
+  }
+
+  if (found == 0U)
+  {
+    return 1;
+  }
+  return (failures == 0U) ? 0 : 1;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Registers the "replay" console command
+  * @retval None
+  */
+void RPL_Init(void)
+{
+  (void)CON_Register(&RPL_ConsoleCommand);
+}
+
+/**
+  * @brief  Plays a scenario and prints failures and callback latencies
+  * @param  PortNum  Port driven by the scenario, must be detached
+  * @param  Scenario Steps to play
+  * @retval Number of failed checks, latency budget overruns included
+  */
+uint32_t RPL_Run(uint8_t PortNum, const RPL_ScenarioTypeDef *Scenario)
+{
+  USBPD_ParamsTypeDef saved = DPM_Params[PortNum];
+  RPL_LatencyTypeDef *lat;
+  uint32_t failures = 0U;
+  uint32_t index;
+  uint32_t fails;
+
+  RPL_TimerStart();
+  (void)memset(RplLatency, 0, sizeof(RplLatency));
+  RplPort        = PortNum;
+  RplTime        = 0U;
+  (void)memset(&RplCapture, 0, sizeof(RplCapture));
+  RplCapture.Pdos = RplPdos;
+  RplVirtualTick = 0U;
+  RplActive      = 1U;
+
+  USBPD_DPM_SetLoadPower(PortNum, 0U);
+  USBPD_DPM_UserCableDetection(PortNum, USBPD_CAD_EVENT_DETACHED);
+
+  for (index = 0U; index < Scenario->Count; index++)
+  {
+    fails = RPL_Step(&Scenario->Steps[index]);
+    if (fails != 0U)
+    {
+      (void)CON_Printf("  step %lu (%s) failed\r\n", (unsigned long)index, RPL_GetOpName(Scenario->Steps[index].Op));
+      failures += fails;
+    }
+  }
+
+  /* Leave the DPM as a detached port */
+  USBPD_DPM_UserCableDetection(PortNum, USBPD_CAD_EVENT_DETACHED);
+  USBPD_DPM_SetLoadPower(PortNum, 0U);
+  RplActive = 0U;
+  DPM_Params[PortNum] = saved;
+
+  for (index = 0U; index < (uint32_t)RPL_CB_NB; index++)
+  {
+    lat = &RplLatency[index];
+    if (lat->Calls == 0U)
+    {
+      continue;
+    }
+    if (RPL_CyclesToUs(lat->Max) > RPL_LATENCY_BUDGET_US)
+    {
+      failures++;
+    }
+    (void)CON_Printf("{\"scenario\":\"%s\",\"cb\":\"%s\",\"calls\":%lu,\"min_us\":%lu,\"avg_us\":%lu,\"max_us\":%lu}\r\n",
+                     Scenario->Name, RPL_CallbackNames[index], (unsigned long)lat->Calls,
+                     (unsigned long)RPL_CyclesToUs(lat->Min), (unsigned long)RPL_CyclesToUs(lat->Total / lat->Calls),
+                     (unsigned long)RPL_CyclesToUs(lat->Max));
+  }
+  (void)CON_Printf("{\"scenario\":\"%s\",\"steps\":%lu,\"vtime_ms\":%lu,\"failures\":%lu}\r\n",
+                   Scenario->Name, (unsigned long)Scenario->Count, (unsigned long)RplTime, (unsigned long)failures);
+
+  return failures;
+}
+
+/**
+  * @brief  Tells whether a scenario drives the port
+  * @param  PortNum Port number
+  * @retval 1 while a scenario runs on PortNum
+  */
+uint8_t RPL_IsActive(uint8_t PortNum)
+{
+  return ((RplActive != 0U) && (PortNum == RplPort)) ? 1U : 0U;
+}
+
+/**
+  * @brief  Filters real time ticks while the virtual clock drives the port
+  * @param  PortNum Port number
+  * @retval 1 if the USBPD_DPM_UserTimerCounter() call must be ignored
+  */
+uint8_t RPL_IgnoreTick(uint8_t PortNum)
+{
+  return ((RPL_IsActive(PortNum) != 0U) && (RplVirtualTick == 0U)) ? 1U : 0U;
+}
+
+/**
+  * @brief  Captures a request instead of handing it to the PE
+  * @param  PortNum Port number
+  * @param  Rdo     Request data object
+  * @param  PdoType Type of the requested object
+  * @retval USBPD_OK
+  */
+USBPD_StatusTypeDef RPL_SendRequest(uint8_t PortNum, uint32_t Rdo, USBPD_CORE_PDO_Type_TypeDef PdoType)
+{
+  UNUSED(PortNum);
+
+  RplCapture.Requests++;
+  RplCapture.Rdo  = Rdo;
+  RplCapture.Type = PdoType;
+  RplCapture.Time = RplTime;
+  DPM_Params[RplPort].PE_Power = USBPD_POWER_TRANSITION;
+
+  return USBPD_OK;
+}
+
+#endif /* DPM_REPLAY */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_dpm_replay.h
+  * @brief   Replay of recorded PD sequences into the sink DPM (DPM_REPLAY).
+  ******************************************************************************
+  * @attention
+  *
+  * Built only with DPM_REPLAY defined. The injector plays the part of the
+  * PE/PRL/CAD: it feeds attach, Source_Capabilities, Accept, PS_RDY, hard
+  * reset and detach events to the DPM user callbacks, drives the DPM user
+  * timer with a virtual clock and captures the requests the DPM would have
+  * sent. Each step can assert the request (object, voltage, current,
+  * mismatch) and the time at which it is sent, and every callback is timed
+  * with the DWT cycle counter against RPL_LATENCY_BUDGET_US. The scenarios
+  * are the tables of usbpd_dpm_scenarios.c, also played on the host by
+  * Tests/Src/test_dpm.c.
+  *
+  * Run it with no cable attached: "replay" runs all scenarios, "replay
+  * <name>" a single one. The load budget is reset to the settings value
+  * afterwards.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_DPM_REPLAY_H
+#define __USBPD_DPM_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(DPM_REPLAY)
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+#include "usbpd_dpm_scenarios.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define RPL_LATENCY_BUDGET_US     100U    /* Longest acceptable DPM callback    */
+
+/* Exported functions prototypes ---------------------------------------------*/
+void                RPL_Init(void);
+uint32_t            RPL_Run(uint8_t PortNum, const RPL_ScenarioTypeDef *Scenario);
+uint8_t             RPL_IsActive(uint8_t PortNum);
+uint8_t             RPL_IgnoreTick(uint8_t PortNum);
+USBPD_StatusTypeDef RPL_SendRequest(uint8_t PortNum, uint32_t Rdo, USBPD_CORE_PDO_Type_TypeDef PdoType);
+
+#endif /* DPM_REPLAY */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_DPM_REPLAY_H */
@@ -35,7 +35,19 @@
 #include "stdio.h"
 #endif /* _TRACE */
 /* USER CODE BEGIN Includes */
-
+#include <string.h>
+#include "console.h"
+#include "governor.h"
+#include "usbpd_snk_policy.h"
+#include "usbpd_lowpower.h"
+#include "usbpd_partner_info.h"
+#include "dsp_app.h"
+#if defined(_TRACE)
+#include "tracer_emb.h"
+#endif /* _TRACE */
+#if defined(DPM_REPLAY)
+#include "usbpd_dpm_replay.h"
+#endif /* DPM_REPLAY */
 /* USER CODE END Includes */
 
 /** @addtogroup STM32_USBPD_APPLICATION
@@ -48,6 +60,20 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN Private_Typedef */
+/* Sink negotiation state of one port */
+typedef struct
+{
+  uint32_t              DPM_ListOfRcvSRCPDO[USBPD_MAX_NB_PDO]; /*!< Last Source_Capabilities          */
+  uint32_t              DPM_NumberOfRcvSRCPDO;                 /*!< Number of received source PDOs    */
+  uint32_t              DPM_RequestedVoltage;                  /*!< Voltage of the last request (mV)  */
+  uint32_t              DPM_LoadPower;                         /*!< Load budget (mW), 0: settings     */
+  SNKP_SelectionTypeDef DPM_Selection;                         /*!< Last request sent                 */
+  SNKP_SelectionTypeDef DPM_Contract;                          /*!< Request accepted by the source    */
+  uint8_t               DPM_ContractValid;
+  USBPD_GMIDB_TypeDef   DPM_GetManuInfo;                       /*!< Last Get_Manufacturer_Info        */
+  volatile uint8_t      DPM_Reevaluate;                        /*!< Request to be sent again          */
+  volatile uint16_t     DPM_RequestTimer;                      /*!< ms until PPS keep-alive or retry  */
+} DPM_USER_PortTypeDef;
 
 /* USER CODE END Private_Typedef */
 
@@ -56,6 +82,7 @@
   * @{
   */
 /* USER CODE BEGIN Private_Define */
+#define DPM_SINK_REQUEST_RETRY    100U  /* tSinkRequest after a Wait answer (ms) */
 
 /* USER CODE END Private_Define */
 
@@ -105,6 +132,7 @@
   */
 
 /* USER CODE BEGIN Private_Variables */
+static DPM_USER_PortTypeDef DPM_Ports[USBPD_PORT_COUNT];
 
 /* USER CODE END Private_Variables */
 /**
@@ -116,6 +144,11 @@
   * @{
   */
 /* USER CODE BEGIN USBPD_USER_PRIVATE_FUNCTIONS_Prototypes */
+static SNKP_StatusTypeDef DPM_SNK_Select(uint8_t PortNum, SNKP_SelectionTypeDef *Selection);
+static void               DPM_SNK_Reset(uint8_t PortNum);
+static uint32_t           DPM_SNK_Budget(const SNKP_SelectionTypeDef *Selection);
+static void               DPM_SNK_ArmTimer(uint8_t PortNum, uint16_t Time);
+static void               DPM_SNK_Execute(void);
 
 /* USER CODE END USBPD_USER_PRIVATE_FUNCTIONS_Prototypes */
 /**
@@ -144,6 +177,26 @@
 USBPD_StatusTypeDef USBPD_DPM_UserInit(void)
 {
 /* USER CODE BEGIN USBPD_DPM_UserInit */
+  uint8_t _port;
+
+  for (_port = 0U; _port < USBPD_PORT_COUNT; _port++)
+  {
+    DPM_SNK_Reset(_port);
+    DPM_Ports[_port].DPM_LoadPower = 0U;
+  }
+#if defined(DPM_REPLAY)
+  RPL_Init();
+#endif /* DPM_REPLAY */
+
+  /* VBUS/IBUS measurement, used by vSafe0V/vSafe5V checks of the stack */
+  if (USBPD_OK != USBPD_PWR_IF_Init())
+  {
+    return USBPD_ERROR;
+  }
+
+  /* Sleep/Stop between PD events, see USBPD_DPM_EnterIdle() */
+  LPM_Init();
+  PTN_Init();
   return USBPD_OK;
 /* USER CODE END USBPD_DPM_UserInit */
 }
@@ -166,7 +219,17 @@ void USBPD_DPM_WaitForTime(uint32_t Time)
 void USBPD_DPM_UserExecute(void const *argument)
 {
 /* USER CODE BEGIN USBPD_DPM_UserExecute */
-
+  DPM_SNK_Execute();
+  PTN_Process();
+  GOV_Process();
+  if (DSP_Process() != 0U)
+  {
+    USBPD_DPM_UserWakeUp();
+  }
+  CON_Process();
+#if defined(_TRACE)
+  TRACER_EMB_Process();
+#endif /* _TRACE */
 /* USER CODE END USBPD_DPM_UserExecute */
 }
 
@@ -179,7 +242,14 @@ void USBPD_DPM_UserExecute(void const *argument)
 void USBPD_DPM_UserCableDetection(uint8_t PortNum, USBPD_CAD_EVENT State)
 {
 /* USER CODE BEGIN USBPD_DPM_UserCableDetection */
-DPM_USER_DEBUG_TRACE(PortNum, "ADVICE: update USBPD_DPM_UserCableDetection");
+  switch(State)
+  {
+    case USBPD_CAD_EVENT_DETACHED:
+      DPM_SNK_Reset(PortNum);
+      break;
+    default:
+      break;
+  }
 /* USER CODE END USBPD_DPM_UserCableDetection */
 }
 
@@ -191,7 +261,22 @@ DPM_USER_DEBUG_TRACE(PortNum, "ADVICE: update USBPD_DPM_UserCableDetection");
 void USBPD_DPM_UserTimerCounter(uint8_t PortNum)
 {
 /* USER CODE BEGIN USBPD_DPM_UserTimerCounter */
-
+#if defined(DPM_REPLAY)
+  /* The replay clock drives the timers of a replayed port */
+  if (RPL_IgnoreTick(PortNum) != 0U)
+  {
+    return;
+  }
+#endif /* DPM_REPLAY */
+  if (DPM_Ports[PortNum].DPM_RequestTimer != 0U)
+  {
+    DPM_Ports[PortNum].DPM_RequestTimer--;
+    if (DPM_Ports[PortNum].DPM_RequestTimer == 0U)
+    {
+      DPM_Ports[PortNum].DPM_Reevaluate = 1U;
+      USBPD_DPM_UserWakeUp();
+    }
+  }
 /* USER CODE END USBPD_DPM_UserTimerCounter */
 }
 
@@ -215,20 +300,38 @@ void USBPD_DPM_Notification(uint8_t PortNum, USBPD_NotifyEventValue_TypeDef Even
   /* Manage event notified by the stack? */
   switch(EventVal)
   {
-//    case USBPD_NOTIFY_POWER_EXPLICIT_CONTRACT :
-//      break;
+    case USBPD_NOTIFY_POWER_EXPLICIT_CONTRACT :
+      DPM_Ports[PortNum].DPM_Contract      = DPM_Ports[PortNum].DPM_Selection;
+      DPM_Ports[PortNum].DPM_ContractValid = 1U;
+      /* PS_RDY received: the new power can be used */
+      GOV_SetBudget(DPM_SNK_Budget(&DPM_Ports[PortNum].DPM_Contract));
+      PTN_Contract(PortNum, DPM_Ports[PortNum].DPM_Contract.Rdo, DPM_Ports[PortNum].DPM_Contract.IsPPS);
+      /* A PPS contract lapses without a new request within tPPSRequest */
+      DPM_SNK_ArmTimer(PortNum, (DPM_Ports[PortNum].DPM_Contract.IsPPS != 0U) ? SNKP_PPS_KEEPALIVE_MS : 0U);
+      break;
 //    case USBPD_NOTIFY_REQUEST_ACCEPTED:
 //      break;
-//    case USBPD_NOTIFY_REQUEST_REJECTED:
-//    case USBPD_NOTIFY_REQUEST_WAIT:
-//      break;
+    case USBPD_NOTIFY_REQUEST_REJECTED:
+      /* Keep the previous contract, and its keep-alive if PPS */
+      if (DPM_Ports[PortNum].DPM_ContractValid != 0U)
+      {
+        DPM_Ports[PortNum].DPM_Selection = DPM_Ports[PortNum].DPM_Contract;
+        DPM_Ports[PortNum].DPM_RequestedVoltage = DPM_Ports[PortNum].DPM_Contract.Voltage;
+        GOV_SetBudget(DPM_SNK_Budget(&DPM_Ports[PortNum].DPM_Contract));
+        DPM_SNK_ArmTimer(PortNum, (DPM_Ports[PortNum].DPM_Contract.IsPPS != 0U) ? SNKP_PPS_KEEPALIVE_MS : 0U);
+      }
+      break;
+    case USBPD_NOTIFY_REQUEST_WAIT:
+      DPM_SNK_ArmTimer(PortNum, DPM_SINK_REQUEST_RETRY);
+      break;
 //    case USBPD_NOTIFY_POWER_SWAP_TO_SNK_DONE:
 //      break;
 //    case USBPD_NOTIFY_STATE_SNK_READY:
 //      break;
-//    case USBPD_NOTIFY_HARDRESET_RX:
-//    case USBPD_NOTIFY_HARDRESET_TX:
-//      break;
+    case USBPD_NOTIFY_HARDRESET_RX:
+    case USBPD_NOTIFY_HARDRESET_TX:
+      DPM_SNK_Reset(PortNum);
+      break;
 //    case USBPD_NOTIFY_STATE_SRC_DISABLED:
 //      break;
 //    case USBPD_NOTIFY_ALERT_RECEIVED :
@@ -279,25 +382,52 @@ void USBPD_DPM_HardReset(uint8_t PortNum, USBPD_PortPowerRole_TypeDef CurrentRol
 void USBPD_DPM_GetDataInfo(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef DataId, uint8_t *Ptr, uint32_t *Size)
 {
 /* USER CODE BEGIN USBPD_DPM_GetDataInfo */
+  USBPD_MIDB_TypeDef _manu;
+  USBPD_SDB_TypeDef  _sdb;
+
   /* Check type of information targeted by request */
   switch(DataId)
   {
-//  case USBPD_CORE_DATATYPE_SNK_PDO:           /*!< Handling of port Sink PDO, requested by get sink capa*/
-    // break;
+  case USBPD_CORE_DATATYPE_SNK_PDO:           /*!< Handling of port Sink PDO, requested by get sink capa*/
+    USBPD_PWR_IF_GetPortPDOs(PortNum, DataId, Ptr, Size);
+    *Size *= 4U;
+    break;
 //  case USBPD_CORE_EXTENDED_CAPA:              /*!< Source Extended capability message content          */
     // break;
-//  case USBPD_CORE_DATATYPE_REQ_VOLTAGE:       /*!< Get voltage value requested for BIST tests, expect 5V*/
-//    *Size = 4;
-//    (void)memcpy((uint8_t *)Ptr, (uint8_t *)&DPM_Ports[PortNum].DPM_RequestedVoltage, *Size);
-    // break;
-//  case USBPD_CORE_INFO_STATUS:                /*!< Information status message content                  */
-    // break;
-//  case USBPD_CORE_MANUFACTURER_INFO:          /*!< Retrieve of Manufacturer info message content       */
-    // break;
+  case USBPD_CORE_DATATYPE_REQ_VOLTAGE:       /*!< Get voltage value requested for BIST tests, expect 5V*/
+    *Size = 4;
+    (void)memcpy((uint8_t *)Ptr, (uint8_t *)&DPM_Ports[PortNum].DPM_RequestedVoltage, *Size);
+    break;
+  case USBPD_CORE_INFO_STATUS:                /*!< Information status message content                  */
+    /* Bus powered, no battery, no temperature sensor: nothing to report */
+    (void)memset(&_sdb, 0, sizeof(_sdb));
+    *Size = sizeof(_sdb);
+    (void)memcpy(Ptr, (uint8_t *)&_sdb, *Size);
+    break;
+  case USBPD_CORE_MANUFACTURER_INFO:          /*!< Retrieve of Manufacturer info message content       */
+    _manu = DPM_USER_Settings[PortNum].DPM_ManuInfoPort;
+    if ((USBPD_MANUFINFO_TARGET_PORT_CABLE_PLUG != DPM_Ports[PortNum].DPM_GetManuInfo.ManufacturerInfoTarget)
+        || (_manu.ManuString[0] == 0U))
+    {
+      /* Battery target (none here) or no string configured */
+      (void)memset(_manu.ManuString, 0, sizeof(_manu.ManuString));
+      (void)strcpy((char *)_manu.ManuString, "Not Supported");
+      *Size = 4U + strlen((char *)_manu.ManuString) + 1U;
+    }
+    else
+    {
+      *Size = 4U + strnlen((char *)_manu.ManuString, sizeof(_manu.ManuString));
+    }
+    (void)memcpy(Ptr, (uint8_t *)&_manu, *Size);
+    break;
 //  case USBPD_CORE_BATTERY_STATUS:             /*!< Retrieve of Battery status message content          */
     // break;
 //  case USBPD_CORE_BATTERY_CAPABILITY:         /*!< Retrieve of Battery capability message content      */
     // break;
+  case USBPD_CORE_SNK_EXTENDED_CAPA:          /*!< Sink Extended capability message content            */
+    *Size = sizeof(USBPD_SKEDB_TypeDef);
+    (void)memcpy(Ptr, (uint8_t *)&DPM_USER_Settings[PortNum].DPM_SNKExtendedCapa, *Size);
+    break;
   default:
     DPM_USER_DEBUG_TRACE(PortNum, "ADVICE: update USBPD_DPM_GetDataInfo:%d", DataId);
     break;
@@ -319,22 +449,35 @@ void USBPD_DPM_SetDataInfo(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef Data
   /* Check type of information targeted by request */
   switch(DataId)
   {
-//  case USBPD_CORE_DATATYPE_RDO_POSITION:      /*!< Reset the PDO position selected by the sink only */
-    // break;
-//  case USBPD_CORE_DATATYPE_RCV_SRC_PDO:       /*!< Storage of Received Source PDO values        */
-    // break;
+  case USBPD_CORE_DATATYPE_RDO_POSITION:      /*!< Reset the PDO position selected by the sink only */
+    if ((Size == 4U) && (*Ptr == 0U))
+    {
+      DPM_Ports[PortNum].DPM_Selection.Position = 0U;
+      DPM_Ports[PortNum].DPM_ContractValid      = 0U;
+    }
+    break;
+  case USBPD_CORE_DATATYPE_RCV_SRC_PDO:       /*!< Storage of Received Source PDO values        */
+    if (Size <= (USBPD_MAX_NB_PDO * 4U))
+    {
+      (void)memcpy((uint8_t *)DPM_Ports[PortNum].DPM_ListOfRcvSRCPDO, Ptr, Size);
+      DPM_Ports[PortNum].DPM_NumberOfRcvSRCPDO = Size / 4U;
+    }
+    break;
 //  case USBPD_CORE_DATATYPE_RCV_SNK_PDO:       /*!< Storage of Received Sink PDO values          */
     // break;
-//  case USBPD_CORE_EXTENDED_CAPA:              /*!< Source Extended capability message content   */
-    // break;
-//  case USBPD_CORE_PPS_STATUS:                 /*!< PPS Status message content                   */
-    // break;
-//  case USBPD_CORE_INFO_STATUS:                /*!< Information status message content           */
-    // break;
-//  case USBPD_CORE_ALERT:                      /*!< Storing of received Alert message content    */
-    // break;
-//  case USBPD_CORE_GET_MANUFACTURER_INFO:      /*!< Storing of received Get Manufacturer info message content */
-    // break;
+  case USBPD_CORE_EXTENDED_CAPA:              /*!< Source Extended capability message content   */
+  case USBPD_CORE_PPS_STATUS:                 /*!< PPS Status message content                   */
+  case USBPD_CORE_INFO_STATUS:                /*!< Information status message content           */
+  case USBPD_CORE_ALERT:                      /*!< Storing of received Alert message content    */
+  case USBPD_CORE_MANUFACTURER_INFO:          /*!< Manufacturer info message content            */
+    (void)PTN_Store(PortNum, DataId, Ptr, Size);
+    break;
+  case USBPD_CORE_GET_MANUFACTURER_INFO:      /*!< Storing of received Get Manufacturer info message content */
+    if (Size == sizeof(USBPD_GMIDB_TypeDef))
+    {
+      (void)memcpy((uint8_t *)&DPM_Ports[PortNum].DPM_GetManuInfo, Ptr, Size);
+    }
+    break;
 //  case USBPD_CORE_GET_BATTERY_STATUS:         /*!< Storing of received Get Battery status message content    */
     // break;
 //  case USBPD_CORE_GET_BATTERY_CAPABILITY:     /*!< Storing of received Get Battery capability message content*/
@@ -359,10 +502,67 @@ void USBPD_DPM_SetDataInfo(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef Data
 void USBPD_DPM_SNK_EvaluateCapabilities(uint8_t PortNum, uint32_t *PtrRequestData, USBPD_CORE_PDO_Type_TypeDef *PtrPowerObjectType)
 {
 /* USER CODE BEGIN USBPD_DPM_SNK_EvaluateCapabilities */
-  DPM_USER_DEBUG_TRACE(PortNum, "ADVICE: update USBPD_DPM_SNK_EvaluateCapabilities");
+  SNKP_SelectionTypeDef _sel;
+  SNKP_StatusTypeDef    _status = DPM_SNK_Select(PortNum, &_sel);
+  USBPD_SNKRDO_TypeDef  _rdo;
+
+  if (SNKP_ERROR == _status)
+  {
+    /* No usable object: vSafe5V with mismatch so the source keeps talking */
+    (void)memset(&_sel, 0, sizeof(_sel));
+    _sel.PdoType  = USBPD_CORE_PDO_TYPE_FIXED;
+    _sel.Position = 1U;
+    _sel.Mismatch = 1U;
+    _sel.Voltage  = 5000U;
+    _rdo.d32 = 0U;
+    _rdo.FixedVariableRDO.ObjectPosition     = 1U;
+    _rdo.FixedVariableRDO.CapabilityMismatch = 1U;
+    _sel.Rdo = _rdo.d32;
+  }
+
+  DPM_Ports[PortNum].DPM_Selection        = _sel;
+  DPM_Ports[PortNum].DPM_RequestedVoltage = _sel.Voltage;
+  DPM_SNK_ArmTimer(PortNum, 0U);
+  /* Step down before the source lowers its output */
+  GOV_LimitBudget(DPM_SNK_Budget(&_sel));
+
+  *PtrRequestData     = _sel.Rdo;
+  *PtrPowerObjectType = _sel.PdoType;
+
+  DPM_USER_DEBUG_TRACE(PortNum, "SNK: PDO%d %dmV %dmA%s", _sel.Position, _sel.Voltage, _sel.Current,
+                       (_sel.Mismatch != 0U) ? " mismatch" : "");
 /* USER CODE END USBPD_DPM_SNK_EvaluateCapabilities */
 }
 
+/**
+  * @brief  Evaluate a single source PDO against the sink power request
+  * @param  PortNum             Port number
+  * @param  SrcPDO              Source PDO to evaluate
+  * @param  PtrRequestedVoltage Pointer on the voltage that would be requested (mV)
+  * @param  PtrRequestedPower   Pointer on the power available at that voltage (mW)
+  * @retval 1 if the PDO covers the load budget, 0 otherwise
+  */
+uint32_t USBPD_DPM_SNK_EvaluateMatchWithSRCPDO(uint8_t PortNum, uint32_t SrcPDO, uint32_t* PtrRequestedVoltage, uint32_t* PtrRequestedPower)
+{
+/* USER CODE BEGIN USBPD_DPM_SNK_EvaluateMatchWithSRCPDO */
+  SNKP_SelectionTypeDef _sel;
+  SNKP_StatusTypeDef    _status;
+
+  _status = SNKP_Evaluate(&DPM_USER_Settings[PortNum].DPM_SNKRequestedPower, &SrcPDO, 1U,
+                          DPM_Ports[PortNum].DPM_LoadPower, 0U, &_sel);
+  if (SNKP_ERROR == _status)
+  {
+    *PtrRequestedVoltage = 0U;
+    *PtrRequestedPower   = 0U;
+    return 0U;
+  }
+
+  *PtrRequestedVoltage = _sel.Voltage;
+  *PtrRequestedPower   = _sel.Power;
+  return (SNKP_OK == _status) ? 1U : 0U;
+/* USER CODE END USBPD_DPM_SNK_EvaluateMatchWithSRCPDO */
+}
+
 /**
   * @brief  Callback to be used by PE to evaluate a Vconn swap
   * @param  PortNum Port number
@@ -542,9 +742,58 @@ USBPD_StatusTypeDef USBPD_DPM_RequestMessageRequest(uint8_t PortNum, uint8_t Ind
 {
   USBPD_StatusTypeDef _status = USBPD_ERROR;
 /* USER CODE BEGIN USBPD_DPM_RequestMessageRequest */
-  /* To be adapted to call the PE function */
-  /*       _status = USBPD_PE_Send_Request(PortNum, rdo.d32, pdo_object);*/
-  DPM_USER_DEBUG_TRACE(PortNum, "ADVICE: update USBPD_DPM_RequestMessageRequest");
+  USBPD_SNKPowerRequest_TypeDef _req;
+  SNKP_SelectionTypeDef         _sel;
+  SNKP_StatusTypeDef            _eval;
+  USBPD_SNKRDO_TypeDef          _rdo;
+  uint32_t                      _pdo;
+
+  if (IndexSrcPDO == 0U)
+  {
+    /* Policy choice over the last Source_Capabilities */
+    _eval = DPM_SNK_Select(PortNum, &_sel);
+  }
+  else if (IndexSrcPDO <= DPM_Ports[PortNum].DPM_NumberOfRcvSRCPDO)
+  {
+    /* Forced object: open the window to it, pin the voltage for an APDO */
+    _req = DPM_USER_Settings[PortNum].DPM_SNKRequestedPower;
+    _req.MinOperatingVoltageInmVunits = 0U;
+    _req.MaxOperatingVoltageInmVunits = 0xFFFFFFFFU;
+    if (RequestedVoltage != 0U)
+    {
+      _req.OperatingVoltageInmVunits    = RequestedVoltage;
+    }
+    _pdo  = DPM_Ports[PortNum].DPM_ListOfRcvSRCPDO[IndexSrcPDO - 1U];
+    _eval = SNKP_Evaluate(&_req, &_pdo, 1U, DPM_Ports[PortNum].DPM_LoadPower, 0U, &_sel);
+    if (SNKP_ERROR != _eval)
+    {
+      _rdo.d32 = _sel.Rdo;
+      _rdo.GenericRDO.ObjectPosition = IndexSrcPDO;
+      _sel.Rdo      = _rdo.d32;
+      _sel.Position = IndexSrcPDO;
+    }
+  }
+  else
+  {
+    _eval = SNKP_ERROR;
+  }
+
+  if (SNKP_ERROR != _eval)
+  {
+#if defined(DPM_REPLAY)
+    _status = (RPL_IsActive(PortNum) != 0U) ? RPL_SendRequest(PortNum, _sel.Rdo, _sel.PdoType)
+                                            : USBPD_PE_Send_Request(PortNum, _sel.Rdo, _sel.PdoType);
+#else
+    _status = USBPD_PE_Send_Request(PortNum, _sel.Rdo, _sel.PdoType);
+#endif /* DPM_REPLAY */
+    if (USBPD_OK == _status)
+    {
+      DPM_Ports[PortNum].DPM_Selection        = _sel;
+      DPM_Ports[PortNum].DPM_RequestedVoltage = _sel.Voltage;
+      DPM_SNK_ArmTimer(PortNum, 0U);
+      GOV_LimitBudget(DPM_SNK_Budget(&_sel));
+    }
+  }
 /* USER CODE END USBPD_DPM_RequestMessageRequest */
   DPM_USER_ERROR_TRACE(PortNum, _status, "REQUEST not accepted by the stack");
   return _status;
@@ -925,6 +1174,138 @@ USBPD_StatusTypeDef USBPD_DPM_RequestSecurityRequest(uint8_t PortNum)
   */
 
 /* USER CODE BEGIN USBPD_USER_PRIVATE_FUNCTIONS */
+/**
+  * @brief  Runs the sink policy over the last received Source_Capabilities
+  * @param  PortNum   Port number
+  * @param  Selection Filled with the object to request
+  * @retval Policy status
+  */
+static SNKP_StatusTypeDef DPM_SNK_Select(uint8_t PortNum, SNKP_SelectionTypeDef *Selection)
+{
+  uint32_t _flags = 0U;
+
+  if (USBPD_PORTDATAROLE_UFP == DPM_Params[PortNum].PE_DataRole)
+  {
+    _flags |= SNKP_FLAG_USB_COMM;
+  }
+#if defined(USBPD_REV30_SUPPORT)
+  /* PPS requires a PD3.0 contract */
+  if (USBPD_SPECIFICATION_REV3 != DPM_Params[PortNum].PE_SpecRevision)
+#endif /* USBPD_REV30_SUPPORT */
+  {
+    _flags |= SNKP_FLAG_NO_PPS;
+  }
+
+  return SNKP_Evaluate(&DPM_USER_Settings[PortNum].DPM_SNKRequestedPower,
+                       DPM_Ports[PortNum].DPM_ListOfRcvSRCPDO, DPM_Ports[PortNum].DPM_NumberOfRcvSRCPDO,
+                       DPM_Ports[PortNum].DPM_LoadPower, _flags, Selection);
+}
+
+/**
+  * @brief  Forgets the negotiated contract (detach, hard reset)
+  * @param  PortNum Port number
+  * @retval None
+  */
+static void DPM_SNK_Reset(uint8_t PortNum)
+{
+  DPM_Ports[PortNum].DPM_RequestTimer      = 0U;
+  DPM_Ports[PortNum].DPM_Reevaluate        = 0U;
+  DPM_Ports[PortNum].DPM_ContractValid     = 0U;
+  DPM_Ports[PortNum].DPM_NumberOfRcvSRCPDO = 0U;
+  DPM_Ports[PortNum].DPM_RequestedVoltage  = 5000U;
+  (void)memset(&DPM_Ports[PortNum].DPM_Selection, 0, sizeof(DPM_Ports[PortNum].DPM_Selection));
+  (void)memset(&DPM_Ports[PortNum].DPM_Contract, 0, sizeof(DPM_Ports[PortNum].DPM_Contract));
+  GOV_SetBudget(GOV_DEFAULT_MW);
+  PTN_Reset(PortNum);
+}
+
+/**
+  * @brief  Power the board may draw under a request
+  * @param  Selection Request sent or accepted
+  * @retval Power in mW, the Type-C default for the vSafe5V fallback
+  */
+static uint32_t DPM_SNK_Budget(const SNKP_SelectionTypeDef *Selection)
+{
+  return (Selection->Power != 0U) ? Selection->Power : GOV_DEFAULT_MW;
+}
+
+/**
+  * @brief  (Re)starts the request timer, 0 stops it
+  * @param  PortNum Port number
+  * @param  Time    Delay in ms before the request is sent again
+  * @retval None
+  */
+static void DPM_SNK_ArmTimer(uint8_t PortNum, uint16_t Time)
+{
+  /* Shared with USBPD_DPM_UserTimerCounter() in SysTick context */
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  DPM_Ports[PortNum].DPM_RequestTimer = Time;
+  DPM_Ports[PortNum].DPM_Reevaluate   = 0U;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Updates the power budget of the sink and renegotiates if needed
+  * @param  PortNum   Port number
+  * @param  LoadPower Power to be drawn from VBUS in mW, 0 to use the
+  *                   OperatingPowerInmWunits setting
+  * @retval None
+  */
+void USBPD_DPM_SetLoadPower(uint8_t PortNum, uint32_t LoadPower)
+{
+  SNKP_SelectionTypeDef _sel;
+
+  if ((PortNum >= USBPD_PORT_COUNT) || (DPM_Ports[PortNum].DPM_LoadPower == LoadPower))
+  {
+    return;
+  }
+  DPM_Ports[PortNum].DPM_LoadPower = LoadPower;
+
+  if ((DPM_Ports[PortNum].DPM_ContractValid == 0U) || (SNKP_ERROR == DPM_SNK_Select(PortNum, &_sel)))
+  {
+    return;
+  }
+
+  /* Only renegotiate when the request itself changes */
+  if (_sel.Rdo != DPM_Ports[PortNum].DPM_Contract.Rdo)
+  {
+    DPM_Ports[PortNum].DPM_Reevaluate = 1U;
+    USBPD_DPM_UserWakeUp();
+  }
+}
+
+/* Load change, PPS keep-alive or retry after Wait */
+static void DPM_SNK_Execute(void)
+{
+  uint8_t _port;
+
+  for (_port = 0U; _port < USBPD_PORT_COUNT; _port++)
+  {
+    if ((DPM_Ports[_port].DPM_Reevaluate != 0U)
+        && (USBPD_POWER_EXPLICITCONTRACT == DPM_Params[_port].PE_Power))
+    {
+      DPM_Ports[_port].DPM_Reevaluate = 0U;
+      if (USBPD_OK != USBPD_DPM_RequestMessageRequest(_port, 0U, 0U))
+      {
+        /* PE busy with another AMS: try again on the next tick */
+        DPM_SNK_ArmTimer(_port, 1U);
+      }
+    }
+  }
+}
+
+#if defined(DPM_REPLAY)
+/**
+  * @brief  Sink part of USBPD_DPM_UserExecute() for the replay injector
+  * @retval None
+  */
+void USBPD_DPM_ReplayExecute(void)
+{
+  DPM_SNK_Execute();
+}
+#endif /* DPM_REPLAY */
 
 /* USER CODE END USBPD_USER_PRIVATE_FUNCTIONS */
 
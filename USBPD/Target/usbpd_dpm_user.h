@@ -156,6 +156,10 @@ USBPD_StatusTypeDef USBPD_DPM_RequestGetBatteryCapability(uint8_t PortNum, uint8
 USBPD_StatusTypeDef USBPD_DPM_RequestGetBatteryStatus(uint8_t PortNum, uint8_t *pBatteryStatusRef);
 USBPD_StatusTypeDef USBPD_DPM_RequestSecurityRequest(uint8_t PortNum);
 /* USER CODE BEGIN Function */
+void                USBPD_DPM_SetLoadPower(uint8_t PortNum, uint32_t LoadPower);
+#if defined(DPM_REPLAY)
+void                USBPD_DPM_ReplayExecute(void);
+#endif /* DPM_REPLAY */
 
 /* USER CODE END Function */
 /**
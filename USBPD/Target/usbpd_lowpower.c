@@ -0,0 +1,553 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_lowpower.c
+  * @brief   Idle manager: Sleep, tickless Sleep and Stop 1 between PD events.
+  ******************************************************************************
+  * @attention
+  *
+  * The RTC wakeup timer, the clock restore after Stop and the RTC reads are
+  * done with CMSIS register accesses: everything here runs with interrupts
+  * masked, where the HAL tick based timeouts would never expire. Waits are
+  * bounded by loop counts instead.
+  *
+  * After Stop the system clock is HSI16. The oscillators and the SYSCLK
+  * selection in use before Stop are restored, PLL settings and the flash
+  * latency are retained by the RCC.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "usbpd_core.h"
+#include "usbpd_dpm_core.h"
+#include "usbpd_pwr_sense.h"
+#include "usbpd_lowpower.h"
+
+/* Private define ------------------------------------------------------------*/
+#define LPM_RTC_WUT_HZ            2048U   /* LSE / 16, WUCKSEL = 000            */
+#define LPM_RTC_KEY1              0xCAU
+#define LPM_RTC_KEY2              0x53U
+#define LPM_RTC_LOCK              0xFFU
+#define LPM_SPIN                  200000U /* Bound of the register polls        */
+#define LPM_BOOST_SETTLE          200U    /* ~1 us at HCLK/2 before HPRE = 1    */
+#define LPM_DAY_S                 86400U
+
+/* EXTI line 43 (UCPD1 wakeup, direct line) has no CMSIS definition */
+#define LPM_EXTI_IMR2_UCPD1       (1UL << 11U)
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Cr;              /* RCC_CR oscillator enables               */
+  uint32_t Crrcr;           /* HSI48 enable                            */
+  uint32_t Cfgr;            /* SW and HPRE                             */
+} LPM_ClockTypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const LPM_ModeNames[] = { "sleep", "tickless", "stop" };
+
+static DMA_Channel_TypeDef *const LPM_DmaChannels[] =
+{
+  DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4,
+  DMA1_Channel5, DMA1_Channel6, DMA1_Channel7, DMA1_Channel8,
+  DMA2_Channel1, DMA2_Channel2, DMA2_Channel3, DMA2_Channel4,
+  DMA2_Channel5, DMA2_Channel6, DMA2_Channel7, DMA2_Channel8,
+};
+
+static const IRQn_Type LPM_DmaIrqs[] =
+{
+  DMA1_Channel1_IRQn, DMA1_Channel2_IRQn, DMA1_Channel3_IRQn, DMA1_Channel4_IRQn,
+  DMA1_Channel5_IRQn, DMA1_Channel6_IRQn, DMA1_Channel7_IRQn, DMA1_Channel8_IRQn,
+  DMA2_Channel1_IRQn, DMA2_Channel2_IRQn, DMA2_Channel3_IRQn, DMA2_Channel4_IRQn,
+  DMA2_Channel5_IRQn, DMA2_Channel6_IRQn, DMA2_Channel7_IRQn, DMA2_Channel8_IRQn,
+};
+
+static LPM_ModeTypeDef LpmMode = LPM_MODE_STOP;
+static LPM_StatsTypeDef LpmStats;
+static uint32_t LpmStatsStart;
+static uint64_t LpmSleepUs;
+static uint64_t LpmTicklessRtc;     /* RTC subsecond ticks */
+static uint64_t LpmStopRtc;
+static uint32_t LpmRtcHz;
+static uint32_t LpmTickCarry;       /* ms fraction not yet added to the tick, x LpmRtcHz */
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t  LPM_PortsAttached(void);
+static uint8_t  LPM_DmaBusy(void);
+static void     LPM_CountWake(void);
+static uint32_t LPM_RtcNow(void);
+static uint32_t LPM_RtcElapsed(uint32_t start);
+static void     LPM_RtcSync(void);
+static void     LPM_RtcArm(uint32_t ms);
+static void     LPM_RtcDisarm(void);
+static void     LPM_TickSuspend(void);
+static void     LPM_TickResume(uint32_t rtc);
+static void     LPM_ClockSave(LPM_ClockTypeDef *clock);
+static void     LPM_ClockRestore(const LPM_ClockTypeDef *clock);
+static uint8_t  LPM_Wait(volatile uint32_t *reg, uint32_t mask, uint32_t set);
+static void     LPM_Sleep(void);
+static void     LPM_SleepTickless(uint32_t Timeout);
+static void     LPM_Stop(uint32_t Timeout);
+static uint32_t LPM_RtcToMs(uint64_t rtc);
+static int32_t  LPM_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef LPM_ConsoleCommand =
+{
+  .Name    = "lpm",
+  .Help    = "lpm [sleep|tickless|stop|reset] - deepest idle mode, residency statistics",
+  .Handler = LPM_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* PE/PRL timers only run, and USB only works, with an attached port */
+static uint8_t LPM_PortsAttached(void)
+{
+  uint8_t port;
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    if (DPM_Params[port].PE_IsConnected != 0U)
+    {
+      return 1U;
+    }
+  }
+  return 0U;
+}
+
+/* A transfer in progress would be frozen by Stop */
+static uint8_t LPM_DmaBusy(void)
+{
+  uint32_t index;
+
+  for (index = 0U; index < (sizeof(LPM_DmaChannels) / sizeof(LPM_DmaChannels[0])); index++)
+  {
+    if ((LPM_DmaChannels[index] != PWRS_DMA_CHANNEL) && ((LPM_DmaChannels[index]->CCR & DMA_CCR_EN) != 0U))
+    {
+      return 1U;
+    }
+  }
+  return 0U;
+}
+
+/* Interrupts are still masked: the pending one is the wake-up source */
+static void LPM_CountWake(void)
+{
+  uint32_t index;
+
+  if (NVIC_GetPendingIRQ(RTC_WKUP_IRQn) != 0U)
+  {
+    LpmStats.WakeRtc++;
+    return;
+  }
+  if (NVIC_GetPendingIRQ(UCPD1_IRQn) != 0U)
+  {
+    LpmStats.WakeUcpd++;
+    return;
+  }
+  if ((NVIC_GetPendingIRQ(USB_LP_IRQn) != 0U) || (NVIC_GetPendingIRQ(USB_HP_IRQn) != 0U))
+  {
+    LpmStats.WakeUsb++;
+    return;
+  }
+  for (index = 0U; index < (sizeof(LPM_DmaIrqs) / sizeof(LPM_DmaIrqs[0])); index++)
+  {
+    if (NVIC_GetPendingIRQ(LPM_DmaIrqs[index]) != 0U)
+    {
+      LpmStats.WakeDma++;
+      return;
+    }
+  }
+  if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U)
+  {
+    LpmStats.WakeTick++;
+    return;
+  }
+  LpmStats.WakeOther++;
+}
+
+/* Calendar time of day in RTC subsecond ticks */
+static uint32_t LPM_RtcNow(void)
+{
+  uint32_t ssr;
+  uint32_t tr;
+  uint32_t seconds;
+
+  /* Reading SSR freezes TR/DR until DR is read */
+  do
+  {
+    ssr = RTC->SSR;
+    tr  = RTC->TR;
+    (void)RTC->DR;
+  } while (ssr != RTC->SSR);
+
+  seconds = ((((tr & RTC_TR_HT) >> RTC_TR_HT_Pos) * 10U) + ((tr & RTC_TR_HU) >> RTC_TR_HU_Pos)) * 3600U
+            + ((((tr & RTC_TR_MNT) >> RTC_TR_MNT_Pos) * 10U) + ((tr & RTC_TR_MNU) >> RTC_TR_MNU_Pos)) * 60U
+            + (((tr & RTC_TR_ST) >> RTC_TR_ST_Pos) * 10U) + ((tr & RTC_TR_SU) >> RTC_TR_SU_Pos);
+
+  return (seconds * LpmRtcHz) + ((LpmRtcHz - 1U) - (ssr & RTC_SSR_SS));
+}
+
+static uint32_t LPM_RtcElapsed(uint32_t start)
+{
+  uint32_t now = LPM_RtcNow();
+
+  return (now >= start) ? (now - start) : ((LPM_DAY_S * LpmRtcHz) - start + now);
+}
+
+/* Shadow registers are stale after Stop until the next RSF */
+static void LPM_RtcSync(void)
+{
+  RTC->WPR = LPM_RTC_KEY1;
+  RTC->WPR = LPM_RTC_KEY2;
+  CLEAR_BIT(RTC->ICSR, RTC_ICSR_RSF);
+  RTC->WPR = LPM_RTC_LOCK;
+  (void)LPM_Wait(&RTC->ICSR, RTC_ICSR_RSF, RTC_ICSR_RSF);
+}
+
+static void LPM_RtcArm(uint32_t ms)
+{
+  uint32_t ticks;
+
+  if (ms > LPM_RTC_MAX_MS)
+  {
+    ms = LPM_RTC_MAX_MS;
+  }
+  ticks = (ms * LPM_RTC_WUT_HZ) / 1000U;
+  if (ticks == 0U)
+  {
+    ticks = 1U;
+  }
+
+  RTC->WPR = LPM_RTC_KEY1;
+  RTC->WPR = LPM_RTC_KEY2;
+  CLEAR_BIT(RTC->CR, RTC_CR_WUTE | RTC_CR_WUTIE);
+  (void)LPM_Wait(&RTC->ICSR, RTC_ICSR_WUTWF, RTC_ICSR_WUTWF);
+  MODIFY_REG(RTC->WUTR, RTC_WUTR_WUT, ticks - 1U);
+  CLEAR_BIT(RTC->CR, RTC_CR_WUCKSEL);
+  RTC->SCR = RTC_SCR_CWUTF;
+  SET_BIT(RTC->CR, RTC_CR_WUTE | RTC_CR_WUTIE);
+  RTC->WPR = LPM_RTC_LOCK;
+}
+
+static void LPM_RtcDisarm(void)
+{
+  RTC->WPR = LPM_RTC_KEY1;
+  RTC->WPR = LPM_RTC_KEY2;
+  CLEAR_BIT(RTC->CR, RTC_CR_WUTE | RTC_CR_WUTIE);
+  RTC->SCR = RTC_SCR_CWUTF;
+  RTC->WPR = LPM_RTC_LOCK;
+  EXTI->PR1 = EXTI_PR1_PIF20;
+  NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+}
+
+static void LPM_TickSuspend(void)
+{
+  CLEAR_BIT(SysTick->CTRL, SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk);
+}
+
+/* Adds the time measured by the RTC to the HAL tick, keeps the remainder */
+static void LPM_TickResume(uint32_t rtc)
+{
+  uint64_t total = ((uint64_t)rtc * 1000U) + LpmTickCarry;
+
+  LpmTickCarry = (uint32_t)(total % LpmRtcHz);
+  uwTick += (uint32_t)(total / LpmRtcHz);
+
+  SysTick->VAL = 0U;
+  SET_BIT(SysTick->CTRL, SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk);
+}
+
+static void LPM_ClockSave(LPM_ClockTypeDef *clock)
+{
+  clock->Cr    = RCC->CR & (RCC_CR_HSEON | RCC_CR_PLLON);
+  clock->Crrcr = RCC->CRRCR & RCC_CRRCR_HSI48ON;
+  clock->Cfgr  = RCC->CFGR & (RCC_CFGR_SW | RCC_CFGR_HPRE);
+}
+
+static void LPM_ClockRestore(const LPM_ClockTypeDef *clock)
+{
+  uint32_t settle;
+  uint8_t  ok = 1U;
+
+  if ((clock->Cr & RCC_CR_HSEON) != 0U)
+  {
+    SET_BIT(RCC->CR, RCC_CR_HSEON);
+    ok &= LPM_Wait(&RCC->CR, RCC_CR_HSERDY, RCC_CR_HSERDY);
+  }
+  if (clock->Crrcr != 0U)
+  {
+    SET_BIT(RCC->CRRCR, RCC_CRRCR_HSI48ON);
+  }
+  if ((clock->Cr & RCC_CR_PLLON) != 0U)
+  {
+    SET_BIT(RCC->CR, RCC_CR_PLLON);
+    ok &= LPM_Wait(&RCC->CR, RCC_CR_PLLRDY, RCC_CR_PLLRDY);
+  }
+  if (ok == 0U)
+  {
+    Error_Handler();
+  }
+
+  if (((clock->Cfgr & RCC_CFGR_SW) == RCC_CFGR_SW_PLL) && ((clock->Cfgr & RCC_CFGR_HPRE) == RCC_CFGR_HPRE_DIV1))
+  {
+    /* Above 80 MHz the switch goes through HCLK = SYSCLK / 2 for 1 us (RM0440 6.2.7) */
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, RCC_CFGR_HPRE_DIV2);
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_SW, RCC_CFGR_SW_PLL);
+    (void)LPM_Wait(&RCC->CFGR, RCC_CFGR_SWS, RCC_CFGR_SWS_PLL);
+    for (settle = 0U; settle < LPM_BOOST_SETTLE; settle++)
+    {
+      __NOP();
+    }
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_HPRE, RCC_CFGR_HPRE_DIV1);
+  }
+  else
+  {
+    MODIFY_REG(RCC->CFGR, RCC_CFGR_SW | RCC_CFGR_HPRE, clock->Cfgr);
+    (void)LPM_Wait(&RCC->CFGR, RCC_CFGR_SWS, (clock->Cfgr & RCC_CFGR_SW) << RCC_CFGR_SWS_Pos);
+  }
+
+  if (clock->Crrcr != 0U)
+  {
+    (void)LPM_Wait(&RCC->CRRCR, RCC_CRRCR_HSI48RDY, RCC_CRRCR_HSI48RDY);
+  }
+}
+
+/* Polls until the 'mask' bits of a register equal 'set', 1 on success */
+static uint8_t LPM_Wait(volatile uint32_t *reg, uint32_t mask, uint32_t set)
+{
+  uint32_t spin;
+
+  for (spin = 0U; spin < LPM_SPIN; spin++)
+  {
+    if ((*reg & mask) == set)
+    {
+      return 1U;
+    }
+  }
+  return 0U;
+}
+
+/* WFI with SysTick running, timed with SysTick itself */
+static void LPM_Sleep(void)
+{
+  uint32_t load = SysTick->LOAD + 1U;
+  uint32_t start;
+  uint32_t end;
+  uint32_t cycles;
+  uint32_t mhz = SystemCoreClock / 1000000U;
+
+  (void)SysTick->CTRL;      /* Clears COUNTFLAG */
+  start = SysTick->VAL;
+  __DSB();
+  __WFI();
+  end = SysTick->VAL;
+
+  /* SysTick wakes the core at the latest, so it wrapped at most once */
+  cycles = ((SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) != 0U) ? (start + load - end) : (start - end);
+  if (mhz != 0U)
+  {
+    LpmSleepUs += cycles / mhz;
+  }
+  LpmStats.Sleeps++;
+  LPM_CountWake();
+}
+
+static void LPM_SleepTickless(uint32_t Timeout)
+{
+  uint32_t start = LPM_RtcNow();
+  uint32_t rtc;
+
+  if (Timeout != 0xFFFFFFFFU)
+  {
+    LPM_RtcArm(Timeout);
+  }
+  LPM_TickSuspend();
+  __DSB();
+  __WFI();
+  LPM_CountWake();
+  LPM_RtcDisarm();
+
+  rtc = LPM_RtcElapsed(start);
+  LPM_TickResume(rtc);
+  LpmTicklessRtc += rtc;
+  LpmStats.TicklessSleeps++;
+}
+
+static void LPM_Stop(uint32_t Timeout)
+{
+  LPM_ClockTypeDef clock;
+  uint32_t start = LPM_RtcNow();
+  uint32_t rtc;
+
+  LPM_ClockSave(&clock);
+  if (Timeout != 0xFFFFFFFFU)
+  {
+    LPM_RtcArm(Timeout);
+  }
+  LPM_TickSuspend();
+
+  HAL_PWREx_EnterSTOP1Mode(PWR_STOPENTRY_WFI);
+
+  LPM_ClockRestore(&clock);
+  LPM_CountWake();
+  LPM_RtcDisarm();
+  LPM_RtcSync();
+
+  rtc = LPM_RtcElapsed(start);
+  LPM_TickResume(rtc);
+  LpmStopRtc += rtc;
+  LpmStats.Stops++;
+}
+
+static uint32_t LPM_RtcToMs(uint64_t rtc)
+{
+  return (uint32_t)((rtc * 1000U) / LpmRtcHz);
+}
+
+static int32_t LPM_Command(int32_t argc, char *argv[])
+{
+  LPM_StatsTypeDef stats;
+  uint32_t mode;
+  uint32_t idle;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "reset") == 0)
+    {
+      LPM_ResetStats();
+    }
+    else
+    {
+      for (mode = 0U; mode < (sizeof(LPM_ModeNames) / sizeof(LPM_ModeNames[0])); mode++)
+      {
+        if (strcmp(argv[1], LPM_ModeNames[mode]) == 0)
+        {
+          break;
+        }
+      }
+      if (mode == (sizeof(LPM_ModeNames) / sizeof(LPM_ModeNames[0])))
+      {
+        return 1;
+      }
+      LPM_SetMode((LPM_ModeTypeDef)mode);
+    }
+  }
+
+  LPM_GetStats(&stats);
+  idle = stats.Sleep + stats.Tickless + stats.Stop;
+  (void)CON_Printf("{\"mode\":\"%s\",\"uptime_ms\":%lu,\"run_ms\":%lu,\"sleep_ms\":%lu,\"tickless_ms\":%lu,"
+                   "\"stop_ms\":%lu,\"sleeps\":%lu,\"tickless\":%lu,\"stops\":%lu,\"stop_denied\":%lu,"
+                   "\"wake_rtc\":%lu,\"wake_ucpd\":%lu,\"wake_usb\":%lu,\"wake_dma\":%lu,\"wake_tick\":%lu,"
+                   "\"wake_other\":%lu}\r\n",
+                   LPM_ModeNames[LpmMode], (unsigned long)stats.Uptime,
+                   (unsigned long)((stats.Uptime > idle) ? (stats.Uptime - idle) : 0U),
+                   (unsigned long)stats.Sleep, (unsigned long)stats.Tickless, (unsigned long)stats.Stop,
+                   (unsigned long)stats.Sleeps, (unsigned long)stats.TicklessSleeps, (unsigned long)stats.Stops,
+                   (unsigned long)stats.StopDenied, (unsigned long)stats.WakeRtc, (unsigned long)stats.WakeUcpd,
+                   (unsigned long)stats.WakeUsb, (unsigned long)stats.WakeDma, (unsigned long)stats.WakeTick,
+                   (unsigned long)stats.WakeOther);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Sets up the RTC wakeup timer and the EXTI wake-up lines
+  * @note   MX_RTC_Init() must have run. Registers the "lpm" console command.
+  * @retval None
+  */
+void LPM_Init(void)
+{
+  LpmRtcHz = (RTC->PRER & RTC_PRER_PREDIV_S) + 1U;
+
+  /* RTC wakeup timer on EXTI 20, rising edge */
+  LPM_RtcDisarm();
+  SET_BIT(EXTI->RTSR1, EXTI_RTSR1_RT20);
+  SET_BIT(EXTI->IMR1, EXTI_IMR1_IM20);
+  NVIC_SetPriority(RTC_WKUP_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 3, 0));
+  NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+  /* UCPD1 type-C events may end Stop 1 */
+  SET_BIT(EXTI->IMR2, LPM_EXTI_IMR2_UCPD1);
+
+  LPM_ResetStats();
+  (void)CON_Register(&LPM_ConsoleCommand);
+}
+
+/**
+  * @brief  Limits the idle modes
+  * @param  mode: Deepest mode allowed, LPM_MODE_SLEEP keeps SysTick running
+  * @retval None
+  */
+void LPM_SetMode(LPM_ModeTypeDef mode)
+{
+  LpmMode = mode;
+}
+
+/**
+  * @brief  Residency and wake-up statistics
+  * @param  stats: Filled with the statistics
+  * @retval None
+  */
+void LPM_GetStats(LPM_StatsTypeDef *stats)
+{
+  *stats = LpmStats;
+  stats->Uptime   = HAL_GetTick() - LpmStatsStart;
+  stats->Sleep    = (uint32_t)(LpmSleepUs / 1000U);
+  stats->Tickless = LPM_RtcToMs(LpmTicklessRtc);
+  stats->Stop     = LPM_RtcToMs(LpmStopRtc);
+}
+
+/**
+  * @brief  Restarts the statistics
+  * @retval None
+  */
+void LPM_ResetStats(void)
+{
+  (void)memset(&LpmStats, 0, sizeof(LpmStats));
+  LpmSleepUs     = 0U;
+  LpmTicklessRtc = 0U;
+  LpmStopRtc     = 0U;
+  LpmStatsStart  = HAL_GetTick();
+}
+
+/**
+  * @brief  RTC wakeup interrupt, only ends the idle period
+  * @retval None
+  */
+void LPM_RTC_IRQHandler(void)
+{
+  LPM_RtcDisarm();
+}
+
+/**
+  * @brief  Idles until the next PD deadline or an interrupt
+  * @note   Overrides the weak DPM version, called with interrupts masked.
+  * @param  Timeout  Milliseconds until the next PD deadline (0xFFFFFFFF: none)
+  * @retval None
+  */
+void USBPD_DPM_EnterIdle(uint32_t Timeout)
+{
+  if ((LpmMode == LPM_MODE_SLEEP) || (LpmRtcHz == 0U) || (Timeout < LPM_TICKLESS_MIN_MS)
+      || (LPM_PortsAttached() != 0U))
+  {
+    LPM_Sleep();
+    return;
+  }
+
+  if ((LpmMode == LPM_MODE_STOP) && (Timeout >= LPM_STOP_MIN_MS))
+  {
+    if (LPM_DmaBusy() == 0U)
+    {
+      PWRS_Suspend();
+      LPM_Stop(Timeout);
+      PWRS_Resume();
+      return;
+    }
+    LpmStats.StopDenied++;
+  }
+
+  LPM_SleepTickless(Timeout);
+}
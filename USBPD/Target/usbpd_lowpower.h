@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_lowpower.h
+  * @brief   Idle manager: Sleep, tickless Sleep and Stop 1 between PD events.
+  ******************************************************************************
+  * @attention
+  *
+  * Implements USBPD_DPM_EnterIdle(), called by the bare-metal DPM loop with
+  * interrupts masked when no PD task is due. The mode depends on the port
+  * state and on the time left until the next DPM deadline:
+  *
+  *  - Sleep: a port is attached, so PE/PRL timers and USB traffic need the
+  *    1 ms SysTick. Any interrupt (UCPD, USB, DMA, SysTick) ends it.
+  *  - Tickless Sleep: all ports detached, so the PD timers are idle and
+  *    SysTick is stopped. The RTC wakeup timer ends it at the deadline,
+  *    DMA transfers keep running and their interrupts end it too.
+  *  - Stop 1: as tickless, and no DMA channel is running apart from the
+  *    VBUS ring, which is suspended. UCPD (attach, EXTI 43) and the RTC
+  *    wakeup timer (EXTI 20) end it. USB cannot be active without an
+  *    attached port.
+  *
+  * The time spent without SysTick is measured with the RTC calendar and
+  * added to the HAL tick before interrupts are unmasked, so HAL_GetTick()
+  * based deadlines stay valid.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_LOWPOWER_H
+#define __USBPD_LOWPOWER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define LPM_TICKLESS_MIN_MS       4U      /* Shortest idle period without SysTick */
+#define LPM_STOP_MIN_MS           20U     /* Shortest idle period in Stop 1       */
+#define LPM_RTC_MAX_MS            30000U  /* Wakeup timer range at RTCCLK/16      */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  LPM_MODE_SLEEP = 0,       /* WFI, SysTick running                    */
+  LPM_MODE_TICKLESS,        /* WFI, SysTick stopped                    */
+  LPM_MODE_STOP,            /* Stop 1                                  */
+} LPM_ModeTypeDef;
+
+typedef struct
+{
+  uint32_t Uptime;          /* ms since the statistics were reset      */
+  uint32_t Sleep;           /* ms per mode                             */
+  uint32_t Tickless;
+  uint32_t Stop;
+  uint32_t Sleeps;          /* Entries per mode                        */
+  uint32_t TicklessSleeps;
+  uint32_t Stops;
+  uint32_t StopDenied;      /* Stop possible but a DMA channel busy    */
+  uint32_t WakeRtc;         /* Wake-ups per source                     */
+  uint32_t WakeUcpd;
+  uint32_t WakeUsb;
+  uint32_t WakeDma;
+  uint32_t WakeTick;
+  uint32_t WakeOther;
+} LPM_StatsTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void LPM_Init(void);
+void LPM_SetMode(LPM_ModeTypeDef mode);
+void LPM_GetStats(LPM_StatsTypeDef *stats);
+void LPM_ResetStats(void);
+void LPM_RTC_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_LOWPOWER_H */
@@ -0,0 +1,342 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_partner_info.c
+  * @brief   Cache of the extended information sent by the port partner.
+  ******************************************************************************
+  * @attention
+  *
+  * The PE hands over the data blocks of the extended messages in the order
+  * they are received, possibly shorter than the structures of usbpd_def.h
+  * (a PD3.0 source sends no EPR Source PDP). Missing bytes read as zero.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "main.h"
+#include "console.h"
+#include "usbpd_core.h"
+#include "usbpd_dpm_core.h"
+#include "usbpd_dpm_user.h"
+#include "usbpd_partner_info.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PTN_MIDB_HEADER_SIZE      4U      /* VID + PID before the string        */
+#define PTN_PPS_MV_UNKNOWN        0xFFFFU
+#define PTN_PPS_MA_UNKNOWN        0xFFU
+
+/* Private variables ---------------------------------------------------------*/
+static PTN_InfoTypeDef PTN_Ports[USBPD_PORT_COUNT];
+
+/* Private function prototypes -----------------------------------------------*/
+static void               PTN_Update(uint8_t PortNum, uint8_t Item, void *Dst, uint32_t DstSize,
+                                     const uint8_t *Ptr, uint32_t Size);
+static USBPD_StatusTypeDef PTN_Request(uint8_t PortNum, uint8_t Item);
+static uint32_t           PTN_Age(const PTN_InfoTypeDef *info, uint8_t Item);
+static void               PTN_Print(uint8_t PortNum);
+static int32_t            PTN_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef PTN_ConsoleCommand =
+{
+  .Name    = "pdinfo",
+  .Help    = "pdinfo [refresh] - cached extended capabilities, status and PPS status of the source",
+  .Handler = PTN_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void PTN_Update(uint8_t PortNum, uint8_t Item, void *Dst, uint32_t DstSize, const uint8_t *Ptr, uint32_t Size)
+{
+  uint8_t index = (uint8_t)__CLZ(__RBIT(Item));
+
+  (void)memset(Dst, 0, DstSize);
+  (void)memcpy(Dst, Ptr, (Size < DstSize) ? Size : DstSize);
+  PTN_Ports[PortNum].Valid      |= Item;
+  PTN_Ports[PortNum].Tick[index] = HAL_GetTick();
+}
+
+static USBPD_StatusTypeDef PTN_Request(uint8_t PortNum, uint8_t Item)
+{
+  USBPD_GMIDB_TypeDef gmidb;
+
+  switch (Item)
+  {
+    case PTN_ITEM_PPS_STATUS:
+      return USBPD_DPM_RequestGetPPS_Status(PortNum);
+    case PTN_ITEM_STATUS:
+      return USBPD_DPM_RequestGetStatus(PortNum);
+    case PTN_ITEM_SRC_CAPA_EXT:
+      return USBPD_DPM_RequestGetSourceCapabilityExt(PortNum);
+    case PTN_ITEM_MANU_INFO:
+      gmidb.ManufacturerInfoTarget = USBPD_MANUFINFO_TARGET_PORT_CABLE_PLUG;
+      gmidb.ManufacturerInfoRef    = 0U;
+      return USBPD_DPM_RequestGetManufacturerInfo(PortNum, USBPD_SOPTYPE_SOP, (uint8_t *)&gmidb);
+    default:
+      return USBPD_ERROR;
+  }
+}
+
+static uint32_t PTN_Age(const PTN_InfoTypeDef *info, uint8_t Item)
+{
+  return HAL_GetTick() - info->Tick[__CLZ(__RBIT(Item))];
+}
+
+/* One JSON line per port, built from several writes to stay within
+   CON_PRINTF_MAX */
+static void PTN_Print(uint8_t PortNum)
+{
+  const PTN_InfoTypeDef *info = &PTN_Ports[PortNum];
+  char name[sizeof(info->ManuInfo.ManuString) + 1U];
+  uint32_t i;
+
+  (void)CON_Printf("{\"port\":%u,\"contract\":%u,\"rev\":%u,\"requests\":%lu,\"alerts\":%lu,\"last_alert\":%u",
+                   (unsigned)PortNum, (unsigned)(USBPD_POWER_EXPLICITCONTRACT == DPM_Params[PortNum].PE_Power),
+                   (unsigned)DPM_Params[PortNum].PE_SpecRevision + 1U, (unsigned long)info->Requests,
+                   (unsigned long)info->Alerts, (unsigned)info->Alert.b.TypeAlert);
+
+  if ((info->Valid & PTN_ITEM_SRC_CAPA_EXT) != 0U)
+  {
+    (void)CON_Printf(",\"src_ext\":{\"vid\":%u,\"pid\":%u,\"xid\":%lu,\"fw\":%u,\"hw\":%u,\"pdp\":%u,\"epr_pdp\":%u,"
+                     "\"holdup\":%u,\"inputs\":%u,\"batteries\":%u,\"touch_temp\":%u,\"age_ms\":%lu}",
+                     (unsigned)info->SrcCapaExt.VID, (unsigned)info->SrcCapaExt.PID,
+                     (unsigned long)info->SrcCapaExt.XID, (unsigned)info->SrcCapaExt.FW_revision,
+                     (unsigned)info->SrcCapaExt.HW_revision, (unsigned)info->SrcCapaExt.SourcePDP,
+                     (unsigned)info->SrcCapaExt.EPRSourcePDP, (unsigned)info->SrcCapaExt.Holdup_time,
+                     (unsigned)info->SrcCapaExt.Source_inputs, (unsigned)info->SrcCapaExt.NbBatteries,
+                     (unsigned)info->SrcCapaExt.Touchtemp, (unsigned long)PTN_Age(info, PTN_ITEM_SRC_CAPA_EXT));
+  }
+  else
+  {
+    (void)CON_Printf(",\"src_ext\":null");
+  }
+
+  if ((info->Valid & PTN_ITEM_STATUS) != 0U)
+  {
+    (void)CON_Printf(",\"status\":{\"temp\":%u,\"input\":%u,\"events\":%u,\"temp_status\":%u,\"power\":%u,"
+                     "\"age_ms\":%lu}",
+                     (unsigned)info->Status.InternalTemp, (unsigned)info->Status.PresentInput,
+                     (unsigned)info->Status.EventFlags, (unsigned)info->Status.TemperatureStatus,
+                     (unsigned)info->Status.PowerStatus, (unsigned long)PTN_Age(info, PTN_ITEM_STATUS));
+  }
+  else
+  {
+    (void)CON_Printf(",\"status\":null");
+  }
+
+  if ((info->Valid & PTN_ITEM_PPS_STATUS) != 0U)
+  {
+    (void)CON_Printf(",\"pps\":{\"mv\":%ld,\"ma\":%ld,\"flags\":%u,\"age_ms\":%lu}",
+                     (info->PpsStatus.fields.OutputVoltageIn20mVunits == PTN_PPS_MV_UNKNOWN)
+                       ? -1L : (long)info->PpsStatus.fields.OutputVoltageIn20mVunits * 20L,
+                     (info->PpsStatus.fields.OutputCurrentIn50mAunits == PTN_PPS_MA_UNKNOWN)
+                       ? -1L : (long)info->PpsStatus.fields.OutputCurrentIn50mAunits * 50L,
+                     (unsigned)info->PpsStatus.fields.RealTimeFlags,
+                     (unsigned long)PTN_Age(info, PTN_ITEM_PPS_STATUS));
+  }
+  else
+  {
+    (void)CON_Printf(",\"pps\":null");
+  }
+
+  if ((info->Valid & PTN_ITEM_MANU_INFO) != 0U)
+  {
+    /* Vendor defined bytes: keep printable ASCII that needs no escaping */
+    for (i = 0U; (i < info->ManuLength) && (info->ManuInfo.ManuString[i] != 0U); i++)
+    {
+      name[i] = ((info->ManuInfo.ManuString[i] < 0x20U) || (info->ManuInfo.ManuString[i] > 0x7EU)
+                 || (info->ManuInfo.ManuString[i] == '"') || (info->ManuInfo.ManuString[i] == '\\'))
+                ? '?' : (char)info->ManuInfo.ManuString[i];
+    }
+    name[i] = '\0';
+    (void)CON_Printf(",\"manu\":{\"vid\":%u,\"pid\":%u,\"name\":\"%s\"}}\r\n",
+                     (unsigned)info->ManuInfo.VID, (unsigned)info->ManuInfo.PID, name);
+  }
+  else
+  {
+    (void)CON_Printf(",\"manu\":null}\r\n");
+  }
+}
+
+static int32_t PTN_Command(int32_t argc, char *argv[])
+{
+  uint8_t port;
+
+  if (argc > 1)
+  {
+    if (strcmp(argv[1], "refresh") != 0)
+    {
+      return 1;
+    }
+    for (port = 0U; port < USBPD_PORT_COUNT; port++)
+    {
+      PTN_Refresh(port, PTN_ITEM_ALL);
+    }
+  }
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    PTN_Print(port);
+  }
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Clears the cache of all ports
+  * @note   Registers the "pdinfo" console command.
+  * @retval None
+  */
+void PTN_Init(void)
+{
+  uint8_t port;
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    PTN_Reset(port);
+  }
+  (void)CON_Register(&PTN_ConsoleCommand);
+}
+
+/**
+  * @brief  Forgets the partner (detach, hard reset)
+  * @note   The static items are requested again after the next contract.
+  * @param  PortNum Port number
+  * @retval None
+  */
+void PTN_Reset(uint8_t PortNum)
+{
+  (void)memset(&PTN_Ports[PortNum], 0, sizeof(PTN_Ports[PortNum]));
+  PTN_Ports[PortNum].Pending = PTN_ITEM_STATUS | PTN_ITEM_SRC_CAPA_EXT | PTN_ITEM_MANU_INFO;
+}
+
+/**
+  * @brief  Reports an explicit contract
+  * @param  PortNum Port number
+  * @param  Rdo     Request accepted by the source
+  * @param  IsPPS   1 for a programmable supply contract
+  * @retval None
+  */
+void PTN_Contract(uint8_t PortNum, uint32_t Rdo, uint8_t IsPPS)
+{
+  PTN_InfoTypeDef *info = &PTN_Ports[PortNum];
+
+  if (IsPPS == 0U)
+  {
+    info->Valid   &= (uint8_t)~PTN_ITEM_PPS_STATUS;
+    info->Pending &= (uint8_t)~PTN_ITEM_PPS_STATUS;
+  }
+  else if (Rdo != info->Rdo)
+  {
+    info->Pending |= PTN_ITEM_PPS_STATUS;
+  }
+  info->Rdo = Rdo;
+}
+
+/**
+  * @brief  Stores a data block received from the partner
+  * @param  PortNum Port number
+  * @param  DataId  Type of data, as passed to USBPD_DPM_SetDataInfo()
+  * @param  Ptr     Data block
+  * @param  Size    Data block size in bytes
+  * @retval 1 if the data belongs to the cache, 0 otherwise
+  */
+uint8_t PTN_Store(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef DataId, const uint8_t *Ptr, uint32_t Size)
+{
+  PTN_InfoTypeDef *info = &PTN_Ports[PortNum];
+
+  switch (DataId)
+  {
+    case USBPD_CORE_EXTENDED_CAPA:
+      PTN_Update(PortNum, PTN_ITEM_SRC_CAPA_EXT, &info->SrcCapaExt, sizeof(info->SrcCapaExt), Ptr, Size);
+      break;
+    case USBPD_CORE_INFO_STATUS:
+      PTN_Update(PortNum, PTN_ITEM_STATUS, &info->Status, sizeof(info->Status), Ptr, Size);
+      break;
+    case USBPD_CORE_PPS_STATUS:
+      PTN_Update(PortNum, PTN_ITEM_PPS_STATUS, &info->PpsStatus, sizeof(info->PpsStatus), Ptr, Size);
+      break;
+    case USBPD_CORE_MANUFACTURER_INFO:
+      PTN_Update(PortNum, PTN_ITEM_MANU_INFO, &info->ManuInfo, sizeof(info->ManuInfo), Ptr, Size);
+      info->ManuLength = (Size <= PTN_MIDB_HEADER_SIZE) ? 0U
+                         : (uint8_t)(((Size - PTN_MIDB_HEADER_SIZE) < sizeof(info->ManuInfo.ManuString))
+                                     ? (Size - PTN_MIDB_HEADER_SIZE) : sizeof(info->ManuInfo.ManuString));
+      break;
+    case USBPD_CORE_ALERT:
+      (void)memcpy(&info->Alert, Ptr, (Size < sizeof(info->Alert)) ? Size : sizeof(info->Alert));
+      info->Alerts++;
+      /* The source expects a Get_Status after an Alert */
+      info->Pending |= PTN_ITEM_STATUS;
+      if ((info->Valid & PTN_ITEM_PPS_STATUS) != 0U)
+      {
+        info->Pending |= PTN_ITEM_PPS_STATUS;
+      }
+      break;
+    default:
+      return 0U;
+  }
+
+  return 1U;
+}
+
+/**
+  * @brief  Requests cached items again
+  * @param  PortNum Port number
+  * @param  Items   Combination of PTN_ITEM_xxx
+  * @retval None
+  */
+void PTN_Refresh(uint8_t PortNum, uint8_t Items)
+{
+  PTN_InfoTypeDef *info = &PTN_Ports[PortNum];
+
+  if (info->Rdo == 0U)
+  {
+    Items &= (uint8_t)~PTN_ITEM_PPS_STATUS;
+  }
+  info->Pending |= Items;
+}
+
+/**
+  * @brief  Sends the next pending request of each port
+  * @note   Called from USBPD_DPM_UserExecute(), after the sink requests so
+  *         that a renegotiation always goes first.
+  * @retval None
+  */
+void PTN_Process(void)
+{
+  PTN_InfoTypeDef *info;
+  uint8_t port;
+  uint8_t item;
+
+  for (port = 0U; port < USBPD_PORT_COUNT; port++)
+  {
+    info = &PTN_Ports[port];
+    if ((info->Pending == 0U) || (USBPD_POWER_EXPLICITCONTRACT != DPM_Params[port].PE_Power))
+    {
+      continue;
+    }
+    if (USBPD_SPECIFICATION_REV3 != DPM_Params[port].PE_SpecRevision)
+    {
+      /* No extended messages in PD2.0 */
+      info->Pending = 0U;
+      continue;
+    }
+
+    /* Lowest bit first: the most volatile item */
+    item = info->Pending & (uint8_t)(0U - info->Pending);
+    if (USBPD_OK == PTN_Request(port, item))
+    {
+      info->Pending &= (uint8_t)~item;
+      info->Requests++;
+    }
+  }
+}
+
+/**
+  * @brief  Cache of a port
+  * @param  PortNum Port number
+  * @retval Pointer to the cache, updated from the DPM loop
+  */
+const PTN_InfoTypeDef *PTN_GetInfo(uint8_t PortNum)
+{
+  return &PTN_Ports[PortNum];
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_partner_info.h
+  * @brief   Cache of the extended information sent by the port partner.
+  ******************************************************************************
+  * @attention
+  *
+  * Keeps the last Source_Capabilities_Extended, Status, PPS_Status and
+  * Manufacturer_Info received on each port, as stored by the PE through
+  * USBPD_DPM_SetDataInfo(). Each item is requested once and refreshed only
+  * when it may have changed:
+  *
+  *  - Source_Capabilities_Extended, Manufacturer_Info: once per attach,
+  *    they describe the charger and never change during a connection.
+  *  - Status: once per attach, then after each Alert from the source.
+  *  - PPS_Status: after each PPS contract with a new RDO and after an
+  *    Alert. PPS keep-alive requests repeat the RDO and cost nothing.
+  *
+  * Requests are sent one at a time from the DPM loop while the port has
+  * an explicit PD3.0 contract. A request refused by a busy PE is retried
+  * on the next pass, a partner answering Not_Supported is not asked again.
+  * The "pdinfo" console command prints the cache.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_PARTNER_INFO_H
+#define __USBPD_PARTNER_INFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_def.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Cached items, PTN_InfoTypeDef Valid/Pending bits */
+#define PTN_ITEM_PPS_STATUS       0x01U
+#define PTN_ITEM_STATUS           0x02U
+#define PTN_ITEM_SRC_CAPA_EXT     0x04U
+#define PTN_ITEM_MANU_INFO        0x08U
+#define PTN_ITEM_ALL              0x0FU
+#define PTN_ITEM_COUNT            4U
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint8_t              Valid;       /* Items received since attach           */
+  uint8_t              Pending;     /* Items to be requested                 */
+  uint8_t              ManuLength;  /* Bytes used in ManuInfo.ManuString     */
+  USBPD_SCEDB_TypeDef  SrcCapaExt;
+  USBPD_SDB_TypeDef    Status;
+  USBPD_PPSSDB_TypeDef PpsStatus;
+  USBPD_MIDB_TypeDef   ManuInfo;
+  USBPD_ADO_TypeDef    Alert;       /* Last Alert data object                */
+  uint32_t             Rdo;         /* Contract in place                     */
+  uint32_t             Tick[PTN_ITEM_COUNT]; /* HAL tick of the last update  */
+  uint32_t             Requests;    /* Messages sent since attach            */
+  uint32_t             Alerts;
+} PTN_InfoTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void                   PTN_Init(void);
+void                   PTN_Reset(uint8_t PortNum);
+void                   PTN_Contract(uint8_t PortNum, uint32_t Rdo, uint8_t IsPPS);
+uint8_t                PTN_Store(uint8_t PortNum, USBPD_CORE_DataInfoType_TypeDef DataId,
+                                 const uint8_t *Ptr, uint32_t Size);
+void                   PTN_Refresh(uint8_t PortNum, uint8_t Items);
+void                   PTN_Process(void);
+const PTN_InfoTypeDef *PTN_GetInfo(uint8_t PortNum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_PARTNER_INFO_H */
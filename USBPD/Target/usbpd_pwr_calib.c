@@ -0,0 +1,200 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_pwr_calib.c
+  * @brief   Conversion model between ADC codes and VBUS/IBUS values.
+  ******************************************************************************
+  * @attention
+  *
+  * Intermediate products are computed on 64 bits: a 25 V divider ratio and
+  * a Q16 trim overflow 32 bits long before the ADC range does.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "usbpd_pwr_calib.h"
+
+/* Private functions ---------------------------------------------------------*/
+static int64_t PWRC_DivRound(int64_t num, int64_t den)
+{
+  if (den == 0)
+  {
+    return 0;
+  }
+  if ((num < 0) != (den < 0))
+  {
+    return (num - (den / 2)) / den;
+  }
+  return (num + (den / 2)) / den;
+}
+
+/* Divider input before trims, in mV, rounded once so a code and its
+   inverse round-trip */
+static int64_t PWRC_VbusRaw(const PWRC_ModelTypeDef *model, uint32_t code, uint32_t vdda)
+{
+  return PWRC_DivRound((int64_t)code * vdda * model->DividerNum, (int64_t)PWRC_FULL_SCALE * model->DividerDen);
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Computes the analog supply from the VREFINT conversion
+  * @param  model: Conversion model
+  * @param  vrefint: VREFINT code, 0 to get the calibration VDDA
+  * @retval VDDA in mV
+  */
+uint32_t PWRC_Vdda(const PWRC_ModelTypeDef *model, uint32_t vrefint)
+{
+  if ((vrefint == 0U) || (model->VrefintCal == 0U))
+  {
+    return model->VrefintCalVdda;
+  }
+  return (uint32_t)PWRC_DivRound((int64_t)model->VrefintCalVdda * model->VrefintCal, vrefint);
+}
+
+/**
+  * @brief  Converts an ADC code into the voltage at the pin
+  * @param  code: 12-bit code
+  * @param  vdda: Analog supply in mV
+  * @retval Pin voltage in mV
+  */
+uint32_t PWRC_PinVoltage(uint32_t code, uint32_t vdda)
+{
+  return (uint32_t)PWRC_DivRound((int64_t)code * vdda, PWRC_FULL_SCALE);
+}
+
+/**
+  * @brief  Converts a VBUS channel code into VBUS
+  * @param  model: Conversion model
+  * @param  code: 12-bit code of the divider output
+  * @param  vdda: Analog supply in mV
+  * @retval VBUS in mV
+  */
+uint32_t PWRC_Vbus(const PWRC_ModelTypeDef *model, uint32_t code, uint32_t vdda)
+{
+  int64_t vbus = PWRC_DivRound(PWRC_VbusRaw(model, code, vdda) * model->VbusGain, PWRC_GAIN_ONE)
+               + model->VbusOffset;
+
+  return (vbus > 0) ? (uint32_t)vbus : 0U;
+}
+
+/**
+  * @brief  Converts an IBUS channel code into IBUS
+  * @param  model: Conversion model
+  * @param  code: 12-bit code of the current sense amplifier output
+  * @param  vdda: Analog supply in mV
+  * @retval IBUS in mA, positive when the sink draws current
+  */
+int32_t PWRC_Ibus(const PWRC_ModelTypeDef *model, uint32_t code, uint32_t vdda)
+{
+  int64_t ibus;
+
+  if (model->IbusSensitivity == 0U)
+  {
+    return 0;
+  }
+  ibus = PWRC_DivRound(((int64_t)PWRC_PinVoltage(code, vdda) - model->IbusZero) * 1000, model->IbusSensitivity);
+
+  return (int32_t)PWRC_DivRound(ibus * model->IbusGain, PWRC_GAIN_ONE);
+}
+
+/**
+  * @brief  Inverse of PWRC_Vbus(), used for analog watchdog thresholds
+  * @param  model: Conversion model
+  * @param  vbus: VBUS in mV
+  * @param  vdda: Analog supply in mV
+  * @retval 12-bit code, saturated to the ADC range
+  */
+uint32_t PWRC_VbusToCode(const PWRC_ModelTypeDef *model, uint32_t vbus, uint32_t vdda)
+{
+  int64_t raw;
+  int64_t code;
+
+  if ((model->VbusGain <= 0) || (model->DividerNum == 0U) || (vdda == 0U))
+  {
+    return PWRC_FULL_SCALE;
+  }
+
+  raw  = PWRC_DivRound(((int64_t)vbus - model->VbusOffset) * PWRC_GAIN_ONE, model->VbusGain);
+  if (raw > ((int64_t)vdda * model->DividerNum))
+  {
+    return PWRC_FULL_SCALE; /* Beyond the divider range, keeps the product below */
+  }
+  code = PWRC_DivRound(raw * model->DividerDen * PWRC_FULL_SCALE, (int64_t)model->DividerNum * vdda);
+
+  if (code < 0)
+  {
+    return 0U;
+  }
+  return (code > (int64_t)PWRC_FULL_SCALE) ? PWRC_FULL_SCALE : (uint32_t)code;
+}
+
+/**
+  * @brief  Two point VBUS trim
+  * @param  model: Conversion model, VbusGain and VbusOffset are updated on success
+  * @param  code1: Code measured with vbus1 applied
+  * @param  vbus1: Reference voltage in mV
+  * @param  code2: Code measured with vbus2 applied
+  * @param  vbus2: Reference voltage in mV, different from vbus1
+  * @param  vdda: Analog supply during both measurements
+  * @retval 0 on success, -1 if the points do not define a slope
+  */
+int32_t PWRC_TrimVbus(PWRC_ModelTypeDef *model, uint32_t code1, uint32_t vbus1,
+                      uint32_t code2, uint32_t vbus2, uint32_t vdda)
+{
+  int64_t raw1 = PWRC_VbusRaw(model, code1, vdda);
+  int64_t raw2 = PWRC_VbusRaw(model, code2, vdda);
+  int64_t gain;
+
+  if ((raw1 == raw2) || (vbus1 == vbus2))
+  {
+    return -1;
+  }
+
+  gain = PWRC_DivRound(((int64_t)vbus2 - vbus1) * PWRC_GAIN_ONE, raw2 - raw1);
+  if (gain <= 0)
+  {
+    return -1;
+  }
+  model->VbusGain   = (int32_t)gain;
+  model->VbusOffset = (int32_t)((int64_t)vbus1 - PWRC_DivRound(raw1 * gain, PWRC_GAIN_ONE));
+
+  return 0;
+}
+
+/**
+  * @brief  Zero and gain IBUS trim
+  * @param  model: Conversion model, IbusZero and IbusGain are updated on success
+  * @param  code0: Code measured with no load
+  * @param  code1: Code measured with ibus1 flowing
+  * @param  ibus1: Reference current in mA, not 0
+  * @param  vdda: Analog supply during both measurements
+  * @retval 0 on success, -1 if the points do not define a gain
+  */
+int32_t PWRC_TrimIbus(PWRC_ModelTypeDef *model, uint32_t code0, uint32_t code1, int32_t ibus1, uint32_t vdda)
+{
+  int64_t zero;
+  int64_t ibus;
+  int64_t gain;
+
+  if ((ibus1 == 0) || (model->IbusSensitivity == 0U))
+  {
+    return -1;
+  }
+
+  zero = PWRC_PinVoltage(code0, vdda);
+  ibus = PWRC_DivRound(((int64_t)PWRC_PinVoltage(code1, vdda) - zero) * 1000, model->IbusSensitivity);
+  if (ibus == 0)
+  {
+    return -1;
+  }
+
+  gain = PWRC_DivRound((int64_t)ibus1 * PWRC_GAIN_ONE, ibus);
+  if (gain <= 0)
+  {
+    return -1;
+  }
+  model->IbusZero = (int32_t)zero;
+  model->IbusGain = (int32_t)gain;
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_pwr_calib.h
+  * @brief   Conversion model between ADC codes and VBUS/IBUS values.
+  ******************************************************************************
+  * @attention
+  *
+  * Pure integer arithmetic, no peripheral access: the model can be built and
+  * checked on a host with recorded ADC codes.
+  *
+  *   VDDA  = VrefintCalVdda * VrefintCal / vrefint_code
+  *   Vpin  = code * VDDA / PWRC_FULL_SCALE
+  *   VBUS  = (Vpin * DividerNum / DividerDen) * VbusGain / 2^16 + VbusOffset
+  *   IBUS  = (Vpin - IbusZero) * 1000 / IbusSensitivity * IbusGain / 2^16
+  *
+  * VbusGain, VbusOffset, IbusZero and IbusGain are board trims obtained with
+  * PWRC_TrimVbus()/PWRC_TrimIbus() from two reference points.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_PWR_CALIB_H
+#define __USBPD_PWR_CALIB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define PWRC_FULL_SCALE           4095U   /* 12-bit result after oversampling shift */
+#define PWRC_GAIN_ONE             65536   /* Q16 unity trim                        */
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t VrefintCal;      /* Factory VREFINT code                    */
+  uint16_t VrefintCalVdda;  /* VDDA of the factory measurement (mV)    */
+  uint32_t DividerNum;      /* VBUS = Vpin * DividerNum / DividerDen   */
+  uint32_t DividerDen;
+  int32_t  VbusGain;        /* Q16 trim                                */
+  int32_t  VbusOffset;      /* mV                                      */
+  uint32_t IbusSensitivity; /* Amplifier output in mV per A            */
+  int32_t  IbusZero;        /* Amplifier output at 0 A (mV)            */
+  int32_t  IbusGain;        /* Q16 trim                                */
+} PWRC_ModelTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t PWRC_Vdda(const PWRC_ModelTypeDef *model, uint32_t vrefint);
+uint32_t PWRC_PinVoltage(uint32_t code, uint32_t vdda);
+uint32_t PWRC_Vbus(const PWRC_ModelTypeDef *model, uint32_t code, uint32_t vdda);
+int32_t  PWRC_Ibus(const PWRC_ModelTypeDef *model, uint32_t code, uint32_t vdda);
+uint32_t PWRC_VbusToCode(const PWRC_ModelTypeDef *model, uint32_t vbus, uint32_t vdda);
+int32_t  PWRC_TrimVbus(PWRC_ModelTypeDef *model, uint32_t code1, uint32_t vbus1,
+                       uint32_t code2, uint32_t vbus2, uint32_t vdda);
+int32_t  PWRC_TrimIbus(PWRC_ModelTypeDef *model, uint32_t code0, uint32_t code1, int32_t ibus1, uint32_t vdda);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_PWR_CALIB_H */
@@ -0,0 +1,536 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_pwr_sense.c
+  * @brief   VBUS/IBUS measurement with ADC1, DMA and analog watchdog.
+  ******************************************************************************
+  * @attention
+  *
+  * The HAL/LL ADC drivers are not part of this project, the ADC is set up
+  * with CMSIS register accesses following the RM0440 start-up sequence:
+  * exit deep power down, regulator start-up, single-ended calibration, then
+  * ADEN. The DMA channel uses the LL driver like the UCPD channels.
+  *
+  * Conversion time per channel is (247.5 + 12.5) cycles x 16 at 42.5 MHz,
+  * about 98 us, so one VBUS/IBUS/VREFINT sequence takes ~300 us and the
+  * averaging buffer spans ~5 ms.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "console.h"
+#include "usbpd_pwr_sense.h"
+#include "usbpd_pwr_user.h"
+
+/* Private define ------------------------------------------------------------*/
+#define PWRS_CHANNELS             3U      /* VBUS, IBUS, VREFINT per sequence   */
+#define PWRS_SLOT_VBUS            0U
+#define PWRS_SLOT_IBUS            1U
+#define PWRS_SLOT_VREFINT         2U
+#define PWRS_SAMPLES              (PWRS_SEQUENCES * PWRS_CHANNELS)
+
+#define PWRS_SMP_247CYCLES        6U      /* SMPx code for 247.5 ADC cycles     */
+#define PWRS_OVS_RATIO_16         3U      /* OVSR code for 16x                  */
+#define PWRS_OVS_SHIFT_4          4U      /* Back to 12 bits                    */
+#define PWRS_HYSTERESIS           8U      /* Watchdog hysteresis in codes       */
+#define PWRS_STOP_SPIN            20000U  /* ADSTP polls, > one conversion      */
+
+/* Factory VREFINT calibration (RM0440, 3.0 V, 30 degC) */
+#define PWRS_VREFINT_CAL_ADDR     ((const uint16_t *)0x1FFF75AAUL)
+#define PWRS_VREFINT_CAL_VDDA     3000U
+
+/* CR bits with "rs" property must not be written back as read */
+#define PWRS_ADC_CR_RS            (ADC_CR_ADCAL | ADC_CR_JADSTP | ADC_CR_ADSTP | ADC_CR_JADSTART \
+                                   | ADC_CR_ADSTART | ADC_CR_ADDIS | ADC_CR_ADEN)
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint16_t PwrsSamples[PWRS_SAMPLES];
+static PWRC_ModelTypeDef PwrsModel =
+{
+  .VrefintCal      = 0U,
+  .VrefintCalVdda  = PWRS_VREFINT_CAL_VDDA,
+  .DividerNum      = PWRS_DIVIDER_NUM,
+  .DividerDen      = PWRS_DIVIDER_DEN,
+  .VbusGain        = PWRC_GAIN_ONE,
+  .VbusOffset      = 0,
+  .IbusSensitivity = PWRS_IBUS_SENSITIVITY,
+  .IbusZero        = 0,
+  .IbusGain        = PWRC_GAIN_ONE,
+};
+static uint32_t PwrsThreshold0V     = USBPD_PWR_LOW_VBUS_THRESHOLD;
+static uint32_t PwrsThresholdOn     = USBPD_PWR_HIGH_VBUS_THRESHOLD;
+static uint32_t PwrsCode0V;
+static uint32_t PwrsCodeOn;
+static volatile uint8_t  PwrsLevel  = PWRS_LEVEL_VSAFE0V;
+static volatile uint32_t PwrsEvents;
+static uint8_t  PwrsReady;
+static uint8_t  PwrsSuspended;
+
+/* Private function prototypes -----------------------------------------------*/
+static PWRS_StatusTypeDef PWRS_AdcWait(volatile uint32_t *reg, uint32_t mask, uint32_t set);
+static void               PWRS_Average(uint32_t code[PWRS_CHANNELS]);
+static uint32_t           PWRS_LastVbus(void);
+static PWRS_LevelTypeDef  PWRS_Classify(uint32_t code, PWRS_LevelTypeDef level);
+static void               PWRS_SetWindow(PWRS_LevelTypeDef level);
+static void               PWRS_UpdateCodes(uint32_t vdda);
+static int32_t            PWRS_Command(int32_t argc, char *argv[]);
+
+static const CON_CommandTypeDef PWRS_ConsoleCommand =
+{
+  .Name    = "vbus",
+  .Help    = "vbus - VBUS/IBUS telemetry",
+  .Handler = PWRS_Command,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/* Polls until the 'mask' bits of an ADC register equal 'set' */
+static PWRS_StatusTypeDef PWRS_AdcWait(volatile uint32_t *reg, uint32_t mask, uint32_t set)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while ((*reg & mask) != set)
+  {
+    if ((HAL_GetTick() - tickstart) > PWRS_INIT_TIMEOUT)
+    {
+      return PWRS_TIMEOUT;
+    }
+  }
+  return PWRS_OK;
+}
+
+/* Mean code of each slot over the DMA ring */
+static void PWRS_Average(uint32_t code[PWRS_CHANNELS])
+{
+  uint32_t sum[PWRS_CHANNELS] = {0U};
+  uint32_t index;
+  uint32_t slot;
+
+  for (index = 0U; index < PWRS_SAMPLES; index += PWRS_CHANNELS)
+  {
+    for (slot = 0U; slot < PWRS_CHANNELS; slot++)
+    {
+      sum[slot] += PwrsSamples[index + slot];
+    }
+  }
+  for (slot = 0U; slot < PWRS_CHANNELS; slot++)
+  {
+    code[slot] = (sum[slot] + (PWRS_SEQUENCES / 2U)) / PWRS_SEQUENCES;
+  }
+}
+
+/* Most recent VBUS conversion stored by the DMA */
+static uint32_t PWRS_LastVbus(void)
+{
+  uint32_t next = PWRS_SAMPLES - LL_DMA_GetDataLength(DMA1, LL_DMA_CHANNEL_5);
+  uint32_t last = (next == 0U) ? (PWRS_SAMPLES - 1U) : (next - 1U);
+
+  return PwrsSamples[last - (last % PWRS_CHANNELS) + PWRS_SLOT_VBUS];
+}
+
+/* Level of a VBUS code, with hysteresis around the current level */
+static PWRS_LevelTypeDef PWRS_Classify(uint32_t code, PWRS_LevelTypeDef level)
+{
+  switch (level)
+  {
+    case PWRS_LEVEL_VSAFE0V:
+      if (code <= (PwrsCode0V + PWRS_HYSTERESIS))
+      {
+        return level;
+      }
+      break;
+    case PWRS_LEVEL_TRANSITION:
+      if ((code >= PwrsCode0V) && (code <= PwrsCodeOn))
+      {
+        return level;
+      }
+      break;
+    default:
+      if ((code + PWRS_HYSTERESIS) >= PwrsCodeOn)
+      {
+        return level;
+      }
+      break;
+  }
+
+  if (code < PwrsCode0V)
+  {
+    return PWRS_LEVEL_VSAFE0V;
+  }
+  return (code > PwrsCodeOn) ? PWRS_LEVEL_PRESENT : PWRS_LEVEL_TRANSITION;
+}
+
+/* Watchdog window matching PWRS_Classify() for a level */
+static void PWRS_SetWindow(PWRS_LevelTypeDef level)
+{
+  uint32_t low;
+  uint32_t high;
+
+  switch (level)
+  {
+    case PWRS_LEVEL_VSAFE0V:
+      low  = 0U;
+      high = PwrsCode0V + PWRS_HYSTERESIS;
+      break;
+    case PWRS_LEVEL_TRANSITION:
+      low  = PwrsCode0V;
+      high = PwrsCodeOn;
+      break;
+    default:
+      low  = (PwrsCodeOn > PWRS_HYSTERESIS) ? (PwrsCodeOn - PWRS_HYSTERESIS) : 0U;
+      high = PWRC_FULL_SCALE;
+      break;
+  }
+  if (high > PWRC_FULL_SCALE)
+  {
+    high = PWRC_FULL_SCALE;
+  }
+
+  ADC1->TR1 = (ADC1->TR1 & ~(ADC_TR1_HT1 | ADC_TR1_LT1))
+            | (high << ADC_TR1_HT1_Pos) | (low << ADC_TR1_LT1_Pos);
+}
+
+static void PWRS_UpdateCodes(uint32_t vdda)
+{
+  PwrsCode0V = PWRC_VbusToCode(&PwrsModel, PwrsThreshold0V, vdda);
+  PwrsCodeOn = PWRC_VbusToCode(&PwrsModel, PwrsThresholdOn, vdda);
+  if (PwrsCodeOn <= PwrsCode0V)
+  {
+    PwrsCodeOn = PwrsCode0V + 1U;
+  }
+}
+
+static int32_t PWRS_Command(int32_t argc, char *argv[])
+{
+  static const char *const levels[] = { "vsafe0v", "transition", "present" };
+  PWRS_TelemetryTypeDef tm;
+
+  (void)argc;
+  (void)argv;
+
+  if (PwrsReady == 0U)
+  {
+    return 1;
+  }
+
+  PWRS_GetTelemetry(&tm);
+  (void)CON_Printf("{\"tick\":%lu,\"vbus_mv\":%lu,\"ibus_ma\":%ld,\"p_mw\":%ld,\"vdda_mv\":%lu,"
+                   "\"level\":\"%s\",\"events\":%lu}\r\n",
+                   (unsigned long)tm.Tick, (unsigned long)tm.Voltage, (long)tm.Current, (long)tm.Power,
+                   (unsigned long)tm.Vdda, levels[tm.Level], (unsigned long)tm.Events);
+  return 0;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Starts continuous VBUS/IBUS conversions and the VBUS watchdog
+  * @retval PWRS_OK, PWRS_TIMEOUT if the ADC did not respond
+  */
+PWRS_StatusTypeDef PWRS_Init(void)
+{
+  LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
+  uint32_t code[PWRS_CHANNELS];
+  uint32_t delay;
+
+  LL_AHB2_GRP1_EnableClock(LL_AHB2_GRP1_PERIPH_GPIOA);
+  LL_AHB2_GRP1_EnableClock(LL_AHB2_GRP1_PERIPH_ADC12);
+
+  /**ADC1 GPIO Configuration
+  PA0   ------> ADC1_IN1 (VBUS divider)
+  PA1   ------> ADC1_IN2 (IBUS amplifier)
+  */
+  GPIO_InitStruct.Pin = LL_GPIO_PIN_0 | LL_GPIO_PIN_1;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_ANALOG;
+  GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
+  LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+  PwrsModel.VrefintCal = *PWRS_VREFINT_CAL_ADDR;
+
+  /* Synchronous clock HCLK/4 (42.5 MHz at 170 MHz), VREFINT path on */
+  MODIFY_REG(ADC12_COMMON->CCR, ADC_CCR_CKMODE | ADC_CCR_PRESC, ADC_CCR_CKMODE_1 | ADC_CCR_CKMODE_0);
+  SET_BIT(ADC12_COMMON->CCR, ADC_CCR_VREFEN);
+
+  /* Leave deep power down, start the regulator (tADCVREG_STUP = 20 us) */
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS | ADC_CR_DEEPPWD | ADC_CR_ADVREGEN, ADC_CR_ADVREGEN);
+  HAL_Delay(1U);
+
+  /* Single-ended calibration */
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS | ADC_CR_ADCALDIF, ADC_CR_ADCAL);
+  if (PWRS_AdcWait(&ADC1->CR, ADC_CR_ADCAL, 0U) != PWRS_OK)
+  {
+    return PWRS_TIMEOUT;
+  }
+  /* At least 4 ADC clock cycles between ADCAL=0 and ADEN=1 */
+  for (delay = 0U; delay < 32U; delay++)
+  {
+    __NOP();
+  }
+
+  ADC1->CFGR = ADC_CFGR_JQDIS | ADC_CFGR_CONT | ADC_CFGR_OVRMOD | ADC_CFGR_DMAEN | ADC_CFGR_DMACFG
+             | ADC_CFGR_AWD1SGL | ADC_CFGR_AWD1EN | (PWRS_VBUS_CHANNEL << ADC_CFGR_AWD1CH_Pos);
+  ADC1->CFGR2 = ADC_CFGR2_ROVSE | (PWRS_OVS_RATIO_16 << ADC_CFGR2_OVSR_Pos)
+              | (PWRS_OVS_SHIFT_4 << ADC_CFGR2_OVSS_Pos);
+  ADC1->SMPR1 = (PWRS_SMP_247CYCLES << (PWRS_VBUS_CHANNEL * 3U))
+              | (PWRS_SMP_247CYCLES << (PWRS_IBUS_CHANNEL * 3U));
+  ADC1->SMPR2 = (PWRS_SMP_247CYCLES << ((PWRS_VREFINT_CHANNEL - 10U) * 3U));
+  ADC1->SQR1  = ((PWRS_CHANNELS - 1U) << ADC_SQR1_L_Pos)
+              | (PWRS_VBUS_CHANNEL << ADC_SQR1_SQ1_Pos)
+              | (PWRS_IBUS_CHANNEL << ADC_SQR1_SQ2_Pos)
+              | (PWRS_VREFINT_CHANNEL << ADC_SQR1_SQ3_Pos);
+  ADC1->DIFSEL = 0U;
+  ADC1->TR1 = (PWRC_FULL_SCALE << ADC_TR1_HT1_Pos);
+  ADC1->IER = 0U;
+
+  ADC1->ISR = ADC_ISR_ADRDY;
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADEN);
+  if (PWRS_AdcWait(&ADC1->ISR, ADC_ISR_ADRDY, ADC_ISR_ADRDY) != PWRS_OK)
+  {
+    return PWRS_TIMEOUT;
+  }
+
+  /* ADC1 DMA Init: circular ring of PWRS_SEQUENCES sequences */
+  LL_DMA_SetPeriphRequest(DMA1, LL_DMA_CHANNEL_5, LL_DMAMUX_REQ_ADC1);
+  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_5, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MODE_CIRCULAR);
+  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_5, LL_DMA_PDATAALIGN_HALFWORD);
+  LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_5, LL_DMA_MDATAALIGN_HALFWORD);
+  LL_DMA_ConfigAddresses(DMA1, LL_DMA_CHANNEL_5, (uint32_t)&ADC1->DR, (uint32_t)PwrsSamples,
+                         LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_5, PWRS_SAMPLES);
+  LL_DMA_ClearFlag_TC5(DMA1);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_5);
+
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADSTART);
+
+  /* Readers average the whole ring: wait until it has been filled once */
+  delay = HAL_GetTick();
+  while (LL_DMA_IsActiveFlag_TC5(DMA1) == 0U)
+  {
+    if ((HAL_GetTick() - delay) > (PWRS_INIT_TIMEOUT * 2U))
+    {
+      return PWRS_TIMEOUT;
+    }
+  }
+  LL_DMA_ClearFlag_TC5(DMA1);
+
+  PWRS_Average(code);
+  PWRS_UpdateCodes(PWRC_Vdda(&PwrsModel, code[PWRS_SLOT_VREFINT]));
+  PwrsLevel = PWRS_Classify(code[PWRS_SLOT_VBUS], PWRS_LEVEL_VSAFE0V);
+  PWRS_SetWindow((PWRS_LevelTypeDef)PwrsLevel);
+
+  ADC1->ISR = ADC_ISR_AWD1;
+  ADC1->IER = ADC_IER_AWD1IE;
+  NVIC_SetPriority(ADC1_2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 1, 0));
+  NVIC_EnableIRQ(ADC1_2_IRQn);
+
+  PwrsReady = 1U;
+  (void)CON_Register(&PWRS_ConsoleCommand);
+
+  return PWRS_OK;
+}
+
+/**
+  * @brief  Stops conversions and puts ADC1 in deep power down
+  * @retval None
+  */
+void PWRS_DeInit(void)
+{
+  NVIC_DisableIRQ(ADC1_2_IRQn);
+  ADC1->IER = 0U;
+  PwrsReady = 0U;
+  PwrsSuspended = 0U;
+
+  if ((ADC1->CR & ADC_CR_ADSTART) != 0U)
+  {
+    MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADSTP);
+    (void)PWRS_AdcWait(&ADC1->CR, ADC_CR_ADSTP, 0U);
+  }
+  if ((ADC1->CR & ADC_CR_ADEN) != 0U)
+  {
+    MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADDIS);
+    (void)PWRS_AdcWait(&ADC1->CR, ADC_CR_ADEN, 0U);
+  }
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_5);
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS | ADC_CR_ADVREGEN | ADC_CR_DEEPPWD, ADC_CR_DEEPPWD);
+}
+
+/**
+  * @brief  Stops conversions before the MCU enters Stop mode or the
+  *         system clock is switched
+  * @note   Called with interrupts masked, so the wait is bounded by a loop
+  *         count instead of the tick. ADC1 stays enabled and calibrated.
+  * @retval None
+  */
+void PWRS_Suspend(void)
+{
+  uint32_t spin;
+
+  if ((PwrsReady == 0U) || (PwrsSuspended != 0U))
+  {
+    return;
+  }
+
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADSTP);
+  for (spin = 0U; (spin < PWRS_STOP_SPIN) && ((ADC1->CR & ADC_CR_ADSTP) != 0U); spin++)
+  {
+  }
+  LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_5);
+  PwrsSuspended = 1U;
+}
+
+/**
+  * @brief  Restarts conversions after Stop mode or a clock switch
+  * @note   The ring restarts on a sequence boundary. It holds samples from
+  *         before the suspension until it has been filled again (~5 ms),
+  *         the watchdog acts on the first new VBUS conversion.
+  * @retval None
+  */
+void PWRS_Resume(void)
+{
+  if (PwrsSuspended == 0U)
+  {
+    return;
+  }
+  PwrsSuspended = 0U;
+
+  LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_5, PWRS_SAMPLES);
+  LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_5);
+  ADC1->ISR = ADC_ISR_OVR | ADC_ISR_EOC | ADC_ISR_EOS;
+  MODIFY_REG(ADC1->CR, PWRS_ADC_CR_RS, ADC_CR_ADSTART);
+}
+
+/**
+  * @brief  Averaged VBUS
+  * @retval VBUS in mV, 0 when the service is not running
+  */
+uint32_t PWRS_GetVoltage(void)
+{
+  uint32_t code[PWRS_CHANNELS];
+
+  if (PwrsReady == 0U)
+  {
+    return 0U;
+  }
+  PWRS_Average(code);
+  return PWRC_Vbus(&PwrsModel, code[PWRS_SLOT_VBUS], PWRC_Vdda(&PwrsModel, code[PWRS_SLOT_VREFINT]));
+}
+
+/**
+  * @brief  Averaged IBUS
+  * @retval IBUS in mA, 0 when the service is not running
+  */
+int32_t PWRS_GetCurrent(void)
+{
+  uint32_t code[PWRS_CHANNELS];
+
+  if (PwrsReady == 0U)
+  {
+    return 0;
+  }
+  PWRS_Average(code);
+  return PWRC_Ibus(&PwrsModel, code[PWRS_SLOT_IBUS], PWRC_Vdda(&PwrsModel, code[PWRS_SLOT_VREFINT]));
+}
+
+/**
+  * @brief  Consistent VBUS/IBUS/power snapshot, e.g. to tag capture frames
+  * @param  telemetry: Filled with the snapshot
+  * @retval None
+  */
+void PWRS_GetTelemetry(PWRS_TelemetryTypeDef *telemetry)
+{
+  uint32_t code[PWRS_CHANNELS] = {0U};
+
+  if (PwrsReady != 0U)
+  {
+    PWRS_Average(code);
+  }
+  telemetry->Tick    = HAL_GetTick();
+  telemetry->Vdda    = PWRC_Vdda(&PwrsModel, code[PWRS_SLOT_VREFINT]);
+  telemetry->Voltage = (PwrsReady != 0U) ? PWRC_Vbus(&PwrsModel, code[PWRS_SLOT_VBUS], telemetry->Vdda) : 0U;
+  telemetry->Current = (PwrsReady != 0U) ? PWRC_Ibus(&PwrsModel, code[PWRS_SLOT_IBUS], telemetry->Vdda) : 0;
+  telemetry->Power   = (int32_t)(((int64_t)telemetry->Voltage * telemetry->Current) / 1000);
+  telemetry->Level   = PwrsLevel;
+  telemetry->Events  = PwrsEvents;
+}
+
+/**
+  * @brief  VBUS level tracked by the analog watchdog
+  * @retval Current level
+  */
+PWRS_LevelTypeDef PWRS_GetLevel(void)
+{
+  return (PWRS_LevelTypeDef)PwrsLevel;
+}
+
+/**
+  * @brief  Sets the watchdog thresholds
+  * @param  vsafe0v: Upper bound of vSafe0V in mV
+  * @param  present: VBUS present / disconnection threshold in mV
+  * @retval None
+  */
+void PWRS_SetThresholds(uint32_t vsafe0v, uint32_t present)
+{
+  uint32_t code[PWRS_CHANNELS];
+
+  PwrsThreshold0V = vsafe0v;
+  PwrsThresholdOn = present;
+  if (PwrsReady == 0U)
+  {
+    return;
+  }
+
+  PWRS_Average(code);
+  NVIC_DisableIRQ(ADC1_2_IRQn);
+  PWRS_UpdateCodes(PWRC_Vdda(&PwrsModel, code[PWRS_SLOT_VREFINT]));
+  PWRS_SetWindow((PWRS_LevelTypeDef)PwrsLevel);
+  NVIC_EnableIRQ(ADC1_2_IRQn);
+}
+
+/**
+  * @brief  Conversion model in use, trims may be applied in place
+  * @note   Call PWRS_SetThresholds() afterwards to refresh the watchdog.
+  * @retval Pointer to the model
+  */
+PWRC_ModelTypeDef *PWRS_GetModel(void)
+{
+  return &PwrsModel;
+}
+
+/**
+  * @brief  ADC1 interrupt: VBUS left the watchdog window
+  * @retval None
+  */
+void PWRS_IRQHandler(void)
+{
+  PWRS_LevelTypeDef level;
+
+  if ((ADC1->ISR & ADC_ISR_AWD1) == 0U)
+  {
+    return;
+  }
+  ADC1->ISR = ADC_ISR_AWD1;
+
+  level = PWRS_Classify(PWRS_LastVbus(), (PWRS_LevelTypeDef)PwrsLevel);
+  if (level == (PWRS_LevelTypeDef)PwrsLevel)
+  {
+    return;
+  }
+
+  PwrsLevel = level;
+  PwrsEvents++;
+  PWRS_SetWindow(level);
+  PWRS_LevelCallback(level);
+}
+
+/**
+  * @brief  VBUS level change notification, called in interrupt context
+  * @param  level: New level
+  * @retval None
+  */
+__weak void PWRS_LevelCallback(PWRS_LevelTypeDef level)
+{
+  UNUSED(level);
+}
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file    usbpd_pwr_sense.h
+  * @brief   VBUS/IBUS measurement with ADC1, DMA and analog watchdog.
+  ******************************************************************************
+  * @attention
+  *
+  * ADC1 converts VBUS, IBUS and VREFINT continuously with 16x hardware
+  * oversampling. DMA1 channel 5 stores the results in a circular buffer of
+  * PWRS_SEQUENCES sequences which readers average on demand, so no interrupt
+  * is taken per conversion.
+  *
+  * The analog watchdog 1 watches the VBUS channel with a window around the
+  * current level (vSafe0V, transition, present). Leaving the window raises
+  * the ADC interrupt, which moves the window and calls PWRS_LevelCallback():
+  * attach and detach are seen within one sequence instead of a poll period.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __USBPD_PWR_SENSE_H
+#define __USBPD_PWR_SENSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "usbpd_pwr_calib.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Board wiring: VBUS divider on PA0, current sense amplifier on PA1 */
+#define PWRS_VBUS_CHANNEL         1U      /* ADC1_IN1                           */
+#define PWRS_IBUS_CHANNEL         2U      /* ADC1_IN2                           */
+#define PWRS_VREFINT_CHANNEL      18U     /* ADC1_IN18                          */
+
+#define PWRS_DIVIDER_NUM          115U    /* 100k / 15k divider                 */
+#define PWRS_DIVIDER_DEN          15U
+#define PWRS_IBUS_SENSITIVITY     500U    /* 10 mOhm shunt, 50 V/V: mV per A    */
+
+#define PWRS_SEQUENCES            16U     /* Sequences averaged by the readers  */
+#define PWRS_INIT_TIMEOUT         5U      /* ms                                 */
+#define PWRS_DMA_CHANNEL          DMA1_Channel5   /* Ring, stopped by PWRS_Suspend() */
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum
+{
+  PWRS_OK = 0,
+  PWRS_ERROR,
+  PWRS_TIMEOUT,
+} PWRS_StatusTypeDef;
+
+typedef enum
+{
+  PWRS_LEVEL_VSAFE0V = 0,   /* Below the vSafe0V threshold             */
+  PWRS_LEVEL_TRANSITION,    /* Between vSafe0V and the present level   */
+  PWRS_LEVEL_PRESENT,       /* Above the VBUS present threshold        */
+} PWRS_LevelTypeDef;
+
+typedef struct
+{
+  uint32_t Tick;            /* HAL_GetTick() of the snapshot           */
+  uint32_t Voltage;         /* VBUS mV                                 */
+  int32_t  Current;         /* IBUS mA                                 */
+  int32_t  Power;           /* mW                                      */
+  uint32_t Vdda;            /* mV                                      */
+  uint32_t Level;           /* PWRS_LevelTypeDef                       */
+  uint32_t Events;          /* Watchdog level changes since init       */
+} PWRS_TelemetryTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+PWRS_StatusTypeDef PWRS_Init(void);
+void               PWRS_DeInit(void);
+void               PWRS_Suspend(void);
+void               PWRS_Resume(void);
+uint32_t           PWRS_GetVoltage(void);
+int32_t            PWRS_GetCurrent(void);
+void               PWRS_GetTelemetry(PWRS_TelemetryTypeDef *telemetry);
+PWRS_LevelTypeDef  PWRS_GetLevel(void);
+void               PWRS_SetThresholds(uint32_t vsafe0v, uint32_t present);
+PWRC_ModelTypeDef *PWRS_GetModel(void);
+void               PWRS_IRQHandler(void);
+void               PWRS_LevelCallback(PWRS_LevelTypeDef level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBPD_PWR_SENSE_H */
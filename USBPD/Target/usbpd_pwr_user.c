@@ -27,6 +27,7 @@
 #endif /* _TRACE */
 
 /* USER CODE BEGIN include */
+#include "usbpd_pwr_sense.h"
 
 /* USER CODE END include */
 
@@ -76,6 +77,8 @@
   * @{
   */
 /* USER CODE BEGIN POWER_Private_Variables */
+static USBPD_PWR_VBUSDetectCallbackFunc *PWR_VBUSDetectCallback[USBPD_PWR_INSTANCES_NBR];
+static USBPD_PWR_VBUSConnectionStatusTypeDef PWR_VBUSStatus = VBUS_NOT_CONNECTED;
 
 /* USER CODE END POWER_Private_Variables */
 /**
@@ -263,9 +266,9 @@ __weak int32_t BSP_USBPD_PWR_VBUSInit(uint32_t Instance)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
-  else
+  else if (PWRS_Init() != PWRS_OK)
   {
-    PWR_DEBUG_TRACE(Instance, "ADVICE: Update BSP_USBPD_PWR_VBUSInit");
+    ret = BSP_ERROR_PERIPH_FAILURE;
   }
 
   return ret;
@@ -284,12 +287,16 @@ __weak int32_t BSP_USBPD_PWR_VBUSDeInit(uint32_t Instance)
 {
   /* USER CODE BEGIN BSP_USBPD_PWR_VBUSDeInit */
   /* Check if instance is valid       */
-  int32_t ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  int32_t ret = BSP_ERROR_NONE;
 
   if (Instance >= USBPD_PWR_INSTANCES_NBR)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
+  else
+  {
+    PWRS_DeInit();
+  }
   return ret;
   /* USER CODE END BSP_USBPD_PWR_VBUSDeInit */
 }
@@ -479,10 +486,10 @@ __weak int32_t BSP_USBPD_PWR_VBUSGetVoltage(uint32_t Instance, uint32_t *pVoltag
   }
   else
   {
-    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
-    PWR_DEBUG_TRACE(Instance, "ADVICE: Update BSP_USBPD_PWR_VBUSGetVoltage");
+    ret = BSP_ERROR_NONE;
+    val = PWRS_GetVoltage();
+    *pVoltage = val;
   }
-  *pVoltage = val;
   return ret;
   /* USER CODE END BSP_USBPD_PWR_VBUSGetVoltage */
 }
@@ -507,8 +514,8 @@ __weak int32_t BSP_USBPD_PWR_VBUSGetCurrent(uint32_t Instance, int32_t *pCurrent
   }
   else
   {
-    *pCurrent = 0;
-    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+    *pCurrent = PWRS_GetCurrent();
+    ret = BSP_ERROR_NONE;
   }
   return ret;
   /* USER CODE END BSP_USBPD_PWR_VBUSGetCurrent */
@@ -662,12 +669,16 @@ __weak int32_t BSP_USBPD_PWR_SetVBUSDisconnectionThreshold(uint32_t Instance,
 {
   /* USER CODE BEGIN BSP_USBPD_PWR_SetVBUSDisconnectionThreshold */
   /* Check if instance is valid       */
-  int32_t ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  int32_t ret = BSP_ERROR_NONE;
 
   if (Instance >= USBPD_PWR_INSTANCES_NBR)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
+  else
+  {
+    PWRS_SetThresholds(USBPD_PWR_LOW_VBUS_THRESHOLD, VoltageThreshold);
+  }
   return ret;
   /* USER CODE END BSP_USBPD_PWR_SetVBUSDisconnectionThreshold */
 }
@@ -689,12 +700,16 @@ __weak int32_t BSP_USBPD_PWR_RegisterVBUSDetectCallback(uint32_t  Instance,
 {
   /* USER CODE BEGIN BSP_USBPD_PWR_RegisterVBUSDetectCallback */
   /* Check if instance is valid       */
-  int32_t ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
+  int32_t ret = BSP_ERROR_NONE;
 
   if (Instance >= USBPD_PWR_INSTANCES_NBR)
   {
     ret = BSP_ERROR_WRONG_PARAM;
   }
+  else
+  {
+    PWR_VBUSDetectCallback[Instance] = pfnVBUSDetectCallback;
+  }
   return ret;
   /* USER CODE END BSP_USBPD_PWR_RegisterVBUSDetectCallback */
 }
@@ -720,8 +735,8 @@ __weak int32_t BSP_USBPD_PWR_VBUSIsOn(uint32_t Instance, uint8_t *pState)
   }
   else
   {
-    ret = BSP_ERROR_FEATURE_NOT_SUPPORTED;
-    PWR_DEBUG_TRACE(Instance, "ADVICE: Update BSP_USBPD_PWR_VBUSIsOn");
+    ret = BSP_ERROR_NONE;
+    state = (PWRS_GetLevel() == PWRS_LEVEL_PRESENT) ? 1U : 0U;
   }
   *pState = state;
   return ret;
@@ -780,6 +795,29 @@ __weak void BSP_USBPD_PWR_EventCallback(uint32_t Instance)
   */
 
 /* USER CODE BEGIN POWER_Private_Functions */
+/**
+  * @brief  VBUS watchdog level change, forwarded to the registered detect callback
+  * @note   Called from the ADC interrupt. VBUS is reported absent as soon as it
+  *         leaves the present level, i.e. falls below the disconnection threshold.
+  * @param  level New VBUS level
+  * @retval None
+  */
+void PWRS_LevelCallback(PWRS_LevelTypeDef level)
+{
+  USBPD_PWR_VBUSConnectionStatusTypeDef status = (level == PWRS_LEVEL_PRESENT) ? VBUS_CONNECTED : VBUS_NOT_CONNECTED;
+
+  if (status == PWR_VBUSStatus)
+  {
+    return;
+  }
+  PWR_VBUSStatus = status;
+
+  if (PWR_VBUSDetectCallback[USBPD_PWR_TYPE_C_PORT_1] != NULL)
+  {
+    PWR_VBUSDetectCallback[USBPD_PWR_TYPE_C_PORT_1](USBPD_PWR_TYPE_C_PORT_1, status);
+  }
+  BSP_USBPD_PWR_EventCallback(USBPD_PWR_TYPE_C_PORT_1);
+}
 
 /* USER CODE END POWER_Private_Functions */
 